@@ -0,0 +1,93 @@
+#include "bench.h"
+#include "../src/IO/assetPack.h"
+
+#include <cstdio>
+#include <fstream>
+#include <system_error>
+
+namespace VULKVULK{
+
+namespace{
+
+//  what Pipeline::readFile did for every file before the pack : open, size, read
+size_t readLoose(const std::string& path){
+    std::ifstream file{path, std::ios::ate | std::ios::binary};
+    if(!file.is_open()){
+        return 0;
+    }
+    std::vector<char> buffer(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return buffer.size();
+}
+
+}   //  namespace
+
+//  Loose files vs one pack holding the same files : mount + lookup + copy out, everything the app would read
+//  Files are in the OS cache after the first run -> this shows the per file open cost, a cold disk only adds seeks
+void benchAssetPack(){
+    constexpr int ITERATIONS = 10;
+    std::vector<AssetPack::source> sources{};
+    std::error_code ec;
+    for(const char* directory : {"./src/GameAsset/Models", "./shaders/compiledShaders"}){
+        for(std::filesystem::recursive_directory_iterator it{directory, ec}, end; !ec && it != end; it.increment(ec)){
+            if(it->is_regular_file(ec) && it->file_size(ec) > 0){
+                sources.push_back({it->path().string(), it->path().string()});
+            }
+        }
+    }
+    if(sources.empty()){
+        std::printf("no files to pack\n");
+        return;
+    }
+    const std::string packPath = (std::filesystem::temp_directory_path(ec) / "vulkvulk_bench.vkpack").string();
+    if(!AssetPack::write(packPath, sources)){
+        std::printf("could not write %s\n", packPath.c_str());
+        return;
+    }
+
+    size_t looseBytes = 0;
+    const double looseTime = benchBestTime(ITERATIONS, [&]{
+        looseBytes = 0;
+        for(const auto& source : sources){
+            looseBytes += readLoose(source.path);
+        }
+    });
+    //  how the mesh/texture caches were opened before the pack : a mapping per file
+    size_t mappedBytes = 0;
+    const double mappedTime = benchBestTime(ITERATIONS, [&]{
+        mappedBytes = 0;
+        for(const auto& source : sources){
+            MappedFile file{};
+            if(file.open(source.path)){
+                std::vector<char> buffer(file.data(), file.data() + file.size());
+                mappedBytes += buffer.size();
+            }
+        }
+    });
+    size_t packBytes = 0;
+    const double packTime = benchBestTime(ITERATIONS, [&]{
+        AssetPack pack{};
+        packBytes = 0;
+        if(!pack.mount(packPath)){
+            return;
+        }
+        for(const auto& source : sources){
+            if(const AssetPack::entryView entry = pack.find(source.name)){
+                std::vector<char> buffer(entry.data, entry.data + entry.size);
+                packBytes += buffer.size();
+            }
+        }
+    });
+    std::filesystem::remove(packPath, ec);
+
+    const double megaBytes = double(looseBytes) / (1 << 20);
+    std::printf("%-12s %8s %10s %10s %10s\n", "", "files", "MB", "ms", "MB/s");
+    std::printf("%-12s %8zu %10.1f %10.2f %10.0f\n", "loose read", sources.size(), megaBytes, looseTime * 1e3, megaBytes / looseTime);
+    std::printf("%-12s %8zu %10.1f %10.2f %10.0f\n", "loose mmap", sources.size(), double(mappedBytes) / (1 << 20), mappedTime * 1e3,
+                double(mappedBytes) / (1 << 20) / mappedTime);
+    std::printf("%-12s %8zu %10.1f %10.2f %10.0f%s\n", "pack", sources.size(), double(packBytes) / (1 << 20), packTime * 1e3,
+                double(packBytes) / (1 << 20) / packTime, packBytes == looseBytes ? "" : "  MISMATCH");
+}
+
+}   //  namespace VULKVULK
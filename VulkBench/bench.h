@@ -0,0 +1,61 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace VULKVULK{
+
+//  Models we ship -> missing ones(backpack.obj is not in the repo) are skipped
+inline const std::vector<std::string>& benchModelPaths(){
+    static const std::vector<std::string> paths = {
+        "./src/GameAsset/Models/colored_cube.obj",
+        "./src/GameAsset/Models/flat_vase.obj",
+        "./src/GameAsset/Models/smooth_vase.obj",
+        "./src/GameAsset/Models/ps1_rusty_robot.obj",
+        "./src/GameAsset/Models/backpack/backpack.obj",
+    };
+    return paths;
+}
+
+inline bool benchFileExists(const std::string& path){
+    std::error_code ec;
+    return std::filesystem::is_regular_file(path, ec);
+}
+
+//  Best wall time of "iterations" runs in seconds -> best instead of average filters out scheduler noise
+inline double benchBestTime(int iterations, const std::function<void()>& fn){
+    double best = 1e30;
+    for(int i = 0; i < iterations; i++){
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        auto end = std::chrono::high_resolution_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - start).count());
+    }
+    return best;
+}
+
+//  Every benchmark lives in its own file
+void benchObjLoader();
+void benchVertexDedup();
+void benchMeshOptimizer();
+void benchVertexQuantizer();
+void benchIndexPacker();
+void benchMeshSimplifier();
+void benchMeshletBuilder();
+void benchObjStream();
+void benchTexture();
+void benchGeometryCodec();
+void benchAssetPack();
+void benchVertexWelder();
+void benchSplitStream();
+void benchSceneFile();
+void benchImpostorBaker();
+
+}   //  namespace VULKVULK
+
+#endif
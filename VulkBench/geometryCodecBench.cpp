@@ -0,0 +1,86 @@
+#include "bench.h"
+#include "../src/Render/geometryCodec.h"
+#include "../src/Render/meshOptimizer.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace VULKVULK{
+
+namespace{
+//  size x size quad grid with a wavy surface -> realistic float mantissas instead of whole numbers
+Model::bufferData makeTerrain(uint32_t size){
+    Model::bufferData terrain{};
+    for(uint32_t y = 0; y <= size; y++){
+        for(uint32_t x = 0; x <= size; x++){
+            Model::Vertex vertex{};
+            float fx = float(x) / size, fy = float(y) / size;
+            vertex.position = {fx, 0.05f * std::sin(fx * 31.0f) * std::cos(fy * 17.0f), fy};
+            vertex.normal = glm::normalize(glm::vec3{-1.55f * std::cos(fx * 31.0f) * std::cos(fy * 17.0f), 1.0f, 0.85f * std::sin(fx * 31.0f) * std::sin(fy * 17.0f)});
+            vertex.color = {1.0f, 1.0f, 1.0f};
+            vertex.uv = {fx, fy};
+            terrain.vertices.push_back(vertex);
+        }
+    }
+    for(uint32_t y = 0; y < size; y++){
+        for(uint32_t x = 0; x < size; x++){
+            uint32_t i = y * (size + 1) + x;
+            terrain.indices.insert(terrain.indices.end(), {i, i + size + 1, i + 1, i + 1, i + size + 1, i + size + 2});
+        }
+    }
+    return terrain;
+}
+}   //  namespace
+
+//  Compression ratio and single thread encode/decode speed(decode MB/s counts decoded bytes)
+//  Meshes big enough to matter(the synthetic terrain) have to decode at DECODE_TARGET_MB or more -> "SLOW" otherwise
+void benchGeometryCodec(){
+    constexpr int ITERATIONS = 5;
+    constexpr double DECODE_TARGET_MB = 1024.0;
+    constexpr size_t TARGET_MIN_BYTES = 16u << 20;     //  small meshes are dominated by per block setup
+    std::printf("%-48s %10s %10s %7s %7s %11s %11s %s\n", "model", "raw KB", "coded KB", "vertex", "index",
+                "encode MB/s", "decode MB/s", "");
+    auto report = [&](const std::string& name, Model::bufferData& bData){
+        //  same vertex order the cache stores
+        MeshOptimizer::optimize(bData, std::cout);
+        const uint32_t vertexCount = static_cast<uint32_t>(bData.vertices.size());
+        const uint32_t indexCount = static_cast<uint32_t>(bData.indices.size());
+        const size_t vertexBytes = size_t(vertexCount) * sizeof(Model::Vertex);
+        const size_t indexBytes = size_t(indexCount) * sizeof(uint32_t);
+
+        std::vector<uint8_t> vertexCode, indexCode;
+        double encodeTime = benchBestTime(ITERATIONS, [&]{
+            vertexCode = GeometryCodec::encodeVertices(bData.vertices.data(), vertexCount);
+            indexCode = GeometryCodec::encodeIndices(bData.indices.data(), indexCount);
+        });
+        std::vector<Model::Vertex> vertices(vertexCount);
+        std::vector<uint32_t> indices(indexCount);
+        bool decoded = true;
+        double decodeTime = benchBestTime(ITERATIONS, [&]{
+            decoded &= GeometryCodec::decodeVertices(vertexCode.data(), vertexCode.size(), vertices.data(), vertexCount, false);
+            decoded &= GeometryCodec::decodeIndices(indexCode.data(), indexCode.size(), indices.data(), indexCount, false);
+        });
+        bool same = decoded && std::memcmp(vertices.data(), bData.vertices.data(), vertexBytes) == 0
+                    && std::memcmp(indices.data(), bData.indices.data(), indexBytes) == 0;
+        const double rawMB = (vertexBytes + indexBytes) / double(1 << 20);
+        const bool slow = vertexBytes + indexBytes >= TARGET_MIN_BYTES && rawMB / decodeTime < DECODE_TARGET_MB;
+        std::printf("%-48s %10.1f %10.1f %6.1f%% %6.1f%% %11.0f %11.0f %s%s\n", name.c_str(),
+                    (vertexBytes + indexBytes) / 1024.0, (vertexCode.size() + indexCode.size()) / 1024.0,
+                    100.0 * vertexCode.size() / std::max<size_t>(vertexBytes, 1), 100.0 * indexCode.size() / std::max<size_t>(indexBytes, 1),
+                    rawMB / encodeTime, rawMB / decodeTime, same ? "" : "MISMATCH ", slow ? "SLOW" : "");
+    };
+    for(const auto& path : benchModelPaths()){
+        if(!benchFileExists(path)){
+            continue;
+        }
+        Model::bufferData bData{};
+        bData.loadModel(path);
+        report(path, bData);
+    }
+    Model::bufferData terrain = makeTerrain(1023);
+    report("synthetic terrain 1023x1023", terrain);
+    std::printf("decode target : %.0f MB/s per core for meshes of %zu MB or more\n", DECODE_TARGET_MB, TARGET_MIN_BYTES >> 20);
+}
+
+}   //  namespace VULKVULK
@@ -0,0 +1,60 @@
+#include "bench.h"
+#include "../src/Render/impostorBaker.h"
+#include "../src/Render/meshSimplifier.h"
+
+#include <cstdio>
+
+namespace VULKVULK{
+
+//  Every frame direction maps back to its own frame and every frame shows some of the model
+static bool validateAtlas(const ImpostorAtlas& atlas, double& coverage){
+    for(uint32_t y = 0; y < atlas.frames; y++){
+        for(uint32_t x = 0; x < atlas.frames; x++){
+            if(ImpostorBaker::frameFor(atlas.frames, ImpostorBaker::frameDirection(atlas.frames, x, y)) != x + y * atlas.frames){
+                return false;
+            }
+        }
+    }
+    const uint32_t size = atlas.color.width;
+    std::vector<size_t> covered(size_t(atlas.frames) * atlas.frames, 0);
+    size_t total = 0;
+    for(uint32_t y = 0; y < size; y++){
+        for(uint32_t x = 0; x < size; x++){
+            if(atlas.color.data[(size_t(y) * size + x) * 4 + 3] != 0){
+                covered[(y / atlas.frameSize) * atlas.frames + x / atlas.frameSize]++;
+                total++;
+            }
+        }
+    }
+    coverage = double(total) / (double(size) * size);
+    return std::find(covered.begin(), covered.end(), size_t(0)) == covered.end();
+}
+
+//  8x8 frames of 64 pixels per model : baked from level 0 vs from the LOD chain(coarsest level under a pixel)
+void benchImpostorBaker(){
+    constexpr int ITERATIONS = 3;
+    const std::vector<float> ratios{0.5f, 0.25f, 0.125f};
+    const ImpostorBaker::settings config{};
+    std::printf("%-48s %10s %10s %10s %10s %9s %6s\n", "model", "triangles", "level 0", "lod chain", "atlas KB", "coverage", "valid");
+    for(const auto& path : benchModelPaths()){
+        if(!benchFileExists(path)){
+            continue;
+        }
+        Model::bufferData source{};
+        source.loadModel(path);
+        ImpostorAtlas atlas{};
+        const double fullTime = benchBestTime(ITERATIONS, [&]{
+            atlas = ImpostorBaker::bake(source.view(), config);
+        });
+        MeshSimplifier::buildLodChain(source, ratios, 0.02f);
+        const double lodTime = benchBestTime(ITERATIONS, [&]{
+            atlas = ImpostorBaker::bake(source.view(), config);
+        });
+        double coverage = 0.0;
+        const bool valid = validateAtlas(atlas, coverage);
+        std::printf("%-48s %10zu %7.2f ms %7.2f ms %10zu %8.1f%% %6s\n", path.c_str(), source.indices.size() / 3,
+                    fullTime * 1e3, lodTime * 1e3, atlas.getMemorySize() / 1024, coverage * 100.0, valid ? "ok" : "FAIL");
+    }
+}
+
+}   //  namespace VULKVULK
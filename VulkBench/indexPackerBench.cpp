@@ -0,0 +1,72 @@
+#include "bench.h"
+#include "../src/Render/indexPacker.h"
+
+#include <cstdio>
+
+namespace VULKVULK{
+
+namespace{
+//  size x size quad grid -> (size+1)^2 vertices, big enough to force splitting
+Model::bufferData makeGrid(uint32_t size){
+    Model::bufferData grid{};
+    for(uint32_t y = 0; y <= size; y++){
+        for(uint32_t x = 0; x <= size; x++){
+            Model::Vertex vertex{};
+            vertex.position = {float(x), 0.0f, float(y)};
+            vertex.normal = {0.0f, 1.0f, 0.0f};
+            grid.vertices.push_back(vertex);
+        }
+    }
+    for(uint32_t y = 0; y < size; y++){
+        for(uint32_t x = 0; x < size; x++){
+            uint32_t i = y * (size + 1) + x;
+            grid.indices.insert(grid.indices.end(), {i, i + size + 1, i + 1, i + 1, i + size + 1, i + size + 2});
+        }
+    }
+    return grid;
+}
+
+//  every range stays inside 16 bit addressing and resolves to the same triangles as the source
+bool samePrimitives(const Model::bufferData& source, const IndexPacker::Result& packed){
+    const std::vector<Model::Vertex>& vertices = packed.vertices.empty() ? source.vertices : packed.vertices;
+    size_t drawn = 0;
+    for(const auto& range : packed.ranges){
+        for(uint32_t i = range.firstIndex; i < range.firstIndex + range.indexCount; i++){
+            size_t vertex = size_t(range.vertexOffset) + packed.indices[i];
+            if(vertex >= vertices.size() || !(vertices[vertex] == source.vertices[source.indices[i]])){
+                return false;
+            }
+        }
+        drawn += range.indexCount;
+    }
+    return drawn == source.indices.size();
+}
+}   //  namespace
+
+//  Index memory 32 vs 16 bit, number of draws and vertices duplicated on chunk borders
+void benchIndexPacker(){
+    constexpr int ITERATIONS = 5;
+    std::printf("%-48s %10s %10s %10s %7s %10s %9s\n", "model", "vertices", "32bit KB", "16bit KB", "ranges", "duplicated", "time");
+    auto report = [&](const std::string& name, const Model::bufferData& bData){
+        IndexPacker::Result packed{};
+        double time = benchBestTime(ITERATIONS, [&]{
+            IndexPacker::pack(bData.view(), packed);
+        });
+        size_t vertexCount = packed.vertices.empty() ? bData.vertices.size() : packed.vertices.size();
+        std::printf("%-48s %10zu %10.1f %10.1f %7zu %10zu %6.2f ms%s\n",
+                    name.c_str(), bData.vertices.size(), bData.indices.size() * 4 / 1024.0, packed.indices.size() * 2 / 1024.0,
+                    packed.ranges.size(), vertexCount - bData.vertices.size(), time * 1e3,
+                    samePrimitives(bData, packed) ? "" : "  MISMATCH");
+    };
+    for(const auto& path : benchModelPaths()){
+        if(!benchFileExists(path)){
+            continue;
+        }
+        Model::bufferData bData{};
+        bData.loadModel(path);
+        report(path, bData);
+    }
+    report("synthetic grid 511x511", makeGrid(511));
+}
+
+}   //  namespace VULKVULK
@@ -0,0 +1,53 @@
+#include "bench.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace{
+struct BenchEntry{
+    const char* name;
+    void (*run)();
+};
+const BenchEntry BENCHES[] = {
+    {"objLoader", VULKVULK::benchObjLoader},
+    {"vertexDedup", VULKVULK::benchVertexDedup},
+    {"meshOptimizer", VULKVULK::benchMeshOptimizer},
+    {"vertexQuantizer", VULKVULK::benchVertexQuantizer},
+    {"indexPacker", VULKVULK::benchIndexPacker},
+    {"meshSimplifier", VULKVULK::benchMeshSimplifier},
+    {"meshletBuilder", VULKVULK::benchMeshletBuilder},
+    {"objStream", VULKVULK::benchObjStream},
+    {"texture", VULKVULK::benchTexture},
+    {"geometryCodec", VULKVULK::benchGeometryCodec},
+    {"assetPack", VULKVULK::benchAssetPack},
+    {"vertexWelder", VULKVULK::benchVertexWelder},
+    {"splitStream", VULKVULK::benchSplitStream},
+    {"sceneFile", VULKVULK::benchSceneFile},
+    {"impostorBaker", VULKVULK::benchImpostorBaker},
+};
+}
+
+//  Usage : VULKVULK_BENCH [name]  -> runs every benchmark when no name is given
+int main(int argc, char** argv){
+    try{
+        bool found = false;
+        for(const auto& bench : BENCHES){
+            if(argc > 1 && std::strcmp(argv[1], bench.name) != 0){
+                continue;
+            }
+            found = true;
+            std::cout << "==== " << bench.name << " ====\n";
+            bench.run();
+        }
+        if(!found){
+            std::cerr << "Unknown benchmark : " << argv[1] << '\n';
+            return EXIT_FAILURE;
+        }
+    }catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,57 @@
+#include "bench.h"
+#include "../src/Render/meshOptimizer.h"
+
+#include <array>
+#include <cstdio>
+#include <iostream>
+
+namespace VULKVULK{
+
+namespace{
+//  Triangles as sorted list of rotated(smallest position first) vertex triples -> winding kept, start corner ignored
+std::vector<std::array<Model::Vertex, 3>> triangleSet(const Model::bufferData& bData){
+    std::vector<std::array<Model::Vertex, 3>> triangles;
+    triangles.reserve(bData.indices.size() / 3);
+    for(size_t i = 0; i + 2 < bData.indices.size(); i += 3){
+        std::array<uint32_t, 3> tri{bData.indices[i], bData.indices[i + 1], bData.indices[i + 2]};
+        auto first = std::min_element(tri.begin(), tri.end(), [&](uint32_t a, uint32_t b){
+            return std::hash<Model::Vertex>{}(bData.vertices[a]) < std::hash<Model::Vertex>{}(bData.vertices[b]);
+        });
+        std::rotate(tri.begin(), first, tri.end());
+        triangles.push_back({bData.vertices[tri[0]], bData.vertices[tri[1]], bData.vertices[tri[2]]});
+    }
+    auto key = [](const std::array<Model::Vertex, 3>& t){
+        return std::array<size_t, 3>{std::hash<Model::Vertex>{}(t[0]), std::hash<Model::Vertex>{}(t[1]), std::hash<Model::Vertex>{}(t[2])};
+    };
+    std::sort(triangles.begin(), triangles.end(), [&](const auto& a, const auto& b){ return key(a) < key(b); });
+    return triangles;
+}
+}   //  namespace
+
+//  Post-transform cache efficiency before/after the optimizer, plus its cost at load time
+void benchMeshOptimizer(){
+    constexpr int ITERATIONS = 5;
+    std::printf("%-48s %10s %16s %16s %10s\n", "model", "triangles", "ACMR", "ATVR", "time");
+    for(const auto& path : benchModelPaths()){
+        if(!benchFileExists(path)){
+            continue;
+        }
+        Model::bufferData source{};
+        source.loadModel(path);
+        auto before = MeshOptimizer::analyzeVertexCache(source.indices.data(), source.indices.size(), source.vertices.size());
+
+        Model::bufferData optimized{};
+        double time = benchBestTime(ITERATIONS, [&]{
+            optimized = source;
+            MeshOptimizer::optimize(optimized, std::cout, false);
+        });
+        auto after = MeshOptimizer::analyzeVertexCache(optimized.indices.data(), optimized.indices.size(), optimized.vertices.size());
+        bool same = triangleSet(source) == triangleSet(optimized);
+
+        std::printf("%-48s %10zu %7.3f -> %5.3f %7.3f -> %5.3f %7.2f ms%s\n",
+                    path.c_str(), source.indices.size() / 3, before.acmr, after.acmr, before.atvr, after.atvr,
+                    time * 1e3, same ? "" : "  MISMATCH");
+    }
+}
+
+}   //  namespace VULKVULK
@@ -0,0 +1,42 @@
+#include "bench.h"
+#include "../src/Render/meshSimplifier.h"
+
+#include <cstdio>
+
+namespace VULKVULK{
+
+//  LOD chain per model : triangles and error of every level(error relative to mesh radius) and build time
+void benchMeshSimplifier(){
+    constexpr int ITERATIONS = 3;
+    const std::vector<float> ratios{0.5f, 0.25f, 0.125f, 0.0625f};
+    constexpr float MAX_ERROR = 0.02f;
+    std::printf("%-48s %10s %s\n", "model", "time", "levels(triangles @ error)");
+    for(const auto& path : benchModelPaths()){
+        if(!benchFileExists(path)){
+            continue;
+        }
+        Model::bufferData source{};
+        source.loadModel(path);
+
+        Model::bufferData lods{};
+        double time = benchBestTime(ITERATIONS, [&]{
+            lods = source;
+            MeshSimplifier::buildLodChain(lods, ratios, MAX_ERROR);
+        });
+
+        glm::vec3 minPos = source.vertices[0].position, maxPos = minPos;
+        for(const auto& vertex : source.vertices){
+            minPos = glm::min(minPos, vertex.position);
+            maxPos = glm::max(maxPos, vertex.position);
+        }
+        float radius = glm::length(maxPos - minPos) * 0.5f;
+
+        std::printf("%-48s %7.1f ms", path.c_str(), time * 1e3);
+        for(const auto& level : lods.lods){
+            std::printf("  %u @ %.4f", level.indexCount / 3, level.error / radius);
+        }
+        std::printf("\n");
+    }
+}
+
+}   //  namespace VULKVULK
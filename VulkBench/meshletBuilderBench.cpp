@@ -0,0 +1,99 @@
+#include "bench.h"
+#include "../src/Render/meshletBuilder.h"
+#include "../src/Render/meshSimplifier.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <random>
+
+namespace VULKVULK{
+
+//  Sorted triangle list with rotation normalized so the smallest index comes first(winding is kept)
+static std::vector<std::array<uint32_t, 3>> sortedTriangles(const uint32_t* indices, uint32_t indexCount){
+    std::vector<std::array<uint32_t, 3>> triangles(indexCount / 3);
+    for(uint32_t t = 0; t < indexCount / 3; t++){
+        std::array<uint32_t, 3> tri{indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2]};
+        std::rotate(tri.begin(), std::min_element(tri.begin(), tri.end()), tri.end());
+        triangles[t] = tri;
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+//  Checks the meshlet invariants : same triangles per level, limits, spheres contain their vertices
+//  and cone culled meshlets only hold back facing triangles for random camera positions
+static bool validateMeshlets(const Model::bufferData& source, const Model::bufferData& built){
+    for(size_t l = 0; l < built.lods.size(); l++){
+        const auto& before = source.lods.empty() ? Model::lodLevel{0, static_cast<uint32_t>(source.indices.size())} : source.lods[l];
+        const auto& after = built.lods[l];
+        if(sortedTriangles(source.indices.data() + before.firstIndex, before.indexCount)
+            != sortedTriangles(built.indices.data() + after.firstIndex, after.indexCount)){
+            return false;
+        }
+    }
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> range(-1.0f, 1.0f);
+    for(const auto& cluster : built.meshlets){
+        if(cluster.vertexCount > MeshletBuilder::MAX_VERTICES || cluster.triangleCount > MeshletBuilder::MAX_TRIANGLES){
+            return false;
+        }
+        for(uint32_t i = 0; i < cluster.triangleCount * 3; i++){
+            const glm::vec3& position = built.vertices[built.indices[cluster.firstIndex + i]].position;
+            if(glm::distance(position, cluster.center) > cluster.radius * 1.0001f + 1e-6f){
+                return false;
+            }
+        }
+        if(cluster.coneCutoff >= 1.0f){
+            continue;
+        }
+        for(int sample = 0; sample < 64; sample++){
+            Model::cullView view{};     //  zero planes -> only the cone test remains
+            view.cameraPosition = cluster.center + glm::vec3{range(rng), range(rng), range(rng)} * cluster.radius * 8.0f;
+            if(view.isVisible(cluster)){
+                continue;
+            }
+            for(uint32_t t = 0; t < cluster.triangleCount; t++){
+                const uint32_t* tri = built.indices.data() + cluster.firstIndex + t * 3;
+                const glm::vec3& a = built.vertices[tri[0]].position;
+                const glm::vec3& b = built.vertices[tri[1]].position;
+                const glm::vec3& c = built.vertices[tri[2]].position;
+                if(glm::dot(glm::cross(b - a, c - a), view.cameraPosition - a) > 1e-6f){
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+//  Meshlets per model over its LOD chain : count, average size, fill rate, cone cullable share and build time
+void benchMeshletBuilder(){
+    constexpr int ITERATIONS = 3;
+    const std::vector<float> ratios{0.5f, 0.25f, 0.125f};
+    std::printf("%-48s %9s %9s %9s %8s %8s %8s %10s %6s\n",
+        "model", "meshlets", "avg vert", "avg tri", "v fill", "t fill", "cone", "time", "valid");
+    for(const auto& path : benchModelPaths()){
+        if(!benchFileExists(path)){
+            continue;
+        }
+        Model::bufferData source{};
+        source.loadModel(path);
+        MeshSimplifier::buildLodChain(source, ratios, 0.02f);
+
+        Model::bufferData built{};
+        double time = benchBestTime(ITERATIONS, [&]{
+            built = source;
+            MeshletBuilder::build(built);
+        });
+
+        auto stats = MeshletBuilder::computeStats(built.meshlets);
+        std::printf("%-48s %9zu %9.1f %9.1f %7.1f%% %7.1f%% %7.1f%% %7.2f ms %6s\n",
+            path.c_str(), stats.meshletCount, stats.averageVertices, stats.averageTriangles,
+            stats.vertexFill * 100.0f, stats.triangleFill * 100.0f, stats.coneCullable * 100.0f,
+            time * 1e3, validateMeshlets(source, built) ? "ok" : "FAIL");
+    }
+}
+
+}   //  namespace VULKVULK
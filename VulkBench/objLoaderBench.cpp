@@ -0,0 +1,65 @@
+#include "bench.h"
+#include "../src/IO/objLoader.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace VULKVULK{
+
+namespace{
+
+//  number of vertices whose bytes differ, -1 when vertex/index/submesh layout itself differs
+long long countDifferences(const Model::bufferData& a, const Model::bufferData& b){
+    if(a.vertices.size() != b.vertices.size() || a.indices != b.indices || a.submeshes.size() != b.submeshes.size()
+        || a.materials.size() != b.materials.size()){
+        return -1;
+    }
+    long long differences = 0;
+    for(size_t i = 0; i < a.vertices.size(); i++){
+        differences += std::memcmp(&a.vertices[i], &b.vertices[i], sizeof(Model::Vertex)) != 0;
+    }
+    return differences;
+}
+
+}   //  namespace
+
+//  Parse throughput(file MB / best wall time, includes triangulation + dedup) of tinyobj vs the native loader
+void benchObjLoader(){
+    constexpr int ITERATIONS = 5;
+    std::printf("%-48s %10s %12s %12s %12s  %s\n", "model", "size(MB)", "tinyobj", "native", "native exact", "result");
+    for(const auto& path : benchModelPaths()){
+        if(!benchFileExists(path)){
+            std::printf("%-48s missing, skipped\n", path.c_str());
+            continue;
+        }
+        double megaBytes = double(std::filesystem::file_size(path)) / (1024.0 * 1024.0);
+
+        Model::bufferData reference{};
+        double tinyObjTime = benchBestTime(ITERATIONS, [&]{ reference.loadModelTinyObj(path); });
+
+        Model::bufferData compatible{};
+        bool supported = true;
+        double compatibleTime = benchBestTime(ITERATIONS, [&]{ supported = ObjLoader::load(path, compatible); });
+        if(!supported){
+            std::printf("%-48s %10.2f %7.1f MB/s %12s %12s  native loader falls back to tinyobj\n",
+                        path.c_str(), megaBytes, megaBytes / tinyObjTime, "-", "-");
+            continue;
+        }
+
+        Model::bufferData exact{};
+        ObjLoaderOptions exactOptions{};
+        exactOptions.exactFloats = true;
+        double exactTime = benchBestTime(ITERATIONS, [&]{ ObjLoader::load(path, exact, exactOptions); });
+
+        //  compatible mode has to be bit identical, exact mode may only differ where tinyobj rounds wrong
+        long long compatibleDiff = countDifferences(reference, compatible);
+        long long exactDiff = countDifferences(reference, exact);
+        char result[128];
+        std::snprintf(result, sizeof(result), "%s, exact differs in %lld of %zu vertices",
+                      compatibleDiff == 0 ? "identical" : "MISMATCH", exactDiff, exact.vertices.size());
+        std::printf("%-48s %10.2f %7.1f MB/s %7.1f MB/s %7.1f MB/s  %s\n",
+                    path.c_str(), megaBytes, megaBytes / tinyObjTime, megaBytes / compatibleTime, megaBytes / exactTime, result);
+    }
+}
+
+}   //  namespace VULKVULK
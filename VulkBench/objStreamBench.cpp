@@ -0,0 +1,65 @@
+#include "bench.h"
+#include "../src/IO/objLoader.h"
+
+#include <cstdio>
+
+namespace VULKVULK{
+
+//  Streaming import vs the in memory loader : time, vertex count, peak memory held by the import
+//  Valid when both produce the same triangle corners(vertex values per index) in the same order
+//  and the counts announced by begin() are exactly what gets streamed(GPU buffers are sized by them)
+void benchObjStream(){
+    constexpr int ITERATIONS = 3;
+    ObjStreamOptions options{};
+    options.windowSize = size_t(64) << 10;      //  small window so it shows on the models we ship
+    options.batchSize = size_t(64) << 10;
+    std::printf("%-48s %10s %10s %10s %10s %12s %12s %6s\n",
+        "model", "load", "stream", "vertices", "streamed", "mesh(KB)", "peak(KB)", "valid");
+    for(const auto& path : benchModelPaths()){
+        if(!benchFileExists(path)){
+            continue;
+        }
+        Model::bufferData loaded{};
+        if(!ObjLoader::load(path, loaded)){
+            std::printf("%-48s not supported by the native loader, skipped\n", path.c_str());
+            continue;
+        }
+        double loadTime = benchBestTime(ITERATIONS, [&]{ ObjLoader::load(path, loaded); });
+
+        Model::bufferData streamed{};
+        size_t announcedIndices = 0, announcedVertices = 0;
+        ObjStreamSink sink{};
+        sink.begin = [&](size_t indexCount, size_t vertexCount){
+            streamed.vertices.clear();
+            streamed.indices.clear();
+            streamed.indices.reserve(indexCount);
+            announcedIndices = indexCount;
+            announcedVertices = vertexCount;
+        };
+        sink.vertices = [&](const Model::Vertex* vertices, size_t count){
+            streamed.vertices.insert(streamed.vertices.end(), vertices, vertices + count);
+        };
+        sink.indices = [&](const uint32_t* indices, size_t count){
+            streamed.indices.insert(streamed.indices.end(), indices, indices + count);
+        };
+        ObjStreamStats stats{};
+        bool ok = true;
+        double streamTime = benchBestTime(ITERATIONS, [&]{ ok = ObjLoader::stream(path, sink, stats, options) && ok; });
+        if(!ok){
+            std::printf("%-48s stream failed : %s\n", path.c_str(), stats.error.c_str());
+            continue;
+        }
+
+        bool valid = streamed.indices.size() == loaded.indices.size()
+                  && announcedIndices == streamed.indices.size() && announcedVertices == streamed.vertices.size();
+        for(size_t i = 0; valid && i < loaded.indices.size(); i++){
+            valid = streamed.vertices[streamed.indices[i]] == loaded.vertices[loaded.indices[i]];
+        }
+        size_t meshBytes = streamed.vertices.size() * sizeof(Model::Vertex) + streamed.indices.size() * sizeof(uint32_t);
+        std::printf("%-48s %7.2f ms %7.2f ms %10zu %10zu %12zu %12zu %6s\n",
+            path.c_str(), loadTime * 1e3, streamTime * 1e3, loaded.vertices.size(), streamed.vertices.size(),
+            meshBytes >> 10, stats.peakMemory >> 10, valid ? "ok" : "FAIL");
+    }
+}
+
+}   //  namespace VULKVULK
@@ -0,0 +1,76 @@
+#include "bench.h"
+#include "../src/IO/sceneFile.h"
+
+#include <cstdio>
+#include <fstream>
+#include <system_error>
+
+namespace VULKVULK{
+
+//  Million object scene : text conversion(parse + write) vs writing the binary alone vs map + instantiate
+//  Instantiation gets empty model handles -> measures the GameObject fill, not model loading
+void benchSceneFile(){
+    constexpr int ITERATIONS = 3;
+    constexpr uint32_t SIDE = 1000;     //  SIDE * SIDE objects on a grid
+    std::error_code ec;
+    const std::string sourcePath = (std::filesystem::temp_directory_path(ec) / "vulkvulk_bench.scene").string();
+    {
+        std::ofstream out{sourcePath, std::ios::trunc};
+        out << "model flat_vase ./src/GameAsset/Models/flat_vase.obj optimize compact lods meshlets\n"
+               "model smooth_vase ./src/GameAsset/Models/smooth_vase.obj optimize compact lods meshlets\n";
+        char line[160];
+        for(uint32_t z = 0; z < SIDE; z++){
+            for(uint32_t x = 0; x < SIDE; x++){
+                const int length = std::snprintf(line, sizeof(line), "object %s t %.2f 0.5 %.2f r 0 %.3f 0 s 3 1.5 3 c %.2f 0.5 0.5\n",
+                                                 (x + z) % 2 ? "smooth_vase" : "flat_vase", x * 2.5f, z * 2.5f, float(x % 7),
+                                                 float(z % 10) * 0.1f);
+                out.write(line, length);
+            }
+        }
+    }
+
+    std::string error{};
+    SceneFile::sceneData scene{};
+    const double parseTime = benchBestTime(ITERATIONS, [&]{
+        if(!SceneFile::parseText(sourcePath, scene, error)){
+            std::printf("%s\n", error.c_str());
+        }
+    });
+    bool written = true;
+    const double writeTime = benchBestTime(ITERATIONS, [&]{
+        written = SceneFile::write(sourcePath, scene);
+    });
+    if(!written || scene.objectCount() != size_t(SIDE) * SIDE){
+        std::printf("could not convert %s\n", sourcePath.c_str());
+        std::filesystem::remove(sourcePath, ec);
+        return;
+    }
+
+    size_t instantiated = 0;
+    bool same = true;
+    const double loadTime = benchBestTime(ITERATIONS, [&]{
+        SceneFile file{};
+        std::vector<GameObject> objects{};
+        if(!file.open(sourcePath)){
+            return;
+        }
+        file.instantiate(std::vector<ModelHandle>(file.getModelCount()), objects);
+        instantiated = objects.size();
+        same = instantiated == scene.objectCount() && objects.back().transform.translation == scene.translations.back()
+               && objects.back().color == scene.colors.back();
+    });
+
+    const double textMegaBytes = double(std::filesystem::file_size(sourcePath, ec)) / (1 << 20);
+    const double binaryMegaBytes = double(std::filesystem::file_size(SceneFile::cachePathFor(sourcePath), ec)) / (1 << 20);
+    std::printf("%-22s %10s %10s %10s\n", "", "objects", "MB", "ms");
+    std::printf("%-22s %10zu %10.1f %10.1f\n", "text parse", scene.objectCount(), textMegaBytes, parseTime * 1e3);
+    std::printf("%-22s %10zu %10.1f %10.1f\n", "binary write", scene.objectCount(), binaryMegaBytes, writeTime * 1e3);
+    std::printf("%-22s %10zu %10.1f %10.1f%s\n", "map + instantiate", instantiated, binaryMegaBytes, loadTime * 1e3,
+                same ? "" : "  MISMATCH");
+    std::printf("write + read : %.1f ms\n", (writeTime + loadTime) * 1e3);
+
+    std::filesystem::remove(SceneFile::cachePathFor(sourcePath), ec);
+    std::filesystem::remove(sourcePath, ec);
+}
+
+}   //  namespace VULKVULK
@@ -0,0 +1,90 @@
+#include "bench.h"
+#include "../src/Render/meshOptimizer.h"
+
+#include <array>
+#include <cstdio>
+#include <iostream>
+
+namespace VULKVULK{
+
+namespace{
+
+//  Small set associative LRU cache in front of memory, sized like the vertex fetch cache of a GPU shader core
+class FetchCache{
+public:
+    static constexpr size_t LINE_SIZE = 64;
+    static constexpr size_t SETS = 64;
+    static constexpr size_t WAYS = 4;       //  64 * 4 * 64 = 16 KB
+
+    //  bytes [address, address + size) -> lines that were not cached count as memory traffic
+    void read(size_t address, size_t size){
+        for(size_t line = address / LINE_SIZE; line <= (address + size - 1) / LINE_SIZE; line++){
+            touch(line);
+        }
+    }
+    size_t trafficBytes() const { return misses * LINE_SIZE; }
+
+private:
+    void touch(size_t line){
+        std::array<size_t, WAYS>& set = sets[line % SETS];
+        size_t way = 0;
+        while(way < WAYS && set[way] != line + 1){
+            way++;
+        }
+        if(way == WAYS){
+            misses++;
+            way = WAYS - 1;
+        }
+        //  move to front, oldest line falls off the back
+        for(; way > 0; way--){
+            set[way] = set[way - 1];
+        }
+        set[0] = line + 1;      //  0 marks an empty way
+    }
+
+    std::array<std::array<size_t, WAYS>, SETS> sets{};
+    size_t misses = 0;
+};
+
+//  Memory traffic of the position fetches of a depth only pass : every index of level 0 reads its vertex's position
+//  "stride" is the distance between two positions in the bound stream
+size_t depthPassTraffic(const Model::preparedMesh& mesh, size_t stride){
+    FetchCache cache{};
+    const Model::lodDraw& level = mesh.lods.front();
+    for(uint32_t r = level.firstRange; r < level.firstRange + level.rangeCount; r++){
+        const Model::drawRange& range = mesh.ranges[r];
+        for(uint32_t i = range.firstIndex; i < range.firstIndex + range.indexCount; i++){
+            const size_t vertex = size_t(mesh.indices[i]) + size_t(range.vertexOffset);
+            cache.read(vertex * stride, sizeof(glm::vec3));
+        }
+    }
+    return cache.trafficBytes();
+}
+
+}   //  namespace
+
+//  Vertex memory a position only pass(depth prepass, shadow map) pulls in through a 16 KB fetch cache
+//  interleaved Vertex buffer vs the position stream of VertexFormat::SPLIT, meshes in MeshOptimizer order
+void benchSplitStream(){
+    std::printf("%-48s %10s %12s %12s %12s %8s\n", "model", "vertices", "buffer KB", "full KB", "split KB", "saved");
+    for(const auto& path : benchModelPaths()){
+        if(!benchFileExists(path)){
+            std::printf("%-48s missing, skipped\n", path.c_str());
+            continue;
+        }
+        Model::bufferData bData{};
+        bData.loadModel(path);
+        MeshOptimizer::optimize(bData, std::cout, false);
+        const Model::preparedMesh full = Model::prepare(bData.view(), Model::VertexFormat::FULL);
+        const Model::preparedMesh split = Model::prepare(bData.view(), Model::VertexFormat::SPLIT);
+        if(full.lods.empty()){
+            continue;
+        }
+        const double fullKB = double(depthPassTraffic(full, sizeof(Model::Vertex))) / 1024.0;
+        const double splitKB = double(depthPassTraffic(split, sizeof(glm::vec3))) / 1024.0;
+        std::printf("%-48s %10u %12.1f %12.1f %12.1f %7.1f%%\n", path.c_str(), full.vertexCount,
+                    double(full.vertexData.size()) / 1024.0, fullKB, splitKB, 100.0 * (1.0 - splitKB / fullKB));
+    }
+}
+
+}   //  namespace VULKVULK
@@ -0,0 +1,60 @@
+#include "bench.h"
+#include "../src/IO/objLoader.h"
+#include "../src/Render/vertexDedup.h"
+
+#include <cstdio>
+#include <unordered_map>
+
+namespace VULKVULK{
+
+//  Welding throughput on the expanded(one vertex per corner) stream of each model
+//  "before" is the std::unordered_map + count() + operator[] x2 sequence the loaders used to run
+void benchVertexDedup(){
+    constexpr int ITERATIONS = 10;
+    std::printf("%-48s %10s %10s %16s %16s %8s\n", "model", "corners", "unique", "unordered_map", "flat table", "speedup");
+    for(const auto& path : benchModelPaths()){
+        if(!benchFileExists(path)){
+            continue;
+        }
+        Model::bufferData bData{};
+        bData.loadModel(path);
+        std::vector<Model::Vertex> corners;
+        corners.reserve(bData.indices.size());
+        for(uint32_t index : bData.indices){
+            corners.push_back(bData.vertices[index]);
+        }
+
+        std::vector<Model::Vertex> vertices;
+        std::vector<uint32_t> indices;
+        double mapTime = benchBestTime(ITERATIONS, [&]{
+            vertices.clear();
+            indices.clear();
+            std::unordered_map<Model::Vertex, uint32_t> uniqueVertices{};
+            for(const auto& vertex : corners){
+                if(uniqueVertices.count(vertex) == 0){
+                    uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
+                    vertices.push_back(vertex);
+                }
+                indices.push_back(uniqueVertices[vertex]);
+            }
+        });
+        bool sameAsMap = vertices.size() == bData.vertices.size() && indices == bData.indices;
+
+        double tableTime = benchBestTime(ITERATIONS, [&]{
+            vertices.clear();
+            indices.clear();
+            VertexDedupTable uniqueVertices{corners.size()};
+            for(const auto& vertex : corners){
+                indices.push_back(uniqueVertices.findOrInsert(vertex, vertices));
+            }
+        });
+        bool sameAsTable = vertices.size() == bData.vertices.size() && indices == bData.indices;
+
+        double millions = double(corners.size()) / 1e6;
+        std::printf("%-48s %10zu %10zu %9.1f Mv/s %11.1f Mv/s %7.2fx%s\n",
+                    path.c_str(), corners.size(), bData.vertices.size(), millions / mapTime, millions / tableTime,
+                    mapTime / tableTime, sameAsMap && sameAsTable ? "" : "  MISMATCH");
+    }
+}
+
+}   //  namespace VULKVULK
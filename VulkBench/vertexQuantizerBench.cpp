@@ -0,0 +1,53 @@
+#include "bench.h"
+#include "../src/Render/vertexQuantizer.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace VULKVULK{
+
+//  Vertex memory full vs compact, worst case decode error per attribute and encode cost
+void benchVertexQuantizer(){
+    constexpr int ITERATIONS = 5;
+    std::printf("%-48s %10s %10s %7s %11s %10s %9s %9s %9s\n",
+                "model", "full KB", "compact KB", "saved", "pos err", "normal deg", "uv err", "color err", "time");
+    for(const auto& path : benchModelPaths()){
+        if(!benchFileExists(path)){
+            continue;
+        }
+        Model::bufferData bData{};
+        bData.loadModel(path);
+
+        std::vector<Model::CompactVertex> compact;
+        VertexQuantizer::PositionBounds bounds{};
+        double time = benchBestTime(ITERATIONS, [&]{
+            VertexQuantizer::quantize(bData.view(), compact, bounds);
+        });
+
+        //  position error relative to bounds diagonal -> comparable across model sizes
+        float diagonal = 2.0f * glm::length(bounds.extent);
+        float positionError = 0.0f, normalError = 0.0f, uvError = 0.0f, colorError = 0.0f;
+        for(size_t i = 0; i < compact.size(); i++){
+            const Model::Vertex& source = bData.vertices[i];
+            Model::Vertex decoded = VertexQuantizer::decode(compact[i], bounds);
+            positionError = std::max(positionError, glm::length(decoded.position - source.position) / diagonal);
+            float normalLength = glm::length(source.normal);
+            if(normalLength > 0.0f){
+                float cosAngle = std::clamp(glm::dot(decoded.normal, source.normal / normalLength), -1.0f, 1.0f);
+                normalError = std::max(normalError, std::acos(cosAngle) * 57.29578f);
+            }
+            uvError = std::max({uvError, std::abs(decoded.uv.x - source.uv.x), std::abs(decoded.uv.y - source.uv.y)});
+            for(int c = 0; c < 3; c++){
+                colorError = std::max(colorError, std::abs(decoded.color[c] - std::clamp(source.color[c], 0.0f, 1.0f)));
+            }
+        }
+
+        double fullKB = double(bData.vertices.size() * sizeof(Model::Vertex)) / 1024.0;
+        double compactKB = double(compact.size() * sizeof(Model::CompactVertex)) / 1024.0;
+        std::printf("%-48s %10.1f %10.1f %6.1f%% %11.2e %10.4f %9.2e %9.2e %6.2f ms\n",
+                    path.c_str(), fullKB, compactKB, 100.0 * (1.0 - compactKB / fullKB),
+                    positionError, normalError, uvError, colorError, time * 1e3);
+    }
+}
+
+}   //  namespace VULKVULK
@@ -0,0 +1,70 @@
+#include "bench.h"
+#include "../src/Render/vertexWelder.h"
+
+#include <cstdio>
+
+namespace VULKVULK{
+
+namespace{
+
+//  What a scan export looks like to the exact dedup : every corner its own vertex, shared corners a few ulps apart
+Model::bufferData noisyCopy(const Model::bufferData& source, float noise){
+    Model::bufferData noisy{};
+    uint32_t state = 2463534242u;
+    auto jitter = [&]{
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return (float(state) / 4294967296.0f - 0.5f) * noise;
+    };
+    noisy.vertices.reserve(source.indices.size());
+    for(uint32_t index : source.indices){
+        Model::Vertex vertex = source.vertices[index];
+        vertex.position += glm::vec3{jitter(), jitter(), jitter()};
+        vertex.normal += glm::vec3{jitter(), jitter(), jitter()};
+        vertex.uv += glm::vec2{jitter(), jitter()};
+        noisy.indices.push_back(static_cast<uint32_t>(noisy.vertices.size()));
+        noisy.vertices.push_back(vertex);
+    }
+    noisy.bounds = source.bounds;
+    return noisy;
+}
+
+}   //  namespace
+
+//  Welding of each model with every corner split off and jittered by 1e-6 -> should land on the exact dedup count again
+//  The second run has to give the same arrays(determinism)
+void benchVertexWelder(){
+    constexpr int ITERATIONS = 5;
+    constexpr float NOISE = 1e-6f;
+    std::printf("%-48s %10s %10s %10s %10s %10s %10s\n", "model", "corners", "exact", "welded", "merged", "removed", "Mv/s");
+    for(const auto& path : benchModelPaths()){
+        if(!benchFileExists(path)){
+            continue;
+        }
+        Model::bufferData bData{};
+        bData.loadModel(path);
+        const Model::bufferData noisy = noisyCopy(bData, NOISE);
+        VertexWelder::tolerance limits{};
+        limits.position = 1e-5f * (bData.bounds.empty() ? 1.0f : bData.bounds[0].radius) + NOISE;
+        limits.normal = 1e-3f;
+        limits.color = 1.0f / 255.0f;
+        limits.uv = 1e-4f;
+
+        Model::bufferData welded{};
+        VertexWelder::Stats stats{};
+        const double time = benchBestTime(ITERATIONS, [&]{
+            welded = noisy;
+            stats = VertexWelder::weld(welded, limits);
+        });
+        Model::bufferData again = noisy;
+        VertexWelder::weld(again, limits);
+        const bool deterministic = again.indices == welded.indices && again.vertices == welded.vertices;
+
+        std::printf("%-48s %10zu %10zu %10u %10u %10u %10.1f%s\n", path.c_str(), noisy.vertices.size(), bData.vertices.size(),
+                    stats.weldedCount, stats.mergedVertices, stats.removedTriangles, noisy.vertices.size() / time / 1e6,
+                    deterministic ? "" : "  NOT DETERMINISTIC");
+    }
+}
+
+}   //  namespace VULKVULK
@@ -0,0 +1,411 @@
+#include "cooker.h"
+#include "../src/Core/utils.h"
+#include "../src/IO/assetPack.h"
+#include "../src/IO/mappedFile.h"
+#include "../src/IO/meshCache.h"
+#include "../src/IO/sceneFile.h"
+#include "../src/IO/textureCache.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_map>
+
+namespace VULKVULK{
+
+namespace{
+
+namespace fs = std::filesystem;
+
+struct manifestEntry{
+    uint64_t contentHash = 0;
+    uint32_t processKey = 0;
+};
+//  (relative path, processKey) -> content hash, a model has one line per option set it was cooked with
+using Manifest = std::map<std::pair<std::string, uint32_t>, uint64_t>;
+
+//  one cache to bake : scenes and textures have one, models one per distinct option set the scenes load them with
+struct cookJob{
+    std::string path;               //  relative to the cooked root
+    ModelLoadOptions model{};       //  models only
+    uint32_t processKey = 0;
+};
+
+std::string lowerExtension(const fs::path& path){
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c){ return static_cast<char>(std::tolower(c)); });
+    return extension;
+}
+
+bool isModel(const fs::path& path){
+    return lowerExtension(path) == ".obj";
+}
+
+//  text scene description, see SceneFile
+bool isScene(const fs::path& path){
+    return lowerExtension(path) == ".scene";
+}
+
+//  formats stb_image decodes to 8 bit RGBA
+bool isImage(const fs::path& path){
+    const std::string extension = lowerExtension(path);
+    return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" || extension == ".bmp";
+}
+
+bool hashFile(const fs::path& path, uint64_t& hash){
+    MappedFile file{};
+    if(!file.open(path.string())){
+        //  mapping fails on empty files -> still a valid(empty) source
+        std::error_code ec;
+        if(fs::is_regular_file(path, ec) && fs::file_size(path, ec) == 0){
+            hash = hashBytes(nullptr, 0, hash);
+            return true;
+        }
+        return false;
+    }
+    hash = hashBytes(file.data(), file.size(), hash);
+    return true;
+}
+
+//  "mtllib a.mtl" lines of an OBJ, names are relative to the OBJ and may contain spaces
+std::vector<std::string> materialLibraries(const fs::path& objPath){
+    std::vector<std::string> libraries{};
+    std::ifstream in{objPath};
+    std::string line;
+    while(std::getline(in, line)){
+        size_t start = line.find_first_not_of(" \t");
+        if(start == std::string::npos || line.compare(start, 7, "mtllib ") != 0){
+            continue;
+        }
+        size_t nameStart = line.find_first_not_of(" \t", start + 7);
+        size_t nameEnd = line.find_last_not_of(" \t\r");
+        if(nameStart != std::string::npos && nameEnd >= nameStart){
+            libraries.push_back(line.substr(nameStart, nameEnd - nameStart + 1));
+        }
+    }
+    return libraries;
+}
+
+//  content hash of everything the cooked output depends on -> OBJ + the MTL files it names
+bool hashSource(const fs::path& path, uint64_t& hash){
+    hash = 0;
+    if(!hashFile(path, hash)){
+        return false;
+    }
+    if(!isModel(path)){
+        return true;
+    }
+    for(const std::string& library : materialLibraries(path)){
+        hash = hashBytes(library.data(), library.size(), hash);
+        //  a missing MTL is not an error(the loader falls back to the default material), creating it later changes the hash
+        hashFile(path.parent_path() / library, hash);
+    }
+    return true;
+}
+
+//  one line per asset : "<content hash> <process key> <relative path>"
+Manifest readManifest(const fs::path& path){
+    Manifest manifest{};
+    std::ifstream in{path};
+    std::string line;
+    while(std::getline(in, line)){
+        std::istringstream fields{line};
+        manifestEntry entry{};
+        std::string relativePath;
+        if(!(fields >> std::hex >> entry.contentHash >> entry.processKey)){
+            continue;
+        }
+        fields.get();
+        std::getline(fields, relativePath);
+        if(!relativePath.empty()){
+            manifest[{relativePath, entry.processKey}] = entry.contentHash;
+        }
+    }
+    return manifest;
+}
+
+bool writeManifest(const fs::path& path, const std::vector<std::pair<std::string, manifestEntry>>& entries){
+    //  write to temp file and rename -> an interrupted cook never leaves a half written manifest
+    const fs::path tempPath = path.string() + ".tmp";
+    {
+        std::ofstream out{tempPath, std::ios::trunc};
+        if(!out.is_open()){
+            return false;
+        }
+        out << std::hex;
+        for(const auto& [relativePath, entry] : entries){
+            out << entry.contentHash << ' ' << entry.processKey << ' ' << relativePath << '\n';
+        }
+        if(!out.good()){
+            out.close();
+            fs::remove(tempPath);
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tempPath, path, ec);
+    if(ec){
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+
+std::string canonicalPath(const fs::path& path){
+    std::error_code ec;
+    const fs::path canonical = fs::weakly_canonical(path, ec);
+    return (ec ? path.lexically_normal() : canonical).generic_string();
+}
+
+//  load options every scene under the root asks for, per canonical model path, distinct processKeys only
+//  scene model paths are relative to the working directory like at runtime
+std::unordered_map<std::string, std::vector<ModelLoadOptions>> sceneModelOptions(const fs::path& root, const std::vector<std::string>& sources,
+                                                                                 const CookOptions& options){
+    std::unordered_map<std::string, std::vector<ModelLoadOptions>> result{};
+    for(const std::string& relativePath : sources){
+        const fs::path source = root / relativePath;
+        SceneFile::sceneData scene{};
+        std::string error{};
+        //  a malformed scene fails its own job, its models keep the default options
+        if(!isScene(source) || !SceneFile::parseText(source.string(), scene, error)){
+            continue;
+        }
+        for(size_t i = 0; i < scene.modelPaths.size(); i++){
+            ModelLoadOptions modelOptions = SceneFile::loadOptions(scene.modelFlags[i]);
+            modelOptions.compressCache = options.model.compressCache;
+            std::vector<ModelLoadOptions>& sets = result[canonicalPath(scene.modelPaths[i])];
+            const uint32_t key = modelOptions.processKey();
+            if(std::none_of(sets.begin(), sets.end(), [&](const ModelLoadOptions& known){ return known.processKey() == key; })){
+                sets.push_back(modelOptions);
+            }
+        }
+    }
+    return result;
+}
+
+//  models named by a scene get its option sets, every other model CookOptions::model
+//  scenes have no processing options, their cache only depends on the text
+std::vector<cookJob> cookJobs(const fs::path& root, const std::vector<std::string>& sources, const CookOptions& options){
+    const auto modelOptions = sceneModelOptions(root, sources, options);
+    std::vector<cookJob> jobs{};
+    for(const std::string& relativePath : sources){
+        const fs::path source = root / relativePath;
+        if(isScene(source)){
+            jobs.push_back({relativePath, options.model, 0});
+            continue;
+        }
+        if(!isModel(source)){
+            jobs.push_back({relativePath, options.model, options.texture.processKey()});
+            continue;
+        }
+        auto found = modelOptions.find(canonicalPath(source));
+        if(found == modelOptions.end()){
+            jobs.push_back({relativePath, options.model, options.model.processKey()});
+            continue;
+        }
+        for(const ModelLoadOptions& sceneOptions : found->second){
+            jobs.push_back({relativePath, sceneOptions, sceneOptions.processKey()});
+        }
+    }
+    return jobs;
+}
+
+//  mesh caches are named after the processKey they hold
+std::string cachePathFor(const fs::path& source, uint32_t processKey){
+    if(isScene(source)){
+        return SceneFile::cachePathFor(source.string());
+    }
+    return isModel(source) ? MeshCache::cachePathFor(source.string(), processKey) : TextureCache::cachePathFor(source.string());
+}
+
+//  same check the runtime does before it uses a cache
+bool cacheIsValid(const fs::path& source, uint32_t processKey){
+    if(isScene(source)){
+        SceneFile scene{};
+        return scene.open(source.string());
+    }
+    MappedFile file{};
+    if(isModel(source)){
+        Model::bufferView view{};
+        Model::bufferData storage{};
+        return MeshCache::read(source.string(), processKey, file, view, storage);
+    }
+    Texture::textureView view{};
+    return TextureCache::read(source.string(), processKey, file, view);
+}
+
+bool restamp(const fs::path& source, uint32_t processKey){
+    if(isScene(source)){
+        return SceneFile::restamp(source.string());
+    }
+    return isModel(source) ? MeshCache::restamp(source.string(), processKey) : TextureCache::restamp(source.string());
+}
+
+void cook(const fs::path& source, const ModelLoadOptions& modelOptions, const TextureLoadOptions& textureOptions, std::ostream& log){
+    const std::string path = source.string();
+    if(isScene(source)){
+        std::string error{};
+        if(!SceneFile::convert(path, error)){
+            throw std::runtime_error(error);
+        }
+        return;
+    }
+    if(isModel(source)){
+        Model::bufferData bData{};
+        Model::processFile(path, modelOptions, bData, log);
+        if(!MeshCache::write(path, modelOptions.processKey(), bData.view(), modelOptions.compressCache)){
+            throw std::runtime_error("could not write " + MeshCache::cachePathFor(path, modelOptions.processKey()));
+        }
+        return;
+    }
+    const Texture::preparedTexture texture = Texture::processFile(path, textureOptions, log);
+    if(!TextureCache::write(path, textureOptions.processKey(), texture.view())){
+        throw std::runtime_error("could not write " + TextureCache::cachePathFor(path));
+    }
+}
+
+}   //  namespace
+
+const char* Cooker::statusName(Status status){
+    switch(status){
+        case Status::UP_TO_DATE: return "up to date";
+        case Status::RESTAMPED: return "restamped";
+        case Status::COOKED: return "cooked";
+        default: return "FAILED";
+    }
+}
+
+std::vector<std::string> Cooker::findSources(const std::string& root){
+    std::vector<std::string> sources{};
+    std::error_code ec;
+    for(fs::recursive_directory_iterator it{root, ec}, end; !ec && it != end; it.increment(ec)){
+        if(it->is_regular_file(ec) && (isModel(it->path()) || isImage(it->path()) || isScene(it->path()))){
+            sources.push_back(fs::relative(it->path(), root, ec).generic_string());
+        }
+    }
+    if(ec){
+        throw std::runtime_error("failed to scan " + root + " : " + ec.message());
+    }
+    std::sort(sources.begin(), sources.end());
+    return sources;
+}
+
+std::vector<Cooker::assetResult> Cooker::cookDirectory(const std::string& root, const CookOptions& options, ThreadPool& pool){
+    const std::vector<cookJob> jobs = cookJobs(root, findSources(root), options);
+    const fs::path manifestPath = fs::path(root) / MANIFEST_NAME;
+    const Manifest manifest = options.force ? Manifest{} : readManifest(manifestPath);
+
+    std::vector<assetResult> results(jobs.size());
+    std::vector<manifestEntry> entries(jobs.size());
+    //  one cache per job, big textures still spread out through the nested parallelFor of mips/compression
+    pool.parallelFor(jobs.size(), [&](size_t i){
+        auto start = std::chrono::steady_clock::now();
+        const cookJob& job = jobs[i];
+        const fs::path source = fs::path(root) / job.path;
+        assetResult& result = results[i];
+        manifestEntry& entry = entries[i];
+        result.path = job.path;
+        result.processKey = job.processKey;
+        entry.processKey = job.processKey;
+
+        std::ostringstream log{};
+        if(!hashSource(source, entry.contentHash)){
+            result.status = Status::FAILED;
+            log << "could not read " << source.string();
+        }
+        else{
+            auto known = manifest.find({job.path, job.processKey});
+            bool sameContent = known != manifest.end() && known->second == entry.contentHash;
+            if(sameContent && cacheIsValid(source, entry.processKey)){
+                result.status = Status::UP_TO_DATE;
+            }
+            else if(sameContent && restamp(source, entry.processKey) && cacheIsValid(source, entry.processKey)){
+                result.status = Status::RESTAMPED;
+            }
+            else{
+                try{
+                    cook(source, job.model, options.texture, log);
+                    result.status = Status::COOKED;
+                }
+                catch(const std::exception& e){
+                    result.status = Status::FAILED;
+                    log << e.what();
+                }
+            }
+        }
+        result.cachePath = cachePathFor(source, entry.processKey);
+        if(result.status != Status::FAILED){
+            std::error_code ec;
+            result.outputBytes = fs::file_size(result.cachePath, ec);
+        }
+        result.log = log.str();
+        result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    });
+
+    //  failed assets drop out -> tried again next run
+    std::vector<std::pair<std::string, manifestEntry>> cooked{};
+    for(size_t i = 0; i < jobs.size(); i++){
+        if(results[i].status != Status::FAILED){
+            cooked.push_back({jobs[i].path, entries[i]});
+        }
+    }
+    if(!writeManifest(manifestPath, cooked)){
+        throw std::runtime_error("failed to write " + manifestPath.string());
+    }
+    return results;
+}
+
+size_t Cooker::writePack(const std::string& root, const std::vector<assetResult>& results, const std::string& packPath){
+    //  rank decides the layout : load order first, then by kind, then by name
+    struct packSource{
+        AssetPack::source source;
+        size_t rank;
+    };
+    const std::vector<std::string> loadOrder = AssetPack::readLoadOrder(AssetPack::LOAD_ORDER_PATH);
+    std::unordered_map<std::string, size_t> orderRank{};
+    for(size_t i = 0; i < loadOrder.size(); i++){
+        orderRank.emplace(loadOrder[i], i);
+    }
+    std::vector<packSource> sources{};
+    auto add = [&](const std::string& path, size_t kind){
+        const std::string name = AssetPack::normalize(path);
+        auto known = orderRank.find(name);
+        sources.push_back({{name, path}, known != orderRank.end() ? known->second : loadOrder.size() + kind});
+    };
+
+    std::error_code ec;
+    for(fs::directory_iterator it{SHADER_DIRECTORY, ec}, end; !ec && it != end; it.increment(ec)){
+        if(it->is_regular_file(ec) && lowerExtension(it->path()) == ".spv"){
+            add(it->path().string(), 0);
+        }
+    }
+    for(const assetResult& result : results){
+        if(result.status != Status::FAILED){
+            const fs::path source = fs::path(root) / result.path;
+            add(result.cachePath, isScene(source) ? 1 : isModel(source) ? 2 : 3);
+        }
+    }
+    std::stable_sort(sources.begin(), sources.end(), [](const packSource& a, const packSource& b){
+        return a.rank != b.rank ? a.rank < b.rank : a.source.name < b.source.name;
+    });
+
+    std::vector<AssetPack::source> ordered{};
+    ordered.reserve(sources.size());
+    for(const packSource& source : sources){
+        ordered.push_back(source.source);
+    }
+    if(!AssetPack::write(packPath, ordered)){
+        throw std::runtime_error("failed to write " + packPath);
+    }
+    return ordered.size();
+}
+
+}   //  namespace VULKVULK
@@ -0,0 +1,68 @@
+#ifndef COOKER_H
+#define COOKER_H
+
+#include "../src/Render/model.h"
+#include "../src/Render/texture.h"
+#include "../src/Core/threadPool.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace VULKVULK{
+
+struct CookOptions{
+    ModelLoadOptions model{};       //  models no scene names, compressCache applies to every model
+    TextureLoadOptions texture{};
+    bool force = false;             //  cook everything, ignore the manifest
+    std::string packPath{};         //  also bundle the cooked caches + compiled shaders into this AssetPack, empty -> none
+};
+
+//  Offline asset cooker : walks a directory and bakes every OBJ, image and text scene into the binary caches the runtime
+//  loads(.vkmesh / .vktex / .vkscene next to the source -> one mmap at load time, see MeshCache / TextureCache / SceneFile)
+//  Assets are cooked in parallel, the per asset work(mips, block compression, ...) fans out on the same pool
+//
+//  Models are cooked once per distinct option set(processKey) the .scene files under the root load them with
+//  -> every scene hits its own mesh cache, models no scene names are cooked with CookOptions::model
+//
+//  Incremental : "<root>/.vkcook_manifest" keeps a content hash of every source(OBJ + the MTL files it references)
+//  per processKey it was cooked with. Unchanged content only gets its cache stamp refreshed when the mtime moved
+//  (fresh checkout, copied folder) instead of being cooked again
+//
+//  Pack : the caches of every asset that cooked fine + the SPIR-V under SHADER_DIRECTORY go into one AssetPack,
+//  laid out in the order of AssetPack::LOAD_ORDER_PATH(written by the app) -> startup reads the pack front to back
+//  entries the app never asked for follow as shaders, scenes, meshes, textures
+class Cooker{
+public:
+    static constexpr const char* MANIFEST_NAME = ".vkcook_manifest";
+    static constexpr const char* SHADER_DIRECTORY = "./shaders/compiledShaders";
+
+    enum class Status{
+        UP_TO_DATE,                 //  cache valid, nothing done
+        RESTAMPED,                  //  same content, cache header got the new source stamp
+        COOKED,
+        FAILED,
+    };
+    struct assetResult{
+        std::string path;           //  relative to the cooked root
+        uint32_t processKey = 0;    //  options the cache was baked with, one result per option set of a model
+        Status status = Status::FAILED;
+        double milliseconds = 0.0;  //  hashing + cooking of this asset
+        std::string cachePath{};    //  cache file written for it
+        uint64_t outputBytes = 0;   //  size of the cache file
+        std::string log{};          //  processing details, error message when FAILED
+    };
+
+    //  sources under "root" the cooker handles, sorted
+    static std::vector<std::string> findSources(const std::string& root);
+    //  cooks every source under "root", results in findSources order, the option sets of a model next to each other
+    static std::vector<assetResult> cookDirectory(const std::string& root, const CookOptions& options,
+                                                  ThreadPool& pool = ThreadPool::shared());
+    //  bundles the output of cookDirectory, returns the number of entries, throws if the pack can not be written
+    static size_t writePack(const std::string& root, const std::vector<assetResult>& results, const std::string& packPath);
+    static const char* statusName(Status status);
+};
+
+}   //  namespace VULKVULK
+
+#endif
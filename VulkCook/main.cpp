@@ -0,0 +1,109 @@
+#include "cooker.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace{
+
+void printUsage(){
+    std::cout << "Usage : VULKVULK_COOK [options] [directory]   (default ./src/GameAsset)\n"
+                 "    --force               cook everything, ignore the manifest\n"
+                 "    --weld                merge near duplicate vertices(scanned meshes) before processing\n"
+                 "    --no-optimize         skip vertex cache/fetch optimization\n"
+                 "    --no-lods             skip LOD generation\n"
+                 "    --no-meshlets         skip meshlet clustering\n"
+                 "    --compress-geometry   pack mesh vertices/indices(GeometryCodec), takes --force to convert cooked meshes\n"
+                 "    --compression <c>     texture block compression : none | bc1 | bc7 (default bc7)\n"
+                 "    --linear              textures hold linear data(normal/roughness maps)\n"
+                 "    --pack <file>         also bundle caches + compiled shaders into one asset pack(app loads ./assets.vkpack)\n"
+                 "    --verbose             print the processing log of every cooked asset\n";
+}
+
+VULKVULK::TextureCompression parseCompression(const std::string& name){
+    if(name == "none") return VULKVULK::TextureCompression::NONE;
+    if(name == "bc1") return VULKVULK::TextureCompression::BC1;
+    if(name == "bc7") return VULKVULK::TextureCompression::BC7;
+    throw std::runtime_error("unknown compression " + name);
+}
+
+}
+
+//  Bakes the .vkmesh/.vktex caches ahead of time -> the app only maps them, run from repo root like the app
+int main(int argc, char** argv){
+    using VULKVULK::Cooker;
+    try{
+        //  same processing the app asks for, so its loads hit the cooked caches
+        VULKVULK::CookOptions options{};
+        options.model.optimizeMesh = true;
+        options.model.compactVertices = true;
+        options.model.generateLods = true;
+        options.model.buildMeshlets = true;
+        std::string root = "./src/GameAsset";
+        bool verbose = false;
+
+        for(int i = 1; i < argc; i++){
+            const std::string arg = argv[i];
+            if(arg == "--force") options.force = true;
+            else if(arg == "--weld") options.model.weldVertices = true;
+            else if(arg == "--no-optimize") options.model.optimizeMesh = false;
+            else if(arg == "--no-lods") options.model.generateLods = false;
+            else if(arg == "--no-meshlets") options.model.buildMeshlets = false;
+            else if(arg == "--compress-geometry") options.model.compressCache = true;
+            else if(arg == "--linear") options.texture.srgb = false;
+            else if(arg == "--verbose") verbose = true;
+            else if(arg == "--pack" && i + 1 < argc) options.packPath = argv[++i];
+            else if(arg == "--compression" && i + 1 < argc) options.texture.compression = parseCompression(argv[++i]);
+            else if(arg == "--help" || arg == "-h"){
+                printUsage();
+                return EXIT_SUCCESS;
+            }
+            else if(!arg.empty() && arg[0] == '-'){
+                std::cerr << "Unknown option : " << arg << '\n';
+                printUsage();
+                return EXIT_FAILURE;
+            }
+            else root = arg;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        const auto results = Cooker::cookDirectory(root, options);
+        const double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        //  per asset report, sum of asset times > wall time shows how well the cores were used
+        double assetMs = 0.0;
+        uint64_t outputBytes = 0;
+        size_t counts[4]{};
+        std::cout << std::fixed << std::setprecision(1);
+        for(const auto& result : results){
+            std::cout << std::setw(10) << result.milliseconds << " ms " << std::setw(10) << result.outputBytes / 1024 << " KB  "
+                      << std::left << std::setw(11) << Cooker::statusName(result.status) << std::right << ' ' << result.path;
+            //  a model cooked for several scene option sets shows up once per set
+            if(result.processKey != 0){
+                std::cout << " (" << std::hex << std::setfill('0') << std::setw(8) << result.processKey << std::dec << std::setfill(' ') << ')';
+            }
+            std::cout << '\n';
+            if(result.status == Cooker::Status::FAILED || (verbose && !result.log.empty())){
+                std::cout << result.log << (result.log.empty() || result.log.back() == '\n' ? "" : "\n");
+            }
+            assetMs += result.milliseconds;
+            outputBytes += result.outputBytes;
+            counts[static_cast<size_t>(result.status)]++;
+        }
+        std::cout << results.size() << " assets : " << counts[0] << " up to date, " << counts[1] << " restamped, "
+                  << counts[2] << " cooked, " << counts[3] << " failed\n"
+                  << "Output " << outputBytes / 1024 << " KB, wall " << wallMs << " ms, asset time " << assetMs << " ms\n";
+        if(!options.packPath.empty()){
+            const size_t entries = Cooker::writePack(root, results, options.packPath);
+            std::cout << "Pack " << options.packPath << " : " << entries << " entries\n";
+        }
+        return counts[static_cast<size_t>(Cooker::Status::FAILED)] > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+    }catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+}
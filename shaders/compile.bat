@@ -1,3 +1,8 @@
 C:/VulkanSDK/1.3.216.0/Bin/glslc.exe simple.vert -o compiledShaders/vert.spv
 C:/VulkanSDK/1.3.216.0/Bin/glslc.exe simple.frag -o compiledShaders/frag.spv
+C:/VulkanSDK/1.3.216.0/Bin/glslc.exe simple_compact.vert -o compiledShaders/compact_vert.spv
+C:/VulkanSDK/1.3.216.0/Bin/glslc.exe impostor.vert -o compiledShaders/impostor_vert.spv
+C:/VulkanSDK/1.3.216.0/Bin/glslc.exe impostor.frag -o compiledShaders/impostor_frag.spv
+C:/VulkanSDK/1.3.216.0/Bin/glslc.exe depth_prepass.vert -o compiledShaders/depth_prepass_vert.spv
+C:/VulkanSDK/1.3.216.0/Bin/glslc.exe depth_prepass.frag -o compiledShaders/depth_prepass_frag.spv
 pause
\ No newline at end of file
@@ -0,0 +1,11 @@
+#!/bin/sh
+#   same as compile.bat with the glslc found on PATH(Vulkan SDK or shaderc), run from anywhere
+#   the CMake build runs the same commands(VULKVULK_SHADERS target) whenever it finds glslc
+cd "$(dirname "$0")" || exit 1
+glslc simple.vert -o compiledShaders/vert.spv
+glslc simple.frag -o compiledShaders/frag.spv
+glslc simple_compact.vert -o compiledShaders/compact_vert.spv
+glslc impostor.vert -o compiledShaders/impostor_vert.spv
+glslc impostor.frag -o compiledShaders/impostor_frag.spv
+glslc depth_prepass.vert -o compiledShaders/depth_prepass_vert.spv
+glslc depth_prepass.frag -o compiledShaders/depth_prepass_frag.spv
@@ -0,0 +1,5 @@
+#version 460
+
+//  depth only, the prepass pipeline masks every color write
+void main(){
+}
@@ -0,0 +1,16 @@
+#version 460
+
+//  depth prepass of Model::VertexFormat::SPLIT -> reads binding 0(positions) only
+layout(location = 0) in vec3 position;
+
+layout(push_constant) uniform Push{
+    mat4 transform; //  MVP matrix
+    mat4 normalMatrix;
+}push;
+
+//  same expression as simple.vert, both invariant -> the color pass hits exactly the depth written here
+invariant gl_Position;
+
+void main(){
+    gl_Position = push.transform * vec4(position, 1.0);
+}
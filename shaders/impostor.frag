@@ -0,0 +1,32 @@
+#version 460
+
+layout(location = 0) in vec2 fragFrame;
+
+layout(location = 0) out vec4 OutColor;
+
+layout(set = 0, binding = 0) uniform sampler2D atlasColor;      //  rgb albedo, a coverage
+layout(set = 0, binding = 1) uniform sampler2D atlasNormals;    //  rgb model space normal * 0.5 + 0.5
+
+layout(push_constant) uniform Push{
+    mat4 transform;
+    mat4 normalMatrix;
+}push;
+
+//  same light as simple.vert, per pixel here since the normals come from the atlas
+const vec3 DIRECTION_TO_LIGHT = normalize(vec3(1.0, -3.0, -1.0));
+const float AMBIENT = 0.02;
+
+void main(){
+    //  sampled before any discard -> implicit LOD derivatives stay defined
+    vec2 uv = push.normalMatrix[3].xy + fragFrame * push.normalMatrix[3].z;
+    vec4 albedo = texture(atlasColor, uv);
+    vec3 normal = texture(atlasNormals, uv).xyz * 2.0 - 1.0;
+    //  outside the frame : nothing baked there, the neighbouring frame is a different view
+    bool outside = any(lessThan(fragFrame, vec2(0.0))) || any(greaterThan(fragFrame, vec2(1.0)));
+    if(outside || albedo.a < 0.5){
+        discard;
+    }
+    vec3 normalWorldSpace = normalize(mat3(push.normalMatrix) * normal);
+    float lightIntensity = AMBIENT + max(dot(normalWorldSpace, DIRECTION_TO_LIGHT), 0);
+    OutColor = vec4(lightIntensity * albedo.rgb, 1.0);
+}
@@ -0,0 +1,26 @@
+#version 460
+
+//  Impostor quad, no vertex buffer -> two triangles out of gl_VertexIndex(draw 6 vertices)
+//  push.transform maps the corner in [-1, 1] to clip space through the camera facing quad, see SimpleRenderSystem
+
+layout(location = 0) out vec2 fragFrame;     //  position in the frame, [0, 1] inside
+
+layout(push_constant) uniform Push{
+    mat4 transform;         //  MVP matrix * camera facing quad
+    mat4 normalMatrix;      //  4th column : atlas u, v of the frame + frame size in uv
+                            //  w of the columns : quad corner -> frame plane, 2x2 row major
+}push;
+
+const vec2 CORNERS[6] = vec2[](
+    vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+    vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0)
+);
+
+void main(){
+    vec2 corner = CORNERS[gl_VertexIndex];
+    gl_Position = push.transform * vec4(corner, 0.0, 1.0);
+    //  same mapping as ImpostorBaker : u along the frame's right axis, v along its up axis
+    vec2 frame = vec2(dot(vec2(push.normalMatrix[0].w, push.normalMatrix[1].w), corner),
+                      dot(vec2(push.normalMatrix[2].w, push.normalMatrix[3].w), corner));
+    fragFrame = frame * 0.5 + 0.5;
+}
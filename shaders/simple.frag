@@ -1,14 +1,18 @@
 #version 460
 
 layout (location = 0) in vec3 fragColor;
+layout (location = 1) in vec2 fragUv;
 
 layout (location = 0) out vec4 OutColor;
 
+//  material diffuse texture(map_Kd), a white texel when the material has none or it is still streaming in
+layout(set = 1, binding = 0) uniform sampler2D diffuseTexture;
+
 layout(push_constant) uniform Push{
     mat4 transform; //  MVP matrix
     mat4 normalMatrix;    
 }push;  
 
 void main(){
-    OutColor = vec4(fragColor, 1.0);
-}
\ No newline at end of file
+    OutColor = vec4(fragColor * texture(diffuseTexture, fragUv).rgb, 1.0);
+}
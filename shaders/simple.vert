@@ -7,10 +7,11 @@ layout(location = 3) in vec2 uv;
 
 
 layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragUv;   //  material texture coordinate, image rows top down
  
 layout(push_constant) uniform Push{
     mat4 transform; //  MVP matrix
-    mat4 normalMatrix;    
+    mat4 normalMatrix;     //  4th column : material diffuse color
 }push;   
 
 //  inputs for light calculation should always be normalized
@@ -19,6 +20,9 @@ const vec3 DIRECTION_TO_LIGHT = normalize(vec3(1.0, -3.0, -1.0));   // set direc
 //          additional calculation for per vertex light direction(ex. point-vertexPoint) 
 const float AMBIENT = 0.02; //  Ambient illusion is a trick to mimic inderect illumination with small cost
 
+//  SPLIT models are drawn again over their depth prepass(depth_prepass.vert) -> positions must match bit for bit
+invariant gl_Position;
+
 
 void main(){
     gl_Position = push.transform * vec4(position, 1.0); 
@@ -39,5 +43,7 @@ void main(){
     float lightIntensity = AMBIENT + max(dot(normalWorldSpace, DIRECTION_TO_LIGHT), 0);
 
 
-    fragColor = lightIntensity * color;
+    fragColor = lightIntensity * color * push.normalMatrix[3].xyz;
+    //  OBJ v grows upwards
+    fragUv = vec2(uv.x, 1.0 - uv.y);
 }
\ No newline at end of file
@@ -0,0 +1,39 @@
+#version 460
+ 
+//  Model::CompactVertex -> formats do the snorm/unorm/half unpacking, see Model::CompactVertex::getAttributeDescriptions
+layout(location = 0) in vec4 position;  //  relative to mesh bounds, push.transform already holds the dequantization
+layout(location = 1) in vec4 color; 
+layout(location = 2) in vec2 normal;    //  octahedral
+layout(location = 3) in vec2 uv; 
+
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragUv;   //  material texture coordinate, image rows top down
+ 
+layout(push_constant) uniform Push{
+    mat4 transform; //  MVP matrix * dequantization
+    mat4 normalMatrix;     //  4th column : material diffuse color
+}push;   
+
+const vec3 DIRECTION_TO_LIGHT = normalize(vec3(1.0, -3.0, -1.0));
+const float AMBIENT = 0.02;
+
+//  same as VertexQuantizer::decodeOctahedral
+vec3 decodeOctahedral(vec2 e){
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return n;
+}
+
+void main(){
+    gl_Position = push.transform * vec4(position.xyz, 1.0); 
+
+    vec3 normalWorldSpace = normalize(mat3(push.normalMatrix) * decodeOctahedral(normal));
+    float lightIntensity = AMBIENT + max(dot(normalWorldSpace, DIRECTION_TO_LIGHT), 0);
+
+    fragColor = lightIntensity * color.rgb * push.normalMatrix[3].xyz;
+    //  OBJ v grows upwards
+    fragUv = vec2(uv.x, 1.0 - uv.y);
+}
@@ -4,18 +4,31 @@
 #include "../Render/simpleRenderSystem.h"
 #include "../Render/camera.h"
 #include "../IO/keyboard_movement.h"
+#include "../IO/assetPack.h"
 
 #include <stdexcept>
 #include <array>
 #include <chrono>
+#include <iostream>
 
 namespace VULKVULK{
 
 App::App(){
+    //  cooked pack -> every asset below comes out of one mapping, loose files otherwise
+    AssetPack& pack = AssetPack::shared();
+    if(pack.mount(AssetPack::DEFAULT_PATH)){
+        pack.prefetch();
+        std::cout << "Asset pack : " << pack.getEntryCount() << " entries\n";
+    }
     loadGameObjects();
 }
 
-App::~App(){}
+App::~App(){
+    //  loose files this run -> the order they were asked for becomes the layout of the next cooked pack
+    if(!AssetPack::shared().isMounted()){
+        AssetPack::shared().writeLoadOrder(AssetPack::LOAD_ORDER_PATH);
+    }
+}
 
 void App::run(){
     SimpleRenderSystem mySimpleRenderSystem(myDevice, myRenderer.GetSwapChainRenderPass());
@@ -30,10 +43,16 @@ void App::run(){
     auto currentTime = std::chrono::high_resolution_clock::now();
 
 
+    SimpleRenderSystem::frameStats printedStats{};
+    float statsTimer = 0.0f;
+
     //  Main Loop
     while(!myWindow.shouldClose()){
         glfwPollEvents();
-        
+        //  models finished loading since last frame go to the GPU, uploads that are done become drawable
+        myAssetLoader.update();
+        myModelRegistry.update();
+
         auto newTime = std::chrono::high_resolution_clock::now();   //  call after poll time to consider events 
         float frameTime = std::chrono::duration<float, std::chrono::seconds::period>(newTime - currentTime).count();
         currentTime = newTime;
@@ -41,17 +60,38 @@ void App::run(){
         //  View Transform
         cameraController.moveInPlaneXZ(myWindow.GetWindow(), frameTime, viewObject);
         cam.setViewYXZ(viewObject.transform.translation, viewObject.transform.rotation);
+        //  cells follow the camera, objects of cells that just loaded are drawable this frame
+        myWorld.update(viewObject.transform.translation);
+        std::vector<GameObject>& gameObjects = myWorld.getObjects();
+        for(auto& gameObject : gameObjects){
+            gameObject.updateModel();
+        }
         //  Projection Transform
         float aspect = myRenderer.GetAspectRatio();
         cam.setPerspectiveProjection(glm::radians(45.0f), aspect, 0.1f, 30.0f);
+        //  texture mips follow this frame's camera, uploads are spread over frames
+        myTextureStreamer.update(gameObjects, cam, static_cast<float>(myWindow.getExtent().height));
 
         //  if swapChain need recreation it returns nullptr
         if(auto commandBuffer = myRenderer.beginFrame()){
             myRenderer.beginSwapChainRenderPass(commandBuffer);
-            mySimpleRenderSystem.renderGameObjects(commandBuffer, myGameObjects, cam);
+            mySimpleRenderSystem.renderGameObjects(commandBuffer, gameObjects, cam);
             myRenderer.endSwapChainRenderPass(commandBuffer);
             myRenderer.endFrame();
         }
+        //  state changes of the last frame, at most once a second and only when they changed
+        statsTimer += frameTime;
+        const SimpleRenderSystem::frameStats& stats = mySimpleRenderSystem.getFrameStats();
+        if(statsTimer >= 1.0f && stats != printedStats){
+            std::cout << "Frame : " << stats.pipelineBinds << " pipeline binds, " << stats.materialChanges << " material changes, "
+                      << stats.textureBinds << " texture binds, " << stats.bufferBinds << " buffer binds, " << stats.objectPushes << " object pushes, "
+                      << stats.drawCalls << " draw calls\n";
+            std::cout << "World : " << myWorld.getLoadedCellCount() << '/' << myWorld.getCellCount() << " cells loaded, "
+                      << myWorld.getLoadingCellCount() << " loading, " << myWorld.getLoadsInFlight() << " loads in flight, "
+                      << myWorld.getDroppedObjectCount() << " objects over budget\n";
+            printedStats = stats;
+            statsTimer = 0.0f;
+        }
         
     }
     //  CPU blocks any operation(mainly deconstruction) so GPU operation can end before hand -> this will prevent error poppin up when closing window
@@ -118,32 +158,14 @@ std::unique_ptr<Model> createCubeModel(Device& device, glm::vec3 offset) {
 
 void App::loadGameObjects() {
     //std::shared_ptr<Model> model = createCubeModel(myDevice, {0.0f, 0.0f, 0.0f});
-   
-    std::shared_ptr<Model> model = Model::createModelFromFile(myDevice, "./src/GameAsset/Models/flat_vase.obj");//colored_cube
-    auto flat_vase = GameObject::createGameObject();
-    flat_vase.model = model;
-    flat_vase.transform.translation = {-1.5f, .5f, 2.5f}; //  model transform(modelSpace -> worldSpace)
-    flat_vase.transform.scale = {3.f, 1.5f, 3.f};
-    
-   
-    std::shared_ptr<Model> model1 = Model::createModelFromFile(myDevice, "./src/GameAsset/Models/smooth_vase.obj");//colored_cube
-    auto smooth_vase = GameObject::createGameObject();
-    smooth_vase.model = model1;
-    smooth_vase.transform.translation = {1.5f, .5f, 2.5f}; //  model transform(modelSpace -> worldSpace)
-    smooth_vase.transform.scale = {3.f, 1.5f, 3.f};
-
-   
-    std::shared_ptr<Model> model2 = Model::createModelFromFile(myDevice, "./src/GameAsset/Models/backpack/backpack.obj");//colored_cube
-    auto famine = GameObject::createGameObject();
-    famine.model = model2;
-    famine.transform.translation = {.5f, .5f, 5.5f}; //  model transform(modelSpace -> worldSpace)
-    famine.transform.scale = {1.f, 1.f, 1.f};
-
-    myGameObjects.push_back(std::move(flat_vase));
-    myGameObjects.push_back(std::move(smooth_vase));
-    myGameObjects.push_back(std::move(famine));
-
-
+    //  models, transforms and colors come from the scene file -> converted from its text source on first load
+    //  nothing is loaded here, cells around the camera stream in from the first frame on(see WorldStreamer)
+    //  same file requested by two cells is loaded once, see ModelRegistry
+    std::string error{};
+    if(!myWorld.load(SCENE_PATH, error)){
+        throw std::runtime_error("Failed to load scene : " + error);
+    }
+    std::cout << "Scene : " << myWorld.getCellCount() << " cells\n";
 }
 
 
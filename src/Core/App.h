@@ -7,6 +7,10 @@
 #include "../Render/renderer.h"
 //  #include "../Render/model.h"
 #include "../GameAsset/gameObject.h"    //  -> contains model.h
+#include "../IO/assetLoader.h"
+#include "../IO/modelRegistry.h"
+#include "../IO/textureStreamer.h"
+#include "../IO/worldStreamer.h"
 
 
 #include <memory>
@@ -17,6 +21,8 @@ class App{
     public:
         static constexpr int WIDTH = 1280;
         static constexpr int HEIGHT = 960;
+        //  text source of the startup scene, see SceneFile
+        static constexpr const char* SCENE_PATH = "./src/GameAsset/Scenes/default.scene";
 
         App();
        ~App();
@@ -34,8 +40,12 @@ class App{
         Device myDevice{myWindow}; 
         
         Renderer myRenderer{myWindow, myDevice}; 
+        AssetLoader myAssetLoader{myDevice};    //  declared after device -> destroyed before it
+        ModelRegistry myModelRegistry{myAssetLoader};
+        TextureStreamer myTextureStreamer{myDevice};
 
-        std::vector<GameObject> myGameObjects;
+        //  objects of the cells around the camera, declared after the registry + streamer -> releases its models and textures first
+        WorldStreamer myWorld{myModelRegistry, &myTextureStreamer};
 };
 
 }   //  namespace VULKVULK
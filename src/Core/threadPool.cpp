@@ -0,0 +1,110 @@
+#include "threadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace VULKVULK{
+
+ThreadPool::ThreadPool(uint32_t threadCount){
+    if(threadCount == 0){
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers.reserve(threadCount);
+    for(uint32_t i = 0; i < threadCount; i++){
+        workers.emplace_back([this]{ workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool(){
+    {
+        std::lock_guard<std::mutex> lock{queueMutex};
+        stopping = true;
+    }
+    queueCondition.notify_all();
+    for(auto& worker : workers){
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared(){
+    static ThreadPool pool{};
+    return pool;
+}
+
+void ThreadPool::enqueue(std::function<void()> job){
+    {
+        std::lock_guard<std::mutex> lock{queueMutex};
+        jobs.push(std::move(job));
+    }
+    queueCondition.notify_one();
+}
+
+void ThreadPool::workerLoop(){
+    while(true){
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock{queueMutex};
+            queueCondition.wait(lock, [this]{ return stopping || !jobs.empty(); });
+            if(stopping && jobs.empty()){
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop();
+        }
+        job();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& fn){
+    if(count == 0){
+        return;
+    }
+    if(count == 1){
+        fn(0);
+        return;
+    }
+
+    //  shared state outlives this call -> helper jobs that start late just find no work left and return
+    struct State{
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> finished{0};
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<State>();
+    const std::function<void(size_t)>* body = &fn;
+
+    auto work = [state, body, count]{
+        size_t index;
+        while((index = state->next.fetch_add(1)) < count){
+            try{
+                (*body)(index);
+            }catch(...){
+                std::lock_guard<std::mutex> lock{state->mutex};
+                if(!state->error){
+                    state->error = std::current_exception();
+                }
+            }
+            if(state->finished.fetch_add(1) + 1 == count){
+                std::lock_guard<std::mutex> lock{state->mutex};
+                state->done.notify_all();
+            }
+        }
+    };
+
+    size_t helperCount = std::min(count - 1, workers.size());
+    for(size_t i = 0; i < helperCount; i++){
+        enqueue(work);
+    }
+    work();
+
+    std::unique_lock<std::mutex> lock{state->mutex};
+    state->done.wait(lock, [&]{ return state->finished.load() == count; });
+    if(state->error){
+        std::rethrow_exception(state->error);
+    }
+}
+
+}   //  namespace VULKVULK
@@ -0,0 +1,59 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace VULKVULK{
+
+//  Fixed number of worker threads pulling jobs from a single queue
+class ThreadPool{
+public:
+    //  0 => one worker per hardware thread
+    explicit ThreadPool(uint32_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    //  Pool shared by asset loading code -> created on first use
+    static ThreadPool& shared();
+
+    uint32_t workerCount() const {return static_cast<uint32_t>(workers.size());}
+
+    template <typename F>
+    auto submit(F&& job) -> std::future<decltype(job())>{
+        using ResultType = decltype(job());
+        auto task = std::make_shared<std::packaged_task<ResultType()>>(std::forward<F>(job));
+        std::future<ResultType> result = task->get_future();
+        enqueue([task]{ (*task)(); });
+        return result;
+    }
+
+    //  Runs fn(0) ... fn(count-1) across the pool and blocks until all are done
+    //  Calling thread also takes indices, so this is safe to call from inside a job(no deadlock when pool is busy)
+    //  First exception thrown by fn gets rethrown on the calling thread
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+private:
+    void enqueue(std::function<void()> job);
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> jobs;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    bool stopping = false;
+};
+
+}   //  namespace VULKVULK
+
+#endif
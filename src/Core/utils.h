@@ -1,6 +1,8 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <cstdint>
+#include <cstring>
 #include <functional>
 
 namespace VULKVULK{
@@ -11,6 +13,32 @@ void hashCombine(std::size_t& seed, const T& v, const Rest&... rest){
     (hashCombine(seed, rest), ...);
 }
 
+//  64 bit hash of raw bytes(murmur3 style mixing, 8 bytes per step) -> fast enough to run over whole vertex/index buffers
+inline uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0){
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t h = seed ^ (uint64_t(size) * 0x9E3779B97F4A7C15ull);
+    size_t i = 0;
+    for(; i + 8 <= size; i += 8){
+        uint64_t k;
+        memcpy(&k, bytes + i, 8);
+        k *= 0x87C37B91114253D5ull;
+        k = (k << 31) | (k >> 33);
+        k *= 0x4CF5AD432745937Full;
+        h ^= k;
+        h = ((h << 27) | (h >> 37)) * 5 + 0x52DCE729;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, bytes + i, size - i);
+    h ^= tail * 0x87C37B91114253D5ull;
+    //  final avalanche
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
 
 }
 
@@ -2,7 +2,7 @@
 
 namespace VULKVULK{
 //  transform = scale * rotation * translation (calculate in <- direction )
-glm::mat4 TransformComponent::mat4(){
+glm::mat4 TransformComponent::mat4() const{
     const float c3 = glm::cos(rotation.z);
     const float s3 = glm::sin(rotation.z);
     const float c2 = glm::cos(rotation.x);
@@ -36,7 +36,7 @@ glm::mat4 TransformComponent::mat4(){
     return transform;
 }
 
-glm::mat3 TransformComponent::normalMatrix(){
+glm::mat3 TransformComponent::normalMatrix() const{
     const float c3 = glm::cos(rotation.z);
     const float s3 = glm::sin(rotation.z);
     const float c2 = glm::cos(rotation.x);
@@ -66,5 +66,51 @@ glm::mat3 TransformComponent::normalMatrix(){
     return transform;
 }
 
+void GameObject::createGameObjects(size_t count, std::vector<GameObject>& objects){
+    id_t next = reserveIds(count);
+    objects.reserve(objects.size() + count);
+    for(size_t i = 0; i < count; i++){
+        objects.push_back(GameObject{next++});
+    }
+}
+
+bool GameObject::updateModel(){
+    if(pendingModel.isResident()){
+        model = pendingModel.get();
+        pendingModel = ModelHandle{};
+    }
+    return model != nullptr;
+}
+
+const Model::boundingVolume& GameObject::getWorldBounds() const{
+    //  keyed on the id, not the address -> a new model allocated where a released one lived still misses
+    const uint64_t modelId = model ? model->getUniqueId() : 0;
+    if(modelId == boundsModel && transform == boundsTransform){
+        return worldBounds;
+    }
+    boundsModel = modelId;
+    boundsTransform = transform;
+    worldBounds = Model::boundingVolume{};
+    if(model == nullptr || model->getBounds().isEmpty()){
+        return worldBounds;
+    }
+
+    const Model::boundingVolume& local = model->getBounds();
+    const glm::mat4 matrix = transform.mat4();
+    //  box around the transformed box : every world axis gets |matrix| * local half extents
+    const glm::vec3 center = glm::vec3(matrix * glm::vec4((local.min + local.max) * 0.5f, 1.0f));
+    const glm::vec3 halfExtent = (local.max - local.min) * 0.5f;
+    glm::vec3 worldHalfExtent{};
+    for(int axis = 0; axis < 3; axis++){
+        worldHalfExtent += glm::abs(glm::vec3(matrix[axis])) * halfExtent[axis];
+    }
+    worldBounds.min = center - worldHalfExtent;
+    worldBounds.max = center + worldHalfExtent;
+
+    const glm::vec3 scale = glm::abs(transform.scale);
+    worldBounds.center = glm::vec3(matrix * glm::vec4(local.center, 1.0f));
+    worldBounds.radius = local.radius * glm::max(glm::max(scale.x, scale.y), scale.z);
+    return worldBounds;
+}
 
 }
\ No newline at end of file
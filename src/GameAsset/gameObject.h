@@ -2,27 +2,37 @@
 #define GAMEOBJECT_H
 
 #include "../Render/model.h"    //  -> core -> glm
+#include "../IO/assetLoader.h"
 #include <memory>
+#include <vector>
 
 namespace VULKVULK{
+class StreamedTexture;
+
 //  Model transform
 struct TransformComponent{
     glm::vec3 translation{};
     glm::vec3 scale{1.0f, 1.0f, 1.0f};
     glm::vec3 rotation{};
 
-    glm::mat4 mat4();
+    glm::mat4 mat4() const;
     //  Calculate Transpose(Inverse(modelMatrix)) == R*S^-1
-    glm::mat3 normalMatrix();
+    glm::mat3 normalMatrix() const;
+
+    bool operator==(const TransformComponent& other) const {
+        return translation == other.translation && scale == other.scale && rotation == other.rotation;
+    }
+    bool operator!=(const TransformComponent& other) const { return !(*this == other); }
 };
 
 class GameObject{
 public:
     using id_t = unsigned int;
     static GameObject createGameObject(){
-        static id_t currentId = 0;
-        return GameObject{currentId++}; //  starting from 0, every obj will have incrementing number of id
+        return GameObject{reserveIds(1)}; //  starting from 0, every obj will have incrementing number of id
     }
+    //  appends "count" objects with consecutive ids -> bulk instantiation(SceneFile) without a call per object
+    static void createGameObjects(size_t count, std::vector<GameObject>& objects);
 
     GameObject(const GameObject&) = delete;
     GameObject& operator=(const GameObject&) = delete;
@@ -30,15 +40,35 @@ public:
     GameObject& operator=(GameObject&&) = default;  
     
     id_t GetId() const {return id;}
+    //  moves a resident pendingModel into "model", true when there is a model to draw
+    bool updateModel();
+    //  model bounds in world space, empty while there is no model
+    //  cached -> only recomputed when "transform" or "model" changed since the last call
+    const Model::boundingVolume& getWorldBounds() const;
  
     std::shared_ptr<Model> model{}; //  multiple game object can use same model -> model should be shared for convinience
+    ModelHandle pendingModel{};     //  model still loading -> becomes "model" once resident, nothing is drawn until then
+    //  per material of "model"(Model::getMaterial), nullptr where the material has no map_Kd
+    //  -> resident mips follow this object's size on screen, see TextureStreamer
+    std::vector<std::shared_ptr<StreamedTexture>> textures{};
     glm::vec3 color{};
     TransformComponent transform{};
 
 private:
     GameObject(id_t objId) : id(objId) {} 
+    //  first of "count" fresh ids
+    static id_t reserveIds(size_t count){
+        static id_t currentId = 0;
+        const id_t first = currentId;
+        currentId += static_cast<id_t>(count);
+        return first;
+    }
 
     id_t id;    //  Each GameObject has unique ID specifing them 
+
+    mutable Model::boundingVolume worldBounds{};
+    mutable TransformComponent boundsTransform{};   //  transform + model worldBounds was computed for
+    mutable uint64_t boundsModel = 0;               //  Model::getUniqueId, 0 -> no model
 };
 
 
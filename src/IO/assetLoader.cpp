@@ -0,0 +1,325 @@
+#include "assetLoader.h"
+#include "meshCache.h"
+#include "objLoader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+
+namespace VULKVULK{
+
+struct AssetLoader::streamState{
+    //  written by the import job, guarded by "mutex"
+    std::mutex mutex;
+    std::condition_variable changed;    //  chunk queued or taken, import finished, loader gone
+    std::deque<streamChunk> chunks{};
+    size_t queuedBytes = 0;
+    size_t indexCount = 0;
+    size_t vertexCount = 0;
+    bool begun = false;                 //  counts are known
+    bool finished = false;              //  no more chunks, "error" empty on success
+    bool cancelled = false;             //  loader gone or the upload side failed -> job stops at its next batch
+    std::string error{};
+
+    //  main thread only
+    std::shared_ptr<Model> model{};
+    size_t batchesInFlight = 0;         //  submitted batches holding chunks of this model
+    bool complete = false;              //  finishStreamed done, resident once no batch is in flight
+
+    void cancel(){
+        std::lock_guard<std::mutex> lock{mutex};
+        cancelled = true;
+        changed.notify_all();
+    }
+};
+
+AssetLoader::AssetLoader(Device& device, ThreadPool& pool) : device(device), pool(pool){}
+
+AssetLoader::~AssetLoader(){
+    //  import jobs waiting for room in their queue would wait forever
+    for(auto& entry : streaming){
+        entry.stream->cancel();
+    }
+    //  assets of a batch cannot be destroyed while the GPU still copies into them
+    for(auto& upload : uploading){
+        upload.batch->wait();
+    }
+}
+
+ModelHandle AssetLoader::loadModel(const std::string& filepath, const ModelLoadOptions& options){
+    ModelHandle handle{};
+    handle.state = std::make_shared<ModelHandle::sharedState>();
+    handle.state->path = filepath;
+    std::error_code ec;
+    const uint64_t sourceSize = std::filesystem::file_size(filepath, ec);
+    if(!ec && sourceSize > STREAM_SOURCE_BYTES && !MeshCache::exists(filepath, options.processKey())){
+        auto stream = std::make_shared<streamState>();
+        //  state is shared -> job may outlive the loader, it stops at its next batch once cancelled
+        pool.submit([stream, filepath]{
+            auto push = [&](streamChunk chunk, size_t bytes){
+                std::unique_lock<std::mutex> lock{stream->mutex};
+                stream->changed.wait(lock, [&]{ return stream->queuedBytes < STREAM_QUEUE_BYTES || stream->cancelled; });
+                if(stream->cancelled){
+                    throw std::runtime_error("import cancelled");
+                }
+                stream->queuedBytes += bytes;
+                stream->chunks.push_back(std::move(chunk));
+                stream->changed.notify_all();
+            };
+            ObjStreamSink sink{};
+            sink.begin = [&](size_t indexCount, size_t vertexCount){
+                std::lock_guard<std::mutex> lock{stream->mutex};
+                stream->indexCount = indexCount;
+                stream->vertexCount = vertexCount;
+                stream->begun = true;
+                stream->changed.notify_all();
+            };
+            sink.vertices = [&](const Model::Vertex* vertices, size_t count){
+                streamChunk chunk{};
+                chunk.vertices.assign(vertices, vertices + count);
+                push(std::move(chunk), count * sizeof(Model::Vertex));
+            };
+            sink.indices = [&](const uint32_t* indices, size_t count){
+                streamChunk chunk{};
+                chunk.indices.assign(indices, indices + count);
+                push(std::move(chunk), count * sizeof(uint32_t));
+            };
+            std::string error{};
+            try{
+                ObjStreamStats stats{};
+                if(!ObjLoader::stream(filepath, sink, stats)){
+                    error = "streaming import failed : " + stats.error;
+                }
+            }
+            catch(const std::exception& e){
+                error = e.what();
+            }
+            std::lock_guard<std::mutex> lock{stream->mutex};
+            stream->error = error.empty() && !stream->begun ? "streaming import produced no mesh" : error;
+            stream->finished = true;
+            stream->changed.notify_all();
+        });
+        streaming.push_back({handle, std::move(stream)});
+        return handle;
+    }
+    //  job only owns copies -> safe to outlive the loader
+    auto mesh = pool.submit([filepath, options]{
+        return Model::prepareFromFile(filepath, options);
+    });
+    preparing.push_back({handle, std::move(mesh)});
+    return handle;
+}
+
+TextureHandle AssetLoader::loadTexture(const std::string& filepath, const TextureLoadOptions& options){
+    TextureHandle handle{};
+    handle.state = std::make_shared<TextureHandle::sharedState>();
+    handle.state->path = filepath;
+    //  format support is a device query -> decided here, the job only sees plain options
+    TextureLoadOptions supportedOptions = options;
+    supportedOptions.compression = Texture::supportedCompression(device, options.compression, options.srgb);
+    auto texture = pool.submit([filepath, supportedOptions]{
+        return Texture::prepareFromFile(filepath, supportedOptions);
+    });
+    preparingTextures.push_back({handle, std::move(texture)});
+    return handle;
+}
+
+void AssetLoader::update(){
+    collectPrepared(false);
+    retireUploads(false);
+}
+
+void AssetLoader::waitIdle(){
+    collectPrepared(true);
+    retireUploads(true);
+    //  streamed imports only move on once their queued batches get taken -> keep uploading until all are resident
+    while(!streaming.empty()){
+        collectPrepared(true);
+        retireUploads(true);
+    }
+}
+
+void AssetLoader::collectPrepared(bool block){
+    uploadingBatch upload{};
+    upload.batch = std::make_unique<UploadBatch>(device);
+    for(size_t i = 0; i < preparing.size();){
+        auto& entry = preparing[i];
+        if(!block && entry.mesh.wait_for(std::chrono::seconds(0)) != std::future_status::ready){
+            i++;
+            continue;
+        }
+        try{
+            Model::preparedMesh mesh = entry.mesh.get();
+            auto found = contentModels.find(mesh.contentHash);
+            std::shared_ptr<Model> model = found != contentModels.end() ? found->second.lock() : nullptr;
+            if(model){
+                contentHits++;
+                //  a fence only covers its own submit -> the handle waits for the batch that uploads the shared model
+                if(uploadingBatch* source = findUpload(upload, model.get())){
+                    source->handles.push_back({entry.handle, std::move(model)});
+                    uploadCount += source != &upload ? 1 : 0;
+                }
+                else{
+                    entry.handle.state->asset = std::move(model);
+                }
+            }
+            else{
+                upload.meshes.push_back(std::move(mesh));
+                //  moving a preparedMesh keeps its arrays where they are -> pointers recorded by the batch stay valid
+                model = std::make_shared<Model>(device, upload.meshes.back(), *upload.batch);
+                contentModels[model->getContentHash()] = model;
+                upload.handles.push_back({entry.handle, std::move(model)});
+            }
+        }
+        catch(const std::exception& e){
+            entry.handle.state->error = e.what();
+            std::cout << "Failed to load " << entry.handle.getPath() << " : " << e.what() << "\n";
+        }
+        preparing[i] = std::move(preparing.back());
+        preparing.pop_back();
+    }
+    for(size_t i = 0; i < preparingTextures.size();){
+        auto& entry = preparingTextures[i];
+        if(!block && entry.texture.wait_for(std::chrono::seconds(0)) != std::future_status::ready){
+            i++;
+            continue;
+        }
+        try{
+            upload.textures.push_back(entry.texture.get());
+            //  moving a preparedTexture keeps its data where it is -> pointer recorded by the batch stays valid
+            auto texture = std::make_shared<Texture>(device, upload.textures.back(), *upload.batch);
+            upload.textureHandles.push_back({entry.handle, std::move(texture)});
+        }
+        catch(const std::exception& e){
+            entry.handle.state->error = e.what();
+            std::cout << "Failed to load " << entry.handle.getPath() << " : " << e.what() << "\n";
+        }
+        preparingTextures[i] = std::move(preparingTextures.back());
+        preparingTextures.pop_back();
+    }
+    collectStreamed(upload, block);
+    if(upload.handles.empty() && upload.textureHandles.empty() && upload.streams.empty()){
+        return;
+    }
+    upload.batch->submit();
+    upload.streamChunks.clear();
+    uploadCount += upload.handles.size() + upload.textureHandles.size();
+    uploading.push_back(std::move(upload));
+}
+
+void AssetLoader::collectStreamed(uploadingBatch& upload, bool block){
+    for(size_t i = 0; i < streaming.size();){
+        auto& entry = streaming[i];
+        streamState& stream = *entry.stream;
+        std::deque<streamChunk> chunks{};
+        bool begun = false;
+        bool finished = false;
+        std::string error{};
+        {
+            std::unique_lock<std::mutex> lock{stream.mutex};
+            if(block && !stream.complete){
+                stream.changed.wait(lock, [&]{ return !stream.chunks.empty() || stream.finished; });
+            }
+            chunks.swap(stream.chunks);
+            stream.queuedBytes = 0;
+            begun = stream.begun;
+            finished = stream.finished;
+            error = stream.error;
+            stream.changed.notify_all();
+        }
+        //  chunks come in file order -> recorded at increasing offsets, upload side errors stop the job
+        try{
+            if(begun && !stream.model){
+                stream.model = Model::createStreamed(device, stream.indexCount, stream.vertexCount);
+            }
+            //  before recording -> the batch keeps the model alive even when a later chunk throws
+            if(!chunks.empty()){
+                stream.batchesInFlight++;
+                upload.streams.push_back(entry.stream);
+            }
+            for(auto& chunk : chunks){
+                upload.streamChunks.push_back(std::move(chunk));
+                const streamChunk& queued = upload.streamChunks.back();
+                if(!queued.vertices.empty()){
+                    stream.model->uploadStreamedVertices(*upload.batch, queued.vertices.data(), queued.vertices.size());
+                }
+                if(!queued.indices.empty()){
+                    stream.model->uploadStreamedIndices(*upload.batch, queued.indices.data(), queued.indices.size());
+                }
+            }
+            if(finished && error.empty() && !stream.complete){
+                stream.model->finishStreamed();
+                stream.complete = true;
+            }
+        }
+        catch(const std::exception& e){
+            error = e.what();
+            stream.cancel();
+        }
+        if(!error.empty()){
+            entry.handle.state->error = error;
+            std::cout << "Failed to load " << entry.handle.getPath() << " : " << error << "\n";
+        }
+        else if(stream.complete && stream.batchesInFlight == 0){
+            entry.handle.state->asset = stream.model;
+        }
+        else{
+            i++;
+            continue;
+        }
+        //  batches still copying hold the state(and the model) until they retire
+        streaming[i] = std::move(streaming.back());
+        streaming.pop_back();
+    }
+}
+
+AssetLoader::uploadingBatch* AssetLoader::findUpload(uploadingBatch& pending, const Model* model){
+    auto holds = [model](const uploadingBatch& upload){
+        return std::any_of(upload.handles.begin(), upload.handles.end(), [model](const auto& entry){ return entry.second.get() == model; });
+    };
+    if(holds(pending)){
+        return &pending;
+    }
+    for(auto& upload : uploading){
+        if(holds(upload)){
+            return &upload;
+        }
+    }
+    return nullptr;
+}
+
+void AssetLoader::retireUploads(bool block){
+    for(size_t i = 0; i < uploading.size();){
+        auto& upload = uploading[i];
+        if(block){
+            upload.batch->wait();
+        }
+        if(!upload.batch->isComplete()){
+            i++;
+            continue;
+        }
+        for(auto& [handle, model] : upload.handles){
+            handle.state->asset = std::move(model);
+        }
+        for(auto& [handle, texture] : upload.textureHandles){
+            handle.state->asset = std::move(texture);
+        }
+        for(auto& stream : upload.streams){
+            stream->batchesInFlight--;
+        }
+        uploadCount -= upload.handles.size() + upload.textureHandles.size();
+        uploading.erase(uploading.begin() + i);
+        //  drop hashes of models nobody holds anymore
+        for(auto it = contentModels.begin(); it != contentModels.end();){
+            it = it->second.expired() ? contentModels.erase(it) : std::next(it);
+        }
+    }
+}
+
+}   //  namespace VULKVULK
@@ -0,0 +1,131 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include "../Render/model.h"
+#include "../Render/texture.h"
+#include "../Render/uploadBatch.h"
+#include "../Core/threadPool.h"
+
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace VULKVULK{
+
+//  Asset that is still loading -> copies share the same load, get() returns it once it is on the GPU
+//  State only changes inside AssetLoader::update, so it is meant to be read from the main thread
+template <typename T>
+class AssetHandle{
+public:
+    AssetHandle() = default;
+
+    bool isValid() const { return state != nullptr; }
+    bool isResident() const { return state && state->asset != nullptr; }
+    bool hasFailed() const { return state && !state->error.empty(); }
+    //  nullptr until resident
+    std::shared_ptr<T> get() const { return state ? state->asset : nullptr; }
+    const std::string& getPath() const { return state->path; }
+    const std::string& getError() const { return state->error; }
+
+private:
+    friend class AssetLoader;
+    friend class ModelRegistry;
+    struct sharedState{
+        std::string path{};
+        std::shared_ptr<T> asset{};
+        std::string error{};
+    };
+    std::shared_ptr<sharedState> state{};
+};
+using ModelHandle = AssetHandle<Model>;
+using TextureHandle = AssetHandle<Texture>;
+
+//  Loads models and textures without blocking the main loop
+//  Parsing/processing(Model::prepareFromFile, Texture::prepareFromFile) runs on the thread pool, every asset that
+//  finished since the last update() gets uploaded through one UploadBatch, the batch's fence decides when those
+//  assets become resident
+//  Meshes whose content hash matches a live model share it instead of uploading again
+//  OBJ sources above STREAM_SOURCE_BYTES without a mesh cache take the bounded memory streaming import instead
+//  (ObjLoader::stream on the pool, its batches uploaded by update() as they arrive, see Model::createStreamed)
+//  -> never held whole in memory, but no processing : FULL vertices, 32 bit indices, one draw range, default material
+class AssetLoader{
+public:
+    static constexpr uint64_t STREAM_SOURCE_BYTES = uint64_t(256) << 20;
+    //  parsed batches waiting for update() -> the import job stalls once a stream has this much queued
+    static constexpr size_t STREAM_QUEUE_BYTES = size_t(16) << 20;
+
+    explicit AssetLoader(Device& device, ThreadPool& pool = ThreadPool::shared());
+    //  waits for submitted uploads, jobs still running on the pool finish on their own and get dropped
+    ~AssetLoader();
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    ModelHandle loadModel(const std::string& filepath, const ModelLoadOptions& options = ModelLoadOptions{});
+    //  block compression the device can not sample falls back to RGBA8 before the job starts
+    TextureHandle loadTexture(const std::string& filepath, const TextureLoadOptions& options = TextureLoadOptions{});
+
+    //  Main thread, once per frame : uploads prepared assets in one submit, marks finished uploads resident
+    //  Never waits on the GPU or on workers
+    void update();
+    //  Blocks until every requested asset is resident or failed
+    void waitIdle();
+
+    size_t getPendingCount() const { return preparing.size() + preparingTextures.size() + uploadCount + streaming.size(); }
+    //  loads that ended up sharing an already loaded model's GPU buffers
+    size_t getContentHitCount() const { return contentHits; }
+
+private:
+    struct preparingModel{
+        ModelHandle handle;
+        std::future<Model::preparedMesh> mesh;
+    };
+    struct preparingTexture{
+        TextureHandle handle;
+        std::future<Texture::preparedTexture> texture;
+    };
+    //  one parsed batch of a streamed import, vertices or indices
+    struct streamChunk{
+        std::vector<Model::Vertex> vertices{};
+        std::vector<uint32_t> indices{};
+    };
+    struct streamState;     //  shared with the import job
+    struct streamingModel{
+        ModelHandle handle;
+        std::shared_ptr<streamState> stream;
+    };
+    //  assets inside one submitted batch, meshes/textures stay alive until the copies are done
+    //  content shared handles join the batch that uploads the model they share -> resident with it, never earlier
+    struct uploadingBatch{
+        std::unique_ptr<UploadBatch> batch;
+        std::vector<std::pair<ModelHandle, std::shared_ptr<Model>>> handles;
+        std::vector<Model::preparedMesh> meshes;
+        std::vector<std::pair<TextureHandle, std::shared_ptr<Texture>>> textureHandles;
+        std::vector<Texture::preparedTexture> textures;
+        std::vector<streamChunk> streamChunks;                  //  only until submit, it copies them to staging
+        std::vector<std::shared_ptr<streamState>> streams;      //  keep their models alive while copying into them
+    };
+
+    void collectPrepared(bool block);
+    //  takes the queued batches of every streamed import into "upload", "block" waits for each to queue one or finish
+    void collectStreamed(uploadingBatch& upload, bool block);
+    void retireUploads(bool block);
+    //  batch still uploading "model" : "pending"(not submitted yet) or one of uploading, nullptr once it is resident
+    uploadingBatch* findUpload(uploadingBatch& pending, const Model* model);
+
+    Device& device;
+    ThreadPool& pool;
+    std::vector<preparingModel> preparing{};
+    std::vector<preparingTexture> preparingTextures{};
+    std::vector<streamingModel> streaming{};
+    std::vector<uploadingBatch> uploading{};
+    size_t uploadCount = 0;
+    std::unordered_map<uint64_t, std::weak_ptr<Model>> contentModels{};
+    size_t contentHits = 0;
+};
+
+}   //  namespace VULKVULK
+
+#endif
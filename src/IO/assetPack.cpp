@@ -0,0 +1,191 @@
+#include "assetPack.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace VULKVULK{
+
+namespace{
+
+constexpr uint64_t DATA_ALIGNMENT = 16;
+
+uint64_t alignUp(uint64_t value, uint64_t alignment){
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}   //  namespace
+
+AssetPack& AssetPack::shared(){
+    static AssetPack pack{};
+    return pack;
+}
+
+std::string AssetPack::normalize(const std::string& path){
+    namespace fs = std::filesystem;
+    std::string generic = path;
+    for(char& c : generic){
+        if(c == '\\'){
+            c = '/';
+        }
+    }
+    fs::path normal = fs::path(generic).lexically_normal();
+    if(normal.is_absolute()){
+        std::error_code ec;
+        const fs::path current = fs::current_path(ec);
+        if(!ec){
+            fs::path relative = normal.lexically_relative(current);
+            if(!relative.empty()){
+                normal = relative;
+            }
+        }
+    }
+    std::string name = normal.generic_string();
+    while(name.compare(0, 2, "./") == 0){
+        name.erase(0, 2);
+    }
+    return name;
+}
+
+bool AssetPack::mount(const std::string& packPath){
+    file.close();
+    entries.clear();
+    if(!file.open(packPath)){
+        return false;
+    }
+
+    Header header{};
+    bool valid = file.size() >= sizeof(Header);
+    if(valid){
+        std::memcpy(&header, file.data(), sizeof(Header));
+        valid = header.magic == MAGIC
+                && header.version == VERSION
+                && uint64_t(header.entryCount) * sizeof(Entry) <= file.size() - sizeof(Header)
+                && header.namesOffset <= file.size()
+                && header.namesSize <= file.size() - header.namesOffset;
+    }
+    //  never trust offsets read from disk
+    auto toc = reinterpret_cast<const Entry*>(file.data() + sizeof(Header));
+    for(uint32_t i = 0; valid && i < header.entryCount; i++){
+        valid = toc[i].offset <= file.size() && toc[i].size <= file.size() - toc[i].offset
+                && uint64_t(toc[i].nameOffset) + toc[i].nameLength <= header.namesSize;
+        if(valid){
+            const char* name = reinterpret_cast<const char*>(file.data() + header.namesOffset + toc[i].nameOffset);
+            entries[std::string(name, toc[i].nameLength)] = entryView{file.data() + toc[i].offset, static_cast<size_t>(toc[i].size)};
+        }
+    }
+    if(!valid){
+        entries.clear();
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+void AssetPack::prefetch() const{
+    file.prefetch();
+}
+
+AssetPack::entryView AssetPack::find(const std::string& path){
+    std::string name = normalize(path);
+    {
+        std::lock_guard<std::mutex> lock{orderMutex};
+        if(requested.insert(name).second){
+            loadOrder.push_back(name);
+        }
+    }
+    auto found = entries.find(name);
+    return found != entries.end() ? found->second : entryView{};
+}
+
+std::vector<std::string> AssetPack::getLoadOrder() const{
+    std::lock_guard<std::mutex> lock{orderMutex};
+    return loadOrder;
+}
+
+bool AssetPack::writeLoadOrder(const std::string& orderPath) const{
+    const std::vector<std::string> order = getLoadOrder();
+    std::ofstream out{orderPath, std::ios::trunc};
+    for(const std::string& name : order){
+        out << name << '\n';
+    }
+    return out.good();
+}
+
+std::vector<std::string> AssetPack::readLoadOrder(const std::string& orderPath){
+    std::vector<std::string> order{};
+    std::ifstream in{orderPath};
+    std::string line;
+    while(std::getline(in, line)){
+        if(!line.empty() && line.back() == '\r'){
+            line.pop_back();
+        }
+        if(!line.empty()){
+            order.push_back(line);
+        }
+    }
+    return order;
+}
+
+bool AssetPack::write(const std::string& packPath, const std::vector<source>& sources){
+    //  every source mapped first -> sizes known before the table of contents is written
+    std::vector<MappedFile> files(sources.size());
+    std::vector<Entry> toc(sources.size());
+    std::string names{};
+    for(size_t i = 0; i < sources.size(); i++){
+        if(!files[i].open(sources[i].path)){
+            return false;
+        }
+        const std::string name = normalize(sources[i].name);
+        toc[i].size = files[i].size();
+        toc[i].nameOffset = static_cast<uint32_t>(names.size());
+        toc[i].nameLength = static_cast<uint32_t>(name.size());
+        names += name;
+    }
+
+    Header header{};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.entryCount = static_cast<uint32_t>(sources.size());
+    header.namesOffset = sizeof(Header) + toc.size() * sizeof(Entry);
+    header.namesSize = names.size();
+    uint64_t offset = header.namesOffset + header.namesSize;
+    for(Entry& entry : toc){
+        entry.offset = alignUp(offset, DATA_ALIGNMENT);
+        offset = entry.offset + entry.size;
+    }
+
+    //  write to temp file and rename -> a running app never maps a half written pack
+    const std::string tempPath = packPath + ".tmp";
+    {
+        std::ofstream out{tempPath, std::ios::binary | std::ios::trunc};
+        if(!out.is_open()){
+            return false;
+        }
+        const char padding[DATA_ALIGNMENT]{};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(toc.data()), static_cast<std::streamsize>(toc.size() * sizeof(Entry)));
+        out.write(names.data(), static_cast<std::streamsize>(names.size()));
+        for(size_t i = 0; i < toc.size(); i++){
+            const uint64_t current = static_cast<uint64_t>(out.tellp());
+            out.write(padding, static_cast<std::streamsize>(toc[i].offset - current));
+            out.write(reinterpret_cast<const char*>(files[i].data()), static_cast<std::streamsize>(toc[i].size));
+        }
+        if(!out.good()){
+            out.close();
+            std::filesystem::remove(tempPath);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, packPath, ec);
+    if(ec){
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+}   //  namespace VULKVULK
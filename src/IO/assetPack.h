@@ -0,0 +1,101 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include "mappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace VULKVULK{
+
+//  Single file archive of everything startup reads(SPIR-V, .vkmesh, .vktex) -> one open + one mmap instead of a
+//  cold open per file, entries lie in the order the app asked for them so the whole pack reads front to back
+//
+//  File layout (little endian, entry data starts at 16 byte aligned offsets -> cache sections keep their alignment)
+//      [Header][Entry * entryCount][names][entry data ...]
+//
+//  Names are paths relative to the working directory(see normalize), the app resolves the paths it always used
+//  through find() and falls back to loose files for anything the pack does not hold
+//  Entries are used as they are : a pack is rebuilt by the cooker, never checked against loose sources
+class AssetPack{
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t MAGIC = 0x4B504B56;  //  "VKPK"
+    static constexpr const char* DEFAULT_PATH = "./assets.vkpack";
+    //  names find() was asked for, in request order -> the cooker lays the next pack out in this order
+    static constexpr const char* LOAD_ORDER_PATH = "./.vkpack_order";
+
+    struct Header{
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t reserved;
+        uint64_t namesOffset;           //  from start of file
+        uint64_t namesSize;
+    };
+    struct Entry{
+        uint64_t offset;                //  from start of file
+        uint64_t size;                  //  in bytes
+        uint32_t nameOffset;            //  from namesOffset, not null terminated
+        uint32_t nameLength;
+    };
+    //  file content inside the mapping, data == nullptr when the pack does not hold the name
+    struct entryView{
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+
+        explicit operator bool() const { return data != nullptr; }
+    };
+    //  what write() puts into the pack : "name" is what find() gets asked for, "path" where the content is read from
+    struct source{
+        std::string name;
+        std::string path;
+    };
+
+    AssetPack() = default;
+
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    //  Pack the app resolves its files through -> mounted once at startup, stays mapped until exit
+    static AssetPack& shared();
+
+    //  Maps "packPath" and reads its table of contents, false if there is no(valid) pack
+    //  not thread safe : mount before the first load is submitted
+    bool mount(const std::string& packPath);
+    bool isMounted() const { return file.isOpen(); }
+    //  Asks the OS to start reading the whole pack in the background
+    void prefetch() const;
+
+    //  Thread safe, the returned view lives as long as the mount
+    //  every name is recorded(mounted or not) -> see LOAD_ORDER_PATH
+    entryView find(const std::string& path);
+    size_t getEntryCount() const { return entries.size(); }
+
+    std::vector<std::string> getLoadOrder() const;
+    bool writeLoadOrder(const std::string& orderPath) const;
+    //  names of "orderPath", one per line, empty if it does not exist
+    static std::vector<std::string> readLoadOrder(const std::string& orderPath);
+
+    //  "./a/../b\\c.obj" and "b/c.obj" name the same entry, absolute paths become relative to the working directory
+    static std::string normalize(const std::string& path);
+    //  Writes "sources" in the given order, false if a source can not be read or the pack can not be written
+    static bool write(const std::string& packPath, const std::vector<source>& sources);
+
+private:
+    MappedFile file{};
+    std::unordered_map<std::string, entryView> entries{};
+
+    mutable std::mutex orderMutex{};
+    std::vector<std::string> loadOrder{};
+    std::unordered_set<std::string> requested{};
+};
+
+}   //  namespace VULKVULK
+
+#endif
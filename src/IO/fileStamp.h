@@ -0,0 +1,30 @@
+#ifndef FILE_STAMP_H
+#define FILE_STAMP_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+namespace VULKVULK{
+
+//  last write time + size of a source file, stored in cache headers to spot stale caches
+//  returns false if the file does not exist
+inline bool fileStamp(const std::string& path, int64_t& writeTime, uint64_t& size){
+    std::error_code ec;
+    auto time = std::filesystem::last_write_time(path, ec);
+    if(ec){
+        return false;
+    }
+    auto fileSize = std::filesystem::file_size(path, ec);
+    if(ec){
+        return false;
+    }
+    writeTime = static_cast<int64_t>(time.time_since_epoch().count());
+    size = static_cast<uint64_t>(fileSize);
+    return true;
+}
+
+}   //  namespace VULKVULK
+
+#endif
@@ -0,0 +1,138 @@
+#include "mappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace VULKVULK{
+
+MappedFile::~MappedFile(){
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept{
+    if(this != &other){
+        close();
+        std::swap(mappedData, other.mappedData);
+        std::swap(mappedSize, other.mappedSize);
+#ifdef _WIN32
+        std::swap(fileHandle, other.fileHandle);
+        std::swap(mappingHandle, other.mappingHandle);
+#endif
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const std::string& filePath){
+    close();
+
+    HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if(file == INVALID_HANDLE_VALUE){
+        return false;
+    }
+    LARGE_INTEGER fileSize{};
+    if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0){
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(mapping == nullptr){
+        CloseHandle(file);
+        return false;
+    }
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if(view == nullptr){
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    mappedData = static_cast<const uint8_t*>(view);
+    mappedSize = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::close(){
+    if(mappedData != nullptr){
+        UnmapViewOfFile(mappedData);
+    }
+    if(mappingHandle != nullptr){
+        CloseHandle(static_cast<HANDLE>(mappingHandle));
+    }
+    if(fileHandle != nullptr){
+        CloseHandle(static_cast<HANDLE>(fileHandle));
+    }
+    mappedData = nullptr;
+    mappedSize = 0;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+}
+
+void MappedFile::prefetch() const{
+#if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+    if(mappedData != nullptr){
+        WIN32_MEMORY_RANGE_ENTRY range{const_cast<uint8_t*>(mappedData), mappedSize};
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+#endif
+}
+#else
+bool MappedFile::open(const std::string& filePath){
+    close();
+
+    int fd = ::open(filePath.c_str(), O_RDONLY);
+    if(fd < 0){
+        return false;
+    }
+    struct stat fileStat{};
+    if(fstat(fd, &fileStat) != 0 || fileStat.st_size == 0){
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);    //  mapping keeps its own reference to the file
+    if(view == MAP_FAILED){
+        return false;
+    }
+    //  we read front to back, let the kernel read ahead aggressively
+    madvise(view, static_cast<size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+
+    mappedData = static_cast<const uint8_t*>(view);
+    mappedSize = static_cast<size_t>(fileStat.st_size);
+    return true;
+}
+
+void MappedFile::close(){
+    if(mappedData != nullptr){
+        munmap(const_cast<uint8_t*>(mappedData), mappedSize);
+    }
+    mappedData = nullptr;
+    mappedSize = 0;
+}
+
+void MappedFile::prefetch() const{
+    if(mappedData != nullptr){
+        madvise(const_cast<uint8_t*>(mappedData), mappedSize, MADV_WILLNEED);
+    }
+}
+#endif
+
+}   //  namespace VULKVULK
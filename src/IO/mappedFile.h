@@ -0,0 +1,43 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace VULKVULK{
+
+//  Read-only view of a whole file mapped into our address space
+//  -> pages are loaded by the OS on first touch, so nothing gets copied until we actually read it
+class MappedFile{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    //  returns false if file does not exist or could not be mapped (empty files are treated as failure)
+    bool open(const std::string& filePath);
+    void close();
+    //  asks the OS to start reading the whole mapping in the background -> later first touches do not block on disk
+    void prefetch() const;
+
+    bool isOpen() const {return mappedData != nullptr;}
+    const uint8_t* data() const {return mappedData;}
+    size_t size() const {return mappedSize;}
+
+private:
+    const uint8_t* mappedData = nullptr;
+    size_t mappedSize = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;     //  HANDLE, kept as void* so windows.h does not leak into every header
+    void* mappingHandle = nullptr;
+#endif
+};
+
+}   //  namespace VULKVULK
+
+#endif
@@ -0,0 +1,320 @@
+#include "meshCache.h"
+#include "assetPack.h"
+#include "fileStamp.h"
+#include "../Render/geometryCodec.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <vector>
+
+namespace VULKVULK{
+
+namespace{
+
+constexpr uint64_t SECTION_ALIGNMENT = 16;
+
+uint64_t alignUp(uint64_t value, uint64_t alignment){
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+const MeshCache::SectionEntry* findSection(const uint8_t* data, size_t size, const MeshCache::Header& header, uint32_t tag){
+    auto sections = reinterpret_cast<const MeshCache::SectionEntry*>(data + sizeof(MeshCache::Header));
+    for(uint32_t i = 0; i < header.sectionCount; i++){
+        if(sections[i].tag == tag){
+            //  never trust offsets read from disk
+            if(sections[i].offset > size || sections[i].size > size - sections[i].offset){
+                return nullptr;
+            }
+            return &sections[i];
+        }
+    }
+    return nullptr;
+}
+
+bool isIndexRange(uint32_t first, uint64_t count, uint32_t total){
+    return first <= total && count <= total - first;
+}
+
+//  renderer draws every range as it is -> one out of range index or level reads past the buffers on the GPU
+//  a cache failing this is treated as missing and rebuilt from source
+bool rangesAreValid(const Model::bufferView& view){
+    for(uint32_t i = 0; i < view.indexCount; i++){
+        if(view.indices[i] >= view.vertexCount){
+            return false;
+        }
+    }
+    for(uint32_t i = 0; i < view.lodCount; i++){
+        const Model::lodLevel& level = view.lods[i];
+        if(!isIndexRange(level.firstIndex, level.indexCount, view.indexCount)
+            || !isIndexRange(level.firstMeshlet, level.meshletCount, view.meshletCount)){
+            return false;
+        }
+    }
+    for(uint32_t i = 0; i < view.meshletCount; i++){
+        const Model::meshlet& cluster = view.meshlets[i];
+        if(!isIndexRange(cluster.firstIndex, uint64_t(cluster.triangleCount) * 3, view.indexCount)){
+            return false;
+        }
+    }
+    for(uint32_t i = 0; i < view.submeshCount; i++){
+        const Model::submesh& part = view.submeshes[i];
+        if(part.material >= view.materialCount || !isIndexRange(part.firstIndex, part.indexCount, view.indexCount)){
+            return false;
+        }
+    }
+    //  names are read back as C strings
+    for(uint32_t i = 0; i < view.materialCount; i++){
+        const Model::material& surface = view.materials[i];
+        if(surface.name[sizeof(surface.name) - 1] != '\0' || surface.diffuseTexture[sizeof(surface.diffuseTexture) - 1] != '\0'){
+            return false;
+        }
+    }
+    return true;
+}
+
+//  "data" holds a whole cache file, stamp checks are skipped for null stamps(pack entries)
+bool parseCache(const uint8_t* data, size_t size, uint32_t processKey, const int64_t* sourceWriteTime, const uint64_t* sourceSize,
+                Model::bufferView& view, Model::bufferData& storage){
+    if(size < sizeof(MeshCache::Header)){
+        return false;
+    }
+
+    MeshCache::Header header{};
+    std::memcpy(&header, data, sizeof(MeshCache::Header));
+    bool valid = header.magic == MeshCache::MAGIC
+                && header.version == MeshCache::VERSION
+                && header.vertexStride == sizeof(Model::Vertex)
+                && (sourceWriteTime == nullptr || header.sourceWriteTime == *sourceWriteTime) //  source touched after baking -> stale
+                && (sourceSize == nullptr || header.sourceSize == *sourceSize)
+                && header.processKey == processKey
+                && sizeof(MeshCache::Header) + header.sectionCount * sizeof(MeshCache::SectionEntry) <= size;
+    if(!valid){
+        return false;
+    }
+
+    const MeshCache::SectionEntry* vertexSection = findSection(data, size, header, MeshCache::SECTION_VERTICES);
+    const MeshCache::SectionEntry* indexSection = findSection(data, size, header, MeshCache::SECTION_INDICES);
+    const MeshCache::SectionEntry* packedVertexSection = findSection(data, size, header, MeshCache::SECTION_VERTICES_PACKED);
+    const MeshCache::SectionEntry* packedIndexSection = findSection(data, size, header, MeshCache::SECTION_INDICES_PACKED);
+    if((vertexSection == nullptr && packedVertexSection == nullptr) || (indexSection == nullptr && packedIndexSection == nullptr)
+        || (vertexSection != nullptr && vertexSection->size != uint64_t(vertexSection->elementCount) * sizeof(Model::Vertex))
+        || (indexSection != nullptr && indexSection->size != uint64_t(indexSection->elementCount) * sizeof(uint32_t))){
+        return false;
+    }
+
+    const MeshCache::SectionEntry* lodSection = findSection(data, size, header, MeshCache::SECTION_LODS);
+    const MeshCache::SectionEntry* meshletSection = findSection(data, size, header, MeshCache::SECTION_MESHLETS);
+    const MeshCache::SectionEntry* boundsSection = findSection(data, size, header, MeshCache::SECTION_BOUNDS);
+    const MeshCache::SectionEntry* materialSection = findSection(data, size, header, MeshCache::SECTION_MATERIALS);
+    const MeshCache::SectionEntry* submeshSection = findSection(data, size, header, MeshCache::SECTION_SUBMESHES);
+    if((lodSection != nullptr && lodSection->size != uint64_t(lodSection->elementCount) * sizeof(Model::lodLevel))
+        || (meshletSection != nullptr && meshletSection->size != uint64_t(meshletSection->elementCount) * sizeof(Model::meshlet))
+        || (boundsSection != nullptr && boundsSection->size != uint64_t(boundsSection->elementCount) * sizeof(Model::boundingVolume))
+        || (materialSection != nullptr && materialSection->size != uint64_t(materialSection->elementCount) * sizeof(Model::material))
+        || (submeshSection != nullptr && submeshSection->size != uint64_t(submeshSection->elementCount) * sizeof(Model::submesh))
+        || ((materialSection == nullptr) != (submeshSection == nullptr))){
+        return false;
+    }
+
+    view = Model::bufferView{};
+    if(lodSection != nullptr){
+        view.lods = reinterpret_cast<const Model::lodLevel*>(data + lodSection->offset);
+        view.lodCount = lodSection->elementCount;
+    }
+    if(meshletSection != nullptr){
+        view.meshlets = reinterpret_cast<const Model::meshlet*>(data + meshletSection->offset);
+        view.meshletCount = meshletSection->elementCount;
+    }
+    if(boundsSection != nullptr){
+        view.bounds = reinterpret_cast<const Model::boundingVolume*>(data + boundsSection->offset);
+        view.boundsCount = boundsSection->elementCount;
+    }
+    if(materialSection != nullptr){
+        view.materials = reinterpret_cast<const Model::material*>(data + materialSection->offset);
+        view.materialCount = materialSection->elementCount;
+        view.submeshes = reinterpret_cast<const Model::submesh*>(data + submeshSection->offset);
+        view.submeshCount = submeshSection->elementCount;
+    }
+    if(vertexSection != nullptr){
+        view.vertices = reinterpret_cast<const Model::Vertex*>(data + vertexSection->offset);
+        view.vertexCount = vertexSection->elementCount;
+    }
+    else{
+        storage.vertices.resize(packedVertexSection->elementCount);
+        if(!GeometryCodec::decodeVertices(data + packedVertexSection->offset, packedVertexSection->size,
+                                          storage.vertices.data(), packedVertexSection->elementCount)){
+            return false;
+        }
+        view.vertices = storage.vertices.data();
+        view.vertexCount = packedVertexSection->elementCount;
+    }
+    if(indexSection != nullptr){
+        view.indices = reinterpret_cast<const uint32_t*>(data + indexSection->offset);
+        view.indexCount = indexSection->elementCount;
+    }
+    else{
+        storage.indices.resize(packedIndexSection->elementCount);
+        if(!GeometryCodec::decodeIndices(data + packedIndexSection->offset, packedIndexSection->size,
+                                         storage.indices.data(), packedIndexSection->elementCount)){
+            return false;
+        }
+        view.indices = storage.indices.data();
+        view.indexCount = packedIndexSection->elementCount;
+    }
+    return rangesAreValid(view);
+}
+
+}   //  namespace
+
+std::string MeshCache::cachePathFor(const std::string& sourcePath, uint32_t processKey){
+    char key[16]{};
+    std::snprintf(key, sizeof(key), ".%08x", processKey);
+    return sourcePath + key + ".vkmesh";
+}
+
+bool MeshCache::read(const std::string& sourcePath, uint32_t processKey, MappedFile& file, Model::bufferView& view,
+                     Model::bufferData& storage){
+    int64_t writeTime = 0;
+    uint64_t size = 0;
+    if(!fileStamp(sourcePath, writeTime, size)){
+        return false;
+    }
+    if(!file.open(cachePathFor(sourcePath, processKey))){
+        return false;
+    }
+    if(!parseCache(file.data(), file.size(), processKey, &writeTime, &size, view, storage)){
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+bool MeshCache::exists(const std::string& sourcePath, uint32_t processKey){
+    Header header{};
+    const AssetPack::entryView entry = AssetPack::shared().find(cachePathFor(sourcePath, processKey));
+    if(entry){
+        if(entry.size < sizeof(Header)){
+            return false;
+        }
+        std::memcpy(&header, entry.data, sizeof(Header));
+        return header.magic == MAGIC && header.version == VERSION && header.processKey == processKey;
+    }
+    int64_t writeTime = 0;
+    uint64_t size = 0;
+    std::ifstream file{cachePathFor(sourcePath, processKey), std::ios::binary};
+    if(!fileStamp(sourcePath, writeTime, size) || !file.read(reinterpret_cast<char*>(&header), sizeof(header))){
+        return false;
+    }
+    return header.magic == MAGIC && header.version == VERSION && header.processKey == processKey
+        && header.sourceWriteTime == writeTime && header.sourceSize == size;
+}
+
+bool MeshCache::readFromPack(const std::string& sourcePath, uint32_t processKey, Model::bufferView& view, Model::bufferData& storage){
+    const AssetPack::entryView entry = AssetPack::shared().find(cachePathFor(sourcePath, processKey));
+    return entry && parseCache(entry.data, entry.size, processKey, nullptr, nullptr, view, storage);
+}
+
+bool MeshCache::write(const std::string& sourcePath, uint32_t processKey, const Model::bufferView& view, bool compress){
+    Header header{};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.vertexStride = sizeof(Model::Vertex);
+    header.processKey = processKey;
+    if(!fileStamp(sourcePath, header.sourceWriteTime, header.sourceSize)){
+        return false;
+    }
+
+    //  optional sections are only written when they have content
+    SectionEntry sections[7]{};
+    const void* sectionData[7]{};
+    auto addSection = [&](uint32_t tag, const void* data, uint32_t elementCount, uint64_t size){
+        if(tag != SECTION_VERTICES && tag != SECTION_INDICES && elementCount == 0){
+            return;
+        }
+        SectionEntry& entry = sections[header.sectionCount];
+        entry.tag = tag;
+        entry.elementCount = elementCount;
+        entry.size = size;
+        sectionData[header.sectionCount++] = data;
+    };
+    header.sectionCount = 0;
+    std::vector<uint8_t> packedVertices{};
+    std::vector<uint8_t> packedIndices{};
+    if(compress){
+        packedVertices = GeometryCodec::encodeVertices(view.vertices, view.vertexCount);
+        packedIndices = GeometryCodec::encodeIndices(view.indices, view.indexCount);
+        addSection(SECTION_VERTICES_PACKED, packedVertices.data(), view.vertexCount, packedVertices.size());
+        addSection(SECTION_INDICES_PACKED, packedIndices.data(), view.indexCount, packedIndices.size());
+    }
+    else{
+        addSection(SECTION_VERTICES, view.vertices, view.vertexCount, uint64_t(view.vertexCount) * sizeof(Model::Vertex));
+        addSection(SECTION_INDICES, view.indices, view.indexCount, uint64_t(view.indexCount) * sizeof(uint32_t));
+    }
+    addSection(SECTION_LODS, view.lods, view.lodCount, uint64_t(view.lodCount) * sizeof(Model::lodLevel));
+    addSection(SECTION_MESHLETS, view.meshlets, view.meshletCount, uint64_t(view.meshletCount) * sizeof(Model::meshlet));
+    addSection(SECTION_BOUNDS, view.bounds, view.boundsCount, uint64_t(view.boundsCount) * sizeof(Model::boundingVolume));
+    addSection(SECTION_MATERIALS, view.materials, view.materialCount, uint64_t(view.materialCount) * sizeof(Model::material));
+    addSection(SECTION_SUBMESHES, view.submeshes, view.submeshCount, uint64_t(view.submeshCount) * sizeof(Model::submesh));
+    uint64_t offset = sizeof(Header) + header.sectionCount * sizeof(SectionEntry);
+    for(uint32_t i = 0; i < header.sectionCount; i++){
+        sections[i].offset = alignUp(offset, SECTION_ALIGNMENT);
+        offset = sections[i].offset + sections[i].size;
+    }
+
+    //  write to temp file and rename -> reader never maps a half written cache
+    const std::string finalPath = cachePathFor(sourcePath, processKey);
+    const std::string tempPath = finalPath + ".tmp";
+    {
+        std::ofstream out{tempPath, std::ios::binary | std::ios::trunc};
+        if(!out.is_open()){
+            return false;
+        }
+        const char padding[SECTION_ALIGNMENT]{};
+        auto pad = [&](uint64_t target){
+            uint64_t current = static_cast<uint64_t>(out.tellp());
+            out.write(padding, static_cast<std::streamsize>(target - current));
+        };
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(sections), header.sectionCount * sizeof(SectionEntry));
+        for(uint32_t i = 0; i < header.sectionCount; i++){
+            pad(sections[i].offset);
+            out.write(static_cast<const char*>(sectionData[i]), static_cast<std::streamsize>(sections[i].size));
+        }
+        if(!out.good()){
+            out.close();
+            std::filesystem::remove(tempPath);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, finalPath, ec);
+    if(ec){
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+bool MeshCache::restamp(const std::string& sourcePath, uint32_t processKey){
+    Header header{};
+    std::fstream file{cachePathFor(sourcePath, processKey), std::ios::binary | std::ios::in | std::ios::out};
+    if(!file.is_open() || !file.read(reinterpret_cast<char*>(&header), sizeof(header))){
+        return false;
+    }
+    if(header.magic != MAGIC || header.version != VERSION || header.processKey != processKey){
+        return false;
+    }
+    if(!fileStamp(sourcePath, header.sourceWriteTime, header.sourceSize)){
+        return false;
+    }
+    //  only the header changes -> rewritten in place
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    return file.good();
+}
+
+}   //  namespace VULKVULK
@@ -0,0 +1,78 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include "../Render/model.h"
+#include "mappedFile.h"
+
+#include <string>
+
+namespace VULKVULK{
+
+//  Binary cache of the final(deduplicated) vertex/index arrays, written next to the source file as "<source>.<processKey>.vkmesh"
+//  -> the same source loaded with different options keeps one cache per option set instead of rebuilding a shared one
+//  -> loading it is a single mmap + memcpy into the staging buffer instead of parsing obj text again
+//
+//  File layout (little endian, every section starts at 16 byte aligned offset)
+//      [Header][SectionEntry * sectionCount][section data ...]
+//  Vertices/indices are either stored plain(mapped and used in place) or packed with GeometryCodec(decoded on read)
+//  Only the source OBJ is stamped -> editing its MTL alone does not rebuild the cache(touch the OBJ)
+class MeshCache{
+public:
+    //  bump this whenever the layout of the file or of Model::Vertex changes -> old caches get rebuilt
+    static constexpr uint32_t VERSION = 9;
+    static constexpr uint32_t MAGIC = 0x434D4B56;  //  "VKMC"
+
+    enum SectionTag : uint32_t{
+        SECTION_VERTICES = 0x54524556,  //  "VERT"
+        SECTION_INDICES  = 0x58444E49,  //  "INDX"
+        SECTION_LODS     = 0x53444F4C,  //  "LODS" Model::lodLevel table, optional
+        SECTION_MESHLETS = 0x4C48534D,  //  "MSHL" Model::meshlet table, optional
+        SECTION_BOUNDS   = 0x53444E42,  //  "BNDS" Model::boundingVolume table, whole mesh then every shape, optional
+        SECTION_VERTICES_PACKED = 0x5A524556,  //  "VERZ" GeometryCodec stream instead of "VERT"
+        SECTION_INDICES_PACKED  = 0x5A444E49,  //  "INDZ" GeometryCodec stream instead of "INDX"
+        SECTION_MATERIALS = 0x4C52544D, //  "MTRL" Model::material table, optional
+        SECTION_SUBMESHES = 0x4D425553, //  "SUBM" Model::submesh table, optional
+    };
+
+    struct Header{
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vertexStride;          //  sizeof(Model::Vertex) at bake time
+        uint32_t sectionCount;
+        int64_t sourceWriteTime;        //  last write time of the source file this cache was built from
+        uint64_t sourceSize;
+        uint32_t processKey;            //  ModelLoadOptions::processKey() the data was baked with
+        uint32_t reserved;
+    };
+    struct SectionEntry{
+        uint32_t tag;
+        uint32_t elementCount;          //  decoded count for packed sections
+        uint64_t offset;                //  from start of file
+        uint64_t size;                  //  in bytes
+    };
+
+    //  "processKey" in hex is part of the name, see ModelLoadOptions::processKey
+    static std::string cachePathFor(const std::string& sourcePath, uint32_t processKey);
+
+    //  Maps the cache of "sourcePath" and points "view" into the mapping.
+    //  Returns false if there is no cache, it is older than the source, it was written by a different version,
+    //  it was baked with different "processKey" or one of its index/level/meshlet/submesh ranges is out of bounds
+    //  "file" and "storage"(receives packed vertices/indices once decoded) must outlive every use of "view"
+    static bool read(const std::string& sourcePath, uint32_t processKey, MappedFile& file, Model::bufferView& view,
+                     Model::bufferData& storage);
+    //  Header only check -> true when read()/readFromPack() would find a cache for "processKey" that is not stale
+    //  (contents are only validated by read), cheap enough to decide on the main thread which import path to take
+    static bool exists(const std::string& sourcePath, uint32_t processKey);
+    //  Same as read() with the cache taken from AssetPack::shared() -> no source stamp check, "view" lives as long as the mount
+    static bool readFromPack(const std::string& sourcePath, uint32_t processKey, Model::bufferView& view, Model::bufferData& storage);
+    //  Returns false if cache could not be written(read only folder etc.) -> not fatal, we just parse again next time
+    //  "compress" packs vertices/indices -> smaller file for a decode on every read
+    static bool write(const std::string& sourcePath, uint32_t processKey, const Model::bufferView& view, bool compress = false);
+    //  Source content is unchanged but its stamp moved(checkout, copy, touch) -> stores the new stamp in the header
+    //  so read() accepts the cache again without rebuilding, returns false if there is no cache of this version
+    static bool restamp(const std::string& sourcePath, uint32_t processKey);
+};
+
+}   //  namespace VULKVULK
+
+#endif
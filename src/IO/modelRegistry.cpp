@@ -0,0 +1,112 @@
+#include "modelRegistry.h"
+#include "../Render/swapChain.h"
+
+#include <algorithm>
+#include <filesystem>
+
+namespace VULKVULK{
+
+ModelRegistry::ModelRegistry(AssetLoader& loader, VkDeviceSize gpuBudget) : loader(loader), gpuBudget(gpuBudget){}
+
+std::string ModelRegistry::makeKey(const std::string& filepath, const ModelLoadOptions& options){
+    //  "./a/../b.obj" and "b.obj" are the same file -> canonical path when the file exists, normalized path otherwise
+    std::error_code ec;
+    std::filesystem::path path = std::filesystem::weakly_canonical(filepath, ec);
+    if(ec){
+        path = std::filesystem::path(filepath).lexically_normal();
+    }
+    //  options change the uploaded data -> part of the key
+    std::string key = path.generic_string() + "|" + std::to_string(options.processKey()) + (options.compactVertices ? "|c" : options.splitPositions ? "|s" : "|f");
+    if(options.bakeImpostor){
+        key += "|i" + std::to_string(options.impostorFrames) + "x" + std::to_string(options.impostorFrameSize);
+    }
+    return key;
+}
+
+ModelHandle ModelRegistry::acquire(const std::string& filepath, const ModelLoadOptions& options){
+    std::string key = makeKey(filepath, options);
+    auto found = entries.find(key);
+    //  a failed load is not cached -> asking again retries it
+    if(found != entries.end() && !found->second.handle.hasFailed()){
+        pathHits++;
+        found->second.lastUsedFrame = frame;
+        return found->second.handle;
+    }
+    entry& created = entries[key];
+    created.handle = loader.loadModel(filepath, options);
+    created.lastUsedFrame = frame;
+    return created.handle;
+}
+
+void ModelRegistry::update(){
+    frame++;
+
+    //  per model : registry entries pointing at it and whether anything outside the registry holds it
+    struct usage{
+        size_t entryCount = 0;
+        long useCount = 0;
+        bool referenced = false;
+        uint64_t lastUsedFrame = 0;
+        VkDeviceSize bytes = 0;
+    };
+    //  failed loads leave -> the next acquire() starts over(transient I/O errors recover), holders keep their handle
+    for(auto it = entries.begin(); it != entries.end();){
+        it = it->second.handle.hasFailed() ? entries.erase(it) : std::next(it);
+    }
+    std::unordered_map<const Model*, usage> models;
+    for(auto& [key, item] : entries){
+        //  handle copies outside the registry(GameObject::pendingModel etc.) keep the entry in use
+        if(item.handle.state.use_count() > 1){
+            item.lastUsedFrame = frame;
+        }
+        const std::shared_ptr<Model>& model = item.handle.state->asset;
+        if(!model){
+            continue;
+        }
+        usage& use = models[model.get()];
+        use.entryCount++;
+        use.useCount = model.use_count();
+        use.referenced |= item.lastUsedFrame == frame;
+        use.bytes = model->getGpuMemorySize();
+    }
+    residentBytes = 0;
+    for(auto& [model, use] : models){
+        //  every entry's handle holds one reference -> anything above that is a user(GameObject::model etc.)
+        use.referenced |= use.useCount > static_cast<long>(use.entryCount);
+        residentBytes += use.bytes;
+    }
+    for(auto& [key, item] : entries){
+        const std::shared_ptr<Model>& model = item.handle.state->asset;
+        if(!model){
+            continue;
+        }
+        usage& use = models[model.get()];
+        if(use.referenced){
+            item.lastUsedFrame = frame;
+        }
+        use.lastUsedFrame = std::max(use.lastUsedFrame, item.lastUsedFrame);
+    }
+
+    //  least recently used first, only models no frame in flight can still be drawing
+    while(residentBytes > gpuBudget){
+        const Model* victim = nullptr;
+        uint64_t oldest = frame;
+        for(const auto& [model, use] : models){
+            if(!use.referenced && frame - use.lastUsedFrame > SwapChain::MAX_FRAMES_IN_FLIGHT && use.lastUsedFrame < oldest){
+                victim = model;
+                oldest = use.lastUsedFrame;
+            }
+        }
+        if(victim == nullptr){
+            break;
+        }
+        for(auto it = entries.begin(); it != entries.end();){
+            it = it->second.handle.state->asset.get() == victim ? entries.erase(it) : std::next(it);
+        }
+        residentBytes -= models[victim].bytes;
+        models.erase(victim);
+        evictions++;
+    }
+}
+
+}   //  namespace VULKVULK
@@ -0,0 +1,55 @@
+#ifndef MODEL_REGISTRY_H
+#define MODEL_REGISTRY_H
+
+#include "assetLoader.h"
+
+#include <string>
+#include <unordered_map>
+
+namespace VULKVULK{
+
+//  One load per model : requests for the same canonical path(+ same load options) get the same handle,
+//  different paths with identical final vertex/index data share GPU buffers through AssetLoader's content hash
+//  Models stay cached after the last user lets go -> evicted least recently used first once resident GPU memory
+//  goes over the budget, failed loads are dropped so the next acquire retries them
+class ModelRegistry{
+public:
+    static constexpr VkDeviceSize DEFAULT_GPU_BUDGET = VkDeviceSize(256) << 20;
+
+    explicit ModelRegistry(AssetLoader& loader, VkDeviceSize gpuBudget = DEFAULT_GPU_BUDGET);
+
+    ModelRegistry(const ModelRegistry&) = delete;
+    ModelRegistry& operator=(const ModelRegistry&) = delete;
+
+    ModelHandle acquire(const std::string& filepath, const ModelLoadOptions& options = ModelLoadOptions{});
+
+    //  Main thread, once per frame after AssetLoader::update : refreshes usage and evicts over budget
+    void update();
+
+    void setGpuBudget(VkDeviceSize budget) { gpuBudget = budget; }
+    VkDeviceSize getGpuBudget() const { return gpuBudget; }
+    //  GPU memory of resident models(Model::getGpuMemorySize), content shared models counted once
+    VkDeviceSize getResidentBytes() const { return residentBytes; }
+    size_t getPathHitCount() const { return pathHits; }
+    size_t getEvictionCount() const { return evictions; }
+
+private:
+    struct entry{
+        ModelHandle handle;
+        uint64_t lastUsedFrame = 0;
+    };
+
+    static std::string makeKey(const std::string& filepath, const ModelLoadOptions& options);
+
+    AssetLoader& loader;
+    VkDeviceSize gpuBudget;
+    std::unordered_map<std::string, entry> entries{};
+    uint64_t frame = 0;
+    VkDeviceSize residentBytes = 0;
+    size_t pathHits = 0;
+    size_t evictions = 0;
+};
+
+}   //  namespace VULKVULK
+
+#endif
@@ -0,0 +1,1178 @@
+#include "objLoader.h"
+#include "mappedFile.h"
+#include "../Core/threadPool.h"
+#include "../Render/vertexDedup.h"
+
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string_view>
+#include <unordered_map>
+
+namespace VULKVULK{
+
+namespace{
+
+constexpr size_t MIN_CHUNK_SIZE = 1 << 20;  //  below this, thread hand off costs more than parsing
+constexpr int ABSENT_INDEX = INT_MIN;       //  "v" or "v/t" corner without normal/texcoord
+
+struct FaceRecord{
+    uint32_t firstCorner;
+    uint32_t cornerCount;
+    //  chunk local attribute counts at the time face was read -> needed for relative indices
+    uint32_t positionCount;
+    uint32_t texcoordCount;
+    uint32_t normalCount;
+};
+
+struct ObjChunk{
+    const char* begin = nullptr;
+    const char* end = nullptr;
+
+    std::vector<float> positions;   //  xyz
+    std::vector<float> colors;      //  rgb, 1.0 when file has none(same as tinyobj's vertex color fallback)
+    std::vector<float> normals;     //  xyz
+    std::vector<float> texcoords;   //  uv
+    std::vector<int> corners;       //  raw v,vt,vn triplets as written in file
+    std::vector<FaceRecord> faces;
+    std::vector<uint32_t> groupStarts;  //  face count at every o/g line -> where a new shape may start
+    std::vector<std::pair<uint32_t, std::string_view>> materialStarts;  //  (face count, name) at every usemtl line
+    std::vector<std::string_view> libraries;                            //  mtllib lines, rest of the line as is
+    size_t outputCorners = 0;       //  corners after triangulation
+
+    //  global offsets of this chunk, filled after every chunk is parsed
+    size_t outputBase = 0;
+    std::vector<std::pair<uint32_t, uint32_t>> shapeRuns;   //  (first face, global shape), first run starts at face 0
+
+    //  filled by triangulation
+    std::vector<Model::boundingVolume> shapeBounds;         //  boxes of the shapes in shapeRuns, from shapeRuns[0].second on
+    std::vector<std::pair<size_t, uint32_t>> cornerRuns;    //  shapeRuns as (first global output corner, shape)
+    std::vector<std::pair<uint32_t, uint32_t>> materialRuns;    //  (first face, library slot), first run starts at face 0
+
+    bool supported = true;
+};
+
+inline bool isSpace(char c){return c == ' ' || c == '\t';}
+inline bool isDigit(char c){return c >= '0' && c <= '9';}
+
+//  [begin, end) without surrounding spaces/tabs
+std::string_view trimmed(const char* begin, const char* end){
+    while(begin < end && isSpace(*begin)){
+        begin++;
+    }
+    while(end > begin && isSpace(*(end - 1))){
+        end--;
+    }
+    return std::string_view{begin, size_t(end - begin)};
+}
+
+//  Same algorithm as tinyobj's tryParseDouble -> result must match it to the last bit, do not "fix" the precision here
+bool parseDoubleTinyObj(const char* s, const char* sEnd, double* result){
+    if(s >= sEnd){
+        return false;
+    }
+    double mantissa = 0.0;
+    int exponent = 0;
+    char sign = '+';
+    char expSign = '+';
+    const char* curr = s;
+    int read = 0;
+    bool endNotReached = false;
+
+    if(*curr == '+' || *curr == '-'){
+        sign = *curr;
+        curr++;
+    }else if(!isDigit(*curr)){
+        return false;
+    }
+
+    endNotReached = (curr != sEnd);
+    while(endNotReached && isDigit(*curr)){
+        mantissa *= 10;
+        mantissa += static_cast<int>(*curr - 0x30);
+        curr++;
+        read++;
+        endNotReached = (curr != sEnd);
+    }
+    if(read == 0){
+        return false;
+    }
+    if(!endNotReached){
+        goto assemble;
+    }
+
+    if(*curr == '.'){
+        curr++;
+        read = 1;
+        endNotReached = (curr != sEnd);
+        while(endNotReached && isDigit(*curr)){
+            static const double powLut[] = {
+                1.0, 0.1, 0.01, 0.001, 0.0001, 0.00001, 0.000001, 0.0000001,
+            };
+            const int lutEntries = sizeof powLut / sizeof powLut[0];
+            mantissa += static_cast<int>(*curr - 0x30) * (read < lutEntries ? powLut[read] : std::pow(10.0, -read));
+            read++;
+            curr++;
+            endNotReached = (curr != sEnd);
+        }
+    }else if(*curr == 'e' || *curr == 'E'){
+    }else{
+        goto assemble;
+    }
+    if(!endNotReached){
+        goto assemble;
+    }
+
+    if(*curr == 'e' || *curr == 'E'){
+        curr++;
+        endNotReached = (curr != sEnd);
+        if(endNotReached && (*curr == '+' || *curr == '-')){
+            expSign = *curr;
+            curr++;
+        }else if(endNotReached && isDigit(*curr)){
+        }else{
+            return false;
+        }
+
+        read = 0;
+        endNotReached = (curr != sEnd);
+        while(endNotReached && isDigit(*curr)){
+            if(exponent > (INT_MAX / 10)){
+                return false;
+            }
+            exponent *= 10;
+            exponent += static_cast<int>(*curr - 0x30);
+            curr++;
+            read++;
+            endNotReached = (curr != sEnd);
+        }
+        exponent *= (expSign == '+' ? 1 : -1);
+        if(read == 0){
+            return false;
+        }
+    }
+
+assemble:
+    *result = (sign == '+' ? 1 : -1) * (exponent ? std::ldexp(mantissa * std::pow(5.0, exponent), exponent) : mantissa);
+    return true;
+}
+
+bool parseFloatTinyObj(const char* s, const char* sEnd, float& out){
+    double value = 0.0;
+    if(!parseDoubleTinyObj(s, sEnd, &value)){
+        return false;
+    }
+    out = static_cast<float>(value);
+    return true;
+}
+
+//  Correctly rounded float parser, accepts exactly what tinyobj accepts(leading digit required, trailing junk ignored)
+//  
+//  Exporters write things like "-0.123456" -> integer mantissa <= 2^24 and power of ten <= 10^10 are both exact floats,
+//  so one IEEE multiply/divide gives the correctly rounded result(Clinger's fast path).
+//  Anything longer goes to std::from_chars which is correctly rounded too, just slower
+bool parseFloatExact(const char* s, const char* sEnd, float& out){
+    static constexpr float POW10[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+    const char* p = s;
+    bool negative = false;
+    if(p < sEnd && (*p == '+' || *p == '-')){
+        negative = *p == '-';
+        p++;
+    }
+    const char* numberBegin = p;
+
+    uint64_t mantissa = 0;
+    int significantDigits = 0;
+    int exponent10 = 0;
+    bool truncated = false;
+    auto accumulate = [&](char c, int exponentStep){
+        if(significantDigits < 19){
+            mantissa = mantissa * 10 + static_cast<uint64_t>(c - '0');
+            significantDigits += mantissa != 0;     //  leading zeros are free
+            exponent10 += exponentStep;
+        }else{
+            truncated = true;
+            exponent10 += exponentStep + 1;
+        }
+    };
+
+    while(p < sEnd && isDigit(*p)){
+        accumulate(*p++, 0);
+    }
+    if(p == numberBegin){
+        return false;
+    }
+    if(p < sEnd && *p == '.'){
+        p++;
+        while(p < sEnd && isDigit(*p)){
+            accumulate(*p++, -1);
+        }
+    }
+    if(p < sEnd && (*p == 'e' || *p == 'E')){
+        p++;
+        bool negativeExponent = false;
+        if(p < sEnd && (*p == '+' || *p == '-')){
+            negativeExponent = *p == '-';
+            p++;
+        }
+        if(p >= sEnd || !isDigit(*p)){
+            return false;   //  empty exponent
+        }
+        int exponent = 0;
+        while(p < sEnd && isDigit(*p)){
+            if(exponent > (INT_MAX / 10)){
+                return false;
+            }
+            exponent = exponent * 10 + (*p++ - '0');
+        }
+        exponent10 += negativeExponent ? -exponent : exponent;
+    }
+
+    float value;
+    if(!truncated && mantissa <= (uint64_t(1) << 24) && exponent10 >= -10 && exponent10 <= 10){
+        value = static_cast<float>(mantissa);
+        value = exponent10 < 0 ? value / POW10[-exponent10] : value * POW10[exponent10];
+    }else{
+        auto result = std::from_chars(numberBegin, p, value, std::chars_format::general);
+        if(result.ec == std::errc::result_out_of_range){
+            value = exponent10 > 0 ? std::numeric_limits<float>::infinity() : 0.0f;
+        }else if(result.ec != std::errc{}){
+            return false;
+        }
+    }
+    out = negative ? -value : value;
+    return true;
+}
+
+//  Cursor over one line [token, lineEnd), line end excludes "\r\n"
+template <bool ExactFloats>
+struct LineCursor{
+    const char* token;
+    const char* lineEnd;
+
+    void skipSpace(){
+        while(token < lineEnd && isSpace(*token)){
+            token++;
+        }
+    }
+    //  tinyobj's parseReal : value ends at space/tab/'\r', unparsable value keeps default
+    bool parseReal(float& out){
+        skipSpace();
+        const char* end = token;
+        while(end < lineEnd && !isSpace(*end) && *end != '\r'){
+            end++;
+        }
+        bool parsed = ExactFloats ? parseFloatExact(token, end, out) : parseFloatTinyObj(token, end, out);
+        token = end;
+        return parsed;
+    }
+    float parseRealOr(float defaultValue){
+        float value = defaultValue;
+        parseReal(value);
+        return value;
+    }
+    //  atoi() then skip to next '/', space, tab or '\r'
+    int parseIndex(){
+        const char* p = token;
+        while(p < lineEnd && (isSpace(*p) || *p == '\v' || *p == '\f')){
+            p++;
+        }
+        bool negative = false;
+        if(p < lineEnd && (*p == '+' || *p == '-')){
+            negative = *p == '-';
+            p++;
+        }
+        long long value = 0;
+        while(p < lineEnd && isDigit(*p)){
+            value = value * 10 + (*p - '0');
+            if(value > INT_MAX){
+                value = INT_MAX;    //  atoi is undefined here anyway, just do not wrap
+            }
+            p++;
+        }
+        while(token < lineEnd && *token != '/' && !isSpace(*token) && *token != '\r'){
+            token++;
+        }
+        return static_cast<int>(negative ? -value : value);
+    }
+};
+
+//  v/vt/vn triple of a face, tinyobj's parseTriple. 0 is not a valid obj index -> returns false
+template <bool ExactFloats>
+bool parseCorner(LineCursor<ExactFloats>& cursor, int corner[3]){
+    corner[0] = cursor.parseIndex();
+    corner[1] = ABSENT_INDEX;
+    corner[2] = ABSENT_INDEX;
+    if(corner[0] == 0){
+        return false;
+    }
+    if(cursor.token >= cursor.lineEnd || *cursor.token != '/'){
+        return true;
+    }
+    cursor.token++;
+    //  v//vn
+    if(cursor.token < cursor.lineEnd && *cursor.token == '/'){
+        cursor.token++;
+        corner[2] = cursor.parseIndex();
+        return corner[2] != 0;
+    }
+    //  v/vt or v/vt/vn
+    corner[1] = cursor.parseIndex();
+    if(corner[1] == 0){
+        return false;
+    }
+    if(cursor.token >= cursor.lineEnd || *cursor.token != '/'){
+        return true;
+    }
+    cursor.token++;
+    corner[2] = cursor.parseIndex();
+    return corner[2] != 0;
+}
+
+template <bool ExactFloats>
+void parseChunk(ObjChunk& chunk){
+    const char* lineStart = chunk.begin;
+    while(lineStart < chunk.end && chunk.supported){
+        const char* newLine = static_cast<const char*>(std::memchr(lineStart, '\n', size_t(chunk.end - lineStart)));
+        if(newLine == nullptr){
+            newLine = chunk.end;
+        }
+        const char* lineEnd = newLine;
+        if(lineEnd > lineStart && *(lineEnd - 1) == '\r'){
+            lineEnd--;
+        }
+        //  a '\r' anywhere else means old mac line endings -> tinyobj would see different lines
+        if(std::find(lineStart, lineEnd, '\r') != lineEnd){
+            chunk.supported = false;
+            break;
+        }
+
+        LineCursor<ExactFloats> cursor{lineStart, lineEnd};
+        cursor.skipSpace();
+        const char* token = cursor.token;
+        size_t length = static_cast<size_t>(lineEnd - token);
+
+        if(length >= 2 && token[0] == 'v' && isSpace(token[1])){
+            cursor.token += 2;
+            float x = cursor.parseRealOr(0.0f);
+            float y = cursor.parseRealOr(0.0f);
+            float z = cursor.parseRealOr(0.0f);
+            float r = 1.0f, g = 1.0f, b = 1.0f;
+            if(cursor.parseReal(r)){
+                //  only "x y z" and "x y z r g b" are reproduced, "x y z w" goes to tinyobj
+                if(!cursor.parseReal(g) || !cursor.parseReal(b)){
+                    chunk.supported = false;
+                    break;
+                }
+            }
+            chunk.positions.insert(chunk.positions.end(), {x, y, z});
+            chunk.colors.insert(chunk.colors.end(), {r, g, b});
+        }
+        else if(length >= 3 && token[0] == 'v' && token[1] == 'n' && isSpace(token[2])){
+            cursor.token += 3;
+            float x = cursor.parseRealOr(0.0f);
+            float y = cursor.parseRealOr(0.0f);
+            float z = cursor.parseRealOr(0.0f);
+            chunk.normals.insert(chunk.normals.end(), {x, y, z});
+        }
+        else if(length >= 3 && token[0] == 'v' && token[1] == 't' && isSpace(token[2])){
+            cursor.token += 3;
+            float u = cursor.parseRealOr(0.0f);
+            float v = cursor.parseRealOr(0.0f);
+            chunk.texcoords.insert(chunk.texcoords.end(), {u, v});
+        }
+        else if(length >= 2 && token[0] == 'f' && isSpace(token[1])){
+            cursor.token += 2;
+            cursor.skipSpace();
+            FaceRecord face{};
+            face.firstCorner = static_cast<uint32_t>(chunk.corners.size() / 3);
+            face.positionCount = static_cast<uint32_t>(chunk.positions.size() / 3);
+            face.texcoordCount = static_cast<uint32_t>(chunk.texcoords.size() / 2);
+            face.normalCount = static_cast<uint32_t>(chunk.normals.size() / 3);
+            while(cursor.token < cursor.lineEnd){
+                int corner[3];
+                if(!parseCorner(cursor, corner)){
+                    chunk.supported = false;
+                    break;
+                }
+                chunk.corners.insert(chunk.corners.end(), {corner[0], corner[1], corner[2]});
+                face.cornerCount++;
+                while(cursor.token < cursor.lineEnd && (isSpace(*cursor.token) || *cursor.token == '\r')){
+                    cursor.token++;
+                }
+            }
+            if(face.cornerCount > 4){
+                chunk.supported = false;    //  tinyobj ear clips these
+            }
+            if(face.cornerCount >= 3){
+                chunk.faces.push_back(face);
+                chunk.outputCorners += face.cornerCount == 4 ? 6 : 3;
+            }
+        }
+        else if(length >= 2 && (token[0] == 'o' || token[0] == 'g') && isSpace(token[1])){
+            chunk.groupStarts.push_back(static_cast<uint32_t>(chunk.faces.size()));
+        }
+        else if(length >= 7 && std::memcmp(token, "usemtl", 6) == 0 && isSpace(token[6])){
+            chunk.materialStarts.push_back({static_cast<uint32_t>(chunk.faces.size()), trimmed(token + 7, lineEnd)});
+        }
+        else if(length >= 7 && std::memcmp(token, "mtllib", 6) == 0 && isSpace(token[6])){
+            chunk.libraries.push_back(trimmed(token + 7, lineEnd));
+        }
+        //  everything else(comments, s, l, p) does not change vertices or indices
+
+        lineStart = newLine + 1;
+    }
+}
+
+//  Attribute pool that stays split across chunks, looked up with a global obj index instead of being concatenated first
+struct ChunkedPool{
+    std::vector<const float*> data;     //  per chunk
+    std::vector<uint32_t> bases;        //  first global index of every chunk, total count at the end
+    uint32_t components = 0;
+
+    ChunkedPool(const std::vector<ObjChunk>& chunks, std::vector<float> ObjChunk::*pool, uint32_t componentCount)
+        : components(componentCount){
+        uint32_t total = 0;
+        for(const auto& chunk : chunks){
+            data.push_back((chunk.*pool).data());
+            bases.push_back(total);
+            total += static_cast<uint32_t>((chunk.*pool).size() / components);
+        }
+        bases.push_back(total);
+    }
+    uint32_t total() const {return bases.back();}
+    //  almost every reference hits its own chunk, only fall back to binary search otherwise
+    const float* at(uint32_t index, size_t homeChunk) const{
+        size_t chunk = homeChunk;
+        if(index < bases[chunk] || index >= bases[chunk + 1]){
+            chunk = static_cast<size_t>(std::upper_bound(bases.begin(), bases.end(), index) - bases.begin()) - 1;
+        }
+        return data[chunk] + size_t(index - bases[chunk]) * components;
+    }
+};
+
+//  Resolve raw obj index into global 0-based index, -1 when absent, INT_MIN when out of range
+inline int resolveIndex(int raw, uint32_t chunkBase, uint32_t countAtFace, uint32_t totalCount){
+    if(raw == ABSENT_INDEX){
+        return -1;
+    }
+    int64_t index = raw > 0 ? int64_t(raw) - 1 : int64_t(chunkBase) + countAtFace + raw;
+    if(index < 0 || index >= int64_t(totalCount)){
+        return INT_MIN;
+    }
+    return static_cast<int>(index);
+}
+
+struct ResolvedCorner{
+    int position;
+    int texcoord;
+    int normal;
+};
+
+//  "line" starts with "keyword" followed by a space -> "rest" is what follows, trimmed
+bool matchKeyword(std::string_view line, std::string_view keyword, std::string_view& rest){
+    if(line.size() <= keyword.size() || line.compare(0, keyword.size(), keyword) != 0 || !isSpace(line[keyword.size()])){
+        return false;
+    }
+    rest = trimmed(line.data() + keyword.size(), line.data() + line.size());
+    return true;
+}
+
+//  Kd and map_Kd of every newmtl in "path" appended to "library", false if the file can not be opened
+//  a name defined twice keeps its first definition(same as tinyobj)
+bool loadMaterialLibrary(const std::filesystem::path& path, std::vector<Model::material>& library,
+                         std::unordered_map<std::string, uint32_t>& slots){
+    std::ifstream in{path};
+    if(!in.is_open()){
+        return false;
+    }
+    constexpr size_t NONE = std::numeric_limits<size_t>::max();
+    size_t current = NONE;
+    std::string line;
+    while(std::getline(in, line)){
+        if(!line.empty() && line.back() == '\r'){
+            line.pop_back();
+        }
+        const std::string_view view = trimmed(line.data(), line.data() + line.size());
+        std::string_view rest;
+        if(matchKeyword(view, "newmtl", rest)){
+            auto inserted = slots.emplace(std::string(rest), static_cast<uint32_t>(library.size()));
+            current = inserted.second ? library.size() : NONE;
+            if(inserted.second){
+                library.emplace_back().setName(std::string(rest));
+            }
+        }
+        else if(current != NONE && matchKeyword(view, "Kd", rest)){
+            std::istringstream values{std::string(rest)};
+            glm::vec3 diffuse{1.0f};
+            values >> diffuse.x >> diffuse.y >> diffuse.z;
+            library[current].diffuse = diffuse;
+        }
+        else if(current != NONE && matchKeyword(view, "map_Kd", rest)){
+            //  options(-bm 1 ...) come first, file name is the last token
+            const size_t space = rest.find_last_of(" \t");
+            library[current].setDiffuseTexture(std::string(space == std::string_view::npos ? rest : rest.substr(space + 1)));
+        }
+    }
+    return true;
+}
+
+//  "mtllib" may list several files and tinyobj takes the first one it can open, names with spaces are tried whole first
+void loadMaterialLibraries(const std::filesystem::path& directory, std::string_view names, std::vector<Model::material>& library,
+                           std::unordered_map<std::string, uint32_t>& slots){
+    if(names.empty() || loadMaterialLibrary(directory / std::string(names), library, slots)){
+        return;
+    }
+    const char* token = names.data();
+    const char* end = token + names.size();
+    while(token < end){
+        const char* tokenEnd = std::find_if(token, end, isSpace);
+        if(tokenEnd > token && loadMaterialLibrary(directory / std::string(token, tokenEnd), library, slots)){
+            return;
+        }
+        token = tokenEnd < end ? tokenEnd + 1 : end;
+    }
+}
+
+}   //  namespace
+
+bool ObjLoader::load(const std::string& filepath, Model::bufferData& bData, const ObjLoaderOptions& options){
+    MappedFile file{};
+    if(!file.open(filepath)){
+        return false;
+    }
+    const char* begin = reinterpret_cast<const char*>(file.data());
+    const char* end = begin + file.size();
+
+    //  Split into line aligned chunks, a few per worker so uneven chunks still balance out
+    ThreadPool& pool = ThreadPool::shared();
+    size_t targetChunkCount = std::max<size_t>(1, std::min(file.size() / MIN_CHUNK_SIZE, size_t(pool.workerCount() + 1) * 4));
+    size_t targetChunkSize = file.size() / targetChunkCount + 1;
+    std::vector<ObjChunk> chunks;
+    const char* chunkStart = begin;
+    while(chunkStart < end){
+        const char* chunkEnd = chunkStart + std::min(targetChunkSize, size_t(end - chunkStart));
+        chunkEnd = std::find(chunkEnd, end, '\n');
+        if(chunkEnd != end){
+            chunkEnd++;
+        }
+        ObjChunk chunk{};
+        chunk.begin = chunkStart;
+        chunk.end = chunkEnd;
+        chunks.push_back(std::move(chunk));
+        chunkStart = chunkEnd;
+    }
+
+    pool.parallelFor(chunks.size(), [&](size_t i){
+        if(options.exactFloats){
+            parseChunk<true>(chunks[i]);
+        }else{
+            parseChunk<false>(chunks[i]);
+        }
+    });
+
+    //  Shapes like tinyobj : every o/g line ends the current shape if it has faces, shapes without faces do not exist
+    size_t outputTotal = 0;
+    uint32_t shape = 0;
+    bool shapeHasFaces = false;
+    for(auto& chunk : chunks){
+        if(!chunk.supported){
+            return false;
+        }
+        chunk.outputBase = outputTotal;
+        outputTotal += chunk.outputCorners;
+
+        uint32_t face = 0;
+        chunk.shapeRuns.push_back({0, shape});
+        for(uint32_t start : chunk.groupStarts){
+            shapeHasFaces |= start > face;
+            face = start;
+            if(shapeHasFaces){
+                shape++;
+                shapeHasFaces = false;
+            }
+            //  a run that got no faces is replaced by the one starting at the same face
+            if(chunk.shapeRuns.back().first == start){
+                chunk.shapeRuns.back().second = shape;
+            }else{
+                chunk.shapeRuns.push_back({start, shape});
+            }
+        }
+        shapeHasFaces |= chunk.faces.size() > face;
+    }
+    const uint32_t shapeCount = shape + (shapeHasFaces ? 1 : 0);
+
+    //  Materials : every mtllib in file order, usemtl names resolved against them in file order
+    //  names missing from the libraries get the default material, no library at all -> no materials
+    std::vector<Model::material> library{};
+    std::unordered_map<std::string, uint32_t> slots{};
+    const std::filesystem::path directory = std::filesystem::path(filepath).parent_path();
+    for(const auto& chunk : chunks){
+        for(std::string_view names : chunk.libraries){
+            loadMaterialLibraries(directory, names, library, slots);
+        }
+    }
+    const bool useMaterials = !library.empty();
+    const uint32_t defaultSlot = static_cast<uint32_t>(library.size());
+    uint32_t materialSlot = defaultSlot;
+    for(auto& chunk : chunks){
+        chunk.materialRuns.push_back({0, materialSlot});
+        for(const auto& start : chunk.materialStarts){
+            auto found = slots.find(std::string(start.second));
+            materialSlot = found != slots.end() ? found->second : defaultSlot;
+            if(chunk.materialRuns.back().first == start.first){
+                chunk.materialRuns.back().second = materialSlot;
+            }else{
+                chunk.materialRuns.push_back({start.first, materialSlot});
+            }
+        }
+    }
+    const ChunkedPool positions{chunks, &ObjChunk::positions, 3};
+    const ChunkedPool colors{chunks, &ObjChunk::colors, 3};
+    const ChunkedPool normals{chunks, &ObjChunk::normals, 3};
+    const ChunkedPool texcoords{chunks, &ObjChunk::texcoords, 2};
+
+    //  Triangulate + write every corner as Vertex into its final slot
+    std::vector<Model::Vertex> expanded(outputTotal);
+    std::vector<uint32_t> triangleMaterials(useMaterials ? outputTotal / 3 : 0);
+    pool.parallelFor(chunks.size(), [&](size_t i){
+        ObjChunk& chunk = chunks[i];
+        Model::Vertex* out = expanded.data() + chunk.outputBase;
+        const uint32_t firstShape = chunk.shapeRuns.front().second;
+        chunk.shapeBounds.resize(chunk.shapeRuns.back().second - firstShape + 1);
+        size_t run = 0;
+        size_t materialRun = 0;
+        Model::boundingVolume* shapeBounds = nullptr;
+        for(uint32_t f = 0; f < chunk.faces.size(); f++){
+            const FaceRecord& face = chunk.faces[f];
+            if(shapeBounds == nullptr || (run + 1 < chunk.shapeRuns.size() && chunk.shapeRuns[run + 1].first == f)){
+                run += shapeBounds != nullptr;
+                shapeBounds = &chunk.shapeBounds[chunk.shapeRuns[run].second - firstShape];
+                chunk.cornerRuns.push_back({size_t(out - expanded.data()), chunk.shapeRuns[run].second});
+            }
+            if(useMaterials){
+                while(materialRun + 1 < chunk.materialRuns.size() && chunk.materialRuns[materialRun + 1].first <= f){
+                    materialRun++;
+                }
+                const size_t firstTriangle = size_t(out - expanded.data()) / 3;
+                std::fill_n(triangleMaterials.begin() + firstTriangle, face.cornerCount == 4 ? 2 : 1, chunk.materialRuns[materialRun].second);
+            }
+            ResolvedCorner resolved[4];
+            for(uint32_t c = 0; c < face.cornerCount; c++){
+                const int* raw = &chunk.corners[size_t(face.firstCorner + c) * 3];
+                resolved[c].position = resolveIndex(raw[0], positions.bases[i], face.positionCount, positions.total());
+                resolved[c].texcoord = resolveIndex(raw[1], texcoords.bases[i], face.texcoordCount, texcoords.total());
+                resolved[c].normal = resolveIndex(raw[2], normals.bases[i], face.normalCount, normals.total());
+                if(resolved[c].position < 0 || resolved[c].texcoord == INT_MIN || resolved[c].normal == INT_MIN){
+                    chunk.supported = false;
+                    return;
+                }
+            }
+
+            uint32_t order[6] = {0, 1, 2, 0, 0, 0};
+            uint32_t orderCount = 3;
+            if(face.cornerCount == 4){
+                //  tinyobj exports quads when the group ends, it can only see positions defined before that point
+                for(uint32_t c = 0; c < 4; c++){
+                    if(uint32_t(resolved[c].position) >= positions.bases[i] + face.positionCount){
+                        chunk.supported = false;
+                        return;
+                    }
+                }
+                const float* v0 = positions.at(uint32_t(resolved[0].position), i);
+                const float* v1 = positions.at(uint32_t(resolved[1].position), i);
+                const float* v2 = positions.at(uint32_t(resolved[2].position), i);
+                const float* v3 = positions.at(uint32_t(resolved[3].position), i);
+                float e02x = v2[0] - v0[0];
+                float e02y = v2[1] - v0[1];
+                float e02z = v2[2] - v0[2];
+                float e13x = v3[0] - v1[0];
+                float e13y = v3[1] - v1[1];
+                float e13z = v3[2] - v1[2];
+                float sqr02 = e02x * e02x + e02y * e02y + e02z * e02z;
+                float sqr13 = e13x * e13x + e13y * e13y + e13z * e13z;
+                //  split along the shorter diagonal
+                const uint32_t split02[6] = {0, 1, 2, 0, 2, 3};
+                const uint32_t split13[6] = {0, 1, 3, 1, 2, 3};
+                const uint32_t* split = sqr02 < sqr13 ? split02 : split13;
+                std::copy(split, split + 6, order);
+                orderCount = 6;
+            }
+
+            for(uint32_t k = 0; k < orderCount; k++){
+                const ResolvedCorner& corner = resolved[order[k]];
+                Model::Vertex& vertex = *out++;
+                const float* position = positions.at(uint32_t(corner.position), i);
+                const float* color = colors.at(uint32_t(corner.position), i);
+                vertex.position = {position[0], position[1], position[2]};
+                vertex.color = {color[0], color[1], color[2]};
+                shapeBounds->expand(vertex.position);
+                if(corner.normal >= 0){
+                    const float* normal = normals.at(uint32_t(corner.normal), i);
+                    vertex.normal = {normal[0], normal[1], normal[2]};
+                }
+                if(corner.texcoord >= 0){
+                    const float* uv = texcoords.at(uint32_t(corner.texcoord), i);
+                    vertex.uv = {uv[0], uv[1]};
+                }
+            }
+        }
+    });
+    for(const auto& chunk : chunks){
+        if(!chunk.supported){
+            return false;
+        }
+    }
+
+    //  boxes of shapes crossing chunk borders get merged, spheres are fitted in the dedup pass below
+    bData.bounds.assign(size_t(shapeCount) + 1, Model::boundingVolume{});
+    std::vector<std::pair<size_t, uint32_t>> cornerRuns;
+    for(const auto& chunk : chunks){
+        for(size_t k = 0; k < chunk.shapeBounds.size(); k++){
+            if(!chunk.shapeBounds[k].isEmpty()){
+                bData.bounds[chunk.shapeRuns.front().second + k + 1].expand(chunk.shapeBounds[k]);
+                bData.bounds[0].expand(chunk.shapeBounds[k]);
+            }
+        }
+        cornerRuns.insert(cornerRuns.end(), chunk.cornerRuns.begin(), chunk.cornerRuns.end());
+    }
+    for(auto& volume : bData.bounds){
+        volume.centerOnBox();
+    }
+
+    //  Dedup in file order -> same first-seen order as the serial loader
+    bData.vertices.clear();
+    bData.indices.clear();
+    bData.materials.clear();
+    bData.submeshes.clear();
+    bData.indices.reserve(expanded.size());
+    VertexDedupTable uniqueVertices{expanded.size()};
+    size_t run = 0;
+    for(size_t corner = 0; corner < expanded.size(); corner++){
+        const Model::Vertex& vertex = expanded[corner];
+        while(run + 1 < cornerRuns.size() && cornerRuns[run + 1].first <= corner){
+            run++;
+        }
+        bData.bounds[cornerRuns[run].second + 1].fitRadius(vertex.position);
+        bData.bounds[0].fitRadius(vertex.position);
+        bData.indices.push_back(uniqueVertices.findOrInsert(vertex, bData.vertices));
+    }
+    if(useMaterials){
+        bData.assignMaterials(triangleMaterials, library);
+    }
+    return true;
+}
+
+namespace{
+
+//  Calls onLine(lineStart, lineEnd) for every line of "file" read through "window", line end excludes "\r\n"
+//  Returns false(with "error" set by us or by onLine) when a line does not fit the window or onLine returns false
+template <typename LineFn>
+bool forEachLine(std::FILE* file, std::vector<char>& window, std::string& error, LineFn&& onLine){
+    std::rewind(file);
+    size_t filled = 0;
+    bool endOfFile = false;
+    while(true){
+        if(!endOfFile){
+            size_t wanted = window.size() - filled;
+            size_t read = std::fread(window.data() + filled, 1, wanted, file);
+            filled += read;
+            endOfFile = read < wanted;
+            if(std::ferror(file)){
+                error = "read error";
+                return false;
+            }
+        }
+        const char* begin = window.data();
+        const char* end = begin + filled;
+        //  only complete lines get parsed, the rest moves to the front of the window
+        const char* parseEnd = end;
+        if(!endOfFile){
+            while(parseEnd > begin && *(parseEnd - 1) != '\n'){
+                parseEnd--;
+            }
+            if(parseEnd == begin){
+                error = "line longer than the stream window";
+                return false;
+            }
+        }
+        const char* lineStart = begin;
+        while(lineStart < parseEnd){
+            const char* newLine = static_cast<const char*>(std::memchr(lineStart, '\n', size_t(parseEnd - lineStart)));
+            if(newLine == nullptr){
+                newLine = parseEnd;
+            }
+            const char* lineEnd = newLine;
+            if(lineEnd > lineStart && *(lineEnd - 1) == '\r'){
+                lineEnd--;
+            }
+            if(std::find(lineStart, lineEnd, '\r') != lineEnd){
+                error = "'\\r' only line endings are not supported";
+                return false;
+            }
+            if(!onLine(lineStart, lineEnd)){
+                return false;
+            }
+            lineStart = newLine + 1;
+        }
+        if(endOfFile){
+            return true;
+        }
+        filled = size_t(end - parseEnd);
+        std::memmove(window.data(), parseEnd, filled);
+    }
+}
+
+//  whitespace separated tokens in [token, lineEnd)
+size_t countTokens(const char* token, const char* lineEnd){
+    size_t count = 0;
+    while(token < lineEnd){
+        while(token < lineEnd && isSpace(*token)){
+            token++;
+        }
+        if(token == lineEnd){
+            break;
+        }
+        count++;
+        while(token < lineEnd && !isSpace(*token)){
+            token++;
+        }
+    }
+    return count;
+}
+
+//  (v, vt, vn) index triple -> output vertex, flat open addressing(linear probing) like VertexDedupTable
+//  keyed by obj indices, so vertices never have to be read back once they are handed to the sink
+//  filled by the counting pass(exact vertex count up front), the parse pass only numbers the triples in order of first use
+class CornerWeldTable{
+public:
+    size_t bytes() const {return slots.size() * sizeof(Slot);}
+    size_t size() const {return usedSlots;}
+    bool needsGrow() const {return usedSlots + 1 > growThreshold;}
+    //  bytes held while rehashing(old + new slots)
+    size_t growBytes() const {return bytes() + std::max<size_t>(INITIAL_SLOTS, slots.size() * 2) * sizeof(Slot);}
+
+    void insert(const ResolvedCorner& corner){
+        if(needsGrow()){
+            grow();
+        }
+        size_t slot = find(corner);
+        if(slots[slot].position < 0){
+            slots[slot] = {corner.position, corner.texcoord, corner.normal, UNASSIGNED};
+            usedSlots++;
+        }
+    }
+    //  "corner" has to be inserted already, true when this is its first use and it got "nextVertex"
+    bool assign(const ResolvedCorner& corner, uint32_t nextVertex, uint32_t& vertex){
+        Slot& existing = slots[find(corner)];
+        bool first = existing.vertex == UNASSIGNED;
+        if(first){
+            existing.vertex = nextVertex;
+        }
+        vertex = existing.vertex;
+        return first;
+    }
+
+private:
+    struct Slot{
+        int32_t position = -1;     //  -1 -> empty
+        int32_t texcoord = -1;
+        int32_t normal = -1;
+        uint32_t vertex = 0;
+    };
+    static constexpr size_t INITIAL_SLOTS = 1 << 12;
+    static constexpr uint32_t UNASSIGNED = UINT32_MAX;
+
+    //  slot holding "corner" or the empty slot it goes into
+    size_t find(const ResolvedCorner& corner) const {
+        size_t slot = hash(corner) & slotMask;
+        while(slots[slot].position >= 0){
+            const Slot& existing = slots[slot];
+            if(existing.position == corner.position && existing.texcoord == corner.texcoord && existing.normal == corner.normal){
+                break;
+            }
+            slot = (slot + 1) & slotMask;
+        }
+        return slot;
+    }
+
+    static size_t hash(const ResolvedCorner& corner){
+        uint64_t h = uint64_t(uint32_t(corner.position)) * 0x9E3779B97F4A7C15ull;
+        h ^= (uint64_t(uint32_t(corner.texcoord)) << 32 | uint32_t(corner.normal)) * 0xC2B2AE3D27D4EB4Full;
+        h ^= h >> 29;
+        return static_cast<size_t>(h);
+    }
+    void grow(){
+        std::vector<Slot> old = std::move(slots);
+        slots.assign(std::max<size_t>(INITIAL_SLOTS, old.size() * 2), Slot{});
+        slotMask = slots.size() - 1;
+        growThreshold = slots.size() / 4 * 3;
+        for(const auto& entry : old){
+            if(entry.position < 0){
+                continue;
+            }
+            size_t slot = hash({entry.position, entry.texcoord, entry.normal}) & slotMask;
+            while(slots[slot].position >= 0){
+                slot = (slot + 1) & slotMask;
+            }
+            slots[slot] = entry;
+        }
+    }
+
+    std::vector<Slot> slots;
+    size_t slotMask = 0;
+    size_t usedSlots = 0;
+    size_t growThreshold = 0;
+};
+
+//  corners of an "f" record(from after the keyword) resolved against the attributes read so far, same for both stream passes
+bool parseStreamFace(const char* token, const char* lineEnd, uint32_t positionTotal, uint32_t texcoordTotal, uint32_t normalTotal,
+                     std::vector<ResolvedCorner>& face, std::string& error){
+    LineCursor<true> cursor{token, lineEnd};
+    cursor.skipSpace();
+    face.clear();
+    while(cursor.token < cursor.lineEnd){
+        int raw[3];
+        if(!parseCorner(cursor, raw)){
+            error = "invalid face index";
+            return false;
+        }
+        //  whole file is one chunk here -> chunk base 0, counts so far are the totals
+        ResolvedCorner corner{};
+        corner.position = resolveIndex(raw[0], 0, positionTotal, positionTotal);
+        corner.texcoord = resolveIndex(raw[1], 0, texcoordTotal, texcoordTotal);
+        corner.normal = resolveIndex(raw[2], 0, normalTotal, normalTotal);
+        if(corner.position < 0 || corner.texcoord == INT_MIN || corner.normal == INT_MIN){
+            error = "face index out of range or referencing a later attribute";
+            return false;
+        }
+        face.push_back(corner);
+        while(cursor.token < cursor.lineEnd && (isSpace(*cursor.token) || *cursor.token == '\r')){
+            cursor.token++;
+        }
+    }
+    return true;
+}
+
+}   //  namespace
+
+bool ObjLoader::stream(const std::string& filepath, const ObjStreamSink& sink, ObjStreamStats& stats, const ObjStreamOptions& options){
+    stats = ObjStreamStats{};
+    std::unique_ptr<std::FILE, int(*)(std::FILE*)> file{std::fopen(filepath.c_str(), "rb"), &std::fclose};
+    if(!file){
+        stats.error = "could not open " + filepath;
+        return false;
+    }
+    std::vector<char> window(std::max<size_t>(options.windowSize, 4096));
+
+    //  1. counting pass -> exact pool sizes, index count and every distinct corner(exact vertex count)
+    size_t positionCount = 0, texcoordCount = 0, normalCount = 0, indexCount = 0;
+    bool hasColors = false;
+    CornerWeldTable weld{};
+    std::vector<ResolvedCorner> face;
+    stats.peakMemory = window.size();
+    bool counted = forEachLine(file.get(), window, stats.error, [&](const char* lineStart, const char* lineEnd){
+        while(lineStart < lineEnd && isSpace(*lineStart)){
+            lineStart++;
+        }
+        size_t length = static_cast<size_t>(lineEnd - lineStart);
+        if(length >= 2 && lineStart[0] == 'v' && isSpace(lineStart[1])){
+            positionCount++;
+            hasColors = hasColors || countTokens(lineStart + 2, lineEnd) >= 6;
+        }
+        else if(length >= 3 && lineStart[0] == 'v' && lineStart[1] == 't' && isSpace(lineStart[2])){
+            texcoordCount++;
+        }
+        else if(length >= 3 && lineStart[0] == 'v' && lineStart[1] == 'n' && isSpace(lineStart[2])){
+            normalCount++;
+        }
+        else if(length >= 2 && lineStart[0] == 'f' && isSpace(lineStart[1])){
+            if(!parseStreamFace(lineStart + 2, lineEnd, static_cast<uint32_t>(positionCount), static_cast<uint32_t>(texcoordCount),
+                                static_cast<uint32_t>(normalCount), face, stats.error)){
+                return false;
+            }
+            //  faces under 3 corners emit nothing in the parse pass -> their corners are no vertices either
+            if(face.size() < 3){
+                return true;
+            }
+            indexCount += (face.size() - 2) * 3;
+            for(const ResolvedCorner& corner : face){
+                if(weld.needsGrow()){
+                    if(window.size() + weld.growBytes() > options.memoryBudget){
+                        stats.error = "vertex weld table does not fit the memory budget";
+                        return false;
+                    }
+                    stats.peakMemory = std::max(stats.peakMemory, window.size() + weld.growBytes());
+                }
+                weld.insert(corner);
+            }
+        }
+        return true;
+    });
+    if(!counted){
+        return false;
+    }
+    if(indexCount > UINT32_MAX){
+        stats.error = "more than 2^32 indices";
+        return false;
+    }
+
+    const size_t batchVertices = std::max<size_t>(1, options.batchSize / sizeof(Model::Vertex));
+    const size_t batchIndices = std::max<size_t>(1, options.batchSize / sizeof(uint32_t));
+    //  weld table is already at its final size, the parse pass only reads it
+    const size_t fixedBytes = window.size() + batchVertices * sizeof(Model::Vertex) + batchIndices * sizeof(uint32_t)
+                            + (positionCount * (hasColors ? 6 : 3) + normalCount * 3 + texcoordCount * 2) * sizeof(float)
+                            + weld.bytes();
+    if(fixedBytes > options.memoryBudget){
+        stats.error = "attribute pools and weld table need " + std::to_string(fixedBytes >> 20) + " MB, budget is "
+                    + std::to_string(options.memoryBudget >> 20) + " MB";
+        return false;
+    }
+    stats.peakMemory = std::max(stats.peakMemory, fixedBytes);
+    if(sink.begin){
+        sink.begin(indexCount, weld.size());
+    }
+
+    //  2. parse pass
+    std::vector<float> positions, colors, normals, texcoords;
+    positions.reserve(positionCount * 3);
+    colors.reserve(hasColors ? positionCount * 3 : 0);
+    normals.reserve(normalCount * 3);
+    texcoords.reserve(texcoordCount * 2);
+    std::vector<Model::Vertex> vertexBatch;
+    vertexBatch.reserve(batchVertices);
+    std::vector<uint32_t> indexBatch;
+    indexBatch.reserve(batchIndices);
+    uint32_t vertexCount = 0;
+
+    auto flushVertices = [&]{
+        if(!vertexBatch.empty() && sink.vertices){
+            sink.vertices(vertexBatch.data(), vertexBatch.size());
+        }
+        vertexBatch.clear();
+    };
+    auto flushIndices = [&]{
+        if(!indexBatch.empty() && sink.indices){
+            sink.indices(indexBatch.data(), indexBatch.size());
+        }
+        stats.indexCount += indexBatch.size();
+        indexBatch.clear();
+    };
+    auto emit = [&](const ResolvedCorner& corner){
+        uint32_t index;
+        if(weld.assign(corner, vertexCount, index)){
+            Model::Vertex vertex{};
+            const float* position = &positions[size_t(corner.position) * 3];
+            vertex.position = {position[0], position[1], position[2]};
+            vertex.color = {1.0f, 1.0f, 1.0f};
+            if(hasColors){
+                const float* color = &colors[size_t(corner.position) * 3];
+                vertex.color = {color[0], color[1], color[2]};
+            }
+            if(corner.normal >= 0){
+                const float* normal = &normals[size_t(corner.normal) * 3];
+                vertex.normal = {normal[0], normal[1], normal[2]};
+            }
+            if(corner.texcoord >= 0){
+                const float* uv = &texcoords[size_t(corner.texcoord) * 2];
+                vertex.uv = {uv[0], uv[1]};
+            }
+            vertexBatch.push_back(vertex);
+            vertexCount++;
+            if(vertexBatch.size() == batchVertices){
+                flushVertices();
+            }
+        }
+        indexBatch.push_back(index);
+        if(indexBatch.size() == batchIndices){
+            flushIndices();
+        }
+        return true;
+    };
+
+    bool parsed = forEachLine(file.get(), window, stats.error, [&](const char* lineStart, const char* lineEnd){
+        LineCursor<true> cursor{lineStart, lineEnd};
+        cursor.skipSpace();
+        const char* token = cursor.token;
+        size_t length = static_cast<size_t>(lineEnd - token);
+
+        if(length >= 2 && token[0] == 'v' && isSpace(token[1])){
+            cursor.token += 2;
+            float x = cursor.parseRealOr(0.0f);
+            float y = cursor.parseRealOr(0.0f);
+            float z = cursor.parseRealOr(0.0f);
+            positions.insert(positions.end(), {x, y, z});
+            if(hasColors){
+                //  "x y z w" or no color -> white, same as tinyobj
+                float r = 1.0f, g = 1.0f, b = 1.0f;
+                if(!cursor.parseReal(r) || !cursor.parseReal(g) || !cursor.parseReal(b)){
+                    r = g = b = 1.0f;
+                }
+                colors.insert(colors.end(), {r, g, b});
+            }
+        }
+        else if(length >= 3 && token[0] == 'v' && token[1] == 'n' && isSpace(token[2])){
+            cursor.token += 3;
+            float x = cursor.parseRealOr(0.0f);
+            float y = cursor.parseRealOr(0.0f);
+            float z = cursor.parseRealOr(0.0f);
+            normals.insert(normals.end(), {x, y, z});
+        }
+        else if(length >= 3 && token[0] == 'v' && token[1] == 't' && isSpace(token[2])){
+            cursor.token += 3;
+            float u = cursor.parseRealOr(0.0f);
+            float v = cursor.parseRealOr(0.0f);
+            texcoords.insert(texcoords.end(), {u, v});
+        }
+        else if(length >= 2 && token[0] == 'f' && isSpace(token[1])){
+            if(!parseStreamFace(token + 2, lineEnd, static_cast<uint32_t>(positions.size() / 3), static_cast<uint32_t>(texcoords.size() / 2),
+                                static_cast<uint32_t>(normals.size() / 3), face, stats.error)){
+                return false;
+            }
+            if(face.size() == 4){
+                //  split along the shorter diagonal, same as load()
+                const float* v0 = &positions[size_t(face[0].position) * 3];
+                const float* v1 = &positions[size_t(face[1].position) * 3];
+                const float* v2 = &positions[size_t(face[2].position) * 3];
+                const float* v3 = &positions[size_t(face[3].position) * 3];
+                float sqr02 = 0.0f, sqr13 = 0.0f;
+                for(int k = 0; k < 3; k++){
+                    sqr02 += (v2[k] - v0[k]) * (v2[k] - v0[k]);
+                    sqr13 += (v3[k] - v1[k]) * (v3[k] - v1[k]);
+                }
+                const uint32_t split02[6] = {0, 1, 2, 0, 2, 3};
+                const uint32_t split13[6] = {0, 1, 3, 1, 2, 3};
+                for(uint32_t k : (sqr02 < sqr13 ? split02 : split13)){
+                    if(!emit(face[k])){
+                        return false;
+                    }
+                }
+            }
+            else{
+                for(size_t k = 2; k < face.size(); k++){
+                    if(!emit(face[0]) || !emit(face[k - 1]) || !emit(face[k])){
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    });
+    if(!parsed){
+        return false;
+    }
+    flushVertices();
+    flushIndices();
+    stats.vertexCount = vertexCount;
+    return true;
+}
+
+}   //  namespace VULKVULK
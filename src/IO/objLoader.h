@@ -0,0 +1,68 @@
+#ifndef OBJ_LOADER_H
+#define OBJ_LOADER_H
+
+#include "../Render/model.h"
+
+#include <functional>
+#include <string>
+
+namespace VULKVULK{
+
+struct ObjLoaderOptions{
+    //  false : tinyobj's own tryParseDouble -> bit identical to the tinyobj path, default so models load as they always did
+    //  true  : correctly rounded float parsing (exact fast path, std::from_chars for the rest), tinyobj is not always
+    //          correctly rounded -> can differ from tinyobj in the last bit
+    bool exactFloats = false;
+};
+
+//  Bounded memory import(ObjLoader::stream) -> everything held at once counts against "memoryBudget"
+struct ObjStreamOptions{
+    size_t windowSize = size_t(4) << 20;        //  bytes read from the file at a time, longest line has to fit
+    size_t batchSize = size_t(4) << 20;         //  bytes of vertices/indices collected before handing them to the sink
+    size_t memoryBudget = size_t(512) << 20;    //  window + batches + attribute pools + weld table
+};
+
+//  Receives the mesh in batches, pointers are only valid during the call
+struct ObjStreamSink{
+    //  once before the first batch with the exact totals of the mesh -> destination can be sized up front
+    std::function<void(size_t indexCount, size_t vertexCount)> begin;
+    std::function<void(const Model::Vertex* vertices, size_t count)> vertices;
+    std::function<void(const uint32_t* indices, size_t count)> indices;
+};
+
+struct ObjStreamStats{
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+    size_t peakMemory = 0;      //  bytes held by the import itself at its peak
+    std::string error{};        //  why stream() returned false
+};
+
+//  Parallel OBJ parser working in place on the memory mapped file
+//  
+//  1. file gets split into line aligned chunks, every chunk tokenizes its own v/vn/vt/f records on the shared thread pool
+//  2. relative(negative) indices are resolved with per chunk prefix counts, attribute pools stay inside their chunk
+//  3. faces are triangulated the same way tinyobj does(quads split along the shorter diagonal) and written as Vertex
+//     straight into one array, every chunk into its own slice
+//  4. vertex dedup runs over that array in file order -> output order does not depend on chunk or thread count
+//  5. with a readable mtllib, triangles get grouped by their usemtl material into submeshes(see assignMaterials)
+//
+//  Anything we do not reproduce the same way tinyobj does(n-gons with 5+ corners, x y z w positions, broken indices,
+//  '\r' only line endings) makes load() return false so caller can fall back to tinyobj
+class ObjLoader{
+public:
+    static bool load(const std::string& filepath, Model::bufferData& bData, const ObjLoaderOptions& options = ObjLoaderOptions{});
+
+    //  Two passes over the file through a fixed size window, nothing like the whole file or expanded corners is held
+    //  1. counting pass -> exact attribute pool sizes, index count and vertex count(corners welded by their (v, vt, vn)
+    //     indices), fails early when pools and weld table break the budget
+    //  2. parse pass -> vertices are numbered in order of first use and emitted as they come, batches go to "sink"
+    //  Welding by index instead of by value can keep a few more vertices than load() for files repeating attribute values
+    //  n-gons are fan triangulated, references to attributes defined later in the file are not supported
+    //  materials are ignored(one draw range, default material)
+    static bool stream(const std::string& filepath, const ObjStreamSink& sink, ObjStreamStats& stats,
+                       const ObjStreamOptions& options = ObjStreamOptions{});
+};
+
+}   //  namespace VULKVULK
+
+#endif
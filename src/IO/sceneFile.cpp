@@ -0,0 +1,423 @@
+#include "sceneFile.h"
+#include "assetPack.h"
+#include "fileStamp.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <system_error>
+#include <unordered_map>
+
+namespace VULKVULK{
+
+namespace{
+
+constexpr uint64_t DATA_ALIGNMENT = 16;
+//  "object name t x y z r x y z s x y z c r g b" is 18, anything past that is an error anyway
+constexpr size_t MAX_TOKENS = 24;
+
+struct flagName{
+    const char* name;
+    uint32_t flag;
+};
+constexpr flagName MODEL_FLAG_NAMES[] = {
+    {"weld", SceneFile::MODEL_WELD},
+    {"optimize", SceneFile::MODEL_OPTIMIZE},
+    {"compact", SceneFile::MODEL_COMPACT},
+    {"split", SceneFile::MODEL_SPLIT},
+    {"lods", SceneFile::MODEL_LODS},
+    {"meshlets", SceneFile::MODEL_MESHLETS},
+    {"impostor", SceneFile::MODEL_IMPOSTOR},
+};
+
+uint64_t alignUp(uint64_t value, uint64_t alignment){
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+inline bool isSpace(char c){return c == ' ' || c == '\t' || c == '\r';}
+
+//  space separated tokens of "line", returns MAX_TOKENS + 1 when there are more than MAX_TOKENS
+size_t tokenize(std::string_view line, std::string_view* tokens){
+    size_t count = 0;
+    size_t i = 0;
+    while(i < line.size()){
+        while(i < line.size() && isSpace(line[i])){
+            i++;
+        }
+        const size_t start = i;
+        while(i < line.size() && !isSpace(line[i])){
+            i++;
+        }
+        if(i > start){
+            if(count == MAX_TOKENS){
+                return MAX_TOKENS + 1;
+            }
+            tokens[count++] = line.substr(start, i - start);
+        }
+    }
+    return count;
+}
+
+bool parseVec3(const std::string_view* tokens, glm::vec3& value){
+    for(int axis = 0; axis < 3; axis++){
+        const char* begin = tokens[axis].data();
+        const char* end = begin + tokens[axis].size();
+        auto [ptr, ec] = std::from_chars(begin, end, value[axis]);
+        if(ec != std::errc{} || ptr != end){
+            return false;
+        }
+    }
+    return true;
+}
+
+}   //  namespace
+
+uint32_t SceneFile::sceneData::addModel(const std::string& path, uint32_t flags){
+    modelPaths.push_back(path);
+    modelFlags.push_back(flags);
+    return static_cast<uint32_t>(modelPaths.size() - 1);
+}
+
+void SceneFile::sceneData::addObject(uint32_t model, const TransformComponent& transform, const glm::vec3& color){
+    translations.push_back(transform.translation);
+    rotations.push_back(transform.rotation);
+    scales.push_back(transform.scale);
+    colors.push_back(color);
+    modelIndices.push_back(model);
+}
+
+std::string SceneFile::cachePathFor(const std::string& sourcePath){
+    return sourcePath + ".vkscene";
+}
+
+ModelLoadOptions SceneFile::loadOptions(uint32_t flags){
+    ModelLoadOptions options{};
+    options.weldVertices = (flags & MODEL_WELD) != 0;
+    options.optimizeMesh = (flags & MODEL_OPTIMIZE) != 0;
+    options.compactVertices = (flags & MODEL_COMPACT) != 0;
+    options.splitPositions = (flags & MODEL_SPLIT) != 0;
+    options.generateLods = (flags & MODEL_LODS) != 0;
+    options.buildMeshlets = (flags & MODEL_MESHLETS) != 0;
+    options.bakeImpostor = (flags & MODEL_IMPOSTOR) != 0;
+    return options;
+}
+
+bool SceneFile::parseText(const std::string& sourcePath, sceneData& scene, std::string& error){
+    scene = sceneData{};
+    MappedFile source{};
+    if(!source.open(sourcePath)){
+        //  mapping fails on empty files -> still a valid(empty) scene
+        std::error_code ec;
+        if(std::filesystem::is_regular_file(sourcePath, ec) && std::filesystem::file_size(sourcePath, ec) == 0){
+            return true;
+        }
+        error = "could not read " + sourcePath;
+        return false;
+    }
+    const char* cursor = reinterpret_cast<const char*>(source.data());
+    const char* end = cursor + source.size();
+    //  nearly every line is an object -> arrays grow once
+    const size_t lineCount = static_cast<size_t>(std::count(cursor, end, '\n')) + 1;
+    scene.translations.reserve(lineCount);
+    scene.rotations.reserve(lineCount);
+    scene.scales.reserve(lineCount);
+    scene.colors.reserve(lineCount);
+    scene.modelIndices.reserve(lineCount);
+
+    //  names point into the mapping, only needed while parsing
+    std::unordered_map<std::string_view, uint32_t> modelNames{};
+    std::string_view tokens[MAX_TOKENS];
+    size_t lineNumber = 0;
+    auto fail = [&](const std::string& message){
+        error = sourcePath + ":" + std::to_string(lineNumber) + " : " + message;
+        return false;
+    };
+    while(cursor < end){
+        const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', size_t(end - cursor)));
+        lineEnd = lineEnd != nullptr ? lineEnd : end;
+        std::string_view line{cursor, size_t(lineEnd - cursor)};
+        cursor = lineEnd + 1;
+        lineNumber++;
+        line = line.substr(0, line.find('#'));
+
+        const size_t count = tokenize(line, tokens);
+        if(count == 0){
+            continue;
+        }
+        if(count > MAX_TOKENS){
+            return fail("too many tokens");
+        }
+        if(tokens[0] == "object"){
+            if(count < 2){
+                return fail("object needs a model name or -");
+            }
+            uint32_t model = NO_MODEL;
+            if(tokens[1] != "-"){
+                auto found = modelNames.find(tokens[1]);
+                if(found == modelNames.end()){
+                    return fail("unknown model " + std::string(tokens[1]));
+                }
+                model = found->second;
+            }
+            TransformComponent transform{};
+            glm::vec3 color{0.0f};
+            for(size_t k = 2; k < count; k += 4){
+                glm::vec3* target = tokens[k] == "t" ? &transform.translation
+                                  : tokens[k] == "r" ? &transform.rotation
+                                  : tokens[k] == "s" ? &transform.scale
+                                  : tokens[k] == "c" ? &color : nullptr;
+                if(target == nullptr || k + 4 > count || !parseVec3(tokens + k + 1, *target)){
+                    return fail("expected <t|r|s|c> x y z, got " + std::string(tokens[k]));
+                }
+            }
+            scene.addObject(model, transform, color);
+        }
+        else if(tokens[0] == "model"){
+            if(count < 3){
+                return fail("model needs a name and a path");
+            }
+            if(modelNames.count(tokens[1]) != 0){
+                return fail("model " + std::string(tokens[1]) + " defined twice");
+            }
+            uint32_t flags = 0;
+            for(size_t k = 3; k < count; k++){
+                auto known = std::find_if(std::begin(MODEL_FLAG_NAMES), std::end(MODEL_FLAG_NAMES),
+                                          [&](const flagName& option){ return tokens[k] == option.name; });
+                if(known == std::end(MODEL_FLAG_NAMES)){
+                    return fail("unknown model option " + std::string(tokens[k]));
+                }
+                flags |= known->flag;
+            }
+            modelNames.emplace(tokens[1], scene.addModel(std::string(tokens[2]), flags));
+        }
+        else{
+            return fail("unknown record " + std::string(tokens[0]));
+        }
+    }
+    return true;
+}
+
+bool SceneFile::write(const std::string& sourcePath, const sceneData& scene){
+    const size_t objectCount = scene.objectCount();
+    if(scene.modelFlags.size() != scene.modelPaths.size() || scene.translations.size() != objectCount
+       || scene.rotations.size() != objectCount || scene.scales.size() != objectCount || scene.colors.size() != objectCount
+       || scene.modelPaths.size() >= NO_MODEL || objectCount > std::numeric_limits<uint32_t>::max()){
+        return false;
+    }
+    Header header{};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.modelCount = static_cast<uint32_t>(scene.modelPaths.size());
+    header.objectCount = static_cast<uint32_t>(objectCount);
+    if(!fileStamp(sourcePath, header.sourceWriteTime, header.sourceSize)){
+        return false;
+    }
+
+    std::vector<ModelEntry> entries(scene.modelPaths.size());
+    std::string paths{};
+    for(size_t i = 0; i < entries.size(); i++){
+        entries[i].pathOffset = static_cast<uint32_t>(paths.size());
+        entries[i].pathLength = static_cast<uint32_t>(scene.modelPaths[i].size());
+        entries[i].flags = scene.modelFlags[i];
+        paths += scene.modelPaths[i];
+    }
+    header.pathsOffset = sizeof(Header) + entries.size() * sizeof(ModelEntry);
+    header.pathsSize = paths.size();
+
+    //  arrays in file order, each at the next aligned offset
+    const std::pair<uint64_t*, std::pair<const void*, uint64_t>> arrays[] = {
+        {&header.translationsOffset, {scene.translations.data(), objectCount * sizeof(glm::vec3)}},
+        {&header.rotationsOffset, {scene.rotations.data(), objectCount * sizeof(glm::vec3)}},
+        {&header.scalesOffset, {scene.scales.data(), objectCount * sizeof(glm::vec3)}},
+        {&header.colorsOffset, {scene.colors.data(), objectCount * sizeof(glm::vec3)}},
+        {&header.modelIndicesOffset, {scene.modelIndices.data(), objectCount * sizeof(uint32_t)}},
+    };
+    uint64_t offset = header.pathsOffset + header.pathsSize;
+    for(const auto& array : arrays){
+        *array.first = alignUp(offset, DATA_ALIGNMENT);
+        offset = *array.first + array.second.second;
+    }
+
+    //  write to temp file and rename -> a running app never maps a half written scene
+    const std::string cachePath = cachePathFor(sourcePath);
+    const std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream out{tempPath, std::ios::binary | std::ios::trunc};
+        if(!out.is_open()){
+            return false;
+        }
+        const char padding[DATA_ALIGNMENT]{};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(ModelEntry)));
+        out.write(paths.data(), static_cast<std::streamsize>(paths.size()));
+        for(const auto& array : arrays){
+            const uint64_t current = static_cast<uint64_t>(out.tellp());
+            out.write(padding, static_cast<std::streamsize>(*array.first - current));
+            out.write(static_cast<const char*>(array.second.first), static_cast<std::streamsize>(array.second.second));
+        }
+        if(!out.good()){
+            out.close();
+            std::filesystem::remove(tempPath);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, cachePath, ec);
+    if(ec){
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+bool SceneFile::convert(const std::string& sourcePath, std::string& error){
+    sceneData scene{};
+    if(!parseText(sourcePath, scene, error)){
+        return false;
+    }
+    if(!write(sourcePath, scene)){
+        error = "could not write " + cachePathFor(sourcePath);
+        return false;
+    }
+    return true;
+}
+
+bool SceneFile::restamp(const std::string& sourcePath){
+    Header stamped{};
+    std::fstream cache{cachePathFor(sourcePath), std::ios::binary | std::ios::in | std::ios::out};
+    if(!cache.is_open() || !cache.read(reinterpret_cast<char*>(&stamped), sizeof(stamped))){
+        return false;
+    }
+    if(stamped.magic != MAGIC || stamped.version != VERSION){
+        return false;
+    }
+    if(!fileStamp(sourcePath, stamped.sourceWriteTime, stamped.sourceSize)){
+        return false;
+    }
+    //  only the header changes -> rewritten in place
+    cache.seekp(0);
+    cache.write(reinterpret_cast<const char*>(&stamped), sizeof(stamped));
+    return cache.good();
+}
+
+bool SceneFile::open(const std::string& sourcePath){
+    close();
+    int64_t writeTime = 0;
+    uint64_t size = 0;
+    if(!fileStamp(sourcePath, writeTime, size) || !file.open(cachePathFor(sourcePath))){
+        return false;
+    }
+    if(!attach(file.data(), file.size()) || header.sourceWriteTime != writeTime || header.sourceSize != size){
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool SceneFile::openFromPack(const std::string& sourcePath){
+    close();
+    const AssetPack::entryView entry = AssetPack::shared().find(cachePathFor(sourcePath));
+    if(!entry || !attach(entry.data, entry.size)){
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool SceneFile::load(const std::string& sourcePath, std::string& error){
+    if(openFromPack(sourcePath) || open(sourcePath)){
+        return true;
+    }
+    if(!convert(sourcePath, error)){
+        return false;
+    }
+    if(!open(sourcePath)){
+        error = "could not map " + cachePathFor(sourcePath);
+        return false;
+    }
+    return true;
+}
+
+void SceneFile::close(){
+    file.close();
+    data = nullptr;
+    header = Header{};
+    models = nullptr;
+    paths = nullptr;
+    translations = rotations = scales = colors = nullptr;
+    modelIndices = nullptr;
+}
+
+bool SceneFile::attach(const uint8_t* fileData, size_t fileSize){
+    if(fileSize < sizeof(Header)){
+        return false;
+    }
+    std::memcpy(&header, fileData, sizeof(Header));
+    //  never trust offsets read from disk, arrays have to be float aligned to be read in place
+    const uint64_t objectCount = header.objectCount;
+    auto fits = [&](uint64_t offset, uint64_t elementSize){
+        return offset % alignof(float) == 0 && offset <= fileSize && objectCount * elementSize <= fileSize - offset;
+    };
+    bool valid = header.magic == MAGIC
+                 && header.version == VERSION
+                 && uint64_t(header.modelCount) * sizeof(ModelEntry) <= fileSize - sizeof(Header)
+                 && header.pathsOffset <= fileSize
+                 && header.pathsSize <= fileSize - header.pathsOffset
+                 && fits(header.translationsOffset, sizeof(glm::vec3))
+                 && fits(header.rotationsOffset, sizeof(glm::vec3))
+                 && fits(header.scalesOffset, sizeof(glm::vec3))
+                 && fits(header.colorsOffset, sizeof(glm::vec3))
+                 && fits(header.modelIndicesOffset, sizeof(uint32_t));
+    auto entries = reinterpret_cast<const ModelEntry*>(fileData + sizeof(Header));
+    for(uint32_t i = 0; valid && i < header.modelCount; i++){
+        valid = uint64_t(entries[i].pathOffset) + entries[i].pathLength <= header.pathsSize;
+    }
+    if(!valid){
+        header = Header{};
+        return false;
+    }
+    data = fileData;
+    models = entries;
+    paths = reinterpret_cast<const char*>(fileData + header.pathsOffset);
+    translations = reinterpret_cast<const glm::vec3*>(fileData + header.translationsOffset);
+    rotations = reinterpret_cast<const glm::vec3*>(fileData + header.rotationsOffset);
+    scales = reinterpret_cast<const glm::vec3*>(fileData + header.scalesOffset);
+    colors = reinterpret_cast<const glm::vec3*>(fileData + header.colorsOffset);
+    modelIndices = reinterpret_cast<const uint32_t*>(fileData + header.modelIndicesOffset);
+    return true;
+}
+
+std::string_view SceneFile::getModelPath(uint32_t model) const{
+    return std::string_view{paths + models[model].pathOffset, models[model].pathLength};
+}
+
+std::vector<ModelHandle> SceneFile::acquireModels(ModelRegistry& registry) const{
+    std::vector<ModelHandle> handles{};
+    handles.reserve(header.modelCount);
+    for(uint32_t i = 0; i < header.modelCount; i++){
+        handles.push_back(registry.acquire(std::string(getModelPath(i)), loadOptions(models[i].flags)));
+    }
+    return handles;
+}
+
+void SceneFile::instantiate(const std::vector<ModelHandle>& handles, std::vector<GameObject>& objects) const{
+    const size_t first = objects.size();
+    GameObject::createGameObjects(header.objectCount, objects);
+    for(uint32_t i = 0; i < header.objectCount; i++){
+        GameObject& object = objects[first + i];
+        object.transform.translation = translations[i];
+        object.transform.rotation = rotations[i];
+        object.transform.scale = scales[i];
+        object.color = colors[i];
+        //  NO_MODEL and indices a damaged file points past the table leave the object without a model
+        if(modelIndices[i] < handles.size()){
+            object.pendingModel = handles[modelIndices[i]];
+        }
+    }
+}
+
+}   //  namespace VULKVULK
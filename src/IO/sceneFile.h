@@ -0,0 +1,145 @@
+#ifndef SCENE_FILE_H
+#define SCENE_FILE_H
+
+#include "../GameAsset/gameObject.h"
+#include "mappedFile.h"
+#include "modelRegistry.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace VULKVULK{
+
+//  Binary scene : model table + one array per object attribute(SoA), written next to its text source as
+//  "<source>.vkscene" -> loading a scene is one mmap, objects are instantiated straight out of the arrays
+//
+//  File layout (little endian, every array starts at a 16 byte aligned offset)
+//      [Header][ModelEntry * modelCount][paths][translations][rotations][scales][colors][model indices]
+//  vec3 arrays are tightly packed floats(12 bytes per object), model index NO_MODEL -> object without a model
+//
+//  Text source(the converter input), one record per line, '#' starts a comment, tokens are separated by spaces :
+//      model <name> <path> [weld] [optimize] [compact] [split] [lods] [meshlets] [impostor]
+//      object <model name | -> [t x y z] [r x y z] [s x y z] [c r g b]
+//  rotation in radians(TransformComponent::rotation), scale defaults to 1, color to 0
+//  model paths are relative to the working directory like every path of the app and can not hold spaces
+class SceneFile{
+public:
+    //  bump this whenever the layout of the file changes -> old caches get rebuilt
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t MAGIC = 0x43534B56;  //  "VKSC"
+    static constexpr uint32_t NO_MODEL = 0xFFFFFFFF;
+
+    //  load options of a model entry, see loadOptions
+    enum ModelFlags : uint32_t{
+        MODEL_WELD      = 1u << 0,
+        MODEL_OPTIMIZE  = 1u << 1,
+        MODEL_COMPACT   = 1u << 2,
+        MODEL_SPLIT     = 1u << 3,
+        MODEL_LODS      = 1u << 4,
+        MODEL_MESHLETS  = 1u << 5,
+        MODEL_IMPOSTOR  = 1u << 6,
+    };
+
+    struct Header{
+        uint32_t magic;
+        uint32_t version;
+        uint32_t modelCount;
+        uint32_t objectCount;
+        int64_t sourceWriteTime;        //  last write time of the text source this file was converted from
+        uint64_t sourceSize;
+        uint64_t pathsOffset;           //  from start of file
+        uint64_t pathsSize;
+        uint64_t translationsOffset;    //  glm::vec3 * objectCount
+        uint64_t rotationsOffset;       //  glm::vec3 * objectCount
+        uint64_t scalesOffset;          //  glm::vec3 * objectCount
+        uint64_t colorsOffset;          //  glm::vec3 * objectCount
+        uint64_t modelIndicesOffset;    //  uint32_t * objectCount
+    };
+    struct ModelEntry{
+        uint32_t pathOffset;            //  from pathsOffset, not null terminated
+        uint32_t pathLength;
+        uint32_t flags;                 //  ModelFlags
+        uint32_t reserved;
+    };
+
+    //  In memory scene -> what the converter builds and write() stores
+    struct sceneData{
+        std::vector<std::string> modelPaths{};
+        std::vector<uint32_t> modelFlags{};
+        std::vector<glm::vec3> translations{};
+        std::vector<glm::vec3> rotations{};
+        std::vector<glm::vec3> scales{};
+        std::vector<glm::vec3> colors{};
+        std::vector<uint32_t> modelIndices{};
+
+        uint32_t addModel(const std::string& path, uint32_t flags);
+        void addObject(uint32_t model, const TransformComponent& transform, const glm::vec3& color = glm::vec3{0.0f});
+        size_t objectCount() const { return modelIndices.size(); }
+    };
+
+    SceneFile() = default;
+
+    SceneFile(const SceneFile&) = delete;
+    SceneFile& operator=(const SceneFile&) = delete;
+
+    static std::string cachePathFor(const std::string& sourcePath);
+    //  ModelFlags -> what ModelRegistry::acquire gets asked with
+    static ModelLoadOptions loadOptions(uint32_t flags);
+
+    //  Converter : text source -> sceneData, false with "error" naming the line when the text is malformed
+    static bool parseText(const std::string& sourcePath, sceneData& scene, std::string& error);
+    //  Writes the cache of "sourcePath" stamped with the source, false if it could not be written
+    static bool write(const std::string& sourcePath, const sceneData& scene);
+    //  parseText + write
+    static bool convert(const std::string& sourcePath, std::string& error);
+    //  Source content is unchanged but its stamp moved -> stores the new stamp so open() accepts the cache again
+    static bool restamp(const std::string& sourcePath);
+
+    //  Maps the cache of "sourcePath", false if there is none, it is older than the source or of a different version
+    bool open(const std::string& sourcePath);
+    //  Cache of "sourcePath" out of AssetPack::shared(), no source stamp check
+    bool openFromPack(const std::string& sourcePath);
+    //  Pack, then the loose cache, then converting the text source(cache is written for the next run)
+    bool load(const std::string& sourcePath, std::string& error);
+    void close();
+
+    bool isOpen() const { return data != nullptr; }
+    uint32_t getModelCount() const { return header.modelCount; }
+    uint32_t getObjectCount() const { return header.objectCount; }
+    std::string_view getModelPath(uint32_t model) const;
+    uint32_t getModelFlags(uint32_t model) const { return models[model].flags; }
+    //  object arrays, getObjectCount() elements each, valid while the file is open
+    const glm::vec3* getTranslations() const { return translations; }
+    const glm::vec3* getRotations() const { return rotations; }
+    const glm::vec3* getScales() const { return scales; }
+    const glm::vec3* getColors() const { return colors; }
+    const uint32_t* getModelIndices() const { return modelIndices; }
+
+    //  One handle per model table entry, same order
+    std::vector<ModelHandle> acquireModels(ModelRegistry& registry) const;
+    //  Appends every object to "objects" in one pass over the arrays, "models" comes from acquireModels
+    //  (empty handles are fine -> objects without models)
+    void instantiate(const std::vector<ModelHandle>& models, std::vector<GameObject>& objects) const;
+
+private:
+    //  validates the header and points the arrays into [fileData, fileData + fileSize)
+    bool attach(const uint8_t* fileData, size_t fileSize);
+
+    MappedFile file{};
+    const uint8_t* data = nullptr;
+    Header header{};
+    const ModelEntry* models = nullptr;
+    const char* paths = nullptr;
+    const glm::vec3* translations = nullptr;
+    const glm::vec3* rotations = nullptr;
+    const glm::vec3* scales = nullptr;
+    const glm::vec3* colors = nullptr;
+    const uint32_t* modelIndices = nullptr;
+};
+
+}   //  namespace VULKVULK
+
+#endif
@@ -0,0 +1,149 @@
+#include "textureCache.h"
+#include "assetPack.h"
+#include "fileStamp.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace VULKVULK{
+
+namespace{
+
+constexpr uint64_t DATA_ALIGNMENT = 16;
+
+uint64_t alignUp(uint64_t value, uint64_t alignment){
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+//  "data" holds a whole cache file, stamp checks are skipped for null stamps(pack entries)
+bool parseCache(const uint8_t* data, size_t size, uint32_t processKey, const int64_t* sourceWriteTime, const uint64_t* sourceSize,
+                Texture::textureView& view){
+    if(size < sizeof(TextureCache::Header)){
+        return false;
+    }
+
+    TextureCache::Header header{};
+    std::memcpy(&header, data, sizeof(TextureCache::Header));
+    const uint64_t dataOffset = alignUp(sizeof(TextureCache::Header) + uint64_t(header.mipCount) * sizeof(TextureCache::MipEntry), DATA_ALIGNMENT);
+    bool valid = header.magic == TextureCache::MAGIC
+                && header.version == TextureCache::VERSION
+                && (sourceWriteTime == nullptr || header.sourceWriteTime == *sourceWriteTime) //  source touched after baking -> stale
+                && (sourceSize == nullptr || header.sourceSize == *sourceSize)
+                && header.processKey == processKey
+                && header.mipCount > 0
+                && dataOffset <= size;
+    if(!valid){
+        return false;
+    }
+
+    auto levels = reinterpret_cast<const TextureCache::MipEntry*>(data + sizeof(TextureCache::Header));
+    const uint64_t dataSize = size - dataOffset;
+    for(uint32_t i = 0; i < header.mipCount; i++){
+        //  never trust offsets read from disk
+        if(levels[i].offset > dataSize || levels[i].size > dataSize - levels[i].offset){
+            return false;
+        }
+    }
+
+    view = Texture::textureView{};
+    view.format = static_cast<VkFormat>(header.format);
+    view.width = header.width;
+    view.height = header.height;
+    view.levels = levels;
+    view.levelCount = header.mipCount;
+    view.data = data + dataOffset;
+    view.dataSize = dataSize;
+    return true;
+}
+
+}   //  namespace
+
+std::string TextureCache::cachePathFor(const std::string& sourcePath){
+    return sourcePath + ".vktex";
+}
+
+bool TextureCache::read(const std::string& sourcePath, uint32_t processKey, MappedFile& file, Texture::textureView& view){
+    int64_t writeTime = 0;
+    uint64_t size = 0;
+    if(!fileStamp(sourcePath, writeTime, size)){
+        return false;
+    }
+    if(!file.open(cachePathFor(sourcePath))){
+        return false;
+    }
+    if(!parseCache(file.data(), file.size(), processKey, &writeTime, &size, view)){
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+bool TextureCache::readFromPack(const std::string& sourcePath, uint32_t processKey, Texture::textureView& view){
+    const AssetPack::entryView entry = AssetPack::shared().find(cachePathFor(sourcePath));
+    return entry && parseCache(entry.data, entry.size, processKey, nullptr, nullptr, view);
+}
+
+bool TextureCache::write(const std::string& sourcePath, uint32_t processKey, const Texture::textureView& view){
+    Header header{};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.format = static_cast<uint32_t>(view.format);
+    header.width = view.width;
+    header.height = view.height;
+    header.mipCount = view.levelCount;
+    header.processKey = processKey;
+    if(!fileStamp(sourcePath, header.sourceWriteTime, header.sourceSize)){
+        return false;
+    }
+    const uint64_t tableEnd = sizeof(Header) + uint64_t(header.mipCount) * sizeof(MipEntry);
+
+    //  write to temp file and rename -> reader never maps a half written cache
+    const std::string finalPath = cachePathFor(sourcePath);
+    const std::string tempPath = finalPath + ".tmp";
+    {
+        std::ofstream out{tempPath, std::ios::binary | std::ios::trunc};
+        if(!out.is_open()){
+            return false;
+        }
+        const char padding[DATA_ALIGNMENT]{};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(view.levels), header.mipCount * sizeof(MipEntry));
+        out.write(padding, static_cast<std::streamsize>(alignUp(tableEnd, DATA_ALIGNMENT) - tableEnd));
+        out.write(reinterpret_cast<const char*>(view.data), static_cast<std::streamsize>(view.dataSize));
+        if(!out.good()){
+            out.close();
+            std::filesystem::remove(tempPath);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, finalPath, ec);
+    if(ec){
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+bool TextureCache::restamp(const std::string& sourcePath){
+    Header header{};
+    std::fstream file{cachePathFor(sourcePath), std::ios::binary | std::ios::in | std::ios::out};
+    if(!file.is_open() || !file.read(reinterpret_cast<char*>(&header), sizeof(header))){
+        return false;
+    }
+    if(header.magic != MAGIC || header.version != VERSION){
+        return false;
+    }
+    if(!fileStamp(sourcePath, header.sourceWriteTime, header.sourceSize)){
+        return false;
+    }
+    //  only the header changes -> rewritten in place
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    return file.good();
+}
+
+}   //  namespace VULKVULK
@@ -0,0 +1,55 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include "../Render/texture.h"
+#include "mappedFile.h"
+
+#include <string>
+
+namespace VULKVULK{
+
+//  Binary cache of a finished(mipmapped, block compressed) texture, written next to the source as "<source>.vktex"
+//  -> loading it is a single mmap, the level data goes straight into the staging buffer
+//
+//  File layout (little endian, level data starts at a 16 byte aligned offset)
+//      [Header][MipEntry * mipCount][level data ...]
+class TextureCache{
+public:
+    //  bump this whenever the file layout or the encoders' output changes -> old caches get rebuilt
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t MAGIC = 0x58544B56;  //  "VKTX"
+
+    struct Header{
+        uint32_t magic;
+        uint32_t version;
+        uint32_t format;                //  VkFormat of every level
+        uint32_t width;
+        uint32_t height;
+        uint32_t mipCount;
+        int64_t sourceWriteTime;        //  last write time of the source image this cache was built from
+        uint64_t sourceSize;
+        uint32_t processKey;            //  TextureLoadOptions::processKey() the data was baked with
+        uint32_t reserved;
+    };
+    //  offset is relative to the start of the level data
+    using MipEntry = Texture::mipLevel;
+
+    static std::string cachePathFor(const std::string& sourcePath);
+
+    //  Maps the cache of "sourcePath" and points "view" into the mapping
+    //  Returns false if there is no cache, it is older than the source, it was written by a different version
+    //  or it was baked with different "processKey"
+    //  "file" must outlive every use of "view", view.levels points into the mapping as well
+    static bool read(const std::string& sourcePath, uint32_t processKey, MappedFile& file, Texture::textureView& view);
+    //  Same as read() with the cache taken from AssetPack::shared() -> no source stamp check, "view" lives as long as the mount
+    static bool readFromPack(const std::string& sourcePath, uint32_t processKey, Texture::textureView& view);
+    //  Returns false if cache could not be written -> not fatal, the image gets decoded again next time
+    static bool write(const std::string& sourcePath, uint32_t processKey, const Texture::textureView& view);
+    //  Source content is unchanged but its stamp moved(checkout, copy, touch) -> stores the new stamp in the header
+    //  so read() accepts the cache again without rebuilding, returns false if there is no cache of this version
+    static bool restamp(const std::string& sourcePath);
+};
+
+}   //  namespace VULKVULK
+
+#endif
@@ -0,0 +1,288 @@
+#include "textureStreamer.h"
+#include "../Render/swapChain.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+
+namespace VULKVULK{
+
+uint32_t StreamedTexture::baseMip() const{
+    uint32_t mip = 0;
+    while(mip + 1 < source.levels.size()
+        && std::max(source.levels[mip].width, source.levels[mip].height) > TextureStreamer::BASE_MIP_SIZE){
+        mip++;
+    }
+    return mip;
+}
+
+uint64_t StreamedTexture::bytesFrom(uint32_t mip) const{
+    //  levels are stored largest first -> everything from "mip" on is one tail of the data
+    return mip < source.levels.size() ? source.dataSize - source.levels[mip].offset : 0;
+}
+
+TextureStreamer::TextureStreamer(Device& device, ThreadPool& pool, VkDeviceSize gpuBudget) : device(device), pool(pool), gpuBudget(gpuBudget){}
+
+TextureStreamer::~TextureStreamer(){
+    //  images of a batch cannot be destroyed while the GPU still copies into them
+    for(auto& pending : uploads){
+        pending.batch->wait();
+    }
+}
+
+std::shared_ptr<StreamedTexture> TextureStreamer::acquire(const std::string& filepath, const TextureLoadOptions& options){
+    //  format support is a device query -> decided here, the job only sees plain options
+    TextureLoadOptions supportedOptions = options;
+    supportedOptions.compression = Texture::supportedCompression(device, options.compression, options.srgb);
+
+    std::error_code ec;
+    std::filesystem::path path = std::filesystem::weakly_canonical(filepath, ec);
+    if(ec){
+        path = std::filesystem::path(filepath).lexically_normal();
+    }
+    std::string key = path.generic_string() + "|" + std::to_string(supportedOptions.processKey());
+    std::shared_ptr<StreamedTexture>& texture = textures[key];
+    if(texture){
+        return texture;
+    }
+    texture = std::make_shared<StreamedTexture>();
+    texture->path = filepath;
+    //  job only owns copies -> safe to outlive the streamer
+    texture->preparing = pool.submit([filepath, supportedOptions]{
+        return Texture::prepareFromFile(filepath, supportedOptions);
+    });
+    return texture;
+}
+
+void TextureStreamer::update(const std::vector<GameObject>& gameObjects, const Camera& camera, float viewportHeight){
+    frame++;
+    uploadedLastFrame = 0;
+    collectPrepared();
+    retireUploads(false);
+
+    //  textures only the streamer still holds -> images retire like any other replaced image
+    for(auto it = textures.begin(); it != textures.end();){
+        StreamedTexture& texture = *it->second;
+        if(it->second.use_count() > 1 || texture.uploading){
+            ++it;
+            continue;
+        }
+        if(texture.texture){
+            retired.push_back({std::move(texture.texture), frame});
+        }
+        it = textures.erase(it);
+    }
+    //  no frame in flight can still sample these
+    retired.erase(std::remove_if(retired.begin(), retired.end(), [&](const retiredImage& image){
+        return frame - image.frame > SwapChain::MAX_FRAMES_IN_FLIGHT;
+    }), retired.end());
+
+    measureScreenSize(gameObjects, camera, viewportHeight);
+    fitBudget();
+    scheduleUploads();
+
+    residentBytes = 0;
+    for(const auto& [key, texture] : textures){
+        if(texture->texture){
+            residentBytes += texture->texture->getMemorySize();
+        }
+    }
+}
+
+void TextureStreamer::collectPrepared(){
+    for(auto& [key, texture] : textures){
+        if(texture->prepared || !texture->preparing.valid()
+            || texture->preparing.wait_for(std::chrono::seconds(0)) != std::future_status::ready){
+            continue;
+        }
+        try{
+            texture->source = texture->preparing.get();
+            texture->prepared = true;
+            texture->residentMip = texture->getMipCount();
+            texture->wantedMip = texture->targetMip = texture->baseMip();
+        }
+        catch(const std::exception& e){
+            texture->error = e.what();
+            std::cout << "Failed to load " << texture->path << " : " << e.what() << "\n";
+        }
+    }
+}
+
+void TextureStreamer::retireUploads(bool block){
+    for(size_t i = 0; i < uploads.size();){
+        upload& pending = uploads[i];
+        if(block){
+            pending.batch->wait();
+        }
+        if(!pending.batch->isComplete()){
+            i++;
+            continue;
+        }
+        for(auto& [texture, image] : pending.textures){
+            if(texture->texture){
+                retired.push_back({std::move(texture->texture), frame});
+            }
+            texture->residentMip = image->getFirstMip();
+            texture->texture = std::move(image);
+            texture->uploading = false;
+        }
+        uploads.erase(uploads.begin() + i);
+    }
+}
+
+void TextureStreamer::measureScreenSize(const std::vector<GameObject>& gameObjects, const Camera& camera, float viewportHeight){
+    for(auto& [key, texture] : textures){
+        texture->screenPixels = 0.0f;
+    }
+    //  projection[1][1] = 1/tan(fov/2) -> size at depth 1 in NDC, NDC spans 2 units of screen height
+    const float projectionScale = camera.GetProjection()[1][1] * 0.5f;
+    for(const auto& gameObject : gameObjects){
+        if(gameObject.textures.empty() || !gameObject.model){
+            continue;
+        }
+        const Model::boundingVolume& bounds = gameObject.getWorldBounds();
+        float radius = bounds.radius;
+        float depth = (camera.GetView() * glm::vec4(bounds.center, 1.0f)).z;
+        if(depth < -radius){
+            continue;   //  behind the camera
+        }
+        //  camera inside/next to the bounds -> treat as filling the screen instead of dividing by ~0
+        float pixels = 2.0f * radius * projectionScale * viewportHeight / glm::max(depth, radius);
+        for(const auto& texture : gameObject.textures){
+            if(texture){
+                texture->screenPixels = glm::max(texture->screenPixels, pixels);
+            }
+        }
+    }
+
+    for(auto& [key, texture] : textures){
+        if(!texture->prepared){
+            continue;
+        }
+        const Texture::mipLevel& top = texture->source.levels[0];
+        uint32_t base = texture->baseMip();
+        uint32_t wanted = base;
+        if(texture->screenPixels > 0.0f){
+            //  one texel per pixel when the texture spans the object once
+            float level = std::log2(std::max(top.width, top.height) / texture->screenPixels) + mipBias;
+            wanted = static_cast<uint32_t>(std::clamp(std::floor(level), 0.0f, static_cast<float>(base)));
+        }
+        texture->wantedMip = wanted;
+    }
+}
+
+void TextureStreamer::fitBudget(){
+    uint64_t total = 0;
+    for(auto& [key, texture] : textures){
+        if(!texture->prepared){
+            continue;
+        }
+        texture->targetMip = texture->wantedMip;
+        total += texture->bytesFrom(texture->targetMip);
+    }
+    //  over budget : drop a level from the texture with the most texels per screen pixel, base levels always stay
+    while(total > gpuBudget){
+        StreamedTexture* victim = nullptr;
+        float worst = 0.0f;
+        for(auto& [key, texture] : textures){
+            if(!texture->prepared || texture->targetMip >= texture->baseMip()){
+                continue;
+            }
+            const Texture::mipLevel& level = texture->source.levels[texture->targetMip];
+            float oversampling = std::max(level.width, level.height) / std::max(texture->screenPixels, 1.0f);
+            if(victim == nullptr || oversampling > worst){
+                victim = texture.get();
+                worst = oversampling;
+            }
+        }
+        if(victim == nullptr){
+            break;
+        }
+        total -= victim->bytesFrom(victim->targetMip) - victim->bytesFrom(victim->targetMip + 1);
+        victim->targetMip++;
+    }
+}
+
+void TextureStreamer::scheduleUploads(){
+    if(uploads.size() >= MAX_UPLOADS_IN_FLIGHT){
+        return;
+    }
+    std::vector<std::shared_ptr<StreamedTexture>> candidates{};
+    for(auto& [key, texture] : textures){
+        if(texture->prepared && !texture->uploading && texture->targetMip != texture->residentMip){
+            candidates.push_back(texture);
+        }
+    }
+    if(candidates.empty()){
+        return;
+    }
+    //  first arrivals, then drops(free memory, tiny uploads), then raises most undersampled first
+    auto rank = [](const StreamedTexture& texture){
+        if(texture.residentMip == texture.getMipCount()){
+            return 0;
+        }
+        return texture.targetMip > texture.residentMip ? 1 : 2;
+    };
+    auto undersampling = [](const StreamedTexture& texture){
+        const Texture::mipLevel& level = texture.source.levels[texture.residentMip];
+        return std::max(level.width, level.height) / std::max(texture.screenPixels, 1.0f);
+    };
+    std::sort(candidates.begin(), candidates.end(), [&](const auto& a, const auto& b){
+        int rankA = rank(*a), rankB = rank(*b);
+        if(rankA != rankB){
+            return rankA < rankB;
+        }
+        return rankA == 2 && undersampling(*a) < undersampling(*b);
+    });
+
+    upload pending{};
+    pending.batch = std::make_unique<UploadBatch>(device);
+    VkDeviceSize remaining = uploadBytesPerFrame;
+    for(auto& texture : candidates){
+        uint32_t mip;
+        if(texture->residentMip == texture->getMipCount()){
+            mip = texture->baseMip();   //  low levels first, detail follows through the normal path
+        }
+        else if(texture->targetMip > texture->residentMip){
+            mip = texture->targetMip;
+        }
+        else{
+            //  as many levels up as this frame's upload budget allows, at least one
+            mip = texture->residentMip - 1;
+            while(mip > texture->targetMip && texture->bytesFrom(mip - 1) <= remaining){
+                mip--;
+            }
+        }
+        VkDeviceSize bytes = texture->bytesFrom(mip);
+        //  a single step larger than the budget still goes through when it is the only upload this frame
+        if(bytes > remaining && !pending.textures.empty()){
+            continue;
+        }
+        try{
+            auto image = std::make_shared<Texture>(device, texture->source, *pending.batch, mip);
+            pending.textures.push_back({texture, std::move(image)});
+        }
+        catch(const std::exception& e){
+            texture->error = e.what();
+            texture->prepared = false;
+            std::cout << "Failed to stream " << texture->path << " : " << e.what() << "\n";
+            continue;
+        }
+        texture->uploading = true;
+        uploadedLastFrame += bytes;
+        remaining -= std::min(bytes, remaining);
+        if(remaining == 0){
+            break;
+        }
+    }
+    if(pending.textures.empty()){
+        return;
+    }
+    pending.batch->submit();
+    uploads.push_back(std::move(pending));
+}
+
+}   //  namespace VULKVULK
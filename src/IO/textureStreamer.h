@@ -0,0 +1,129 @@
+#ifndef TEXTURE_STREAMER_H
+#define TEXTURE_STREAMER_H
+
+#include "../Render/texture.h"
+#include "../Render/uploadBatch.h"
+#include "../Render/camera.h"
+#include "../GameAsset/gameObject.h"
+#include "../Core/threadPool.h"
+
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace VULKVULK{
+
+//  Texture whose GPU image only holds the mip levels its users need right now
+//  get() returns the image currently resident(nullptr until the base levels arrived), the image gets swapped
+//  by TextureStreamer::update whenever more or fewer levels become resident -> fetch it again every frame
+class StreamedTexture{
+public:
+    const std::string& getPath() const { return path; }
+    bool isReady() const { return texture != nullptr; }
+    bool hasFailed() const { return !error.empty(); }
+    const std::string& getError() const { return error; }
+    std::shared_ptr<Texture> get() const { return texture; }
+
+    //  levels of the full chain, 0 until the source is prepared
+    uint32_t getMipCount() const { return static_cast<uint32_t>(source.levels.size()); }
+    //  largest level on the GPU, getMipCount() while nothing is resident
+    uint32_t getResidentMip() const { return residentMip; }
+    //  level the streamer is moving towards(screen size + budget)
+    uint32_t getTargetMip() const { return targetMip; }
+
+private:
+    friend class TextureStreamer;
+
+    //  level of the source that is uploaded in one piece when the texture first arrives
+    uint32_t baseMip() const;
+    //  GPU bytes of levels [mip, last], from the source level sizes
+    uint64_t bytesFrom(uint32_t mip) const;
+
+    std::string path{};
+    std::string error{};
+    std::future<Texture::preparedTexture> preparing{};
+    //  whole chain stays on the CPU(mapped cache file after the first run) -> levels are re-uploaded from here
+    Texture::preparedTexture source{};
+    bool prepared = false;
+
+    std::shared_ptr<Texture> texture{};
+    uint32_t residentMip = 0;
+    uint32_t wantedMip = 0;             //  from screen size only
+    uint32_t targetMip = 0;             //  wanted after the budget
+    float screenPixels = 0.0f;          //  largest projected size of any user this frame
+    bool uploading = false;             //  one image change in flight at a time
+};
+
+//  Streams texture mip levels in and out of GPU memory
+//  Every frame : projected size of the GameObjects using a texture -> level it needs, the sum of needed levels is
+//  fit into the GPU budget by dropping levels of the most oversampled textures first, then changes are uploaded
+//  least detailed first, limited to uploadBytesPerFrame per frame and never waiting on the GPU
+//  Vulkan images can not grow or shrink -> a change creates an image with the new level range and uploads all of its
+//  levels, the old one is kept until no frame in flight can use it anymore
+class TextureStreamer{
+public:
+    static constexpr VkDeviceSize DEFAULT_GPU_BUDGET = VkDeviceSize(128) << 20;
+    static constexpr VkDeviceSize DEFAULT_UPLOAD_BYTES_PER_FRAME = VkDeviceSize(4) << 20;
+    //  levels up to this size are uploaded as soon as the texture is prepared and are never dropped
+    static constexpr uint32_t BASE_MIP_SIZE = 64;
+    static constexpr size_t MAX_UPLOADS_IN_FLIGHT = 2;
+
+    explicit TextureStreamer(Device& device, ThreadPool& pool = ThreadPool::shared(), VkDeviceSize gpuBudget = DEFAULT_GPU_BUDGET);
+    //  waits for submitted uploads, prepare jobs still running finish on their own and get dropped
+    ~TextureStreamer();
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    //  same path + options -> same texture, released once nothing but the streamer holds it
+    std::shared_ptr<StreamedTexture> acquire(const std::string& filepath, const TextureLoadOptions& options = TextureLoadOptions{});
+
+    //  Main thread, once per frame before recording : "viewportHeight" in pixels
+    void update(const std::vector<GameObject>& gameObjects, const Camera& camera, float viewportHeight);
+
+    void setGpuBudget(VkDeviceSize budget) { gpuBudget = budget; }
+    VkDeviceSize getGpuBudget() const { return gpuBudget; }
+    void setUploadBytesPerFrame(VkDeviceSize bytes) { uploadBytesPerFrame = bytes; }
+    //  > 0 picks smaller levels than the screen asks for
+    void setMipBias(float bias) { mipBias = bias; }
+
+    //  images currently used by textures, images waiting for retirement not included
+    VkDeviceSize getResidentBytes() const { return residentBytes; }
+    VkDeviceSize getUploadedBytesLastFrame() const { return uploadedLastFrame; }
+    size_t getUploadsInFlight() const { return uploads.size(); }
+
+private:
+    struct upload{
+        std::unique_ptr<UploadBatch> batch;
+        std::vector<std::pair<std::shared_ptr<StreamedTexture>, std::shared_ptr<Texture>>> textures;
+    };
+    struct retiredImage{
+        std::shared_ptr<Texture> texture;
+        uint64_t frame;
+    };
+
+    void collectPrepared();
+    void retireUploads(bool block);
+    void measureScreenSize(const std::vector<GameObject>& gameObjects, const Camera& camera, float viewportHeight);
+    void fitBudget();
+    void scheduleUploads();
+
+    Device& device;
+    ThreadPool& pool;
+    VkDeviceSize gpuBudget;
+    VkDeviceSize uploadBytesPerFrame = DEFAULT_UPLOAD_BYTES_PER_FRAME;
+    float mipBias = 0.0f;
+
+    std::unordered_map<std::string, std::shared_ptr<StreamedTexture>> textures{};
+    std::vector<upload> uploads{};
+    std::vector<retiredImage> retired{};
+    uint64_t frame = 0;
+    VkDeviceSize residentBytes = 0;
+    VkDeviceSize uploadedLastFrame = 0;
+};
+
+}   //  namespace VULKVULK
+
+#endif
@@ -0,0 +1,352 @@
+#include "worldStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <functional>
+
+namespace VULKVULK{
+
+namespace{
+
+//  far outside any world we stream, keeps the float -> int conversion defined
+constexpr float MAX_CELL_COORDINATE = float(1 << 30);
+
+int32_t cellCoordinate(float value, float cellSize){
+    return static_cast<int32_t>(std::clamp(std::floor(value / cellSize), -MAX_CELL_COORDINATE, MAX_CELL_COORDINATE));
+}
+
+}   //  namespace
+
+WorldStreamer::WorldStreamer(ModelRegistry& registry, TextureStreamer* textures) : WorldStreamer(registry, settings{}, textures){
+}
+
+WorldStreamer::WorldStreamer(ModelRegistry& registry, const settings& config, TextureStreamer* textures)
+    : registry(registry), textureStreamer(textures){
+    setSettings(config);
+}
+
+void WorldStreamer::setSettings(const settings& value){
+    config = value;
+    config.cellSize = std::max(config.cellSize, 1e-3f);
+    config.loadRadius = std::max(config.loadRadius, 0.0f);
+    config.unloadRadius = std::max(config.unloadRadius, config.loadRadius);
+    config.maxLoadsInFlight = std::max(config.maxLoadsInFlight, 1u);
+}
+
+uint64_t WorldStreamer::cellKey(int32_t x, int32_t z){
+    return (uint64_t(uint32_t(x)) << 32) | uint32_t(z);
+}
+
+float WorldStreamer::cellDistance(const cell& target, const glm::vec3& position) const{
+    //  XZ distance to the cell's square, 0 inside
+    const float minX = float(target.x) * gridCellSize;
+    const float minZ = float(target.z) * gridCellSize;
+    const float dx = std::max(std::max(minX - position.x, position.x - (minX + gridCellSize)), 0.0f);
+    const float dz = std::max(std::max(minZ - position.z, position.z - (minZ + gridCellSize)), 0.0f);
+    return std::sqrt(dx * dx + dz * dz);
+}
+
+bool WorldStreamer::isPending(uint32_t model) const{
+    const ModelHandle& handle = modelSlots[model].handle;
+    return handle.isValid() && !handle.isResident() && !handle.hasFailed();
+}
+
+bool WorldStreamer::load(const std::string& scenePath, std::string& error){
+    //  releases through unload -> loads still running move to abandonedLoads and keep counting
+    for(uint32_t cellIndex : activeCells){
+        unload(cellIndex);
+    }
+    objects.clear();
+    owners.clear();
+    cells.clear();
+    cellLookup.clear();
+    modelSlots.clear();
+    activeCells.clear();
+    loadedCells = 0;
+    loadingCells = 0;
+    droppedObjects = 0;
+    if(!scene.load(scenePath, error)){
+        return false;
+    }
+    gridCellSize = config.cellSize;
+    const uint32_t modelCount = scene.getModelCount();
+    modelSlots.resize(modelCount);
+    modelAccepted.assign(modelCount, 0);
+
+    const glm::vec3* translations = scene.getTranslations();
+    for(uint32_t i = 0; i < scene.getObjectCount(); i++){
+        const int32_t x = cellCoordinate(translations[i].x, gridCellSize);
+        const int32_t z = cellCoordinate(translations[i].z, gridCellSize);
+        auto [found, inserted] = cellLookup.emplace(cellKey(x, z), static_cast<uint32_t>(cells.size()));
+        if(inserted){
+            cell& created = cells.emplace_back();
+            created.x = x;
+            created.z = z;
+        }
+        cells[found->second].sceneObjects.push_back(i);
+    }
+
+    //  model dependencies of every cell, most used first -> the budget keeps what covers the most objects
+    const uint32_t* modelIndices = scene.getModelIndices();
+    std::vector<uint32_t> counts(modelCount, 0);
+    std::vector<uint32_t> used{};
+    for(cell& target : cells){
+        for(uint32_t object : target.sceneObjects){
+            const uint32_t model = modelIndices[object];
+            if(model < modelCount && counts[model]++ == 0){
+                used.push_back(model);
+            }
+        }
+        for(uint32_t model : used){
+            target.models.push_back({model, counts[model], false, false});
+            counts[model] = 0;
+        }
+        used.clear();
+        std::sort(target.models.begin(), target.models.end(), [](const modelUse& a, const modelUse& b){
+            return a.objectCount != b.objectCount ? a.objectCount > b.objectCount : a.model < b.model;
+        });
+    }
+    return true;
+}
+
+void WorldStreamer::update(const glm::vec3& cameraPosition){
+    //  1. out of the unload radius
+    for(size_t i = 0; i < activeCells.size();){
+        if(cellDistance(cells[activeCells[i]], cameraPosition) > config.unloadRadius){
+            unload(activeCells[i]);
+            activeCells[i] = activeCells.back();
+            activeCells.pop_back();
+        }
+        else{
+            i++;
+        }
+    }
+
+    //  2. into the load radius, only the cells around the camera are looked at
+    auto request = [&](uint32_t cellIndex){
+        cell& target = cells[cellIndex];
+        if(target.state == CellState::UNLOADED && cellDistance(target, cameraPosition) <= config.loadRadius){
+            target.state = CellState::LOADING;
+            loadingCells++;
+            activeCells.push_back(cellIndex);
+        }
+    };
+    const double reach = std::ceil(double(config.loadRadius) / gridCellSize);
+    if((2.0 * reach + 1.0) * (2.0 * reach + 1.0) >= double(cells.size())){
+        for(uint32_t i = 0; i < cells.size(); i++){
+            request(i);
+        }
+    }
+    else{
+        const int64_t centerX = cellCoordinate(cameraPosition.x, gridCellSize);
+        const int64_t centerZ = cellCoordinate(cameraPosition.z, gridCellSize);
+        const int64_t span = static_cast<int64_t>(reach);
+        for(int64_t z = centerZ - span; z <= centerZ + span; z++){
+            for(int64_t x = centerX - span; x <= centerX + span; x++){
+                auto found = cellLookup.find(cellKey(static_cast<int32_t>(x), static_cast<int32_t>(z)));
+                if(found != cellLookup.end()){
+                    request(found->second);
+                }
+            }
+        }
+    }
+
+    //  3. loads still running, including the ones of cells that unloaded meanwhile
+    abandonedLoads.erase(std::remove_if(abandonedLoads.begin(), abandonedLoads.end(), [](const ModelHandle& handle){
+        return handle.isResident() || handle.hasFailed();
+    }), abandonedLoads.end());
+    loadsInFlight = static_cast<uint32_t>(abandonedLoads.size());
+    for(uint32_t model = 0; model < modelSlots.size(); model++){
+        loadsInFlight += isPending(model) ? 1 : 0;
+    }
+
+    //  4. nearest loading cell gets the free loads first
+    candidates.clear();
+    for(uint32_t cellIndex : activeCells){
+        if(cells[cellIndex].state == CellState::LOADING){
+            candidates.push_back({cellDistance(cells[cellIndex], cameraPosition), cellIndex});
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    for(const auto& [distance, cellIndex] : candidates){
+        advance(cellIndex);
+    }
+}
+
+void WorldStreamer::acquireModel(uint32_t model){
+    modelSlot& slot = modelSlots[model];
+    if(slot.users++ == 0){
+        const uint32_t flags = scene.getModelFlags(model);
+        slot.handle = registry.acquire(std::string(scene.getModelPath(model)), SceneFile::loadOptions(flags));
+    }
+}
+
+void WorldStreamer::releaseModel(uint32_t model){
+    modelSlot& slot = modelSlots[model];
+    if(--slot.users > 0){
+        return;
+    }
+    //  the load can not be cancelled -> it keeps counting against maxLoadsInFlight until it is done
+    if(isPending(model)){
+        abandonedLoads.push_back(std::move(slot.handle));
+    }
+    slot.handle = ModelHandle{};
+    slot.textures.clear();
+}
+
+void WorldStreamer::acquireTextures(uint32_t model){
+    modelSlot& slot = modelSlots[model];
+    if(textureStreamer == nullptr || !slot.textures.empty()){
+        return;
+    }
+    const std::shared_ptr<Model> resident = slot.handle.get();
+    const std::filesystem::path directory = std::filesystem::path(scene.getModelPath(model)).parent_path();
+    slot.textures.resize(resident->getMaterialCount());
+    for(uint32_t i = 0; i < resident->getMaterialCount(); i++){
+        const char* diffuseTexture = resident->getMaterial(i).diffuseTexture;
+        if(diffuseTexture[0] != '\0'){
+            slot.textures[i] = textureStreamer->acquire((directory / diffuseTexture).generic_string());
+        }
+    }
+}
+
+void WorldStreamer::advance(uint32_t cellIndex){
+    cell& target = cells[cellIndex];
+    //  models already loaded for another cell cost no load -> only new loads wait for a free one
+    for(size_t i = target.decided; i < target.models.size(); i++){
+        modelUse& use = target.models[i];
+        if(use.acquired){
+            continue;
+        }
+        if(modelSlots[use.model].users == 0 && loadsInFlight >= config.maxLoadsInFlight){
+            continue;
+        }
+        const bool loading = modelSlots[use.model].users == 0;
+        acquireModel(use.model);
+        use.acquired = true;
+        if(loading && isPending(use.model)){
+            loadsInFlight++;
+        }
+    }
+
+    //  decided in the cell's order -> which models fit the budget does not depend on the order loads finish in
+    while(target.decided < target.models.size()){
+        modelUse& use = target.models[target.decided];
+        if(!use.acquired || isPending(use.model)){
+            return;
+        }
+        const ModelHandle& handle = modelSlots[use.model].handle;
+        if(handle.isResident()){
+            const std::shared_ptr<Model> model = handle.get();
+            const VkDeviceSize bytes = model->getGpuMemorySize();
+            if(target.gpuBytes + bytes <= config.maxCellGpuBytes){
+                use.accepted = true;
+                target.gpuBytes += bytes;
+                acquireTextures(use.model);
+            }
+        }
+        if(!use.accepted){
+            releaseModel(use.model);
+            use.acquired = false;
+        }
+        target.decided++;
+    }
+    instantiate(cellIndex);
+}
+
+void WorldStreamer::instantiate(uint32_t cellIndex){
+    cell& target = cells[cellIndex];
+    for(const modelUse& use : target.models){
+        modelAccepted[use.model] = use.accepted ? 1 : 0;
+    }
+    //  objects without a model always come along, objects of dropped models never do
+    const uint32_t* modelIndices = scene.getModelIndices();
+    auto keeps = [&](uint32_t object){
+        return modelIndices[object] >= modelAccepted.size() || modelAccepted[modelIndices[object]] != 0;
+    };
+    const size_t count = static_cast<size_t>(std::count_if(target.sceneObjects.begin(), target.sceneObjects.end(), keeps));
+
+    const glm::vec3* translations = scene.getTranslations();
+    const glm::vec3* rotations = scene.getRotations();
+    const glm::vec3* scales = scene.getScales();
+    const glm::vec3* colors = scene.getColors();
+    size_t next = objects.size();
+    GameObject::createGameObjects(count, objects);
+    owners.reserve(objects.size());
+    target.slots.reserve(count);
+    for(uint32_t object : target.sceneObjects){
+        if(!keeps(object)){
+            continue;
+        }
+        GameObject& created = objects[next];
+        created.transform.translation = translations[object];
+        created.transform.rotation = rotations[object];
+        created.transform.scale = scales[object];
+        created.color = colors[object];
+        //  accepted models are resident already -> drawable from this frame on
+        if(modelIndices[object] < modelAccepted.size()){
+            created.model = modelSlots[modelIndices[object]].handle.get();
+            created.textures = modelSlots[modelIndices[object]].textures;
+        }
+        owners.push_back({cellIndex, static_cast<uint32_t>(target.slots.size())});
+        target.slots.push_back(static_cast<uint32_t>(next));
+        next++;
+    }
+    for(const modelUse& use : target.models){
+        modelAccepted[use.model] = 0;
+    }
+
+    target.droppedObjects = static_cast<uint32_t>(target.sceneObjects.size() - count);
+    droppedObjects += target.droppedObjects;
+    target.state = CellState::LOADED;
+    loadingCells--;
+    loadedCells++;
+}
+
+void WorldStreamer::unload(uint32_t cellIndex){
+    cell& target = cells[cellIndex];
+    if(target.state == CellState::LOADED){
+        //  swap with the last object, highest slot first -> the object moving in never belongs to this cell
+        std::sort(target.slots.begin(), target.slots.end(), std::greater<uint32_t>{});
+        for(uint32_t slot : target.slots){
+            const size_t last = objects.size() - 1;
+            if(slot != last){
+                objects[slot] = std::move(objects[last]);
+                owners[slot] = owners[last];
+                cells[owners[slot].first].slots[owners[slot].second] = slot;
+            }
+            objects.pop_back();
+            owners.pop_back();
+        }
+        target.slots.clear();
+        droppedObjects -= target.droppedObjects;
+        target.droppedObjects = 0;
+        loadedCells--;
+    }
+    else if(target.state == CellState::LOADING){
+        loadingCells--;
+    }
+    for(modelUse& use : target.models){
+        if(use.acquired){
+            releaseModel(use.model);
+        }
+        use.acquired = false;
+        use.accepted = false;
+    }
+    target.decided = 0;
+    target.gpuBytes = 0;
+    target.state = CellState::UNLOADED;
+}
+
+VkDeviceSize WorldStreamer::getLargestCellGpuBytes() const{
+    VkDeviceSize largest = 0;
+    for(uint32_t cellIndex : activeCells){
+        if(cells[cellIndex].state == CellState::LOADED){
+            largest = std::max(largest, cells[cellIndex].gpuBytes);
+        }
+    }
+    return largest;
+}
+
+}   //  namespace VULKVULK
@@ -0,0 +1,142 @@
+#ifndef WORLD_STREAMER_H
+#define WORLD_STREAMER_H
+
+#include "sceneFile.h"
+#include "textureStreamer.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace VULKVULK{
+
+//  Streams a scene in and out around the camera, cell by cell
+//
+//  The scene is split into square cells on the XZ plane(by object translation), every cell keeps its object list and
+//  the models those objects use. Every update :
+//  1. loaded/loading cells farther than unloadRadius go away(objects removed, model references released)
+//  2. unloaded cells closer than loadRadius start loading, nearest first -> the gap between the radii is the hysteresis
+//     that keeps a camera on a cell border from loading and unloading the same cell every frame
+//  3. loading cells ask ModelRegistry for their models, nearest cell first, most used model first, never more than
+//     maxLoadsInFlight models loading at once
+//  4. a cell whose models all arrived gets its objects instantiated into getObjects()
+//
+//  Material textures : once a model is accepted its map_Kd textures are acquired from the TextureStreamer(when there is one)
+//  and handed to its objects through GameObject::textures, released together with the model
+//
+//  GPU memory per cell : models are accepted in the cell's order until their memory would pass maxCellGpuBytes,
+//  objects of a model that did not fit are left out of the cell(getDroppedObjectCount)
+//  models shared by cells count for each of them, ModelRegistry evicts models no cell holds anymore once over its budget
+class WorldStreamer{
+public:
+    struct settings{
+        float cellSize = 16.0f;                         //  world units, edge of a cell
+        float loadRadius = 48.0f;                       //  cells closer than this(XZ distance to their square) load
+        float unloadRadius = 64.0f;                     //  loaded cells farther than this unload, >= loadRadius
+        uint32_t maxLoadsInFlight = 4;                  //  models being read/processed/uploaded at once
+        VkDeviceSize maxCellGpuBytes = VkDeviceSize(64) << 20;  //  Model::getGpuMemorySize of a cell's models
+    };
+    enum class CellState : uint8_t{
+        UNLOADED,
+        LOADING,        //  waiting for its models
+        LOADED,         //  objects are in getObjects()
+    };
+
+    //  "textures" nullptr -> objects come without textures
+    explicit WorldStreamer(ModelRegistry& registry, TextureStreamer* textures = nullptr);
+    WorldStreamer(ModelRegistry& registry, const settings& config, TextureStreamer* textures = nullptr);
+
+    WorldStreamer(const WorldStreamer&) = delete;
+    WorldStreamer& operator=(const WorldStreamer&) = delete;
+
+    //  Loads the scene(see SceneFile::load) and sorts its objects into cells of settings::cellSize,
+    //  drops everything the previous scene streamed in, nothing is streamed in before update()
+    bool load(const std::string& scenePath, std::string& error);
+    //  Main thread, once per frame after ModelRegistry::update
+    void update(const glm::vec3& cameraPosition);
+
+    //  objects of every loaded cell -> order changes whenever a cell unloads
+    std::vector<GameObject>& getObjects() { return objects; }
+    const std::vector<GameObject>& getObjects() const { return objects; }
+
+    void setSettings(const settings& config);
+    const settings& getSettings() const { return config; }
+
+    size_t getCellCount() const { return cells.size(); }
+    size_t getLoadedCellCount() const { return loadedCells; }
+    size_t getLoadingCellCount() const { return loadingCells; }
+    uint32_t getLoadsInFlight() const { return loadsInFlight; }
+    //  objects left out of loaded cells because their model broke the cell budget or failed to load
+    size_t getDroppedObjectCount() const { return droppedObjects; }
+    //  largest GPU memory held by one loaded cell
+    VkDeviceSize getLargestCellGpuBytes() const;
+
+private:
+    //  one model of a cell and how many of the cell's objects use it
+    struct modelUse{
+        uint32_t model;
+        uint32_t objectCount;
+        bool acquired;          //  holds a reference on modelSlots[model]
+        bool accepted;          //  decided and within budget -> its objects get instantiated
+    };
+    struct cell{
+        int32_t x;
+        int32_t z;
+        CellState state = CellState::UNLOADED;
+        std::vector<uint32_t> sceneObjects{};   //  indices into the scene arrays
+        std::vector<modelUse> models{};         //  most used first
+        uint32_t decided = 0;                   //  models[0, decided) are accepted or dropped
+        VkDeviceSize gpuBytes = 0;              //  accepted models
+        uint32_t droppedObjects = 0;            //  LOADED : objects left out
+        std::vector<uint32_t> slots{};          //  LOADED : positions of its objects in "objects"
+    };
+    //  scene model shared by every cell using it
+    struct modelSlot{
+        ModelHandle handle{};
+        uint32_t users = 0;     //  cells holding a reference
+        //  per material of the model once it was accepted, see GameObject::textures
+        std::vector<std::shared_ptr<StreamedTexture>> textures{};
+    };
+
+    static uint64_t cellKey(int32_t x, int32_t z);
+    float cellDistance(const cell& target, const glm::vec3& position) const;
+    //  true while the model can not be decided yet
+    bool isPending(uint32_t model) const;
+
+    void acquireModel(uint32_t model);
+    void releaseModel(uint32_t model);
+    //  map_Kd of every material of a resident model, paths relative to the model's file
+    void acquireTextures(uint32_t model);
+    //  acquires in order while loads are available, decides what arrived, instantiates once everything is decided
+    void advance(uint32_t cellIndex);
+    void instantiate(uint32_t cellIndex);
+    void unload(uint32_t cellIndex);
+
+    ModelRegistry& registry;
+    TextureStreamer* textureStreamer;
+    settings config;
+    SceneFile scene{};
+    float gridCellSize = 1.0f;              //  cellSize the cells were built with
+
+    std::vector<cell> cells{};
+    std::unordered_map<uint64_t, uint32_t> cellLookup{};
+    std::vector<modelSlot> modelSlots{};
+    //  loads nobody waits for anymore(their cell unloaded) -> still count as in flight until they are done
+    std::vector<ModelHandle> abandonedLoads{};
+    std::vector<uint8_t> modelAccepted{};   //  scratch of instantiate, per scene model
+
+    std::vector<GameObject> objects{};
+    std::vector<std::pair<uint32_t, uint32_t>> owners{};   //  per object : (cell, index into the cell's slots)
+
+    std::vector<uint32_t> activeCells{};    //  LOADING or LOADED
+    std::vector<std::pair<float, uint32_t>> candidates{};  //  (distance, cell), kept between frames
+    size_t loadedCells = 0;
+    size_t loadingCells = 0;
+    uint32_t loadsInFlight = 0;
+    size_t droppedObjects = 0;
+};
+
+}   //  namespace VULKVULK
+
+#endif
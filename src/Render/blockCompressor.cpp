@@ -0,0 +1,455 @@
+#include "blockCompressor.h"
+#include "../Core/threadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace VULKVULK{
+
+namespace{
+
+//  BC7 4 bit index interpolation weights(out of 64), fixed by the format
+constexpr uint32_t BC7_WEIGHTS[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+//  BC1 4 color mode : index -> weight of endpoint 0 in thirds
+constexpr float BC1_WEIGHTS[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+
+//  mean and dominant direction of the block's colors, power iteration on the covariance matrix
+void principalAxis(const uint8_t block[64], int channels, float mean[4], float axis[4]){
+    for(int c = 0; c < 4; c++){
+        mean[c] = 0.0f;
+        axis[c] = 0.0f;
+    }
+    for(int i = 0; i < 16; i++){
+        for(int c = 0; c < channels; c++){
+            mean[c] += block[i * 4 + c];
+        }
+    }
+    for(int c = 0; c < channels; c++){
+        mean[c] /= 16.0f;
+    }
+    float cov[4][4] = {};
+    for(int i = 0; i < 16; i++){
+        float d[4];
+        for(int c = 0; c < channels; c++){
+            d[c] = block[i * 4 + c] - mean[c];
+        }
+        for(int a = 0; a < channels; a++){
+            for(int b = 0; b < channels; b++){
+                cov[a][b] += d[a] * d[b];
+            }
+        }
+    }
+    float v[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    for(int iteration = 0; iteration < 8; iteration++){
+        float next[4] = {};
+        for(int a = 0; a < channels; a++){
+            for(int b = 0; b < channels; b++){
+                next[a] += cov[a][b] * v[b];
+            }
+        }
+        float length = 0.0f;
+        for(int c = 0; c < channels; c++){
+            length += next[c] * next[c];
+        }
+        if(length < 1e-12f){
+            //  flat block -> any axis works, endpoints collapse onto the mean
+            return;
+        }
+        length = 1.0f / std::sqrt(length);
+        for(int c = 0; c < channels; c++){
+            v[c] = next[c] * length;
+        }
+    }
+    for(int c = 0; c < channels; c++){
+        axis[c] = v[c];
+    }
+}
+
+//  endpoints = extremes of the block projected on its principal axis
+void axisEndpoints(const uint8_t block[64], int channels, float e0[4], float e1[4]){
+    float mean[4], axis[4];
+    principalAxis(block, channels, mean, axis);
+    float low = 0.0f, high = 0.0f;
+    for(int i = 0; i < 16; i++){
+        float t = 0.0f;
+        for(int c = 0; c < channels; c++){
+            t += (block[i * 4 + c] - mean[c]) * axis[c];
+        }
+        low = std::min(low, t);
+        high = std::max(high, t);
+    }
+    for(int c = 0; c < 4; c++){
+        e0[c] = std::clamp(mean[c] + axis[c] * high, 0.0f, 255.0f);
+        e1[c] = std::clamp(mean[c] + axis[c] * low, 0.0f, 255.0f);
+    }
+}
+
+//  solves the 2x2 normal equations for endpoints given each pixel's weight of endpoint 0
+//  returns false if every pixel uses the same weight
+bool leastSquaresEndpoints(const uint8_t block[64], int channels, const float weight0[16], float e0[4], float e1[4]){
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float ax[4] = {}, bx[4] = {};
+    for(int i = 0; i < 16; i++){
+        float a = weight0[i];
+        float b = 1.0f - a;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for(int c = 0; c < channels; c++){
+            ax[c] += a * block[i * 4 + c];
+            bx[c] += b * block[i * 4 + c];
+        }
+    }
+    float det = aa * bb - ab * ab;
+    if(std::abs(det) < 1e-6f){
+        return false;
+    }
+    det = 1.0f / det;
+    for(int c = 0; c < channels; c++){
+        e0[c] = std::clamp((ax[c] * bb - bx[c] * ab) * det, 0.0f, 255.0f);
+        e1[c] = std::clamp((bx[c] * aa - ax[c] * ab) * det, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+uint16_t to565(const float color[4]){
+    uint32_t r = static_cast<uint32_t>(color[0] * (31.0f / 255.0f) + 0.5f);
+    uint32_t g = static_cast<uint32_t>(color[1] * (63.0f / 255.0f) + 0.5f);
+    uint32_t b = static_cast<uint32_t>(color[2] * (31.0f / 255.0f) + 0.5f);
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+void from565(uint16_t packed, int color[3]){
+    int r = (packed >> 11) & 31;
+    int g = (packed >> 5) & 63;
+    int b = packed & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+void bc1Palette(uint16_t c0, uint16_t c1, int palette[4][3]){
+    from565(c0, palette[0]);
+    from565(c1, palette[1]);
+    for(int c = 0; c < 3; c++){
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+}
+
+//  nearest palette entry per pixel, 4 color mode -> returns total squared error
+uint32_t bc1Indices(const uint8_t block[64], uint16_t c0, uint16_t c1, uint8_t indices[16]){
+    int palette[4][3];
+    bc1Palette(c0, c1, palette);
+    uint32_t total = 0;
+    for(int i = 0; i < 16; i++){
+        uint32_t best = UINT32_MAX;
+        for(int p = 0; p < 4; p++){
+            uint32_t error = 0;
+            for(int c = 0; c < 3; c++){
+                int d = block[i * 4 + c] - palette[p][c];
+                error += d * d;
+            }
+            if(error < best){
+                best = error;
+                indices[i] = static_cast<uint8_t>(p);
+            }
+        }
+        total += best;
+    }
+    return total;
+}
+
+void putBits(uint8_t* out, uint32_t& position, uint32_t count, uint32_t value){
+    for(uint32_t i = 0; i < count; i++, position++){
+        if((value >> i) & 1){
+            out[position >> 3] |= static_cast<uint8_t>(1u << (position & 7));
+        }
+    }
+}
+
+uint32_t getBits(const uint8_t* in, uint32_t& position, uint32_t count){
+    uint32_t value = 0;
+    for(uint32_t i = 0; i < count; i++, position++){
+        value |= ((in[position >> 3] >> (position & 7)) & 1u) << i;
+    }
+    return value;
+}
+
+//  BC7 mode 6 endpoint : 7 bits per channel + one p-bit shared by the channels -> 8 bit value (q << 1) | p
+struct bc7Endpoint{
+    uint8_t q[4];
+    uint8_t p;
+
+    int value(int c) const { return (q[c] << 1) | p; }
+};
+
+bc7Endpoint quantizeBC7(const float color[4]){
+    bc7Endpoint best{};
+    float bestError = INFINITY;
+    for(uint8_t p = 0; p < 2; p++){
+        bc7Endpoint candidate{};
+        candidate.p = p;
+        float error = 0.0f;
+        for(int c = 0; c < 4; c++){
+            float q = std::clamp(std::round((color[c] - p) * 0.5f), 0.0f, 127.0f);
+            candidate.q[c] = static_cast<uint8_t>(q);
+            float d = color[c] - candidate.value(c);
+            error += d * d;
+        }
+        if(error < bestError){
+            bestError = error;
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+uint32_t bc7Indices(const uint8_t block[64], const bc7Endpoint& e0, const bc7Endpoint& e1, uint8_t indices[16]){
+    int palette[16][4];
+    for(int w = 0; w < 16; w++){
+        for(int c = 0; c < 4; c++){
+            palette[w][c] = static_cast<int>(((64 - BC7_WEIGHTS[w]) * e0.value(c) + BC7_WEIGHTS[w] * e1.value(c) + 32) >> 6);
+        }
+    }
+    uint32_t total = 0;
+    for(int i = 0; i < 16; i++){
+        uint32_t best = UINT32_MAX;
+        for(int w = 0; w < 16; w++){
+            uint32_t error = 0;
+            for(int c = 0; c < 4; c++){
+                int d = block[i * 4 + c] - palette[w][c];
+                error += d * d;
+            }
+            if(error < best){
+                best = error;
+                indices[i] = static_cast<uint8_t>(w);
+            }
+        }
+        total += best;
+    }
+    return total;
+}
+
+//  4x4 block at block coordinates(bx, by), edge pixels repeated past the image border
+void fetchBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t bx, uint32_t by, uint8_t block[64]){
+    for(uint32_t y = 0; y < 4; y++){
+        uint32_t sy = std::min(by * 4 + y, height - 1);
+        for(uint32_t x = 0; x < 4; x++){
+            uint32_t sx = std::min(bx * 4 + x, width - 1);
+            std::memcpy(block + (y * 4 + x) * 4, rgba + (size_t(sy) * width + sx) * 4, 4);
+        }
+    }
+}
+
+}   //  namespace
+
+size_t BlockCompressor::blockBytes(TextureCompression compression){
+    switch(compression){
+        case TextureCompression::BC1: return 8;
+        case TextureCompression::BC7: return 16;
+        default: return 0;
+    }
+}
+
+size_t BlockCompressor::imageBytes(TextureCompression compression, uint32_t width, uint32_t height){
+    if(compression == TextureCompression::NONE){
+        return size_t(width) * height * 4;
+    }
+    return size_t((width + BLOCK_DIM - 1) / BLOCK_DIM) * ((height + BLOCK_DIM - 1) / BLOCK_DIM) * blockBytes(compression);
+}
+
+void BlockCompressor::encodeBC1(const uint8_t block[64], uint8_t out[8]){
+    float e0[4], e1[4];
+    axisEndpoints(block, 3, e0, e1);
+    uint16_t c0 = to565(e0);
+    uint16_t c1 = to565(e1);
+    uint8_t indices[16];
+    uint32_t error = bc1Indices(block, c0, c1, indices);
+
+    //  one refinement : endpoints that best fit the chosen indices, kept only if they actually help
+    float weight0[16];
+    for(int i = 0; i < 16; i++){
+        weight0[i] = BC1_WEIGHTS[indices[i]];
+    }
+    if(error > 0 && leastSquaresEndpoints(block, 3, weight0, e0, e1)){
+        uint16_t r0 = to565(e0);
+        uint16_t r1 = to565(e1);
+        uint8_t refined[16];
+        uint32_t refinedError = bc1Indices(block, r0, r1, refined);
+        if(refinedError < error){
+            c0 = r0;
+            c1 = r1;
+            std::memcpy(indices, refined, sizeof(indices));
+        }
+    }
+
+    //  c0 > c1 selects 4 color mode -> swapping endpoints mirrors the palette(0 <-> 1, 2 <-> 3)
+    if(c0 < c1){
+        std::swap(c0, c1);
+        for(uint8_t& index : indices){
+            index ^= 1;
+        }
+    }
+    else if(c0 == c1){
+        //  3 color mode, index 0 is the only color we want
+        std::memset(indices, 0, sizeof(indices));
+    }
+    uint32_t packed = 0;
+    for(int i = 0; i < 16; i++){
+        packed |= uint32_t(indices[i]) << (i * 2);
+    }
+    out[0] = static_cast<uint8_t>(c0);
+    out[1] = static_cast<uint8_t>(c0 >> 8);
+    out[2] = static_cast<uint8_t>(c1);
+    out[3] = static_cast<uint8_t>(c1 >> 8);
+    std::memcpy(out + 4, &packed, 4);
+}
+
+void BlockCompressor::decodeBC1(const uint8_t in[8], uint8_t block[64]){
+    uint16_t c0 = static_cast<uint16_t>(in[0] | (in[1] << 8));
+    uint16_t c1 = static_cast<uint16_t>(in[2] | (in[3] << 8));
+    int palette[4][3];
+    bc1Palette(c0, c1, palette);
+    uint8_t alpha[4] = {255, 255, 255, 255};
+    if(c0 <= c1){
+        //  3 color mode : midpoint + transparent black
+        for(int c = 0; c < 3; c++){
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+        alpha[3] = 0;
+    }
+    uint32_t packed;
+    std::memcpy(&packed, in + 4, 4);
+    for(int i = 0; i < 16; i++){
+        uint32_t index = (packed >> (i * 2)) & 3;
+        for(int c = 0; c < 3; c++){
+            block[i * 4 + c] = static_cast<uint8_t>(palette[index][c]);
+        }
+        block[i * 4 + 3] = alpha[index];
+    }
+}
+
+void BlockCompressor::encodeBC7(const uint8_t block[64], uint8_t out[16]){
+    float f0[4], f1[4];
+    axisEndpoints(block, 4, f0, f1);
+    bc7Endpoint e0 = quantizeBC7(f0);
+    bc7Endpoint e1 = quantizeBC7(f1);
+    uint8_t indices[16];
+    uint32_t error = bc7Indices(block, e0, e1, indices);
+
+    float weight0[16];
+    for(int i = 0; i < 16; i++){
+        weight0[i] = (64 - BC7_WEIGHTS[indices[i]]) / 64.0f;
+    }
+    if(error > 0 && leastSquaresEndpoints(block, 4, weight0, f0, f1)){
+        bc7Endpoint r0 = quantizeBC7(f0);
+        bc7Endpoint r1 = quantizeBC7(f1);
+        uint8_t refined[16];
+        uint32_t refinedError = bc7Indices(block, r0, r1, refined);
+        if(refinedError < error){
+            e0 = r0;
+            e1 = r1;
+            std::memcpy(indices, refined, sizeof(indices));
+        }
+    }
+
+    //  anchor(pixel 0) index is stored with its top bit implied 0 -> mirror the block if it is set
+    if(indices[0] & 8){
+        std::swap(e0, e1);
+        for(uint8_t& index : indices){
+            index = static_cast<uint8_t>(15 - index);
+        }
+    }
+
+    std::memset(out, 0, 16);
+    uint32_t position = 0;
+    putBits(out, position, 7, 1u << 6);     //  mode 6
+    for(int c = 0; c < 4; c++){
+        putBits(out, position, 7, e0.q[c]);
+        putBits(out, position, 7, e1.q[c]);
+    }
+    putBits(out, position, 1, e0.p);
+    putBits(out, position, 1, e1.p);
+    putBits(out, position, 3, indices[0]);
+    for(int i = 1; i < 16; i++){
+        putBits(out, position, 4, indices[i]);
+    }
+}
+
+void BlockCompressor::decodeBC7(const uint8_t in[16], uint8_t block[64]){
+    if((in[0] & 0x7F) != 0x40){
+        //  not mode 6 -> decoded as transparent black, same as the spec does for reserved modes
+        std::memset(block, 0, 64);
+        return;
+    }
+    uint32_t position = 7;
+    bc7Endpoint e0{}, e1{};
+    for(int c = 0; c < 4; c++){
+        e0.q[c] = static_cast<uint8_t>(getBits(in, position, 7));
+        e1.q[c] = static_cast<uint8_t>(getBits(in, position, 7));
+    }
+    e0.p = static_cast<uint8_t>(getBits(in, position, 1));
+    e1.p = static_cast<uint8_t>(getBits(in, position, 1));
+    for(int i = 0; i < 16; i++){
+        uint32_t index = getBits(in, position, i == 0 ? 3 : 4);
+        for(int c = 0; c < 4; c++){
+            block[i * 4 + c] = static_cast<uint8_t>(((64 - BC7_WEIGHTS[index]) * e0.value(c) + BC7_WEIGHTS[index] * e1.value(c) + 32) >> 6);
+        }
+    }
+}
+
+std::vector<uint8_t> BlockCompressor::compress(const uint8_t* rgba, uint32_t width, uint32_t height, TextureCompression compression){
+    if(compression == TextureCompression::NONE){
+        return std::vector<uint8_t>(rgba, rgba + size_t(width) * height * 4);
+    }
+    const uint32_t blocksX = (width + BLOCK_DIM - 1) / BLOCK_DIM;
+    const uint32_t blocksY = (height + BLOCK_DIM - 1) / BLOCK_DIM;
+    const size_t bytes = blockBytes(compression);
+    std::vector<uint8_t> out(size_t(blocksX) * blocksY * bytes);
+    ThreadPool::shared().parallelFor(blocksY, [&](size_t by){
+        uint8_t block[64];
+        for(uint32_t bx = 0; bx < blocksX; bx++){
+            fetchBlock(rgba, width, height, bx, static_cast<uint32_t>(by), block);
+            uint8_t* dst = out.data() + (by * blocksX + bx) * bytes;
+            if(compression == TextureCompression::BC1){
+                encodeBC1(block, dst);
+            }
+            else{
+                encodeBC7(block, dst);
+            }
+        }
+    });
+    return out;
+}
+
+std::vector<uint8_t> BlockCompressor::decompress(const uint8_t* blocks, uint32_t width, uint32_t height, TextureCompression compression){
+    if(compression == TextureCompression::NONE){
+        return std::vector<uint8_t>(blocks, blocks + size_t(width) * height * 4);
+    }
+    const uint32_t blocksX = (width + BLOCK_DIM - 1) / BLOCK_DIM;
+    const uint32_t blocksY = (height + BLOCK_DIM - 1) / BLOCK_DIM;
+    const size_t bytes = blockBytes(compression);
+    std::vector<uint8_t> out(size_t(width) * height * 4);
+    ThreadPool::shared().parallelFor(blocksY, [&](size_t by){
+        uint8_t block[64];
+        for(uint32_t bx = 0; bx < blocksX; bx++){
+            const uint8_t* src = blocks + (by * blocksX + bx) * bytes;
+            if(compression == TextureCompression::BC1){
+                decodeBC1(src, block);
+            }
+            else{
+                decodeBC7(src, block);
+            }
+            for(uint32_t y = 0; y < 4 && by * 4 + y < height; y++){
+                uint32_t columns = std::min(4u, width - bx * 4);
+                std::memcpy(out.data() + ((by * 4 + y) * width + bx * 4) * 4, block + y * 16, columns * 4);
+            }
+        }
+    });
+    return out;
+}
+
+}   //  namespace VULKVULK
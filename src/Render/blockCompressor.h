@@ -0,0 +1,41 @@
+#ifndef BLOCK_COMPRESSOR_H
+#define BLOCK_COMPRESSOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace VULKVULK{
+
+enum class TextureCompression : uint32_t{
+    NONE,       //  RGBA8, 4 bytes per pixel
+    BC1,        //  8 bytes per 4x4 block, RGB only(alpha is dropped)
+    BC7,        //  16 bytes per 4x4 block, RGBA
+};
+
+//  CPU encoders for GPU block compression formats
+//  BC1 : principal axis endpoints + one least squares refinement
+//  BC7 : mode 6 only(one RGBA subset, 7.7.7.7 endpoints + p-bit, 4 bit indices) -> good quality for its cost,
+//        decodeBC7 only understands blocks written by encodeBC7
+//  Blocks are 4x4 RGBA8 pixels row by row, images whose size is not a multiple of 4 repeat their edge pixels
+class BlockCompressor{
+public:
+    static constexpr uint32_t BLOCK_DIM = 4;
+
+    static size_t blockBytes(TextureCompression compression);
+    //  bytes of one image of the given size
+    static size_t imageBytes(TextureCompression compression, uint32_t width, uint32_t height);
+
+    static void encodeBC1(const uint8_t block[64], uint8_t out[8]);
+    static void decodeBC1(const uint8_t in[8], uint8_t block[64]);
+    static void encodeBC7(const uint8_t block[64], uint8_t out[16]);
+    static void decodeBC7(const uint8_t in[16], uint8_t block[64]);
+
+    //  whole image, block rows spread over the shared thread pool
+    static std::vector<uint8_t> compress(const uint8_t* rgba, uint32_t width, uint32_t height, TextureCompression compression);
+    static std::vector<uint8_t> decompress(const uint8_t* blocks, uint32_t width, uint32_t height, TextureCompression compression);
+};
+
+}   //  namespace VULKVULK
+
+#endif
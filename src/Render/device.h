@@ -52,6 +52,7 @@ class Device {
   QueueFamilyIndices findPhysicalQueueFamilies() { return findQueueFamilies(physicalDevice); }
   VkFormat findSupportedFormat(
       const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
+  bool isFormatSupported(VkFormat format, VkImageTiling tiling, VkFormatFeatureFlags features);
 
   // Buffer Helper Functions
   void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
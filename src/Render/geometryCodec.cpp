@@ -0,0 +1,675 @@
+#include "geometryCodec.h"
+#include "../Core/threadPool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <queue>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GEOMETRY_CODEC_SSE2 1
+#endif
+
+namespace VULKVULK{
+
+namespace{
+
+constexpr uint32_t MAX_CODE_LENGTH = 11;                    //  -> 2048 entry decode table, stays in L1
+constexpr uint32_t TABLE_SIZE = 1u << MAX_CODE_LENGTH;
+constexpr uint32_t STREAM_COUNT = 4;
+constexpr uint32_t PLANE_COUNT = 4;                         //  bytes of a 32 bit field
+constexpr uint32_t GROUP_FIELDS = 4;                        //  fields decoded together -> one 16 byte store per element
+constexpr size_t PACKED_LENGTHS_SIZE = 128;                 //  256 code lengths, 4 bits each
+constexpr uint32_t VERTEX_FIELDS = sizeof(Model::Vertex) / sizeof(uint32_t);
+static_assert(sizeof(Model::Vertex) % sizeof(uint32_t) == 0, "Vertex has to be made of 32 bit fields");
+static_assert(GeometryCodec::BLOCK_ELEMENTS <= 65536, "sparse planes store 16 bit positions");
+
+enum PlaneMode : uint8_t{
+    PLANE_CONSTANT = 0,     //  [value]
+    PLANE_RAW = 1,          //  [bytes]
+    PLANE_HUFFMAN = 2,      //  [code lengths][stream sizes u32 * 4][streams], stream s holds the s-th quarter
+    PLANE_SPARSE = 3,       //  [value][exception count u32][positions u16 * count][bytes * count], everything else is value
+};
+
+//  [streamHeader][block end offset u64 * blockCount][blocks], offsets from the first block
+struct streamHeader{
+    uint32_t elementCount;
+    uint32_t fields;
+    uint32_t blockCount;
+    uint32_t reserved;
+};
+
+inline uint32_t zigzag(uint32_t value){ return (value << 1) ^ (0u - (value >> 31)); }
+inline uint32_t unzigzag(uint32_t value){ return (value >> 1) ^ (0u - (value & 1u)); }
+
+inline uint32_t reverseBits(uint32_t code, uint32_t length){
+    code = ((code & 0x5555u) << 1) | ((code >> 1) & 0x5555u);
+    code = ((code & 0x3333u) << 2) | ((code >> 2) & 0x3333u);
+    code = ((code & 0x0F0Fu) << 4) | ((code >> 4) & 0x0F0Fu);
+    code = ((code & 0x00FFu) << 8) | ((code >> 8) & 0x00FFu);
+    return code >> (16 - length);
+}
+
+//  Huffman code lengths over "counts"(at least 2 used symbols)
+//  too long codes -> counts get halved(used symbols stay used) until the tree fits, only hit by very skewed planes
+void buildCodeLengths(const uint32_t counts[256], uint8_t lengths[256]){
+    uint64_t scaled[256];
+    std::copy(counts, counts + 256, scaled);
+    for(;;){
+        using entry = std::pair<uint64_t, int32_t>;
+        std::priority_queue<entry, std::vector<entry>, std::greater<entry>> queue;
+        std::vector<int32_t> parents;
+        int32_t leaves[256];
+        for(int32_t symbol = 0; symbol < 256; symbol++){
+            leaves[symbol] = -1;
+            if(scaled[symbol] > 0){
+                leaves[symbol] = static_cast<int32_t>(parents.size());
+                queue.push({scaled[symbol], leaves[symbol]});
+                parents.push_back(-1);
+            }
+        }
+        while(queue.size() > 1){
+            entry a = queue.top();
+            queue.pop();
+            entry b = queue.top();
+            queue.pop();
+            int32_t parent = static_cast<int32_t>(parents.size());
+            parents.push_back(-1);
+            parents[a.second] = parent;
+            parents[b.second] = parent;
+            queue.push({a.first + b.first, parent});
+        }
+        //  parents are created after their children -> one walk down from the root(last node)
+        std::vector<uint32_t> depth(parents.size(), 0);
+        for(int32_t node = static_cast<int32_t>(parents.size()) - 2; node >= 0; node--){
+            depth[node] = depth[parents[node]] + 1;
+        }
+        uint32_t maxLength = 0;
+        for(int32_t symbol = 0; symbol < 256; symbol++){
+            lengths[symbol] = leaves[symbol] < 0 ? 0 : static_cast<uint8_t>(depth[leaves[symbol]]);
+            maxLength = std::max<uint32_t>(maxLength, lengths[symbol]);
+        }
+        if(maxLength <= MAX_CODE_LENGTH){
+            return;
+        }
+        for(uint64_t& count : scaled){
+            count = (count + 1) / 2;
+        }
+    }
+}
+
+//  canonical codes(deflate order), bit reversed since streams are read LSB first
+void buildCodes(const uint8_t lengths[256], uint16_t codes[256]){
+    uint32_t lengthCount[MAX_CODE_LENGTH + 1] = {};
+    for(uint32_t symbol = 0; symbol < 256; symbol++){
+        lengthCount[lengths[symbol]]++;
+    }
+    lengthCount[0] = 0;
+    uint32_t nextCode[MAX_CODE_LENGTH + 1] = {};
+    uint32_t code = 0;
+    for(uint32_t length = 1; length <= MAX_CODE_LENGTH; length++){
+        code = (code + lengthCount[length - 1]) << 1;
+        nextCode[length] = code;
+    }
+    for(uint32_t symbol = 0; symbol < 256; symbol++){
+        codes[symbol] = lengths[symbol] == 0 ? 0 : static_cast<uint16_t>(reverseBits(nextCode[lengths[symbol]]++, lengths[symbol]));
+    }
+}
+
+//  Decode table entry for the next MAX_CODE_LENGTH bits of a stream : up to 2 symbols whose codes fit in those bits
+//  -> skewed planes(short codes) decode 2 bytes per lookup
+//  bits 0-7 first symbol, 8-15 second symbol, 16-19 first code length, 20-23 bits used by both, 24-31 symbol count
+inline uint32_t tableEntry(uint32_t first, uint32_t second, uint32_t firstLength, uint32_t usedBits, uint32_t count){
+    return first | (second << 8) | (firstLength << 16) | (usedBits << 20) | (count << 24);
+}
+
+//  false unless the lengths form a complete code(never trust lengths read from disk)
+//  "pairs" false -> one symbol per entry, cheaper to build when codes are too long for pairs to be common
+bool buildDecodeTable(const uint8_t lengths[256], uint32_t table[TABLE_SIZE], bool pairs){
+    uint32_t kraft = 0;
+    for(uint32_t symbol = 0; symbol < 256; symbol++){
+        if(lengths[symbol] > MAX_CODE_LENGTH){
+            return false;
+        }
+        if(lengths[symbol] > 0){
+            kraft += TABLE_SIZE >> lengths[symbol];
+        }
+    }
+    if(kraft != TABLE_SIZE){
+        return false;
+    }
+    uint16_t codes[256];
+    buildCodes(lengths, codes);
+    if(!pairs){
+        for(uint32_t symbol = 0; symbol < 256; symbol++){
+            const uint32_t length = lengths[symbol];
+            if(length == 0){
+                continue;
+            }
+            for(uint32_t slot = codes[symbol]; slot < TABLE_SIZE; slot += 1u << length){
+                table[slot] = tableEntry(symbol, 0, length, length, 1);
+            }
+        }
+        return true;
+    }
+    //  single symbol entries first, pairs are built from them
+    uint16_t single[TABLE_SIZE];
+    for(uint32_t symbol = 0; symbol < 256; symbol++){
+        const uint32_t length = lengths[symbol];
+        if(length == 0){
+            continue;
+        }
+        for(uint32_t slot = codes[symbol]; slot < TABLE_SIZE; slot += 1u << length){
+            single[slot] = static_cast<uint16_t>(symbol | (length << 8));
+        }
+    }
+    for(uint32_t bits = 0; bits < TABLE_SIZE; bits++){
+        const uint32_t first = single[bits];
+        const uint32_t firstLength = first >> 8;
+        //  bits above the window read as 0 -> only a second code that ends inside the window is real
+        const uint32_t second = single[bits >> firstLength];
+        const uint32_t secondLength = second >> 8;
+        if(firstLength + secondLength <= MAX_CODE_LENGTH){
+            table[bits] = tableEntry(first & 0xFF, second & 0xFF, firstLength, firstLength + secondLength, 2);
+        }else{
+            table[bits] = tableEntry(first & 0xFF, 0, firstLength, firstLength, 1);
+        }
+    }
+    return true;
+}
+
+struct bitWriter{
+    std::vector<uint8_t>& out;
+    uint64_t pending = 0;
+    uint32_t pendingBits = 0;
+
+    void put(uint32_t code, uint32_t length){
+        pending |= uint64_t(code) << pendingBits;
+        pendingBits += length;
+        while(pendingBits >= 8){
+            out.push_back(static_cast<uint8_t>(pending));
+            pending >>= 8;
+            pendingBits -= 8;
+        }
+    }
+    void flush(){
+        if(pendingBits > 0){
+            out.push_back(static_cast<uint8_t>(pending));
+        }
+        pending = 0;
+        pendingBits = 0;
+    }
+};
+
+//  next 57+ bits of a stream starting at bit "position", zeros past the end
+inline uint64_t peekBits(const uint8_t* data, size_t size, uint64_t position){
+    const size_t byte = static_cast<size_t>(position >> 3);
+    uint64_t bits = 0;
+    if(byte + 8 <= size){
+        std::memcpy(&bits, data + byte, 8);
+    }
+    else{
+        for(size_t i = 0; byte + i < size && i < 8; i++){
+            bits |= uint64_t(data[byte + i]) << (8 * i);
+        }
+    }
+    return bits >> (position & 7);
+}
+
+void encodePlane(const uint8_t* bytes, uint32_t count, std::vector<uint8_t>& out){
+    uint32_t counts[256] = {};
+    for(uint32_t i = 0; i < count; i++){
+        counts[bytes[i]]++;
+    }
+    uint32_t usedSymbols = 0;
+    for(uint32_t symbolCount : counts){
+        usedSymbols += symbolCount > 0;
+    }
+    if(usedSymbols <= 1){
+        out.push_back(PLANE_CONSTANT);
+        out.push_back(count > 0 ? bytes[0] : 0);
+        return;
+    }
+
+    uint8_t lengths[256];
+    buildCodeLengths(counts, lengths);
+    uint64_t payloadBits = 0;
+    for(uint32_t symbol = 0; symbol < 256; symbol++){
+        payloadBits += uint64_t(counts[symbol]) * lengths[symbol];
+    }
+    //  every stream rounds up to a byte
+    const uint64_t huffmanSize = PACKED_LENGTHS_SIZE + STREAM_COUNT * sizeof(uint32_t) + payloadBits / 8 + STREAM_COUNT;
+    //  high bytes of small deltas are nearly constant -> Huffman can not go below 1 bit per byte there,
+    //  a list of the exceptions is smaller and decodes at memset speed
+    const uint32_t common = static_cast<uint32_t>(std::max_element(counts, counts + 256) - counts);
+    const uint32_t exceptions = count - counts[common];
+    const uint64_t sparseSize = 1 + sizeof(uint32_t) + uint64_t(exceptions) * 3;
+    if(sparseSize <= huffmanSize && sparseSize < count){
+        out.push_back(PLANE_SPARSE);
+        out.push_back(static_cast<uint8_t>(common));
+        const uint8_t* countBytes = reinterpret_cast<const uint8_t*>(&exceptions);
+        out.insert(out.end(), countBytes, countBytes + sizeof(exceptions));
+        const size_t positions = out.size();
+        out.resize(positions + size_t(exceptions) * 3);
+        uint8_t* position = out.data() + positions;
+        uint8_t* value = position + size_t(exceptions) * 2;
+        for(uint32_t i = 0; i < count; i++){
+            if(bytes[i] != common){
+                const uint16_t index = static_cast<uint16_t>(i);
+                std::memcpy(position, &index, sizeof(index));
+                position += sizeof(index);
+                *value++ = bytes[i];
+            }
+        }
+        return;
+    }
+    //  saving less than 1/4 is not worth decoding at Huffman instead of memcpy speed
+    if(huffmanSize * 4 >= uint64_t(count) * 3){
+        out.push_back(PLANE_RAW);
+        out.insert(out.end(), bytes, bytes + count);
+        return;
+    }
+
+    uint16_t codes[256];
+    buildCodes(lengths, codes);
+    std::vector<uint8_t> streams[STREAM_COUNT];
+    bitWriter writers[STREAM_COUNT] = {{streams[0]}, {streams[1]}, {streams[2]}, {streams[3]}};
+    const uint32_t quarter = (count + STREAM_COUNT - 1) / STREAM_COUNT;
+    for(uint32_t s = 0; s < STREAM_COUNT; s++){
+        streams[s].reserve(static_cast<size_t>(payloadBits / 8 / STREAM_COUNT + 16));
+        for(uint32_t i = s * quarter; i < std::min(count, (s + 1) * quarter); i++){
+            writers[s].put(codes[bytes[i]], lengths[bytes[i]]);
+        }
+    }
+
+    out.push_back(PLANE_HUFFMAN);
+    for(uint32_t symbol = 0; symbol < 256; symbol += 2){
+        out.push_back(static_cast<uint8_t>(lengths[symbol] | (lengths[symbol + 1] << 4)));
+    }
+    for(uint32_t s = 0; s < STREAM_COUNT; s++){
+        writers[s].flush();
+        uint32_t size = static_cast<uint32_t>(streams[s].size());
+        const uint8_t* sizeBytes = reinterpret_cast<const uint8_t*>(&size);
+        out.insert(out.end(), sizeBytes, sizeBytes + sizeof(size));
+    }
+    for(const auto& stream : streams){
+        out.insert(out.end(), stream.begin(), stream.end());
+    }
+}
+
+bool decodeHuffman(const uint8_t*& cursor, const uint8_t* end, uint8_t* out, uint32_t count){
+    if(size_t(end - cursor) < PACKED_LENGTHS_SIZE + STREAM_COUNT * sizeof(uint32_t)){
+        return false;
+    }
+    uint8_t lengths[256];
+    for(uint32_t i = 0; i < PACKED_LENGTHS_SIZE; i++){
+        lengths[i * 2] = cursor[i] & 0x0F;
+        lengths[i * 2 + 1] = cursor[i] >> 4;
+    }
+    cursor += PACKED_LENGTHS_SIZE;
+    uint64_t payloadBytes = 0;
+    for(uint32_t s = 0; s < STREAM_COUNT; s++){
+        uint32_t streamSize;
+        std::memcpy(&streamSize, cursor + s * sizeof(uint32_t), sizeof(streamSize));
+        payloadBytes += streamSize;
+    }
+    //  pairs need two codes within MAX_CODE_LENGTH bits -> only common below ~5 bits per symbol
+    uint32_t table[TABLE_SIZE];
+    if(!buildDecodeTable(lengths, table, payloadBytes * 8 < uint64_t(count) * 5)){
+        return false;
+    }
+
+    const uint8_t* data[STREAM_COUNT];
+    size_t size[STREAM_COUNT];
+    uint64_t position[STREAM_COUNT] = {};
+    uint8_t* target[STREAM_COUNT];
+    uint8_t* targetEnd[STREAM_COUNT];
+    const uint32_t quarter = (count + STREAM_COUNT - 1) / STREAM_COUNT;
+    const uint8_t* streamStart = cursor + STREAM_COUNT * sizeof(uint32_t);
+    for(uint32_t s = 0; s < STREAM_COUNT; s++){
+        uint32_t streamSize;
+        std::memcpy(&streamSize, cursor + s * sizeof(uint32_t), sizeof(streamSize));
+        if(size_t(end - streamStart) < streamSize){
+            return false;
+        }
+        data[s] = streamStart;
+        size[s] = streamSize;
+        streamStart += streamSize;
+        target[s] = out + std::min(count, s * quarter);
+        targetEnd[s] = out + std::min(count, (s + 1) * quarter);
+    }
+    cursor = streamStart;
+
+    //  5 lookups per stream and refill(5 * 11 bits <= 57), the 4 streams are independent chains for the CPU to overlap
+    //  both symbols of an entry are always stored, a single symbol entry's second byte gets overwritten by the next one
+    constexpr uint32_t MASK = TABLE_SIZE - 1;
+    constexpr uint32_t LOOKUPS = 5;
+    constexpr ptrdiff_t MARGIN = LOOKUPS * 2;
+    //  locals instead of arrays -> everything stays in registers
+    uint8_t* target0 = target[0];
+    uint8_t* target1 = target[1];
+    uint8_t* target2 = target[2];
+    uint8_t* target3 = target[3];
+    auto lookup = [&](uint64_t bits, uint32_t& used, uint8_t*& out){
+        const uint32_t entry = table[(bits >> used) & MASK];
+        const uint16_t pair = static_cast<uint16_t>(entry);
+        std::memcpy(out, &pair, sizeof(pair));
+        out += entry >> 24;
+        used += (entry >> 20) & 0xF;
+    };
+    while(targetEnd[0] - target0 >= MARGIN && targetEnd[1] - target1 >= MARGIN
+        && targetEnd[2] - target2 >= MARGIN && targetEnd[3] - target3 >= MARGIN){
+        const uint64_t bits0 = peekBits(data[0], size[0], position[0]);
+        const uint64_t bits1 = peekBits(data[1], size[1], position[1]);
+        const uint64_t bits2 = peekBits(data[2], size[2], position[2]);
+        const uint64_t bits3 = peekBits(data[3], size[3], position[3]);
+        uint32_t used0 = 0, used1 = 0, used2 = 0, used3 = 0;
+        for(uint32_t k = 0; k < LOOKUPS; k++){
+            lookup(bits0, used0, target0);
+            lookup(bits1, used1, target1);
+            lookup(bits2, used2, target2);
+            lookup(bits3, used3, target3);
+        }
+        position[0] += used0;
+        position[1] += used1;
+        position[2] += used2;
+        position[3] += used3;
+    }
+    target[0] = target0;
+    target[1] = target1;
+    target[2] = target2;
+    target[3] = target3;
+    for(uint32_t s = 0; s < STREAM_COUNT; s++){
+        while(target[s] < targetEnd[s]){
+            const uint32_t entry = table[peekBits(data[s], size[s], position[s]) & MASK];
+            *target[s]++ = static_cast<uint8_t>(entry);
+            position[s] += (entry >> 16) & 0xF;
+        }
+        //  a corrupt stream runs past its end(reads zeros there) instead of out of bounds -> caught here
+        if(position[s] > uint64_t(size[s]) * 8){
+            return false;
+        }
+    }
+    return true;
+}
+
+//  "cursor" past the mode byte -> memset to the common value, then patch the exceptions
+bool decodeSparse(const uint8_t*& cursor, const uint8_t* end, uint8_t* out, uint32_t count){
+    uint32_t exceptions;
+    if(size_t(end - cursor) < 1 + sizeof(exceptions)){
+        return false;
+    }
+    std::memset(out, *cursor++, count);
+    std::memcpy(&exceptions, cursor, sizeof(exceptions));
+    cursor += sizeof(exceptions);
+    if(size_t(end - cursor) / 3 < exceptions){
+        return false;
+    }
+    const uint8_t* positions = cursor;
+    const uint8_t* values = cursor + size_t(exceptions) * 2;
+    for(uint32_t i = 0; i < exceptions; i++){
+        uint16_t position;
+        std::memcpy(&position, positions + size_t(i) * 2, sizeof(position));
+        if(position >= count){
+            return false;
+        }
+        out[position] = values[i];
+    }
+    cursor += size_t(exceptions) * 3;
+    return true;
+}
+
+//  "plane" -> the decoded bytes : "out" or, for raw planes, the data itself(no copy)
+bool decodePlane(const uint8_t*& cursor, const uint8_t* end, uint8_t* out, uint32_t count, const uint8_t*& plane){
+    if(cursor >= end){
+        return false;
+    }
+    plane = out;
+    const uint8_t mode = *cursor++;
+    switch(mode){
+        case PLANE_CONSTANT:
+            if(cursor >= end){
+                return false;
+            }
+            std::memset(out, *cursor++, count);
+            return true;
+        case PLANE_RAW:
+            if(size_t(end - cursor) < count){
+                return false;
+            }
+            plane = cursor;
+            cursor += count;
+            return true;
+        case PLANE_HUFFMAN:
+            return decodeHuffman(cursor, end, out, count);
+        case PLANE_SPARSE:
+            return decodeSparse(cursor, end, out, count);
+        default:
+            return false;
+    }
+}
+
+#ifdef GEOMETRY_CODEC_SSE2
+//  elements i..i+15 of the 4 byte planes of a field : interleaved back into words, unzigzag, prefix sum inside the vector + carry
+inline void planeWords(const uint8_t* const planes[PLANE_COUNT], uint32_t i, __m128i& carry, __m128i words[4]){
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i bytes0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[0] + i));
+    const __m128i bytes1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[1] + i));
+    const __m128i bytes2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[2] + i));
+    const __m128i bytes3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[3] + i));
+    const __m128i low01 = _mm_unpacklo_epi8(bytes0, bytes1);
+    const __m128i high01 = _mm_unpackhi_epi8(bytes0, bytes1);
+    const __m128i low23 = _mm_unpacklo_epi8(bytes2, bytes3);
+    const __m128i high23 = _mm_unpackhi_epi8(bytes2, bytes3);
+    words[0] = _mm_unpacklo_epi16(low01, low23);
+    words[1] = _mm_unpackhi_epi16(low01, low23);
+    words[2] = _mm_unpacklo_epi16(high01, high23);
+    words[3] = _mm_unpackhi_epi16(high01, high23);
+    for(uint32_t w = 0; w < 4; w++){
+        __m128i x = words[w];
+        x = _mm_xor_si128(_mm_srli_epi32(x, 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(x, one)));
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+        x = _mm_add_epi32(x, carry);
+        carry = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+        words[w] = x;
+    }
+}
+#endif
+
+//  "planes" : PLANE_COUNT byte planes per field for "fields" <= GROUP_FIELDS consecutive fields
+//  -> running sum of the unzigzagged words, the fields of an element every "stride" bytes of "target"
+void reconstructFields(const uint8_t* const planes[GROUP_FIELDS * PLANE_COUNT], uint32_t count, uint32_t fields, uint8_t* target, size_t stride){
+    uint32_t values[GROUP_FIELDS] = {};
+    uint32_t i = 0;
+#ifdef GEOMETRY_CODEC_SSE2
+    //  16 elements per step, then 4x4 transposes -> all fields of an element leave in one store instead of a 4 byte scatter per field
+    __m128i carry[GROUP_FIELDS] = {};
+    //  one packed field(indices) -> the words already are the elements
+    for(; stride == sizeof(uint32_t) && i + 16 <= count; i += 16){
+        __m128i words[4];
+        planeWords(planes, i, carry[0], words);
+        for(uint32_t w = 0; w < 4; w++){
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + (i + w * 4) * stride), words[w]);
+        }
+    }
+    for(; i + 16 <= count; i += 16){
+        __m128i words[GROUP_FIELDS][4] = {};
+        for(uint32_t field = 0; field < fields; field++){
+            planeWords(planes + field * PLANE_COUNT, i, carry[field], words[field]);
+        }
+        for(uint32_t w = 0; w < 4; w++){
+            const __m128i low01 = _mm_unpacklo_epi32(words[0][w], words[1][w]);
+            const __m128i high01 = _mm_unpackhi_epi32(words[0][w], words[1][w]);
+            const __m128i low23 = _mm_unpacklo_epi32(words[2][w], words[3][w]);
+            const __m128i high23 = _mm_unpackhi_epi32(words[2][w], words[3][w]);
+            const __m128i elements[4] = {
+                _mm_unpacklo_epi64(low01, low23), _mm_unpackhi_epi64(low01, low23),
+                _mm_unpacklo_epi64(high01, high23), _mm_unpackhi_epi64(high01, high23),
+            };
+            for(uint32_t e = 0; e < 4; e++){
+                uint8_t* element = target + (i + w * 4 + e) * stride;
+                if(fields == GROUP_FIELDS){
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(element), elements[e]);
+                    continue;
+                }
+                //  a partial group(last fields of an element) must not spill into the next element
+                if(fields >= 2){
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(element), elements[e]);
+                }
+                if(fields != 2){
+                    const uint32_t last = static_cast<uint32_t>(_mm_cvtsi128_si32(fields == 3 ? _mm_srli_si128(elements[e], 8) : elements[e]));
+                    std::memcpy(element + (fields - 1) * sizeof(uint32_t), &last, sizeof(last));
+                }
+            }
+        }
+    }
+    for(uint32_t field = 0; field < fields; field++){
+        values[field] = static_cast<uint32_t>(_mm_cvtsi128_si32(carry[field]));
+    }
+#endif
+    for(uint32_t field = 0; field < fields; field++){
+        const uint8_t* plane0 = planes[field * PLANE_COUNT];
+        const uint8_t* plane1 = planes[field * PLANE_COUNT + 1];
+        const uint8_t* plane2 = planes[field * PLANE_COUNT + 2];
+        const uint8_t* plane3 = planes[field * PLANE_COUNT + 3];
+        uint32_t value = values[field];
+        for(uint32_t j = i; j < count; j++){
+            value += unzigzag(uint32_t(plane0[j]) | (uint32_t(plane1[j]) << 8) | (uint32_t(plane2[j]) << 16) | (uint32_t(plane3[j]) << 24));
+            std::memcpy(target + j * stride + field * sizeof(uint32_t), &value, sizeof(value));
+        }
+    }
+}
+
+//  "elements" : "count" elements of "stride" bytes, the first "fields" 32 bit words of each get encoded
+void encodeBlock(const uint8_t* elements, size_t stride, uint32_t fields, uint32_t count, std::vector<uint8_t>& out){
+    std::vector<uint8_t> planes(size_t(count) * PLANE_COUNT);
+    for(uint32_t field = 0; field < fields; field++){
+        uint32_t previous = 0;
+        for(uint32_t i = 0; i < count; i++){
+            uint32_t value;
+            std::memcpy(&value, elements + i * stride + field * sizeof(uint32_t), sizeof(value));
+            const uint32_t delta = zigzag(value - previous);
+            previous = value;
+            for(uint32_t p = 0; p < PLANE_COUNT; p++){
+                planes[size_t(p) * count + i] = static_cast<uint8_t>(delta >> (8 * p));
+            }
+        }
+        for(uint32_t p = 0; p < PLANE_COUNT; p++){
+            encodePlane(planes.data() + size_t(p) * count, count, out);
+        }
+    }
+}
+
+bool decodeBlock(const uint8_t* data, size_t size, uint8_t* elements, size_t stride, uint32_t fields, uint32_t count){
+    //  every byte gets written before it is read -> no zero fill
+    std::unique_ptr<uint8_t[]> scratch(new uint8_t[size_t(count) * PLANE_COUNT * std::min(GROUP_FIELDS, fields)]);
+    const uint8_t* planes[GROUP_FIELDS * PLANE_COUNT];
+    const uint8_t* cursor = data;
+    const uint8_t* end = data + size;
+    for(uint32_t first = 0; first < fields; first += GROUP_FIELDS){
+        const uint32_t group = std::min(GROUP_FIELDS, fields - first);
+        for(uint32_t p = 0; p < group * PLANE_COUNT; p++){
+            if(!decodePlane(cursor, end, scratch.get() + size_t(p) * count, count, planes[p])){
+                return false;
+            }
+        }
+        reconstructFields(planes, count, group, elements + first * sizeof(uint32_t), stride);
+    }
+    return cursor == end;
+}
+
+std::vector<uint8_t> encodeStream(const uint8_t* elements, size_t stride, uint32_t fields, uint32_t count){
+    const uint32_t blockCount = (count + GeometryCodec::BLOCK_ELEMENTS - 1) / GeometryCodec::BLOCK_ELEMENTS;
+    std::vector<std::vector<uint8_t>> blocks(blockCount);
+    ThreadPool::shared().parallelFor(blockCount, [&](size_t block){
+        const uint32_t first = static_cast<uint32_t>(block) * GeometryCodec::BLOCK_ELEMENTS;
+        const uint32_t blockElements = std::min(GeometryCodec::BLOCK_ELEMENTS, count - first);
+        encodeBlock(elements + first * stride, stride, fields, blockElements, blocks[block]);
+    });
+
+    streamHeader header{count, fields, blockCount, 0};
+    std::vector<uint64_t> ends(blockCount);
+    uint64_t offset = 0;
+    for(uint32_t block = 0; block < blockCount; block++){
+        offset += blocks[block].size();
+        ends[block] = offset;
+    }
+    std::vector<uint8_t> out;
+    out.reserve(sizeof(header) + ends.size() * sizeof(uint64_t) + offset);
+    const uint8_t* headerBytes = reinterpret_cast<const uint8_t*>(&header);
+    out.insert(out.end(), headerBytes, headerBytes + sizeof(header));
+    const uint8_t* endBytes = reinterpret_cast<const uint8_t*>(ends.data());
+    out.insert(out.end(), endBytes, endBytes + ends.size() * sizeof(uint64_t));
+    for(const auto& block : blocks){
+        out.insert(out.end(), block.begin(), block.end());
+    }
+    return out;
+}
+
+bool decodeStream(const uint8_t* data, size_t size, uint8_t* elements, size_t stride, uint32_t fields, uint32_t count, bool parallel){
+    streamHeader header{};
+    if(size < sizeof(header)){
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    const uint32_t blockCount = (count + GeometryCodec::BLOCK_ELEMENTS - 1) / GeometryCodec::BLOCK_ELEMENTS;
+    if(header.elementCount != count || header.fields != fields || header.blockCount != blockCount
+        || (size - sizeof(header)) / sizeof(uint64_t) < blockCount){
+        return false;
+    }
+    std::vector<uint64_t> ends(blockCount);
+    std::memcpy(ends.data(), data + sizeof(header), ends.size() * sizeof(uint64_t));
+    const uint8_t* blockData = data + sizeof(header) + ends.size() * sizeof(uint64_t);
+    const uint64_t blockDataSize = size - sizeof(header) - ends.size() * sizeof(uint64_t);
+    uint64_t previousEnd = 0;
+    for(uint64_t end : ends){
+        if(end < previousEnd){
+            return false;
+        }
+        previousEnd = end;
+    }
+    if(previousEnd != blockDataSize){
+        return false;
+    }
+
+    std::vector<uint8_t> decoded(blockCount, 0);
+    auto decodeOne = [&](size_t block){
+        const uint64_t begin = block == 0 ? 0 : ends[block - 1];
+        const uint32_t first = static_cast<uint32_t>(block) * GeometryCodec::BLOCK_ELEMENTS;
+        const uint32_t blockElements = std::min(GeometryCodec::BLOCK_ELEMENTS, count - first);
+        decoded[block] = decodeBlock(blockData + begin, static_cast<size_t>(ends[block] - begin),
+                                     elements + first * stride, stride, fields, blockElements);
+    };
+    if(parallel){
+        ThreadPool::shared().parallelFor(blockCount, decodeOne);
+    }
+    else{
+        for(size_t block = 0; block < blockCount; block++){
+            decodeOne(block);
+        }
+    }
+    return std::all_of(decoded.begin(), decoded.end(), [](uint8_t ok){ return ok != 0; });
+}
+
+}   //  namespace
+
+std::vector<uint8_t> GeometryCodec::encodeVertices(const Model::Vertex* vertices, uint32_t count){
+    return encodeStream(reinterpret_cast<const uint8_t*>(vertices), sizeof(Model::Vertex), VERTEX_FIELDS, count);
+}
+
+std::vector<uint8_t> GeometryCodec::encodeIndices(const uint32_t* indices, uint32_t count){
+    return encodeStream(reinterpret_cast<const uint8_t*>(indices), sizeof(uint32_t), 1, count);
+}
+
+bool GeometryCodec::decodeVertices(const uint8_t* data, size_t size, Model::Vertex* vertices, uint32_t count, bool parallel){
+    return decodeStream(data, size, reinterpret_cast<uint8_t*>(vertices), sizeof(Model::Vertex), VERTEX_FIELDS, count, parallel);
+}
+
+bool GeometryCodec::decodeIndices(const uint8_t* data, size_t size, uint32_t* indices, uint32_t count, bool parallel){
+    return decodeStream(data, size, reinterpret_cast<uint8_t*>(indices), sizeof(uint32_t), 1, count, parallel);
+}
+
+}   //  namespace VULKVULK
@@ -0,0 +1,40 @@
+#ifndef GEOMETRY_CODEC_H
+#define GEOMETRY_CODEC_H
+
+#include "model.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace VULKVULK{
+
+//  Lossless codec for the vertex/index arrays of Model::bufferData(what the mesh cache stores)
+//
+//  Elements are split into blocks of BLOCK_ELEMENTS that encode/decode independently(on the shared thread pool)
+//  Inside a block every 32 bit field of an element(1 for indices, 11 for Vertex) is
+//  1. delta coded against the same field of the previous element and ZigZag mapped -> small signed steps, small numbers
+//  2. split into 4 byte planes(transpose) -> high bytes of small numbers end up together as long runs of zeros
+//  3. every plane is stored as a constant, sparse(one common byte + a list of exceptions), raw or
+//     Huffman coded(11 bit max code length, 4 streams decoded side by side)
+//     sparse covers the nearly constant high bytes Huffman can not code below 1 bit each
+//     Huffman only when it saves at least 1/4 of the raw plane -> near random low mantissa bytes decode at memcpy speed
+//  Decoding looks up up to 2 symbols per table access, planes go back to words + prefix sum 16 elements at a time(SSE2)
+//  and 4 fields at a time are transposed back into elements -> one store per element instead of one per field
+//  Target : >= 1 GB/s decode per core(VulkBench geometry codec)
+class GeometryCodec{
+public:
+    static constexpr uint32_t BLOCK_ELEMENTS = 16384;
+
+    static std::vector<uint8_t> encodeVertices(const Model::Vertex* vertices, uint32_t count);
+    static std::vector<uint8_t> encodeIndices(const uint32_t* indices, uint32_t count);
+
+    //  "count" is what the data has to decode to -> false on any mismatch or malformed data, "out" is garbage then
+    //  "parallel" false keeps everything on the calling thread(benchmarks)
+    static bool decodeVertices(const uint8_t* data, size_t size, Model::Vertex* vertices, uint32_t count, bool parallel = true);
+    static bool decodeIndices(const uint8_t* data, size_t size, uint32_t* indices, uint32_t count, bool parallel = true);
+};
+
+}   //  namespace VULKVULK
+
+#endif
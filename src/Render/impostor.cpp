@@ -0,0 +1,92 @@
+#include "impostor.h"
+#include "impostorBaker.h"
+
+#include <array>
+#include <stdexcept>
+
+namespace VULKVULK{
+
+VkDescriptorSetLayout Impostor::createSetLayout(Device& device){
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+    for(uint32_t i = 0; i < bindings.size(); i++){
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        bindings[i].pImmutableSamplers = nullptr;
+    }
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+    VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+    if(vkCreateDescriptorSetLayout(device.device(), &layoutInfo, nullptr, &layout) != VK_SUCCESS){
+        throw std::runtime_error("failed to create impostor descriptor set layout!");
+    }
+    return layout;
+}
+
+Impostor::Impostor(Device& device, const ImpostorAtlas& atlas, UploadBatch& batch) : device(device){
+    frames = atlas.frames;
+    frameSize = atlas.frameSize;
+    center = atlas.center;
+    radius = atlas.radius;
+    color = std::make_unique<Texture>(device, atlas.color, batch);
+    normals = std::make_unique<Texture>(device, atlas.normals, batch);
+    //  descriptors only point at the image views -> written now, sampled once the batch completed
+    createDescriptorSet();
+}
+
+Impostor::~Impostor(){
+    //  sets are freed with their pool
+    vkDestroyDescriptorPool(device.device(), descriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(device.device(), setLayout, nullptr);
+}
+
+void Impostor::createDescriptorSet(){
+    setLayout = createSetLayout(device);
+
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSize.descriptorCount = 2;
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    if(vkCreateDescriptorPool(device.device(), &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS){
+        throw std::runtime_error("failed to create impostor descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &setLayout;
+    if(vkAllocateDescriptorSets(device.device(), &allocInfo, &descriptorSet) != VK_SUCCESS){
+        throw std::runtime_error("failed to allocate impostor descriptor set!");
+    }
+
+    std::array<VkDescriptorImageInfo, 2> images{};
+    const Texture* textures[2] = {color.get(), normals.get()};
+    std::array<VkWriteDescriptorSet, 2> writes{};
+    for(uint32_t i = 0; i < writes.size(); i++){
+        images[i].sampler = textures[i]->getSampler();
+        images[i].imageView = textures[i]->getImageView();
+        images[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = descriptorSet;
+        writes[i].dstBinding = i;
+        writes[i].dstArrayElement = 0;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[i].descriptorCount = 1;
+        writes[i].pImageInfo = &images[i];
+    }
+    vkUpdateDescriptorSets(device.device(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
+
+void Impostor::bind(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, uint32_t set){
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, set, 1, &descriptorSet, 0, nullptr);
+}
+
+}   //  namespace VULKVULK
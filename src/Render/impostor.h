@@ -0,0 +1,57 @@
+#ifndef IMPOSTOR_H
+#define IMPOSTOR_H
+
+#include "device.h"
+#include "texture.h"
+#include "../Core/core.h"
+
+#include <memory>
+
+namespace VULKVULK{
+
+class UploadBatch;
+struct ImpostorAtlas;
+
+//  GPU side of an ImpostorAtlas : color + normal atlas and the descriptor set sampling them
+//  set layout : binding 0 color, binding 1 normals, both combined image samplers read by the fragment shader
+//  -> every impostor's own layout is identically defined to createSetLayout(), so pipelines built with that one bind
+//     any impostor's set
+class Impostor{
+public:
+    //  caller owns the layout(vkDestroyDescriptorSetLayout)
+    static VkDescriptorSetLayout createSetLayout(Device& device);
+
+    //  records the atlas uploads into "batch" -> usable once the batch completed, "atlas" must stay alive until then
+    Impostor(Device& device, const ImpostorAtlas& atlas, UploadBatch& batch);
+    ~Impostor();
+
+    Impostor(const Impostor&) = delete;
+    Impostor& operator=(const Impostor&) = delete;
+
+    void bind(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, uint32_t set);
+
+    uint32_t getFrameCount() const { return frames; }
+    uint32_t getFrameSize() const { return frameSize; }
+    const glm::vec3& getCenter() const { return center; }
+    float getRadius() const { return radius; }
+    VkDeviceSize getMemorySize() const { return color->getMemorySize() + normals->getMemorySize(); }
+
+private:
+    void createDescriptorSet();
+
+    Device& device;
+    std::unique_ptr<Texture> color;
+    std::unique_ptr<Texture> normals;
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+
+    uint32_t frames = 0;
+    uint32_t frameSize = 0;
+    glm::vec3 center{};
+    float radius = 0.0f;
+};
+
+}   //  namespace VULKVULK
+
+#endif
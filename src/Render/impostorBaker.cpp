@@ -0,0 +1,247 @@
+#include "impostorBaker.h"
+#include "mipGenerator.h"
+#include "vertexQuantizer.h"
+#include "../Core/threadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace VULKVULK{
+
+namespace{
+
+//  uncovered pixels next to covered ones take their neighbours' color -> bilinear filtering and mips at the
+//  silhouette blend towards the surface instead of black
+constexpr uint32_t DILATION_PASSES = 2;
+
+uint8_t unorm8(float value){
+    return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+//  one triangle run drawn with one diffuse color
+struct colorRange{
+    uint32_t firstIndex;
+    uint32_t endIndex;
+    glm::vec3 diffuse;
+};
+
+Texture::preparedTexture toTexture(const std::vector<uint8_t>& rgba, uint32_t size, uint32_t frameSize){
+    std::vector<MipGenerator::image> chain = MipGenerator::buildChain(rgba.data(), size, size, MipFilter::BOX, false);
+    //  box filtered power of two frames never mix until a frame is a single pixel -> smaller levels are left out
+    uint32_t levelCount = 1;
+    while((frameSize >> levelCount) > 0){
+        levelCount++;
+    }
+    chain.resize(std::min<size_t>(chain.size(), levelCount));
+
+    Texture::preparedTexture texture{};
+    texture.format = VK_FORMAT_R8G8B8A8_UNORM;
+    texture.width = size;
+    texture.height = size;
+    for(const MipGenerator::image& level : chain){
+        texture.levels.push_back({level.width, level.height, texture.pixels.size(), level.pixels.size()});
+        texture.pixels.insert(texture.pixels.end(), level.pixels.begin(), level.pixels.end());
+    }
+    texture.data = texture.pixels.data();
+    texture.dataSize = texture.pixels.size();
+    return texture;
+}
+
+}   //  namespace
+
+glm::vec3 ImpostorBaker::frameDirection(uint32_t frames, uint32_t x, uint32_t y){
+    const float scale = 2.0f / float(frames);
+    return VertexQuantizer::decodeOctahedral({(float(x) + 0.5f) * scale - 1.0f, (float(y) + 0.5f) * scale - 1.0f});
+}
+
+uint32_t ImpostorBaker::frameFor(uint32_t frames, const glm::vec3& direction){
+    const glm::vec2 encoded = VertexQuantizer::encodeOctahedral(direction);
+    auto cell = [&](float value){
+        return std::min(static_cast<uint32_t>(std::max((value * 0.5f + 0.5f) * float(frames), 0.0f)), frames - 1);
+    };
+    return cell(encoded.x) + cell(encoded.y) * frames;
+}
+
+void ImpostorBaker::frameBasis(const glm::vec3& direction, glm::vec3& right, glm::vec3& up){
+    const glm::vec3 forward = glm::normalize(direction);
+    //  straight above/below -> any horizontal reference works, it only has to match between bake and draw
+    const glm::vec3 reference = std::abs(forward.y) > 0.99f ? glm::vec3{0.0f, 0.0f, 1.0f} : glm::vec3{0.0f, 1.0f, 0.0f};
+    right = glm::normalize(glm::cross(reference, forward));
+    up = glm::cross(forward, right);
+}
+
+ImpostorAtlas ImpostorBaker::bake(const Model::bufferView& bView, const settings& config){
+    ImpostorAtlas atlas{};
+    atlas.frames = std::max(config.frames, 1u);
+    atlas.frameSize = 1;
+    while(atlas.frameSize < config.frameSize){
+        atlas.frameSize <<= 1;
+    }
+    const Model::boundingVolume bounds = bView.boundsCount > 0 ? bView.bounds[0]
+                                         : Model::boundingVolume::fromVertices(bView.vertices, bView.vertexCount);
+    atlas.center = bounds.center;
+    atlas.radius = std::max(bounds.radius, 1e-6f);
+
+    //  coarsest level whose error stays below one pixel of a frame -> same picture for less rasterizing
+    const float pixelSize = 2.0f * atlas.radius / float(atlas.frameSize);
+    uint32_t firstIndex = 0;
+    uint32_t endIndex = bView.indexCount;
+    for(uint32_t i = 0; i < bView.lodCount; i++){
+        if(i == 0 || bView.lods[i].error <= pixelSize){
+            firstIndex = bView.lods[i].firstIndex;
+            endIndex = bView.lods[i].firstIndex + bView.lods[i].indexCount;
+        }
+    }
+    std::vector<colorRange> ranges{};
+    for(uint32_t i = 0; i < bView.submeshCount; i++){
+        const Model::submesh& part = bView.submeshes[i];
+        if(part.firstIndex >= firstIndex && part.firstIndex < endIndex){
+            const glm::vec3 diffuse = part.material < bView.materialCount ? bView.materials[part.material].diffuse : glm::vec3{1.0f};
+            ranges.push_back({part.firstIndex, part.firstIndex + part.indexCount, diffuse});
+        }
+    }
+    if(ranges.empty()){
+        ranges.push_back({firstIndex, endIndex, glm::vec3{1.0f}});
+    }
+
+    const uint32_t frameSize = atlas.frameSize;
+    const uint32_t atlasSize = atlas.frames * frameSize;
+    std::vector<uint8_t> color(size_t(atlasSize) * atlasSize * 4, 0);
+    std::vector<uint8_t> normals(size_t(atlasSize) * atlasSize * 4, 0);
+
+    //  frames write disjoint parts of the atlas -> one job per frame
+    ThreadPool::shared().parallelFor(size_t(atlas.frames) * atlas.frames, [&](size_t frame){
+        const uint32_t frameX = static_cast<uint32_t>(frame % atlas.frames);
+        const uint32_t frameY = static_cast<uint32_t>(frame / atlas.frames);
+        const glm::vec3 forward = frameDirection(atlas.frames, frameX, frameY);
+        glm::vec3 right{}, up{};
+        frameBasis(forward, right, up);
+
+        //  x, y in frame pixels, z grows towards the viewer
+        const float toPixels = 0.5f * float(frameSize) / atlas.radius;
+        std::vector<glm::vec3> projected(bView.vertexCount);
+        for(uint32_t i = 0; i < bView.vertexCount; i++){
+            const glm::vec3 offset = bView.vertices[i].position - atlas.center;
+            projected[i] = {glm::dot(offset, right) * toPixels + 0.5f * float(frameSize),
+                            glm::dot(offset, up) * toPixels + 0.5f * float(frameSize), glm::dot(offset, forward)};
+        }
+        std::vector<float> depth(size_t(frameSize) * frameSize, -std::numeric_limits<float>::max());
+        auto pixelAt = [&](std::vector<uint8_t>& target, uint32_t x, uint32_t y){
+            return &target[((size_t(frameY) * frameSize + y) * atlasSize + size_t(frameX) * frameSize + x) * 4];
+        };
+
+        for(const colorRange& range : ranges){
+            for(uint32_t t = range.firstIndex; t + 2 < range.endIndex; t += 3){
+                const uint32_t i0 = bView.indices[t], i1 = bView.indices[t + 1], i2 = bView.indices[t + 2];
+                const glm::vec3& a = projected[i0];
+                const glm::vec3& b = projected[i1];
+                const glm::vec3& c = projected[i2];
+                const float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+                if(std::abs(area) < 1e-12f){
+                    continue;
+                }
+                //  pixel centers inside the triangle's box, either winding(no culling, like the mesh pipelines)
+                const float minX = std::max(std::min({a.x, b.x, c.x}) - 0.5f, 0.0f);
+                const float minY = std::max(std::min({a.y, b.y, c.y}) - 0.5f, 0.0f);
+                const float maxX = std::min(std::max({a.x, b.x, c.x}) - 0.5f, float(frameSize - 1));
+                const float maxY = std::min(std::max({a.y, b.y, c.y}) - 0.5f, float(frameSize - 1));
+                if(minX > maxX || minY > maxY){
+                    continue;
+                }
+                const Model::Vertex& v0 = bView.vertices[i0];
+                const Model::Vertex& v1 = bView.vertices[i1];
+                const Model::Vertex& v2 = bView.vertices[i2];
+                const float inverseArea = 1.0f / area;
+                //  barycentrics are linear in x -> evaluated once per row, stepped along it
+                const float step0 = -(c.y - b.y) * inverseArea;
+                const float step1 = -(a.y - c.y) * inverseArea;
+                const uint32_t startX = static_cast<uint32_t>(std::ceil(minX));
+                for(uint32_t y = static_cast<uint32_t>(std::ceil(minY)); float(y) <= maxY; y++){
+                    const float py = float(y) + 0.5f;
+                    const float px = float(startX) + 0.5f;
+                    float w0 = ((c.x - b.x) * (py - b.y) - (c.y - b.y) * (px - b.x)) * inverseArea - step0;
+                    float w1 = ((a.x - c.x) * (py - c.y) - (a.y - c.y) * (px - c.x)) * inverseArea - step1;
+                    for(uint32_t x = startX; float(x) <= maxX; x++){
+                        w0 += step0;
+                        w1 += step1;
+                        const float w2 = 1.0f - w0 - w1;
+                        if(w0 < 0.0f || w1 < 0.0f || w2 < 0.0f){
+                            continue;
+                        }
+                        const float z = w0 * a.z + w1 * b.z + w2 * c.z;
+                        float& stored = depth[size_t(y) * frameSize + x];
+                        if(z <= stored){
+                            continue;
+                        }
+                        stored = z;
+                        glm::vec3 normal = w0 * v0.normal + w1 * v1.normal + w2 * v2.normal;
+                        const float length = glm::length(normal);
+                        normal = length > 0.0f ? normal / length : forward;
+                        const glm::vec3 albedo = (w0 * v0.color + w1 * v1.color + w2 * v2.color) * range.diffuse;
+                        uint8_t* colorPixel = pixelAt(color, x, y);
+                        uint8_t* normalPixel = pixelAt(normals, x, y);
+                        for(int k = 0; k < 3; k++){
+                            colorPixel[k] = unorm8(albedo[k]);
+                            normalPixel[k] = unorm8(normal[k] * 0.5f + 0.5f);
+                        }
+                        colorPixel[3] = 255;
+                        normalPixel[3] = 255;
+                    }
+                }
+            }
+        }
+
+        //  filled pixels keep alpha 0 -> the impostor shader still discards them
+        std::vector<uint8_t> filled(size_t(frameSize) * frameSize, 0);
+        for(uint32_t y = 0; y < frameSize; y++){
+            for(uint32_t x = 0; x < frameSize; x++){
+                filled[size_t(y) * frameSize + x] = pixelAt(color, x, y)[3] != 0 ? 1 : 0;
+            }
+        }
+        std::vector<uint8_t> next{};
+        for(uint32_t pass = 0; pass < DILATION_PASSES; pass++){
+            next = filled;
+            for(uint32_t y = 0; y < frameSize; y++){
+                for(uint32_t x = 0; x < frameSize; x++){
+                    if(filled[size_t(y) * frameSize + x]){
+                        continue;
+                    }
+                    uint32_t colorSum[3]{}, normalSum[3]{}, count = 0;
+                    const int32_t offsets[4][2]{{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+                    for(const auto& offset : offsets){
+                        const int32_t nx = int32_t(x) + offset[0];
+                        const int32_t ny = int32_t(y) + offset[1];
+                        if(nx < 0 || ny < 0 || nx >= int32_t(frameSize) || ny >= int32_t(frameSize) || !filled[size_t(ny) * frameSize + nx]){
+                            continue;
+                        }
+                        const uint8_t* colorPixel = pixelAt(color, uint32_t(nx), uint32_t(ny));
+                        const uint8_t* normalPixel = pixelAt(normals, uint32_t(nx), uint32_t(ny));
+                        for(int k = 0; k < 3; k++){
+                            colorSum[k] += colorPixel[k];
+                            normalSum[k] += normalPixel[k];
+                        }
+                        count++;
+                    }
+                    if(count == 0){
+                        continue;
+                    }
+                    uint8_t* colorPixel = pixelAt(color, x, y);
+                    uint8_t* normalPixel = pixelAt(normals, x, y);
+                    for(int k = 0; k < 3; k++){
+                        colorPixel[k] = static_cast<uint8_t>((colorSum[k] + count / 2) / count);
+                        normalPixel[k] = static_cast<uint8_t>((normalSum[k] + count / 2) / count);
+                    }
+                    next[size_t(y) * frameSize + x] = 1;
+                }
+            }
+            filled.swap(next);
+        }
+    });
+
+    atlas.color = toTexture(color, atlasSize, frameSize);
+    atlas.normals = toTexture(normals, atlasSize, frameSize);
+    return atlas;
+}
+
+}   //  namespace VULKVULK
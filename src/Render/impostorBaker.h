@@ -0,0 +1,48 @@
+#ifndef IMPOSTOR_BAKER_H
+#define IMPOSTOR_BAKER_H
+
+#include "model.h"
+#include "texture.h"
+
+#include <cstdint>
+
+namespace VULKVULK{
+
+//  Pre-rendered views of a model, frames * frames views on an octahedral grid over the whole sphere of directions
+//  Every frame is an orthographic view of the model's bounding sphere(center, radius) looking back along the frame's
+//  direction, see ImpostorBaker::frameBasis for its axes
+struct ImpostorAtlas{
+    uint32_t frames = 0;            //  per atlas side
+    uint32_t frameSize = 0;         //  pixels per frame side, power of two
+    glm::vec3 center{};             //  model space
+    float radius = 0.0f;
+    //  RGBA8 UNORM, (frames * frameSize)^2, mips down to one pixel per frame
+    Texture::preparedTexture color{};       //  rgb albedo(vertex color * material diffuse), a coverage
+    Texture::preparedTexture normals{};     //  rgb model space normal * 0.5 + 0.5
+
+    size_t getMemorySize() const { return color.dataSize + normals.dataSize; }
+};
+
+//  Bakes impostor atlases on the CPU(small depth tested rasterizer) -> no device, window or swapchain involved,
+//  safe on worker threads and in tools without a GPU
+class ImpostorBaker{
+public:
+    struct settings{
+        uint32_t frames = 8;        //  per atlas side, frames * frames views
+        uint32_t frameSize = 64;    //  pixels, rounded up to a power of two
+    };
+
+    //  Level 0 triangles, or the coarsest LOD whose error stays under one atlas pixel
+    static ImpostorAtlas bake(const Model::bufferView& bView, const settings& config);
+
+    //  octahedral grid : frame (x, y) -> unit direction from the model towards the viewer
+    static glm::vec3 frameDirection(uint32_t frames, uint32_t x, uint32_t y);
+    //  frame whose direction is closest to "direction"(any length), as x + y * frames
+    static uint32_t frameFor(uint32_t frames, const glm::vec3& direction);
+    //  axes of the frame plane for a view along "direction" -> atlas u grows along "right", v along "up"
+    static void frameBasis(const glm::vec3& direction, glm::vec3& right, glm::vec3& up);
+};
+
+}   //  namespace VULKVULK
+
+#endif
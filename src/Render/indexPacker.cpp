@@ -0,0 +1,76 @@
+#include "indexPacker.h"
+
+#include <limits>
+
+namespace VULKVULK{
+
+void IndexPacker::pack(const Model::bufferView& bView, Result& out){
+    out = Result{};
+    if(bView.indexCount == 0){
+        return;
+    }
+    out.indices.resize(bView.indexCount);
+
+    std::vector<Model::lodLevel> levels(bView.lods, bView.lods + bView.lodCount);
+    if(levels.empty()){
+        levels.push_back({0, bView.indexCount, 0.0f});
+    }
+
+    //  common case -> every index already fits, each level is one range
+    if(bView.vertexCount <= MAX_CHUNK_VERTICES){
+        for(uint32_t i = 0; i < bView.indexCount; i++){
+            out.indices[i] = static_cast<uint16_t>(bView.indices[i]);
+        }
+        for(const auto& level : levels){
+            out.lods.push_back({static_cast<uint32_t>(out.ranges.size()), 1, level.error, level.firstMeshlet, level.meshletCount});
+            out.ranges.push_back({level.firstIndex, level.indexCount, 0});
+        }
+        return;
+    }
+
+    //  greedy split in triangle order : close the chunk when the next triangle would not fit
+    //  triangles keep their order, so cache/fetch ordering from MeshOptimizer survives inside each chunk
+    //  levels are split separately, their chunks append to the same vertex array
+    constexpr uint32_t NO_CHUNK = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> chunkOf(bView.vertexCount, NO_CHUNK);
+    std::vector<uint16_t> localOf(bView.vertexCount, 0);
+    out.vertices.reserve(bView.vertexCount);
+
+    uint32_t chunk = 0;
+    for(const auto& level : levels){
+        out.lods.push_back({static_cast<uint32_t>(out.ranges.size()), 0, level.error, level.firstMeshlet, level.meshletCount});
+        chunk++;
+        uint32_t chunkVertexCount = 0;
+        Model::drawRange range{level.firstIndex, 0, static_cast<int32_t>(out.vertices.size())};
+        for(uint32_t i = level.firstIndex; i + 2 < level.firstIndex + level.indexCount; i += 3){
+            const uint32_t* tri = bView.indices + i;
+            uint32_t newVertices = 0;
+            for(int k = 0; k < 3; k++){
+                bool repeated = (k > 0 && tri[k] == tri[0]) || (k > 1 && tri[k] == tri[1]);
+                if(chunkOf[tri[k]] != chunk && !repeated){
+                    newVertices++;
+                }
+            }
+            if(chunkVertexCount + newVertices > MAX_CHUNK_VERTICES){
+                out.ranges.push_back(range);
+                chunk++;
+                chunkVertexCount = 0;
+                range = Model::drawRange{i, 0, static_cast<int32_t>(out.vertices.size())};
+            }
+            for(int k = 0; k < 3; k++){
+                uint32_t v = tri[k];
+                if(chunkOf[v] != chunk){
+                    chunkOf[v] = chunk;
+                    localOf[v] = static_cast<uint16_t>(chunkVertexCount++);
+                    out.vertices.push_back(bView.vertices[v]);
+                }
+                out.indices[i + k] = localOf[v];
+            }
+            range.indexCount += 3;
+        }
+        out.ranges.push_back(range);
+        out.lods.back().rangeCount = static_cast<uint32_t>(out.ranges.size()) - out.lods.back().firstRange;
+    }
+}
+
+}   //  namespace VULKVULK
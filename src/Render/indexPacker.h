@@ -0,0 +1,30 @@
+#ifndef INDEX_PACKER_H
+#define INDEX_PACKER_H
+
+#include "model.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace VULKVULK{
+
+//  Turns a 32 bit indexed mesh into 16 bit indices
+//  Meshes with more than MAX_CHUNK_VERTICES vertices get split into chunks, each addressing its own window of the
+//  vertex buffer through vertexOffset -> vertices referenced from two chunks get duplicated
+//  LOD levels are packed one after another, every level ends up as its own slice of "ranges"
+class IndexPacker{
+public:
+    static constexpr uint32_t MAX_CHUNK_VERTICES = 65535;
+
+    struct Result{
+        std::vector<Model::Vertex> vertices{};      //  empty when the source vertex array can be used as is
+        std::vector<uint16_t> indices{};
+        std::vector<Model::drawRange> ranges{};
+        std::vector<Model::lodDraw> lods{};         //  one per level of the view(a single level when it has none)
+    };
+    static void pack(const Model::bufferView& bView, Result& out);
+};
+
+}   //  namespace VULKVULK
+
+#endif
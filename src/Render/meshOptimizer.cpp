@@ -0,0 +1,171 @@
+#include "meshOptimizer.h"
+
+#include <algorithm>
+#include <ostream>
+#include <limits>
+
+namespace VULKVULK{
+
+MeshOptimizer::CacheStats MeshOptimizer::analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize){
+    CacheStats stats{};
+    if(indexCount < 3){
+        return stats;
+    }
+    //  FIFO cache : vertex is a hit if it went in less than "cacheSize" misses ago
+    std::vector<size_t> insertedAt(vertexCount, std::numeric_limits<size_t>::max());
+    std::vector<bool> used(vertexCount, false);
+    size_t misses = 0;
+    size_t uniqueUsed = 0;
+    for(size_t i = 0; i < indexCount; i++){
+        uint32_t v = indices[i];
+        if(insertedAt[v] == std::numeric_limits<size_t>::max() || misses - insertedAt[v] >= cacheSize){
+            insertedAt[v] = misses;
+            misses++;
+        }
+        if(!used[v]){
+            used[v] = true;
+            uniqueUsed++;
+        }
+    }
+    stats.acmr = float(misses) / float(indexCount / 3);
+    stats.atvr = uniqueUsed > 0 ? float(misses) / float(uniqueUsed) : 0.0f;
+    return stats;
+}
+
+void MeshOptimizer::optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize){
+    const size_t triangleCount = indexCount / 3;
+    if(triangleCount == 0 || vertexCount == 0){
+        return;
+    }
+
+    //  vertex -> triangle adjacency in CSR form
+    std::vector<uint32_t> liveTriangles(vertexCount, 0);
+    for(size_t i = 0; i < triangleCount * 3; i++){
+        liveTriangles[indices[i]]++;
+    }
+    std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+    for(size_t v = 0; v < vertexCount; v++){
+        adjacencyOffset[v + 1] = adjacencyOffset[v] + liveTriangles[v];
+    }
+    std::vector<uint32_t> adjacency(adjacencyOffset.back());
+    {
+        std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+        for(size_t t = 0; t < triangleCount; t++){
+            for(int k = 0; k < 3; k++){
+                adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+            }
+        }
+    }
+
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<int64_t> cacheTime(vertexCount, 0);
+    std::vector<uint32_t> deadEnd;          //  recently touched vertices, first place to look when fanning stops
+    std::vector<uint32_t> candidates;
+    int64_t timeStamp = cacheSize + 1;
+    size_t cursor = 0;                      //  linear scan fallback when dead end stack is empty
+    int64_t fanning = 0;
+
+    while(fanning >= 0){
+        candidates.clear();
+        const uint32_t f = static_cast<uint32_t>(fanning);
+        for(uint32_t a = adjacencyOffset[f]; a < adjacencyOffset[f + 1]; a++){
+            uint32_t t = adjacency[a];
+            if(emitted[t]){
+                continue;
+            }
+            for(int k = 0; k < 3; k++){
+                uint32_t v = indices[t * 3 + k];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+                if(timeStamp - cacheTime[v] > int64_t(cacheSize)){
+                    cacheTime[v] = timeStamp++;
+                }
+            }
+            emitted[t] = true;
+        }
+
+        //  next fanning vertex : one still in cache after emitting all of its triangles, oldest first
+        int64_t next = -1;
+        int64_t bestPriority = -1;
+        for(uint32_t v : candidates){
+            if(liveTriangles[v] == 0){
+                continue;
+            }
+            int64_t priority = 0;
+            if(timeStamp - cacheTime[v] + 2 * int64_t(liveTriangles[v]) <= int64_t(cacheSize)){
+                priority = timeStamp - cacheTime[v];
+            }
+            if(priority > bestPriority){
+                bestPriority = priority;
+                next = v;
+            }
+        }
+        if(next < 0){
+            while(!deadEnd.empty()){
+                uint32_t v = deadEnd.back();
+                deadEnd.pop_back();
+                if(liveTriangles[v] > 0){
+                    next = v;
+                    break;
+                }
+            }
+        }
+        if(next < 0){
+            while(cursor < vertexCount && liveTriangles[cursor] == 0){
+                cursor++;
+            }
+            if(cursor < vertexCount){
+                next = static_cast<int64_t>(cursor);
+            }
+        }
+        fanning = next;
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+
+void MeshOptimizer::optimizeVertexFetch(Model::bufferData& bData){
+    constexpr uint32_t UNUSED = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> remap(bData.vertices.size(), UNUSED);
+    std::vector<Model::Vertex> reordered;
+    reordered.reserve(bData.vertices.size());
+    for(auto& index : bData.indices){
+        if(remap[index] == UNUSED){
+            remap[index] = static_cast<uint32_t>(reordered.size());
+            reordered.push_back(bData.vertices[index]);
+        }
+        index = remap[index];
+    }
+    bData.vertices = std::move(reordered);
+}
+
+void MeshOptimizer::optimize(Model::bufferData& bData, std::ostream& log, bool logStats){
+    std::vector<Model::lodLevel> levels = bData.lods;
+    if(levels.empty()){
+        levels.push_back({0, static_cast<uint32_t>(bData.indices.size()), 0.0f});
+    }
+    const Model::lodLevel& base = levels.front();
+    CacheStats before = analyzeVertexCache(bData.indices.data() + base.firstIndex, base.indexCount, bData.vertices.size());
+    //  per submesh when there are materials -> triangles never cross into another material's range
+    if(bData.submeshes.empty()){
+        for(const auto& level : levels){
+            optimizeVertexCache(bData.indices.data() + level.firstIndex, level.indexCount, bData.vertices.size());
+        }
+    }
+    for(const auto& submesh : bData.submeshes){
+        optimizeVertexCache(bData.indices.data() + submesh.firstIndex, submesh.indexCount, bData.vertices.size());
+    }
+    //  first use over the whole stream -> level 0 decides the order, coarser levels reuse its vertices
+    optimizeVertexFetch(bData);
+    if(logStats){
+        CacheStats after = analyzeVertexCache(bData.indices.data() + base.firstIndex, base.indexCount, bData.vertices.size());
+        log << "Vertex cache(FIFO " << CACHE_SIZE << ") ACMR : " << before.acmr << " -> " << after.acmr
+                  << ", ATVR : " << before.atvr << " -> " << after.atvr << "\n";
+    }
+}
+
+}   //  namespace VULKVULK
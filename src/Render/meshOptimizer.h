@@ -0,0 +1,36 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include "model.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+namespace VULKVULK{
+
+//  Post load reordering passes -> same triangles, better post-transform cache reuse and vertex fetch locality
+class MeshOptimizer{
+public:
+    //  Simulated FIFO post-transform cache size, matches what most desktop GPUs behave like
+    static constexpr uint32_t CACHE_SIZE = 16;
+
+    struct CacheStats{
+        float acmr = 0.0f;  //  average cache miss ratio : transformed vertices per triangle (0.5 ideal, 3.0 worst)
+        float atvr = 0.0f;  //  average transform to vertex ratio : transformed vertices per unique vertex (1.0 ideal)
+    };
+    static CacheStats analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = CACHE_SIZE);
+
+    //  Tipsify(Sander, Nehab, Barczak 2007) : fans around a vertex while it is still in cache, linear time
+    static void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = CACHE_SIZE);
+    //  Reorders vertices in order of first use by the index buffer and remaps indices, unreferenced vertices are dropped
+    static void optimizeVertexFetch(Model::bufferData& bData);
+
+    //  Both passes above, cache order per LOD level(per submesh with materials)
+    //  writes ACMR/ATVR(of level 0) before and after to "log" when "logStats" -> runs on pool workers, never std::cout
+    static void optimize(Model::bufferData& bData, std::ostream& log, bool logStats = true);
+};
+
+}   //  namespace VULKVULK
+
+#endif
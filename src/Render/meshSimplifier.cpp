@@ -0,0 +1,388 @@
+#include "meshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+namespace VULKVULK{
+
+namespace{
+
+//  symmetric 4x4 quadric in double, "weight" = accumulated area so evaluate / weight is a mean squared distance
+struct Quadric{
+    double a00 = 0, a11 = 0, a22 = 0, a01 = 0, a12 = 0, a02 = 0;
+    double b0 = 0, b1 = 0, b2 = 0;
+    double c = 0;
+    double weight = 0;
+
+    static Quadric fromPlane(const glm::dvec3& n, double d, double weight){
+        Quadric q{};
+        q.a00 = weight * n.x * n.x; q.a11 = weight * n.y * n.y; q.a22 = weight * n.z * n.z;
+        q.a01 = weight * n.x * n.y; q.a12 = weight * n.y * n.z; q.a02 = weight * n.x * n.z;
+        q.b0 = weight * n.x * d; q.b1 = weight * n.y * d; q.b2 = weight * n.z * d;
+        q.c = weight * d * d;
+        q.weight = weight;
+        return q;
+    }
+    Quadric& operator+=(const Quadric& o){
+        a00 += o.a00; a11 += o.a11; a22 += o.a22; a01 += o.a01; a12 += o.a12; a02 += o.a02;
+        b0 += o.b0; b1 += o.b1; b2 += o.b2; c += o.c; weight += o.weight;
+        return *this;
+    }
+    double evaluate(const glm::dvec3& p) const{
+        double r = a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z
+                 + 2.0 * (a01 * p.x * p.y + a12 * p.y * p.z + a02 * p.x * p.z)
+                 + 2.0 * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+        return std::max(r, 0.0);
+    }
+};
+
+//  border planes are weighted up so the silhouette of open meshes(vase rims) survives
+constexpr double BORDER_WEIGHT = 10.0;
+
+struct Collapse{
+    uint32_t from;
+    uint32_t to;
+    float error;
+};
+
+uint64_t edgeKey(uint32_t a, uint32_t b){
+    return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+}
+
+//  Everything that only depends on level 0 -> built once per mesh, reused for every level of the chain
+class SimplifyContext{
+public:
+    SimplifyContext(const Model::bufferView& bView) : bView(bView){
+        const uint32_t vertexCount = bView.vertexCount;
+        //  weld by position, wedges of one position form a ring
+        positionId.resize(vertexCount);
+        nextWedge.resize(vertexCount);
+        std::unordered_map<glm::vec3, uint32_t> firstAt{};
+        firstAt.reserve(vertexCount);
+        for(uint32_t v = 0; v < vertexCount; v++){
+            auto inserted = firstAt.emplace(bView.vertices[v].position, v);
+            uint32_t first = inserted.first->second;
+            positionId[v] = first;
+            if(inserted.second){
+                nextWedge[v] = v;
+            }
+            else{
+                nextWedge[v] = nextWedge[first];
+                nextWedge[first] = v;
+            }
+        }
+
+        //  border = edge used by a single triangle
+        std::vector<uint64_t> edges;
+        edges.reserve(bView.indexCount);
+        forEachPositionTriangle([&](uint32_t a, uint32_t b, uint32_t c){
+            edges.push_back(edgeKey(a, b));
+            edges.push_back(edgeKey(b, c));
+            edges.push_back(edgeKey(c, a));
+        });
+        std::sort(edges.begin(), edges.end());
+        border.assign(vertexCount, false);
+
+        quadrics.assign(vertexCount, Quadric{});
+        forEachPositionTriangle([&](uint32_t a, uint32_t b, uint32_t c){
+            glm::dvec3 p0 = position(a), p1 = position(b), p2 = position(c);
+            glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+            double length = glm::length(normal);
+            if(length <= 0.0){
+                return;
+            }
+            normal /= length;
+            Quadric q = Quadric::fromPlane(normal, -glm::dot(normal, p0), length * 0.5);
+            quadrics[a] += q;
+            quadrics[b] += q;
+            quadrics[c] += q;
+
+            const uint32_t corners[3] = {a, b, c};
+            for(int k = 0; k < 3; k++){
+                uint32_t e0 = corners[k], e1 = corners[(k + 1) % 3];
+                auto range = std::equal_range(edges.begin(), edges.end(), edgeKey(e0, e1));
+                if(range.second - range.first != 1){
+                    continue;
+                }
+                border[e0] = border[e1] = true;
+                glm::dvec3 edge = position(e1) - position(e0);
+                glm::dvec3 planeNormal = glm::cross(edge, normal);
+                double planeLength = glm::length(planeNormal);
+                if(planeLength <= 0.0){
+                    continue;
+                }
+                planeNormal /= planeLength;
+                Quadric bq = Quadric::fromPlane(planeNormal, -glm::dot(planeNormal, position(e0)), glm::dot(edge, edge) * BORDER_WEIGHT);
+                quadrics[e0] += bq;
+                quadrics[e1] += bq;
+            }
+        });
+    }
+
+    float simplify(size_t targetIndexCount, float maxError, std::vector<uint32_t>& out) const{
+        //  current triangles as wedge(vertex) ids, collapses happen on position ids
+        std::vector<uint32_t> current(bView.indices, bView.indices + bView.indexCount - bView.indexCount % 3);
+        std::vector<Quadric> q = quadrics;
+        std::vector<uint32_t> remap(bView.vertexCount);
+        std::vector<bool> locked(bView.vertexCount);
+        std::vector<uint32_t> adjacencyOffset(bView.vertexCount + 1);
+        std::vector<uint32_t> adjacency;
+        std::vector<Collapse> collapses;
+        float reached = 0.0f;
+
+        while(current.size() > targetIndexCount){
+            const size_t triangleCount = current.size() / 3;
+            //  position -> triangles, rebuilt every pass
+            std::fill(adjacencyOffset.begin(), adjacencyOffset.end(), 0);
+            for(uint32_t v : current){
+                adjacencyOffset[positionId[v] + 1]++;
+            }
+            for(size_t i = 0; i < bView.vertexCount; i++){
+                adjacencyOffset[i + 1] += adjacencyOffset[i];
+            }
+            adjacency.resize(current.size());
+            {
+                std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+                for(size_t i = 0; i < current.size(); i++){
+                    adjacency[fill[positionId[current[i]]]++] = static_cast<uint32_t>(i / 3);
+                }
+            }
+
+            //  unique edges between positions with the cheaper direction
+            std::vector<uint64_t> edges;
+            edges.reserve(current.size());
+            for(size_t t = 0; t < triangleCount; t++){
+                for(int k = 0; k < 3; k++){
+                    uint32_t a = positionId[current[t * 3 + k]], b = positionId[current[t * 3 + (k + 1) % 3]];
+                    if(a != b){
+                        edges.push_back(edgeKey(a, b));
+                    }
+                }
+            }
+            std::sort(edges.begin(), edges.end());
+            collapses.clear();
+            for(size_t i = 0; i < edges.size();){
+                size_t j = i + 1;
+                while(j < edges.size() && edges[j] == edges[i]){
+                    j++;
+                }
+                const bool borderEdge = j - i == 1;
+                const uint32_t a = uint32_t(edges[i] >> 32), b = uint32_t(edges[i] & 0xFFFFFFFF);
+                i = j;
+                Quadric sum = q[a];
+                sum += q[b];
+                auto cost = [&](uint32_t from, uint32_t to){
+                    //  border positions may only slide along the border
+                    if(border[from] && !borderEdge){
+                        return std::numeric_limits<float>::infinity();
+                    }
+                    return float(std::sqrt(sum.evaluate(position(to)) / std::max(sum.weight, 1e-30)));
+                };
+                float ab = cost(a, b), ba = cost(b, a);
+                if(std::min(ab, ba) <= maxError){
+                    collapses.push_back(ab <= ba ? Collapse{a, b, ab} : Collapse{b, a, ba});
+                }
+            }
+            if(collapses.empty()){
+                break;
+            }
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y){ return x.error < y.error; });
+
+            //  independent collapses only : every triangle touched at most once per pass
+            for(size_t v = 0; v < bView.vertexCount; v++){
+                remap[v] = static_cast<uint32_t>(v);
+            }
+            std::fill(locked.begin(), locked.end(), false);
+            size_t remaining = triangleCount;
+            size_t applied = 0;
+            for(const Collapse& collapse : collapses){
+                if(remaining * 3 <= targetIndexCount){
+                    break;
+                }
+                if(locked[collapse.from] || locked[collapse.to] || flips(current, adjacency, adjacencyOffset, collapse)){
+                    continue;
+                }
+                for(uint32_t a = adjacencyOffset[collapse.from]; a < adjacencyOffset[collapse.from + 1]; a++){
+                    uint32_t t = adjacency[a];
+                    bool removed = false;
+                    for(int k = 0; k < 3; k++){
+                        uint32_t p = positionId[current[t * 3 + k]];
+                        locked[p] = true;
+                        removed |= p == collapse.to;
+                    }
+                    remaining -= removed ? 1 : 0;
+                }
+                uint32_t wedge = collapse.from;
+                do{
+                    remap[wedge] = closestWedge(collapse.to, wedge);
+                    wedge = nextWedge[wedge];
+                }while(wedge != collapse.from);
+                q[collapse.to] += q[collapse.from];
+                reached = std::max(reached, collapse.error);
+                applied++;
+            }
+            if(applied == 0){
+                break;
+            }
+
+            size_t write = 0;
+            for(size_t t = 0; t < triangleCount; t++){
+                uint32_t a = remap[current[t * 3]], b = remap[current[t * 3 + 1]], c = remap[current[t * 3 + 2]];
+                if(positionId[a] == positionId[b] || positionId[b] == positionId[c] || positionId[c] == positionId[a]){
+                    continue;
+                }
+                current[write++] = a;
+                current[write++] = b;
+                current[write++] = c;
+            }
+            current.resize(write);
+        }
+        out = std::move(current);
+        return reached;
+    }
+
+    float radius() const{
+        if(bView.vertexCount == 0){
+            return 0.0f;
+        }
+        glm::vec3 minPos = bView.vertices[0].position, maxPos = minPos;
+        for(uint32_t v = 1; v < bView.vertexCount; v++){
+            minPos = glm::min(minPos, bView.vertices[v].position);
+            maxPos = glm::max(maxPos, bView.vertices[v].position);
+        }
+        return glm::length(maxPos - minPos) * 0.5f;
+    }
+
+private:
+    //  triangles of level 0 as position ids
+    template <typename F>
+    void forEachPositionTriangle(F&& fn) const{
+        for(size_t i = 0; i + 2 < bView.indexCount; i += 3){
+            fn(positionId[bView.indices[i]], positionId[bView.indices[i + 1]], positionId[bView.indices[i + 2]]);
+        }
+    }
+
+    glm::dvec3 position(uint32_t v) const{
+        return glm::dvec3{bView.vertices[v].position};
+    }
+
+    //  moving "from" onto "to" must not turn any surviving triangle around
+    bool flips(const std::vector<uint32_t>& current, const std::vector<uint32_t>& adjacency,
+               const std::vector<uint32_t>& adjacencyOffset, const Collapse& collapse) const{
+        for(uint32_t a = adjacencyOffset[collapse.from]; a < adjacencyOffset[collapse.from + 1]; a++){
+            uint32_t t = adjacency[a];
+            glm::dvec3 before[3], after[3];
+            bool removed = false;
+            for(int k = 0; k < 3; k++){
+                uint32_t p = positionId[current[t * 3 + k]];
+                removed |= p == collapse.to;
+                before[k] = position(p);
+                after[k] = p == collapse.from ? position(collapse.to) : before[k];
+            }
+            if(removed){
+                continue;
+            }
+            glm::dvec3 n0 = glm::cross(before[1] - before[0], before[2] - before[0]);
+            glm::dvec3 n1 = glm::cross(after[1] - after[0], after[2] - after[0]);
+            if(glm::dot(n0, n1) <= 0.0){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //  wedge of "to" whose attributes are closest to "wedge" -> keeps uv/normal seams on the right side
+    uint32_t closestWedge(uint32_t to, uint32_t wedge) const{
+        const Model::Vertex& source = bView.vertices[wedge];
+        uint32_t best = to;
+        float bestDistance = std::numeric_limits<float>::max();
+        uint32_t candidate = to;
+        do{
+            const Model::Vertex& target = bView.vertices[candidate];
+            glm::vec3 dn = target.normal - source.normal, dc = target.color - source.color;
+            glm::vec2 duv = target.uv - source.uv;
+            float distance = glm::dot(dn, dn) + glm::dot(dc, dc) + glm::dot(duv, duv);
+            if(distance < bestDistance){
+                bestDistance = distance;
+                best = candidate;
+            }
+            candidate = nextWedge[candidate];
+        }while(candidate != to);
+        return best;
+    }
+
+    const Model::bufferView& bView;
+    std::vector<uint32_t> positionId;   //  first vertex with the same position
+    std::vector<uint32_t> nextWedge;    //  ring of vertices sharing a position
+    std::vector<bool> border;           //  per position id
+    std::vector<Quadric> quadrics;      //  per position id
+};
+
+}   //  namespace
+
+float MeshSimplifier::simplify(const Model::bufferView& bView, size_t targetIndexCount, float maxError, std::vector<uint32_t>& out){
+    SimplifyContext context{bView};
+    return context.simplify(targetIndexCount, maxError, out);
+}
+
+void MeshSimplifier::buildLodChain(Model::bufferData& bData, const std::vector<float>& ratios, float maxRelativeError){
+    bData.lods.clear();
+    if(bData.indices.size() < 3){
+        return;
+    }
+    //  every level simplifies level 0 -> errors are measured against the real surface, not the previous level
+    const std::vector<uint32_t> base = bData.indices;
+    Model::bufferView baseView = bData.view();
+    baseView.indices = base.data();
+
+    //  materials simplify on their own -> every level keeps one range per material, edges between two materials
+    //  are open borders to both so the seam stays where it is
+    std::vector<Model::submesh> parts = bData.submeshes;
+    if(parts.empty()){
+        parts.push_back({0, static_cast<uint32_t>(base.size()), 0});
+    }
+    std::vector<std::vector<std::vector<uint32_t>>> levels(parts.size());     //  [part][ratio]
+    std::vector<std::vector<float>> errors(parts.size());
+    float maxError = 0.0f;
+    for(size_t p = 0; p < parts.size(); p++){
+        Model::bufferView partView = baseView;
+        partView.indices = base.data() + parts[p].firstIndex;
+        partView.indexCount = parts[p].indexCount;
+        SimplifyContext context{partView};
+        if(p == 0){
+            maxError = maxRelativeError * context.radius();     //  radius is over every vertex, not just the part's
+        }
+        for(float ratio : ratios){
+            size_t target = static_cast<size_t>(double(parts[p].indexCount / 3) * ratio) * 3;
+            errors[p].push_back(context.simplify(target, maxError, levels[p].emplace_back()));
+        }
+    }
+
+    bData.lods.push_back({0, static_cast<uint32_t>(base.size()), 0.0f});
+    for(size_t r = 0; r < ratios.size(); r++){
+        size_t levelSize = 0;
+        float error = 0.0f;
+        for(size_t p = 0; p < parts.size(); p++){
+            levelSize += levels[p][r].size();
+            error = std::max(error, errors[p][r]);
+        }
+        //  less than 10% off the previous level is not worth a level
+        if(levelSize == 0 || levelSize * 10 > size_t(bData.lods.back().indexCount) * 9){
+            break;
+        }
+        bData.lods.push_back({static_cast<uint32_t>(bData.indices.size()), static_cast<uint32_t>(levelSize), error});
+        for(size_t p = 0; p < parts.size(); p++){
+            if(levels[p][r].empty()){
+                continue;
+            }
+            if(!bData.submeshes.empty()){
+                bData.submeshes.push_back({static_cast<uint32_t>(bData.indices.size()), static_cast<uint32_t>(levels[p][r].size()), parts[p].material});
+            }
+            bData.indices.insert(bData.indices.end(), levels[p][r].begin(), levels[p][r].end());
+        }
+    }
+}
+
+}   //  namespace VULKVULK
@@ -0,0 +1,29 @@
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include "model.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace VULKVULK{
+
+//  Quadric error edge collapse(Garland & Heckbert) restricted to half edge collapses
+//  -> a vertex is always collapsed onto an existing neighbour, so every level keeps indexing the original vertex array
+//  Vertices sharing a position(uv/normal seams, flat shading) collapse together, corners pick the wedge of the
+//  target position with the closest attributes. Open borders only slide along themselves.
+class MeshSimplifier{
+public:
+    //  Simplifies the triangle list until "targetIndexCount" or until the next collapse would exceed "maxError"
+    //  Returns the error reached, as a model space distance
+    static float simplify(const Model::bufferView& bView, size_t targetIndexCount, float maxError, std::vector<uint32_t>& out);
+
+    //  Level 0 = current indices, then one level per ratio(of level 0 triangle count) appended to bData.indices
+    //  "maxRelativeError" is relative to the mesh radius. The chain stops early once a level no longer gets smaller
+    //  Submeshes simplify one by one and every level gets its own submeshes appended to bData.submeshes
+    static void buildLodChain(Model::bufferData& bData, const std::vector<float>& ratios, float maxRelativeError);
+};
+
+}   //  namespace VULKVULK
+
+#endif
@@ -0,0 +1,269 @@
+#include "meshletBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+namespace VULKVULK{
+
+namespace{
+
+//  how much a normal off the cluster axis costs compared to adding one vertex
+constexpr float CONE_WEIGHT = 0.5f;
+//  spread past ~84 degrees -> cone would never cull anything
+constexpr float MIN_CONE_DOT = 0.1f;
+
+uint64_t edgeKey(uint32_t a, uint32_t b){
+    return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+}
+
+glm::vec3 triangleNormal(const Model::bufferData& bData, const uint32_t* tri){
+    const glm::vec3& p0 = bData.vertices[tri[0]].position;
+    glm::vec3 normal = glm::cross(bData.vertices[tri[1]].position - p0, bData.vertices[tri[2]].position - p0);
+    float length = glm::length(normal);
+    return length > 0.0f ? normal / length : glm::vec3{0.0f};
+}
+
+//  position ids -> welded adjacency for flat shaded meshes where no two triangles share a vertex
+std::vector<uint32_t> weldPositions(const Model::bufferData& bData){
+    std::vector<uint32_t> positionId(bData.vertices.size());
+    std::unordered_map<glm::vec3, uint32_t> firstAt{};
+    firstAt.reserve(bData.vertices.size());
+    for(uint32_t v = 0; v < bData.vertices.size(); v++){
+        positionId[v] = firstAt.emplace(bData.vertices[v].position, v).first->second;
+    }
+    return positionId;
+}
+
+//  closed = every welded edge of level 0 is shared by exactly two triangles
+bool isClosed(const Model::bufferData& bData, const std::vector<uint32_t>& positionId, const Model::lodLevel& level){
+    std::vector<uint64_t> edges;
+    edges.reserve(level.indexCount);
+    for(uint32_t i = level.firstIndex; i + 2 < level.firstIndex + level.indexCount; i += 3){
+        for(int k = 0; k < 3; k++){
+            edges.push_back(edgeKey(positionId[bData.indices[i + k]], positionId[bData.indices[i + (k + 1) % 3]]));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    for(size_t i = 0; i < edges.size(); i += 2){
+        if(i + 1 >= edges.size() || edges[i] != edges[i + 1] || (i + 2 < edges.size() && edges[i + 2] == edges[i])){
+            return false;
+        }
+    }
+    return true;
+}
+
+void computeBounds(const Model::bufferData& bData, const uint32_t* indices, bool useCone, Model::meshlet& cluster){
+    const uint32_t* first = indices + cluster.firstIndex;
+    const uint32_t count = cluster.triangleCount * 3;
+    glm::vec3 minPos = bData.vertices[first[0]].position, maxPos = minPos;
+    for(uint32_t i = 1; i < count; i++){
+        minPos = glm::min(minPos, bData.vertices[first[i]].position);
+        maxPos = glm::max(maxPos, bData.vertices[first[i]].position);
+    }
+    cluster.center = (minPos + maxPos) * 0.5f;
+    cluster.radius = 0.0f;
+    for(uint32_t i = 0; i < count; i++){
+        cluster.radius = std::max(cluster.radius, glm::length(bData.vertices[first[i]].position - cluster.center));
+    }
+
+    cluster.coneCutoff = 2.0f;
+    cluster.coneApex = cluster.center;
+    cluster.coneAxis = glm::vec3{0.0f};
+    if(!useCone){
+        return;
+    }
+    glm::vec3 axis{0.0f};
+    for(uint32_t t = 0; t < cluster.triangleCount; t++){
+        axis += triangleNormal(bData, first + t * 3);
+    }
+    float axisLength = glm::length(axis);
+    if(!(axisLength > 0.0f)){
+        return;
+    }
+    axis /= axisLength;
+    float minDot = 1.0f;
+    for(uint32_t t = 0; t < cluster.triangleCount; t++){
+        glm::vec3 normal = triangleNormal(bData, first + t * 3);
+        if(normal == glm::vec3{0.0f}){
+            continue;     //  degenerate triangles are invisible either way
+        }
+        minDot = std::min(minDot, glm::dot(axis, normal));
+    }
+    if(minDot < MIN_CONE_DOT){
+        return;
+    }
+    //  apex = center - axis * t, pushed back until it sits behind every triangle plane
+    float maxT = 0.0f;
+    for(uint32_t t = 0; t < cluster.triangleCount; t++){
+        glm::vec3 normal = triangleNormal(bData, first + t * 3);
+        if(normal == glm::vec3{0.0f}){
+            continue;
+        }
+        const glm::vec3& p0 = bData.vertices[first[t * 3]].position;
+        maxT = std::max(maxT, glm::dot(cluster.center - p0, normal) / glm::dot(axis, normal));
+    }
+    cluster.coneAxis = axis;
+    cluster.coneApex = cluster.center - axis * maxT;
+    cluster.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+}
+
+}   //  namespace
+
+void MeshletBuilder::build(Model::bufferData& bData){
+    bData.meshlets.clear();
+    if(bData.indices.size() < 3){
+        return;
+    }
+    if(bData.lods.empty()){
+        bData.lods.push_back({0, static_cast<uint32_t>(bData.indices.size()), 0.0f});
+    }
+    const std::vector<uint32_t> positionId = weldPositions(bData);
+    const bool closed = isClosed(bData, positionId, bData.lods.front());
+
+    std::vector<uint32_t> adjacencyOffset(bData.vertices.size() + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<uint32_t> vertexStamp(bData.vertices.size(), std::numeric_limits<uint32_t>::max());
+    std::vector<uint32_t> reordered;
+    std::vector<uint32_t> candidates;
+
+    for(auto& level : bData.lods){
+        const uint32_t* indices = bData.indices.data() + level.firstIndex;
+        const uint32_t triangleCount = level.indexCount / 3;
+        level.firstMeshlet = static_cast<uint32_t>(bData.meshlets.size());
+
+        //  position id -> triangles of this level
+        std::fill(adjacencyOffset.begin(), adjacencyOffset.end(), 0);
+        for(uint32_t i = 0; i < triangleCount * 3; i++){
+            adjacencyOffset[positionId[indices[i]] + 1]++;
+        }
+        for(size_t i = 0; i + 1 < adjacencyOffset.size(); i++){
+            adjacencyOffset[i + 1] += adjacencyOffset[i];
+        }
+        adjacency.resize(triangleCount * 3);
+        {
+            std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+            for(uint32_t i = 0; i < triangleCount * 3; i++){
+                adjacency[fill[positionId[indices[i]]]++] = i / 3;
+            }
+        }
+        std::vector<glm::vec3> normals(triangleCount);
+        for(uint32_t t = 0; t < triangleCount; t++){
+            normals[t] = triangleNormal(bData, indices + t * 3);
+        }
+        //  submesh of every triangle -> clusters only grow inside their material, meshlets stay inside one submesh
+        std::vector<uint32_t> submeshOf(triangleCount, 0);
+        for(uint32_t p = 0; p < bData.submeshes.size(); p++){
+            const Model::submesh& part = bData.submeshes[p];
+            if(part.firstIndex >= level.firstIndex && part.firstIndex < level.firstIndex + level.indexCount){
+                const uint32_t first = (part.firstIndex - level.firstIndex) / 3;
+                std::fill_n(submeshOf.begin() + first, std::min(part.indexCount / 3, triangleCount - first), p);
+            }
+        }
+
+        std::vector<bool> used(triangleCount, false);
+        reordered.clear();
+        reordered.reserve(triangleCount * 3);
+        uint32_t cursor = 0;
+        while(true){
+            while(cursor < triangleCount && used[cursor]){
+                cursor++;
+            }
+            if(cursor == triangleCount){
+                break;
+            }
+            Model::meshlet cluster{};
+            cluster.firstIndex = level.firstIndex + static_cast<uint32_t>(reordered.size());
+            const uint32_t stamp = static_cast<uint32_t>(bData.meshlets.size());
+            glm::vec3 normalSum{0.0f};
+            candidates.clear();
+
+            auto newVertices = [&](uint32_t t){
+                uint32_t count = 0;
+                for(int k = 0; k < 3; k++){
+                    uint32_t v = indices[t * 3 + k];
+                    bool repeated = (k > 0 && v == indices[t * 3]) || (k > 1 && v == indices[t * 3 + 1]);
+                    count += (vertexStamp[v] != stamp && !repeated) ? 1 : 0;
+                }
+                return count;
+            };
+            auto add = [&](uint32_t t){
+                used[t] = true;
+                for(int k = 0; k < 3; k++){
+                    uint32_t v = indices[t * 3 + k];
+                    if(vertexStamp[v] != stamp){
+                        vertexStamp[v] = stamp;
+                        cluster.vertexCount++;
+                    }
+                    reordered.push_back(v);
+                    uint32_t p = positionId[v];
+                    for(uint32_t a = adjacencyOffset[p]; a < adjacencyOffset[p + 1]; a++){
+                        if(!used[adjacency[a]] && submeshOf[adjacency[a]] == submeshOf[t]){
+                            candidates.push_back(adjacency[a]);
+                        }
+                    }
+                }
+                normalSum += normals[t];
+                cluster.triangleCount++;
+            };
+
+            add(cursor);
+            while(cluster.triangleCount < MAX_TRIANGLES){
+                glm::vec3 axis = glm::length(normalSum) > 0.0f ? glm::normalize(normalSum) : glm::vec3{0.0f};
+                float bestScore = std::numeric_limits<float>::max();
+                uint32_t best = std::numeric_limits<uint32_t>::max();
+                size_t write = 0;
+                for(size_t c = 0; c < candidates.size(); c++){
+                    uint32_t t = candidates[c];
+                    if(used[t]){
+                        continue;
+                    }
+                    candidates[write++] = t;    //  compact lazily, used ones drop out
+                    uint32_t extra = newVertices(t);
+                    if(cluster.vertexCount + extra > MAX_VERTICES){
+                        continue;
+                    }
+                    float score = float(extra) + CONE_WEIGHT * (1.0f - glm::dot(normals[t], axis));
+                    if(score < bestScore){
+                        bestScore = score;
+                        best = t;
+                    }
+                }
+                candidates.resize(write);
+                if(best == std::numeric_limits<uint32_t>::max()){
+                    break;
+                }
+                add(best);
+            }
+            bData.meshlets.push_back(cluster);
+        }
+        std::copy(reordered.begin(), reordered.end(), bData.indices.begin() + level.firstIndex);
+        level.meshletCount = static_cast<uint32_t>(bData.meshlets.size()) - level.firstMeshlet;
+        for(uint32_t m = level.firstMeshlet; m < level.firstMeshlet + level.meshletCount; m++){
+            computeBounds(bData, bData.indices.data(), closed, bData.meshlets[m]);
+        }
+    }
+}
+
+MeshletBuilder::Stats MeshletBuilder::computeStats(const std::vector<Model::meshlet>& meshlets){
+    Stats stats{};
+    stats.meshletCount = meshlets.size();
+    if(meshlets.empty()){
+        return stats;
+    }
+    size_t vertices = 0, triangles = 0, cones = 0;
+    for(const auto& cluster : meshlets){
+        vertices += cluster.vertexCount;
+        triangles += cluster.triangleCount;
+        cones += cluster.coneCutoff <= 1.0f ? 1 : 0;
+    }
+    stats.averageVertices = float(vertices) / float(meshlets.size());
+    stats.averageTriangles = float(triangles) / float(meshlets.size());
+    stats.vertexFill = stats.averageVertices / float(MAX_VERTICES);
+    stats.triangleFill = stats.averageTriangles / float(MAX_TRIANGLES);
+    stats.coneCullable = float(cones) / float(meshlets.size());
+    return stats;
+}
+
+}   //  namespace VULKVULK
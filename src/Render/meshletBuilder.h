@@ -0,0 +1,37 @@
+#ifndef MESHLET_BUILDER_H
+#define MESHLET_BUILDER_H
+
+#include "model.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace VULKVULK{
+
+//  Partitions every LOD level into meshlets of at most MAX_VERTICES unique vertices and MAX_TRIANGLES triangles
+//  Triangles of a level get reordered so each meshlet is a contiguous index range -> drawable with plain vkCmdDrawIndexed
+//  Clusters grow over position adjacency preferring triangles that add no vertex and keep the normal cone tight
+//  A cluster never leaves the submesh it started in -> submesh ranges stay contiguous and never split a meshlet
+class MeshletBuilder{
+public:
+    static constexpr uint32_t MAX_VERTICES = 64;
+    static constexpr uint32_t MAX_TRIANGLES = 124;
+
+    struct Stats{
+        size_t meshletCount = 0;
+        float averageVertices = 0.0f;
+        float averageTriangles = 0.0f;
+        float vertexFill = 0.0f;        //  averageVertices / MAX_VERTICES
+        float triangleFill = 0.0f;      //  averageTriangles / MAX_TRIANGLES
+        float coneCullable = 0.0f;      //  fraction of meshlets with a usable normal cone
+    };
+
+    //  Fills bData.meshlets and the meshlet range of every level(a single level is added when there is none)
+    //  Normal cones are only kept for closed meshes -> with culling off in the pipeline, back faces of open meshes are visible
+    static void build(Model::bufferData& bData);
+    static Stats computeStats(const std::vector<Model::meshlet>& meshlets);
+};
+
+}   //  namespace VULKVULK
+
+#endif
@@ -0,0 +1,352 @@
+#include "mipGenerator.h"
+#include "../Core/threadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MIP_GENERATOR_SSE2 1
+#endif
+
+namespace VULKVULK{
+
+namespace{
+
+//  rows per parallelFor job -> small levels run inline instead of paying for the pool
+constexpr uint32_t ROWS_PER_JOB = 32;
+constexpr uint32_t LINEAR_TO_SRGB_STEPS = 4096;
+
+struct srgbTables{
+    float toLinear[256];
+    uint8_t toSrgb[LINEAR_TO_SRGB_STEPS + 1];
+
+    srgbTables(){
+        for(uint32_t i = 0; i < 256; i++){
+            float c = i / 255.0f;
+            toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for(uint32_t i = 0; i <= LINEAR_TO_SRGB_STEPS; i++){
+            float l = static_cast<float>(i) / LINEAR_TO_SRGB_STEPS;
+            float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            toSrgb[i] = static_cast<uint8_t>(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+        }
+    }
+};
+
+const srgbTables& tables(){
+    static const srgbTables instance{};
+    return instance;
+}
+
+void forRowBands(uint32_t rows, const std::function<void(uint32_t, uint32_t)>& fn){
+    size_t bands = (rows + ROWS_PER_JOB - 1) / ROWS_PER_JOB;
+    ThreadPool::shared().parallelFor(bands, [&](size_t band){
+        uint32_t begin = static_cast<uint32_t>(band) * ROWS_PER_JOB;
+        fn(begin, std::min(rows, begin + ROWS_PER_JOB));
+    });
+}
+
+//  exact 2x2 average with rounding, 8 bit data and even source size only
+void boxHalve8(const uint8_t* src, uint32_t srcWidth, uint8_t* dst, uint32_t dstWidth, uint32_t dstHeight){
+    forRowBands(dstHeight, [&](uint32_t rowBegin, uint32_t rowEnd){
+        for(uint32_t y = rowBegin; y < rowEnd; y++){
+            const uint8_t* row0 = src + size_t(2 * y) * srcWidth * 4;
+            const uint8_t* row1 = row0 + size_t(srcWidth) * 4;
+            uint8_t* out = dst + size_t(y) * dstWidth * 4;
+            uint32_t x = 0;
+#ifdef MIP_GENERATOR_SSE2
+            //  4 source pixels of both rows -> 2 destination pixels per step
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i two = _mm_set1_epi16(2);
+            for(; x + 2 <= dstWidth; x += 2){
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+                __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+                __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+                //  horizontal neighbours sit 4 lanes apart
+                lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+                hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+                __m128i sum = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(lo, hi), two), 2);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x * 4), _mm_packus_epi16(sum, zero));
+            }
+#endif
+            for(; x < dstWidth; x++){
+                for(uint32_t c = 0; c < 4; c++){
+                    uint32_t sum = row0[x * 8 + c] + row0[x * 8 + 4 + c] + row1[x * 8 + c] + row1[x * 8 + 4 + c];
+                    out[x * 4 + c] = static_cast<uint8_t>((sum + 2) >> 2);
+                }
+            }
+        }
+    });
+}
+
+//  zeroth order modified Bessel function, series converges fast for the alphas we use
+float besselI0(float x){
+    float sum = 1.0f;
+    float term = 1.0f;
+    float half = x * 0.5f;
+    for(int k = 1; k < 32; k++){
+        term *= (half / k) * (half / k);
+        sum += term;
+        if(term < sum * 1e-7f){
+            break;
+        }
+    }
+    return sum;
+}
+
+//  source taps of every destination pixel along one axis
+struct filterTaps{
+    std::vector<uint32_t> first;        //  per destination pixel : offset into index/weight
+    std::vector<uint32_t> index;
+    std::vector<float> weight;
+};
+
+filterTaps buildTaps(uint32_t srcSize, uint32_t dstSize, MipFilter filter){
+    filterTaps taps{};
+    taps.first.reserve(dstSize + 1);
+    const float scale = static_cast<float>(srcSize) / dstSize;
+    for(uint32_t x = 0; x < dstSize; x++){
+        taps.first.push_back(static_cast<uint32_t>(taps.index.size()));
+        size_t begin = taps.weight.size();
+        float total = 0.0f;
+        if(filter == MipFilter::BOX){
+            //  overlap of the destination pixel's footprint with each source pixel -> exact for odd sizes too
+            float left = x * scale;
+            float right = left + scale;
+            for(uint32_t s = static_cast<uint32_t>(left); s < srcSize && static_cast<float>(s) < right; s++){
+                float w = std::min(right, s + 1.0f) - std::max(left, static_cast<float>(s));
+                if(w > 0.0f){
+                    taps.index.push_back(s);
+                    taps.weight.push_back(w);
+                    total += w;
+                }
+            }
+        }
+        else{
+            const float radius = MipGenerator::KAISER_RADIUS * scale;
+            const float center = (x + 0.5f) * scale - 0.5f;
+            const float norm = besselI0(MipGenerator::KAISER_ALPHA);
+            int low = static_cast<int>(std::ceil(center - radius));
+            int high = static_cast<int>(std::floor(center + radius));
+            for(int s = low; s <= high; s++){
+                float d = (s - center) / scale;
+                float t = d / MipGenerator::KAISER_RADIUS;
+                float window = besselI0(MipGenerator::KAISER_ALPHA * std::sqrt(std::max(0.0f, 1.0f - t * t))) / norm;
+                float sinc = std::abs(d) < 1e-5f ? 1.0f : std::sin(3.14159265f * d) / (3.14159265f * d);
+                float w = sinc * window;
+                if(w == 0.0f){
+                    continue;
+                }
+                //  clamp addressing -> edge pixels absorb the taps that fall outside
+                taps.index.push_back(static_cast<uint32_t>(std::clamp(s, 0, static_cast<int>(srcSize) - 1)));
+                taps.weight.push_back(w);
+                total += w;
+            }
+        }
+        for(size_t i = begin; i < taps.weight.size(); i++){
+            taps.weight[i] /= total;
+        }
+    }
+    taps.first.push_back(static_cast<uint32_t>(taps.index.size()));
+    return taps;
+}
+
+//  separable resample of a linear float RGBA image, horizontal then vertical
+std::vector<float> resample(const std::vector<float>& src, uint32_t srcWidth, uint32_t srcHeight,
+                            uint32_t dstWidth, uint32_t dstHeight, MipFilter filter){
+    filterTaps horizontal = buildTaps(srcWidth, dstWidth, filter);
+    filterTaps vertical = buildTaps(srcHeight, dstHeight, filter);
+
+    std::vector<float> temp(size_t(dstWidth) * srcHeight * 4);
+    forRowBands(srcHeight, [&](uint32_t rowBegin, uint32_t rowEnd){
+        for(uint32_t y = rowBegin; y < rowEnd; y++){
+            const float* in = src.data() + size_t(y) * srcWidth * 4;
+            float* out = temp.data() + size_t(y) * dstWidth * 4;
+            for(uint32_t x = 0; x < dstWidth; x++){
+#ifdef MIP_GENERATOR_SSE2
+                //  one RGBA pixel per register, same multiply-add order as the scalar path -> same result
+                __m128 sum = _mm_setzero_ps();
+                for(uint32_t t = horizontal.first[x]; t < horizontal.first[x + 1]; t++){
+                    __m128 p = _mm_loadu_ps(in + size_t(horizontal.index[t]) * 4);
+                    sum = _mm_add_ps(sum, _mm_mul_ps(p, _mm_set1_ps(horizontal.weight[t])));
+                }
+                _mm_storeu_ps(out + x * 4, sum);
+#else
+                float sum[4] = {};
+                for(uint32_t t = horizontal.first[x]; t < horizontal.first[x + 1]; t++){
+                    const float* p = in + size_t(horizontal.index[t]) * 4;
+                    float w = horizontal.weight[t];
+                    for(uint32_t c = 0; c < 4; c++){
+                        sum[c] += p[c] * w;
+                    }
+                }
+                std::memcpy(out + x * 4, sum, sizeof(sum));
+#endif
+            }
+        }
+    });
+
+    std::vector<float> dst(size_t(dstWidth) * dstHeight * 4);
+    const size_t rowFloats = size_t(dstWidth) * 4;
+    forRowBands(dstHeight, [&](uint32_t rowBegin, uint32_t rowEnd){
+        for(uint32_t y = rowBegin; y < rowEnd; y++){
+            float* out = dst.data() + y * rowFloats;
+            //  whole rows at a time -> inner loop is a straight multiply-add over contiguous floats
+            for(uint32_t t = vertical.first[y]; t < vertical.first[y + 1]; t++){
+                const float* in = temp.data() + vertical.index[t] * rowFloats;
+                float w = vertical.weight[t];
+                size_t i = 0;
+#ifdef MIP_GENERATOR_SSE2
+                const __m128 weight = _mm_set1_ps(w);
+                for(; i < rowFloats; i += 4){
+                    _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(_mm_loadu_ps(in + i), weight)));
+                }
+#endif
+                for(; i < rowFloats; i++){
+                    out[i] += in[i] * w;
+                }
+            }
+        }
+    });
+    return dst;
+}
+
+//  2x2 box of a linear float level with even size -> what resample computes for it(weights of 0.5 per axis, same
+//  operation order, same bits) without the temp image and tap tables
+std::vector<float> boxHalveLinear(const std::vector<float>& src, uint32_t srcWidth, uint32_t dstWidth, uint32_t dstHeight){
+    std::vector<float> dst(size_t(dstWidth) * dstHeight * 4);
+    forRowBands(dstHeight, [&](uint32_t rowBegin, uint32_t rowEnd){
+        for(uint32_t y = rowBegin; y < rowEnd; y++){
+            const float* row0 = src.data() + size_t(2 * y) * srcWidth * 4;
+            const float* row1 = row0 + size_t(srcWidth) * 4;
+            float* out = dst.data() + size_t(y) * dstWidth * 4;
+            for(uint32_t x = 0; x < dstWidth; x++){
+#ifdef MIP_GENERATOR_SSE2
+                const __m128 half = _mm_set1_ps(0.5f);
+                __m128 top = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(row0 + x * 8), half), _mm_mul_ps(_mm_loadu_ps(row0 + x * 8 + 4), half));
+                __m128 bottom = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(row1 + x * 8), half), _mm_mul_ps(_mm_loadu_ps(row1 + x * 8 + 4), half));
+                _mm_storeu_ps(out + x * 4, _mm_add_ps(_mm_mul_ps(top, half), _mm_mul_ps(bottom, half)));
+#else
+                for(uint32_t c = 0; c < 4; c++){
+                    float top = row0[x * 8 + c] * 0.5f + row0[x * 8 + 4 + c] * 0.5f;
+                    float bottom = row1[x * 8 + c] * 0.5f + row1[x * 8 + 4 + c] * 0.5f;
+                    out[x * 4 + c] = top * 0.5f + bottom * 0.5f;
+                }
+#endif
+            }
+        }
+    });
+    return dst;
+}
+
+std::vector<float> toLinear(const uint8_t* rgba, uint32_t width, uint32_t height, bool srgb){
+    const srgbTables& lut = tables();
+    std::vector<float> out(size_t(width) * height * 4);
+    forRowBands(height, [&](uint32_t rowBegin, uint32_t rowEnd){
+        for(size_t i = size_t(rowBegin) * width * 4; i < size_t(rowEnd) * width * 4; i++){
+            bool color = srgb && (i & 3) != 3;
+            out[i] = color ? lut.toLinear[rgba[i]] : rgba[i] * (1.0f / 255.0f);
+        }
+    });
+    return out;
+}
+
+std::vector<uint8_t> toBytes(const std::vector<float>& linear, uint32_t width, uint32_t height, bool srgb){
+    const srgbTables& lut = tables();
+    std::vector<uint8_t> out(linear.size());
+    forRowBands(height, [&](uint32_t rowBegin, uint32_t rowEnd){
+        size_t i = size_t(rowBegin) * width * 4;
+        const size_t end = size_t(rowEnd) * width * 4;
+#ifdef MIP_GENERATOR_SSE2
+        //  clamp, scale and truncate a pixel at a time(same float operations as below), only the srgb table stays scalar
+        const float colorScale = srgb ? static_cast<float>(LINEAR_TO_SRGB_STEPS) : 255.0f;
+        const __m128 scale = _mm_setr_ps(colorScale, colorScale, colorScale, 255.0f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+        for(; i < end; i += 4){
+            __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(linear.data() + i), zero), one);
+            __m128i q = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half));
+            if(srgb){
+                alignas(16) uint32_t steps[4];
+                _mm_store_si128(reinterpret_cast<__m128i*>(steps), q);
+                out[i] = lut.toSrgb[steps[0]];
+                out[i + 1] = lut.toSrgb[steps[1]];
+                out[i + 2] = lut.toSrgb[steps[2]];
+                out[i + 3] = static_cast<uint8_t>(steps[3]);
+            }
+            else{
+                q = _mm_packs_epi32(q, q);
+                const uint32_t packed = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(q, q)));
+                std::memcpy(out.data() + i, &packed, 4);
+            }
+        }
+#endif
+        for(; i < end; i++){
+            //  Kaiser lobes can overshoot a bit -> clamp before quantizing
+            float v = std::clamp(linear[i], 0.0f, 1.0f);
+            bool color = srgb && (i & 3) != 3;
+            out[i] = color ? lut.toSrgb[static_cast<uint32_t>(v * LINEAR_TO_SRGB_STEPS + 0.5f)]
+                           : static_cast<uint8_t>(v * 255.0f + 0.5f);
+        }
+    });
+    return out;
+}
+
+}   //  namespace
+
+uint32_t MipGenerator::mipCount(uint32_t width, uint32_t height){
+    uint32_t size = std::max(width, height);
+    uint32_t count = 1;
+    while(size > 1){
+        size >>= 1;
+        count++;
+    }
+    return count;
+}
+
+std::vector<MipGenerator::image> MipGenerator::buildChain(const uint8_t* rgba, uint32_t width, uint32_t height, MipFilter filter, bool srgb){
+    std::vector<image> chain{};
+    uint32_t levels = mipCount(width, height);
+    chain.reserve(levels);
+    chain.push_back({width, height, std::vector<uint8_t>(rgba, rgba + size_t(width) * height * 4)});
+
+    //  8 bit box only stays exact on linear data, everything else keeps a float copy of the previous level
+    //  -> rounding does not pile up over the chain
+    bool bytePath = filter == MipFilter::BOX && !srgb;
+    std::vector<float> linear{};
+    if(!bytePath){
+        linear = toLinear(rgba, width, height, srgb);
+    }
+
+    for(uint32_t level = 1; level < levels; level++){
+        const image& previous = chain.back();
+        image next{};
+        next.width = std::max(1u, previous.width / 2);
+        next.height = std::max(1u, previous.height / 2);
+        if(bytePath && previous.width % 2 == 0 && previous.height % 2 == 0){
+            next.pixels.resize(size_t(next.width) * next.height * 4);
+            boxHalve8(previous.pixels.data(), previous.width, next.pixels.data(), next.width, next.height);
+        }
+        else{
+            if(bytePath){
+                linear = toLinear(previous.pixels.data(), previous.width, previous.height, false);
+            }
+            if(filter == MipFilter::BOX && previous.width % 2 == 0 && previous.height % 2 == 0){
+                linear = boxHalveLinear(linear, previous.width, next.width, next.height);
+            }
+            else{
+                linear = resample(linear, previous.width, previous.height, next.width, next.height, filter);
+            }
+            next.pixels = toBytes(linear, next.width, next.height, srgb);
+        }
+        chain.push_back(std::move(next));
+    }
+    return chain;
+}
+
+}   //  namespace VULKVULK
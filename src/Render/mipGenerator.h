@@ -0,0 +1,37 @@
+#ifndef MIP_GENERATOR_H
+#define MIP_GENERATOR_H
+
+#include <cstdint>
+#include <vector>
+
+namespace VULKVULK{
+
+enum class MipFilter : uint32_t{
+    BOX,        //  2x2 average(area weighted for odd sizes), exact 8 bit path for linear data
+    KAISER,     //  Kaiser windowed sinc, keeps distant mips sharper than box without ringing much
+};
+
+//  Full mip chain of an RGBA8 image on the CPU
+//  Color(srgb) data is filtered in linear space -> mips do not darken, alpha is always linear
+//  Rows of every level are spread over the shared thread pool, filtering and conversions use SSE2 where available
+//  (same float operations as the scalar fallback -> both produce the same bytes)
+class MipGenerator{
+public:
+    struct image{
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint8_t> pixels{};  //  RGBA8, tightly packed
+    };
+
+    static uint32_t mipCount(uint32_t width, uint32_t height);
+    //  level 0 is a copy of "rgba", last level is 1x1
+    static std::vector<image> buildChain(const uint8_t* rgba, uint32_t width, uint32_t height, MipFilter filter, bool srgb);
+
+    //  Kaiser kernel parameters -> radius in destination pixels, alpha controls the window's falloff
+    static constexpr float KAISER_RADIUS = 3.0f;
+    static constexpr float KAISER_ALPHA = 4.0f;
+};
+
+}   //  namespace VULKVULK
+
+#endif
@@ -1,33 +1,102 @@
 #include "model.h"
+#include "impostor.h"
+#include "impostorBaker.h"
+#include "indexPacker.h"
+#include "meshletBuilder.h"
+#include "meshOptimizer.h"
+#include "meshSimplifier.h"
+#include "uploadBatch.h"
+#include "vertexDedup.h"
+#include "vertexLayout.h"
+#include "vertexQuantizer.h"
+#include "vertexWelder.h"
 #include "../Core/utils.h"
+#include "../IO/meshCache.h"
+#include "../IO/objLoader.h"
 
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <tiny_obj_loader.h>
-//  to make a hashing function for our Vertex struct, we need to enable this -> to hash individual vec component
-//  though experimental, it is considered safe
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
 
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstring>
+#include <deque>
+#include <filesystem>
+#include <functional>
 #include <iostream>
-#include <unordered_map>    //  chech for duplicate vertex data => if same dont save in vertex but save index id to indices
-
-template <>
-struct std::hash<VULKVULK::Model::Vertex> {
-  size_t operator()(VULKVULK::Model::Vertex const &vertex) const {
-    size_t seed = 0;
-    VULKVULK::hashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
-    return seed;
-  }
-};
+#include <sstream>
+#include <stdexcept>
 
 namespace VULKVULK{
 
-Model::Model(Device& _device, const Model::bufferData& bData) : device(_device){
-    createVertexBuffers(bData.vertices);
-    createIndexBuffer(bData.indices);
+namespace{
+void printBufferMemory(std::ostream& log, const Model::preparedMesh& mesh){
+    log << "Vertex Memory : " << mesh.vertexData.size() / 1024 << " KB";
+    if(mesh.format == Model::VertexFormat::COMPACT){
+        size_t fullSize = size_t(mesh.vertexCount) * sizeof(Model::Vertex);
+        log << " (compact, " << fullSize / 1024 << " KB as full)";
+    }
+    else if(mesh.format == Model::VertexFormat::SPLIT){
+        log << " (split, " << size_t(mesh.vertexCount) * sizeof(glm::vec3) / 1024 << " KB position stream)";
+    }
+    log << ", Index Memory : " << mesh.indices.size() * sizeof(uint16_t) / 1024 << " KB (16 bit, "
+        << mesh.ranges.size() << " draw range)\n";
+    if(mesh.impostor){
+        log << "Impostor Memory : " << mesh.impostor->getMemorySize() / 1024 << " KB (" << mesh.impostor->frames << "x"
+            << mesh.impostor->frames << " frames of " << mesh.impostor->frameSize << " px)\n";
+    }
+}
+
+//  bake runs on the loading thread -> the atlas goes up in the same upload batch as the buffers
+void bakeImpostor(const Model::bufferView& bView, const ModelLoadOptions& options, Model::preparedMesh& mesh, std::ostream& log){
+    auto start = std::chrono::steady_clock::now();
+    ImpostorBaker::settings config{};
+    config.frames = options.impostorFrames;
+    config.frameSize = options.impostorFrameSize;
+    auto atlas = std::make_shared<ImpostorAtlas>(ImpostorBaker::bake(bView, config));
+    //  same mesh with and without(or with another) impostor must not share one Model through the content hash
+    const uint32_t key[2] = {atlas->frames, atlas->frameSize};
+    mesh.contentHash = hashBytes(key, sizeof(key), mesh.contentHash);
+    mesh.impostor = std::move(atlas);
+    log << "Impostor baked in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms\n";
+}
+
+//  streamed batches uploading at once -> their staging memory is part of the import budget
+constexpr size_t STREAM_BATCHES_IN_FLIGHT = 2;
+
+//  every stream of "Input" into one buffer, second stream(if any) is what Model::bind offsets binding 1 by
+template <typename Input>
+void packVertices(const Model::bufferView& source, const VertexQuantizer::PositionBounds& bounds, Model::preparedMesh& mesh){
+    std::array<size_t, Input::STREAM_COUNT> offsets{};
+    mesh.vertexData.resize(Input::streamOffsets(source.vertexCount, offsets));
+    Input::pack(source.vertices, source.vertexCount, mesh.vertexData.data(), bounds);
+    mesh.attributeOffset = Input::STREAM_COUNT > 1 ? offsets.back() : 0;
+}
+}   //  namespace
+
+uint64_t Model::nextUniqueId(){
+    //  0 stays free for "no model"
+    static std::atomic<uint64_t> next{1};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+Model::Model(Device& _device, const Model::bufferData& bData, VertexFormat format) : Model(_device, bData.view(), format){}
+
+Model::Model(Device& _device, const Model::bufferView& bView, VertexFormat format) : device(_device){
+    const preparedMesh mesh = prepare(bView, format);
+    UploadBatch batch{device};
+    createBuffers(mesh, batch);
+    batch.submit();
+    batch.wait();
+}
+
+Model::Model(Device& _device, const preparedMesh& mesh, UploadBatch& batch) : device(_device){
+    createBuffers(mesh, batch);
+}
+
+Model::Model(Device& _device) : device(_device){
 }
 
 Model::~Model(){
@@ -40,37 +109,423 @@ Model::~Model(){
 
 }
 
-std::unique_ptr<Model> Model::createModelFromFile(Device& device, const std::string& filepath){
+std::unique_ptr<Model> Model::createModelFromFile(Device& device, const std::string& filepath, const ModelLoadOptions& options){
+    const preparedMesh mesh = prepareFromFile(filepath, options);
+    UploadBatch batch{device};
+    auto model = std::make_unique<Model>(device, mesh, batch);
+    batch.submit();
+    batch.wait();
+    return model;
+}
+
+std::unique_ptr<Model> Model::createModelFromFileStreamed(Device& device, const std::string& filepath, const ObjStreamOptions& options){
+    std::unique_ptr<Model> model{};
+    ObjStreamOptions importOptions = options;
+    const size_t stagingReserve = STREAM_BATCHES_IN_FLIGHT * options.batchSize;
+    importOptions.memoryBudget = options.memoryBudget > stagingReserve ? options.memoryBudget - stagingReserve : 0;
+
+    //  declared after the model -> waited for before its buffers get destroyed when the import fails
+    std::deque<std::unique_ptr<UploadBatch>> inFlight;
+    auto upload = [&](const std::function<void(UploadBatch&)>& record){
+        //  oldest batch has to finish before another staging buffer is allowed
+        if(inFlight.size() == STREAM_BATCHES_IN_FLIGHT){
+            inFlight.front()->wait();
+            inFlight.pop_front();
+        }
+        auto batch = std::make_unique<UploadBatch>(device);
+        record(*batch);
+        batch->submit();    //  data is in staging memory after this -> importer can reuse its batch
+        inFlight.push_back(std::move(batch));
+    };
+
+    ObjStreamSink sink{};
+    sink.begin = [&](size_t indexCount, size_t vertexCount){
+        model = createStreamed(device, indexCount, vertexCount);
+    };
+    sink.vertices = [&](const Vertex* vertices, size_t count){
+        upload([&](UploadBatch& batch){ model->uploadStreamedVertices(batch, vertices, count); });
+    };
+    sink.indices = [&](const uint32_t* indices, size_t count){
+        upload([&](UploadBatch& batch){ model->uploadStreamedIndices(batch, indices, count); });
+    };
+
+    ObjStreamStats stats{};
+    if(!ObjLoader::stream(filepath, sink, stats, importOptions)){
+        throw std::runtime_error("streaming import of " + filepath + " failed : " + stats.error);
+    }
+    for(auto& batch : inFlight){
+        batch->wait();
+    }
+    model->finishStreamed();
+    std::cout << "Vertex Count : " << stats.vertexCount << " (streamed, import peak " << (stats.peakMemory >> 20)
+              << " MB + " << (stagingReserve >> 20) << " MB staging)\n";
+    return model;
+}
+
+std::unique_ptr<Model> Model::createStreamed(Device& device, size_t indexCount, size_t vertexCount){
+    if(vertexCount < 3 || indexCount == 0){
+        throw std::runtime_error("streamed mesh has nothing to draw");
+    }
+    if(vertexCount > UINT32_MAX || indexCount > UINT32_MAX){
+        throw std::runtime_error("streamed mesh has more than 2^32 vertices or indices");
+    }
+    std::unique_ptr<Model> model{new Model(device)};
+    model->vertexBufferSize = VkDeviceSize(vertexCount) * sizeof(Vertex);
+    device.createBuffer(
+        model->vertexBufferSize,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        model->vertexBuffer, model->vertexBufferMemory);
+    model->indexBufferSize = VkDeviceSize(indexCount) * sizeof(uint32_t);
+    device.createBuffer(
+        model->indexBufferSize,
+        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        model->indexBuffer, model->indexBufferMemory);
+    model->hasIndexBuffer = true;
+    model->indexType = VK_INDEX_TYPE_UINT32;
+    return model;
+}
+
+void Model::uploadStreamedVertices(UploadBatch& batch, const Vertex* vertices, size_t count){
+    const VkDeviceSize offset = VkDeviceSize(vertexCount) * sizeof(Vertex);
+    const VkDeviceSize size = VkDeviceSize(count) * sizeof(Vertex);
+    if(size > vertexBufferSize - offset){
+        throw std::runtime_error("streamed vertices overflow the vertex buffer");
+    }
+    //  squared until finishStreamed
+    for(size_t i = 0; i < count; i++){
+        boundingRadius = glm::max(boundingRadius, glm::dot(vertices[i].position, vertices[i].position));
+        bounds.expand(vertices[i].position);
+    }
+    batch.uploadBuffer(vertices, size, vertexBuffer, offset);
+    vertexCount += static_cast<uint32_t>(count);
+}
+
+void Model::uploadStreamedIndices(UploadBatch& batch, const uint32_t* indices, size_t count){
+    const VkDeviceSize offset = VkDeviceSize(indexCount) * sizeof(uint32_t);
+    const VkDeviceSize size = VkDeviceSize(count) * sizeof(uint32_t);
+    if(size > indexBufferSize - offset){
+        throw std::runtime_error("streamed indices overflow the index buffer");
+    }
+    batch.uploadBuffer(indices, size, indexBuffer, offset);
+    indexCount += static_cast<uint32_t>(count);
+}
+
+void Model::finishStreamed(){
+    if(VkDeviceSize(vertexCount) * sizeof(Vertex) != vertexBufferSize || VkDeviceSize(indexCount) * sizeof(uint32_t) != indexBufferSize){
+        throw std::runtime_error("streamed import ended before filling its buffers");
+    }
+    drawRanges = {{0, indexCount, 0}};
+    lodDraws = {{0, 1, 0.0f, 0, 0, 0, 1}};
+    submeshes = {{0, indexCount, 0}};
+    setMaterials({material{}});
+    boundingRadius = glm::sqrt(boundingRadius);
+    //  batches are gone by now -> sphere around the box instead of fitted to the vertices
+    bounds.centerOnBox();
+    bounds.radius = glm::length(bounds.max - bounds.center);
+}
+
+Model::preparedMesh Model::prepareFromFile(const std::string& filepath, const ModelLoadOptions& options){
+    const VertexFormat format = options.compactVertices ? VertexFormat::COMPACT
+                                : options.splitPositions ? VertexFormat::SPLIT : VertexFormat::FULL;
+    //  collected and printed at once -> lines of models loading on different threads do not interleave
+    std::ostringstream log{};
+    //  Fast path : baked cache from the mounted asset pack or next to the source -> packed straight from the mapping
+    MappedFile cacheFile{};
+    bufferView cachedView{};
+    bufferData cachedData{};
+    const bool packed = MeshCache::readFromPack(filepath, options.processKey(), cachedView, cachedData);
+    if(packed || MeshCache::read(filepath, options.processKey(), cacheFile, cachedView, cachedData)){
+        log << "Vertex Count : " << cachedView.vertexCount << (packed ? " (pack)\n" : " (cached)\n");
+        preparedMesh mesh = prepare(cachedView, format);
+        if(options.bakeImpostor){
+            bakeImpostor(cachedView, options, mesh, log);
+        }
+        printBufferMemory(log, mesh);
+        std::cout << log.str();
+        return mesh;
+    }
+
     bufferData bData{};
-    bData.loadModel(filepath);
+    processFile(filepath, options, bData, log);
+    //  failing to write cache is not an error, we will just parse the obj again next launch
+    if(!MeshCache::write(filepath, options.processKey(), bData.view(), options.compressCache)){
+        log << "Could not write mesh cache for " << filepath << "\n";
+    }
     
-    std::cout << "Vertex Count : " << bData.vertices.size() << "\n";
-    return std::make_unique<Model>(device, bData);
+    log << "Vertex Count : " << bData.vertices.size() << "\n";
+    preparedMesh mesh = prepare(bData.view(), format);
+    if(options.bakeImpostor){
+        bakeImpostor(bData.view(), options, mesh, log);
+    }
+    printBufferMemory(log, mesh);
+    std::cout << log.str();
+    return mesh;
+}
+
+void Model::processFile(const std::string& filepath, const ModelLoadOptions& options, bufferData& bData, std::ostream& log){
+    bData.loadModel(filepath);
+    if(options.weldVertices){
+        const float radius = bData.bounds.empty() ? 0.0f : bData.bounds[0].radius;
+        VertexWelder::tolerance limits{};
+        limits.position = options.weldPositionEpsilon < 0.0f ? -1.0f : options.weldPositionEpsilon * radius;
+        limits.normal = options.weldNormalEpsilon;
+        limits.color = options.weldColorEpsilon;
+        limits.uv = options.weldUvEpsilon;
+        const VertexWelder::Stats stats = VertexWelder::weld(bData, limits);
+        log << "Welded : " << stats.vertexCount << " -> " << stats.weldedCount << " vertices, " << stats.mergedVertices
+            << " merged, " << stats.removedTriangles << " degenerate triangles removed\n";
+    }
+    if(options.generateLods){
+        MeshSimplifier::buildLodChain(bData, options.lodRatios, options.lodMaxError);
+        for(size_t i = 0; i < bData.lods.size(); i++){
+            log << "LOD " << i << " : " << bData.lods[i].indexCount / 3 << " triangles, error " << bData.lods[i].error << "\n";
+        }
+    }
+    if(options.optimizeMesh){
+        MeshOptimizer::optimize(bData, log);
+    }
+    if(options.buildMeshlets){
+        MeshletBuilder::build(bData);
+        //  clustering reorders triangles -> refresh first use order of vertices
+        if(options.optimizeMesh){
+            MeshOptimizer::optimizeVertexFetch(bData);
+        }
+        auto stats = MeshletBuilder::computeStats(bData.meshlets);
+        log << "Meshlets : " << stats.meshletCount << ", fill " << stats.vertexFill * 100.0f << "% vertices "
+            << stats.triangleFill * 100.0f << "% triangles, " << stats.coneCullable * 100.0f << "% cone cullable\n";
+    }
+}
+
+Model::preparedMesh Model::prepare(const bufferView& bView, VertexFormat format){
+    preparedMesh mesh{};
+    mesh.format = format;
+    //  16 bit indices always -> meshes above 65535 vertices come back split with their own vertex array
+    IndexPacker::Result packed{};
+    IndexPacker::pack(bView, packed);
+    bufferView source = bView;
+    if(!packed.vertices.empty()){
+        source.vertices = packed.vertices.data();
+        source.vertexCount = static_cast<uint32_t>(packed.vertices.size());
+    }
+
+    mesh.vertexCount = source.vertexCount;
+    float radiusSquared = 0.0f;
+    for(uint32_t i = 0; i < source.vertexCount; i++){
+        radiusSquared = glm::max(radiusSquared, glm::dot(source.vertices[i].position, source.vertices[i].position));
+    }
+    mesh.boundingRadius = glm::sqrt(radiusSquared);
+    //  loaders fill these while building the vertices, procedural meshes get them here
+    if(bView.boundsCount > 0){
+        mesh.bounds = bView.bounds[0];
+        mesh.shapeBounds.assign(bView.bounds + 1, bView.bounds + bView.boundsCount);
+    }
+    else{
+        mesh.bounds = boundingVolume::fromVertices(source.vertices, source.vertexCount);
+    }
+    //  one switch per mesh, every pack loop below is unrolled for its layout
+    switch(format){
+        case VertexFormat::COMPACT:{
+            const VertexQuantizer::PositionBounds bounds = VertexQuantizer::computeBounds(source.vertices, source.vertexCount);
+            mesh.positionDequantization = bounds.dequantizeMatrix();
+            packVertices<CompactVertexInput>(source, bounds, mesh);
+            break;
+        }
+        case VertexFormat::SPLIT:
+            packVertices<SplitVertexInput>(source, VertexQuantizer::PositionBounds{}, mesh);
+            break;
+        default:
+            packVertices<FullVertexInput>(source, VertexQuantizer::PositionBounds{}, mesh);
+            break;
+    }
+    mesh.indices = std::move(packed.indices);
+    mesh.ranges = std::move(packed.ranges);
+    mesh.lods = std::move(packed.lods);
+    mesh.meshlets.assign(bView.meshlets, bView.meshlets + bView.meshletCount);
+
+    //  every level gets at least one submesh -> renderer only ever walks submeshes
+    mesh.materials.assign(bView.materials, bView.materials + bView.materialCount);
+    if(mesh.materials.empty()){
+        mesh.materials.emplace_back();
+    }
+    if(bView.indexCount == 0){
+        mesh.submeshes.push_back({0, source.vertexCount, 0});   //  vertex range for non indexed models
+    }
+    for(size_t i = 0; i < mesh.lods.size(); i++){
+        const lodLevel level = i < bView.lodCount ? bView.lods[i] : lodLevel{0, bView.indexCount, 0.0f};
+        lodDraw& draw = mesh.lods[i];
+        draw.firstSubmesh = static_cast<uint32_t>(mesh.submeshes.size());
+        for(uint32_t s = 0; s < bView.submeshCount; s++){
+            if(bView.submeshes[s].firstIndex >= level.firstIndex && bView.submeshes[s].firstIndex < level.firstIndex + level.indexCount){
+                mesh.submeshes.push_back(bView.submeshes[s]);
+            }
+        }
+        if(mesh.submeshes.size() == draw.firstSubmesh){
+            mesh.submeshes.push_back({level.firstIndex, level.indexCount, 0});
+        }
+        draw.submeshCount = static_cast<uint32_t>(mesh.submeshes.size()) - draw.firstSubmesh;
+    }
+
+    mesh.contentHash = hashBytes(&mesh.format, sizeof(mesh.format));
+    mesh.contentHash = hashBytes(mesh.vertexData.data(), mesh.vertexData.size(), mesh.contentHash);
+    mesh.contentHash = hashBytes(mesh.indices.data(), mesh.indices.size() * sizeof(uint16_t), mesh.contentHash);
+    mesh.contentHash = hashBytes(mesh.materials.data(), mesh.materials.size() * sizeof(material), mesh.contentHash);
+    mesh.contentHash = hashBytes(mesh.submeshes.data(), mesh.submeshes.size() * sizeof(submesh), mesh.contentHash);
+    return mesh;
+}
+
+Model::boundingVolume Model::boundingVolume::fromVertices(const Vertex* vertices, uint32_t count){
+    boundingVolume volume{};
+    for(uint32_t i = 0; i < count; i++){
+        volume.expand(vertices[i].position);
+    }
+    volume.centerOnBox();
+    for(uint32_t i = 0; i < count; i++){
+        volume.fitRadius(vertices[i].position);
+    }
+    return volume;
+}
+
+uint32_t ModelLoadOptions::processKey() const{
+    //  FNV-1a over every option that changes the baked data
+    uint32_t key = 2166136261u;
+    auto mix = [&](const void* data, size_t size){
+        auto bytes = static_cast<const uint8_t*>(data);
+        for(size_t i = 0; i < size; i++){
+            key = (key ^ bytes[i]) * 16777619u;
+        }
+    };
+    mix(&weldVertices, sizeof(weldVertices));
+    if(weldVertices){
+        mix(&weldPositionEpsilon, sizeof(weldPositionEpsilon));
+        mix(&weldNormalEpsilon, sizeof(weldNormalEpsilon));
+        mix(&weldColorEpsilon, sizeof(weldColorEpsilon));
+        mix(&weldUvEpsilon, sizeof(weldUvEpsilon));
+    }
+    mix(&optimizeMesh, sizeof(optimizeMesh));
+    mix(&generateLods, sizeof(generateLods));
+    mix(&buildMeshlets, sizeof(buildMeshlets));
+    if(generateLods){
+        mix(lodRatios.data(), lodRatios.size() * sizeof(float));
+        mix(&lodMaxError, sizeof(lodMaxError));
+    }
+    return key;
+}
+
+Model::bufferView Model::bufferData::view() const{
+    bufferView bView{};
+    bView.lods = lods.data();
+    bView.lodCount = static_cast<uint32_t>(lods.size());
+    bView.meshlets = meshlets.data();
+    bView.meshletCount = static_cast<uint32_t>(meshlets.size());
+    bView.vertices = vertices.data();
+    bView.vertexCount = static_cast<uint32_t>(vertices.size());
+    bView.indices = indices.data();
+    bView.indexCount = static_cast<uint32_t>(indices.size());
+    bView.bounds = bounds.data();
+    bView.boundsCount = static_cast<uint32_t>(bounds.size());
+    bView.materials = materials.data();
+    bView.materialCount = static_cast<uint32_t>(materials.size());
+    bView.submeshes = submeshes.data();
+    bView.submeshCount = static_cast<uint32_t>(submeshes.size());
+    return bView;
+}
+
+void Model::bufferData::assignMaterials(const std::vector<uint32_t>& triangleMaterials, const std::vector<material>& library){
+    materials.clear();
+    submeshes.clear();
+    const size_t triangleCount = indices.size() / 3;
+    assert(triangleMaterials.size() == triangleCount && "one material per triangle");
+    if(triangleCount == 0){
+        return;
+    }
+
+    //  library slot -> material in order of first use, slot past the library is the default material
+    constexpr uint32_t UNUSED = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> materialOf(library.size() + 1, UNUSED);
+    std::vector<uint32_t> triangleCounts{};
+    std::vector<uint32_t> assigned(triangleCount);
+    for(size_t t = 0; t < triangleCount; t++){
+        const size_t slot = std::min<size_t>(triangleMaterials[t], library.size());
+        if(materialOf[slot] == UNUSED){
+            materialOf[slot] = static_cast<uint32_t>(materials.size());
+            materials.push_back(slot < library.size() ? library[slot] : material{});
+            triangleCounts.push_back(0);
+        }
+        assigned[t] = materialOf[slot];
+        triangleCounts[assigned[t]]++;
+    }
+
+    //  counting sort -> triangles keep their file order inside a material
+    std::vector<uint32_t> cursor(materials.size());
+    uint32_t firstTriangle = 0;
+    for(uint32_t m = 0; m < materials.size(); m++){
+        cursor[m] = firstTriangle;
+        submeshes.push_back({firstTriangle * 3, triangleCounts[m] * 3, m});
+        firstTriangle += triangleCounts[m];
+    }
+    std::vector<uint32_t> sorted(triangleCount * 3);
+    for(size_t t = 0; t < triangleCount; t++){
+        std::copy_n(indices.begin() + t * 3, 3, sorted.begin() + size_t(cursor[assigned[t]]++) * 3);
+    }
+    indices = std::move(sorted);
+}
+
+uint64_t Model::material::key() const{
+    uint64_t hash = hashBytes(&diffuse, sizeof(diffuse));
+    return hashBytes(diffuseTexture, sizeof(diffuseTexture), hash);
+}
+
+void Model::material::setName(const std::string& value){
+    const size_t length = std::min(value.size(), sizeof(name) - 1);
+    std::memset(name, 0, sizeof(name));
+    std::memcpy(name, value.data(), length);
+}
+
+void Model::material::setDiffuseTexture(const std::string& value){
+    const size_t length = std::min(value.size(), sizeof(diffuseTexture) - 1);
+    std::memset(diffuseTexture, 0, sizeof(diffuseTexture));
+    std::memcpy(diffuseTexture, value.data(), length);
+}
+
+void Model::setMaterials(std::vector<material> modelMaterials){
+    materials = std::move(modelMaterials);
+    materialKeys.clear();
+    for(const auto& modelMaterial : materials){
+        materialKeys.push_back(modelMaterial.key());
+    }
+}
+
+void Model::createBuffers(const preparedMesh& mesh, UploadBatch& batch){
+    vertexFormat = mesh.format;
+    attributeOffset = mesh.attributeOffset;
+    positionDequantization = mesh.positionDequantization;
+    boundingRadius = mesh.boundingRadius;
+    bounds = mesh.bounds;
+    shapeBounds = mesh.shapeBounds;
+    contentHash = mesh.contentHash;
+    createVertexBuffer(mesh, batch);
+    createIndexBuffer(mesh, batch);
+    drawRanges = mesh.ranges;
+    lodDraws = mesh.lods;
+    meshlets = mesh.meshlets;
+    submeshes = mesh.submeshes;
+    setMaterials(mesh.materials);
+    if(mesh.impostor){
+        impostor = std::make_unique<Impostor>(device, *mesh.impostor, batch);
+    }
 }
 
 //  Staging buffer is useful for static objects inside renderer, if object tends to frequently get updated, 
 //  staging buffer might slow the rendering process
-void Model::createVertexBuffers(const std::vector<Vertex>& vertices){
-    vertexCount = static_cast<uint32_t>(vertices.size());
+void Model::createVertexBuffer(const preparedMesh& mesh, UploadBatch& batch){
+    vertexCount = mesh.vertexCount;
     //  assert to check vertexCount is at least 3 (to form basic shape)
     assert(vertexCount >= 3 && "Vertex count must be at least 3!");
 
-    VkDeviceSize bufferSize = sizeof(vertices[0]) * vertexCount;  //  bufferSize = sizeof 1 vertex * totalnumber
-    
-    //  previous cpu memory mapping data to cpu writable gpu memory is slow
-    //  So we make a staging buffer that takes the cpu data and sends that to GPU specific memory space which is way faster
-    VkBuffer stagingBuffer; 
-    VkDeviceMemory stagingBufferMemory;
-    device.createBuffer(
-        bufferSize,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,   //  Tell vullkan this buffer is used as src for memory transfer  
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        stagingBuffer, stagingBufferMemory );
-    //  First copy data to staging buffer
-    void* data;
-    vkMapMemory(device.device(), stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, vertices.data(), static_cast<uint32_t>(bufferSize)); 
-    vkUnmapMemory(device.device(), stagingBufferMemory); //  unlink data with gpu data
+    VkDeviceSize bufferSize = mesh.vertexData.size();  //  bufferSize = sizeof 1 vertex * totalnumber
+    vertexBufferSize = bufferSize;
     
     //  create vertex buffer(Device memory)
     device.createBuffer(
@@ -78,35 +533,21 @@ void Model::createVertexBuffers(const std::vector<Vertex>& vertices){
         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,   //    Tell vullkan this buffer is used as dst for memory transfer
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
         vertexBuffer, vertexBufferMemory);
-    //  copy data from staging buffer to Device Memory
-    device.copyBuffer(stagingBuffer, vertexBuffer, bufferSize);
-    //  After copying we dont need staging buffer anymore so we delete it
-    vkDestroyBuffer(device.device(), stagingBuffer, nullptr);   
-    vkFreeMemory(device.device(), stagingBufferMemory, nullptr);
+    //  cpu memory mapped gpu memory is slow to draw from -> data goes through the batch's staging buffer into Device Memory
+    batch.uploadBuffer(mesh.vertexData.data(), bufferSize, vertexBuffer);
 }
 
-void Model::createIndexBuffer(const std::vector<uint32_t>& indices){
-    indexCount = static_cast<uint32_t>(indices.size());
+void Model::createIndexBuffer(const preparedMesh& mesh, UploadBatch& batch){
+    indexCount = static_cast<uint32_t>(mesh.indices.size());
     hasIndexBuffer = indexCount > 0;    //  true when there is 1 or more index value
     
     if(!hasIndexBuffer){
         return;
     }
     
-    VkDeviceSize bufferSize = sizeof(indices[0]) * indexCount;  
-
-    VkBuffer stagingBuffer; 
-    VkDeviceMemory stagingBufferMemory;
-    device.createBuffer(
-        bufferSize,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,   //  Tell vullkan this buffer is used as src for memory transfer  
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        stagingBuffer, stagingBufferMemory );
-
-    void* data;
-    vkMapMemory(device.device(), stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, indices.data(), static_cast<uint32_t>(bufferSize)); 
-    vkUnmapMemory(device.device(), stagingBufferMemory); //  unlink data with gpu data
+    indexType = VK_INDEX_TYPE_UINT16;
+    VkDeviceSize bufferSize = VkDeviceSize(sizeof(uint16_t)) * indexCount;  
+    indexBufferSize = bufferSize;
 
     device.createBuffer(
         bufferSize,
@@ -114,79 +555,237 @@ void Model::createIndexBuffer(const std::vector<uint32_t>& indices){
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
         indexBuffer, indexBufferMemory );
         
-    //  copy data from staging buffer to Device Memory
-    device.copyBuffer(stagingBuffer, indexBuffer, bufferSize);
+    batch.uploadBuffer(mesh.indices.data(), bufferSize, indexBuffer);
+}
 
-    vkDestroyBuffer(device.device(), stagingBuffer, nullptr);   
-    vkFreeMemory(device.device(), stagingBufferMemory, nullptr);
+uint32_t Model::draw(VkCommandBuffer commandBuffer, uint32_t lod, const cullView* cull){
+    if(!hasIndexBuffer){
+        vkCmdDraw(commandBuffer, vertexCount, 1, 0, 0); 
+        return 1;
+    }
+    const lodDraw& level = lodDraws[std::min<size_t>(lod, lodDraws.size() - 1)];
+    const submesh& first = submeshes[level.firstSubmesh];
+    const submesh& last = submeshes[level.firstSubmesh + level.submeshCount - 1];
+    return drawIndices(commandBuffer, level, first.firstIndex, last.firstIndex + last.indexCount, cull);
 }
 
-void Model::draw(VkCommandBuffer commandBuffer){
-    if(hasIndexBuffer){
-        vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, 0);
+uint32_t Model::drawSubmesh(VkCommandBuffer commandBuffer, uint32_t lod, uint32_t submeshIndex, const cullView* cull){
+    const submesh& part = getSubmesh(lod, submeshIndex);
+    if(!hasIndexBuffer){
+        vkCmdDraw(commandBuffer, part.indexCount, 1, part.firstIndex, 0);
+        return 1;
     }
-    else{
-        vkCmdDraw(commandBuffer, vertexCount, 1, 0, 0); 
+    return drawIndices(commandBuffer, lodDraws[std::min<size_t>(lod, lodDraws.size() - 1)], part.firstIndex,
+                       part.firstIndex + part.indexCount, cull);
+}
+
+uint32_t Model::getSubmeshCount(uint32_t lod) const{
+    if(lodDraws.empty()){
+        return static_cast<uint32_t>(submeshes.size());
     }
+    return lodDraws[std::min<size_t>(lod, lodDraws.size() - 1)].submeshCount;
 }
 
-void Model::bind(VkCommandBuffer commandBuffer){
-    VkBuffer buffers[] = {vertexBuffer};
-    VkDeviceSize offsets[] = {0};   //  starting offset to where binding starts
-    //  record to commandBuffer to bind 
-    //  [i]th value of "buffer"&"offset" to binding-index["first_binding" + i]
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
-    if(hasIndexBuffer){
-        // VK_INDEX_TYPE should match indices vector type OR represents total vertices that can be represented (2^16-1 || 2^32-1)
-        vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32); 
+const Model::submesh& Model::getSubmesh(uint32_t lod, uint32_t submeshIndex) const{
+    if(lodDraws.empty()){
+        return submeshes[submeshIndex];
+    }
+    return submeshes[lodDraws[std::min<size_t>(lod, lodDraws.size() - 1)].firstSubmesh + submeshIndex];
+}
+
+uint32_t Model::drawIndices(VkCommandBuffer commandBuffer, const lodDraw& level, uint32_t firstIndex, uint32_t endIndex,
+                            const cullView* cull){
+    uint32_t drawCount = 0;
+    if(cull == nullptr || level.meshletCount == 0){
+        for(uint32_t i = level.firstRange; i < level.firstRange + level.rangeCount; i++){
+            const drawRange& range = drawRanges[i];
+            const uint32_t first = std::max(range.firstIndex, firstIndex);
+            const uint32_t end = std::min(range.firstIndex + range.indexCount, endIndex);
+            if(first < end){
+                vkCmdDrawIndexed(commandBuffer, end - first, 1, first, range.vertexOffset, 0);
+                drawCount++;
+            }
+        }
+        return drawCount;
+    }
+
+    //  meshlets and draw ranges are both sorted by firstIndex -> walk them together
+    //  visible meshlets next to each other inside one range become a single draw
+    uint32_t rangeIndex = level.firstRange;
+    uint32_t pendingRange = 0, pendingFirst = 0, pendingEnd = 0;
+    bool pending = false;
+    auto flush = [&](){
+        if(pending){
+            vkCmdDrawIndexed(commandBuffer, pendingEnd - pendingFirst, 1, pendingFirst, drawRanges[pendingRange].vertexOffset, 0);
+            drawCount++;
+            pending = false;
+        }
+    };
+    //  meshlets never straddle submeshes(see MeshletBuilder) -> first one ending past "firstIndex" starts the slice
+    const meshlet* levelBegin = meshlets.data() + level.firstMeshlet;
+    const meshlet* levelEnd = levelBegin + level.meshletCount;
+    const meshlet* start = std::partition_point(levelBegin, levelEnd, [&](const meshlet& cluster){
+        return cluster.firstIndex + cluster.triangleCount * 3 <= firstIndex;
+    });
+    for(const meshlet* cluster = start; cluster != levelEnd && cluster->firstIndex < endIndex; cluster++){
+        if(!cull->isVisible(*cluster)){
+            continue;
+        }
+        uint32_t first = std::max(cluster->firstIndex, firstIndex);
+        const uint32_t end = std::min(cluster->firstIndex + cluster->triangleCount * 3, endIndex);
+        while(first < end){
+            while(drawRanges[rangeIndex].firstIndex + drawRanges[rangeIndex].indexCount <= first){
+                rangeIndex++;
+            }
+            const uint32_t segmentEnd = std::min(end, drawRanges[rangeIndex].firstIndex + drawRanges[rangeIndex].indexCount);
+            if(pending && pendingRange == rangeIndex && pendingEnd == first){
+                pendingEnd = segmentEnd;
+            }
+            else{
+                flush();
+                pending = true;
+                pendingRange = rangeIndex;
+                pendingFirst = first;
+                pendingEnd = segmentEnd;
+            }
+            first = segmentEnd;
+        }
     }
+    flush();
+    return drawCount;
 }
 
-//  INFO:   [Pipeline] Need to provide pipeline with these descriptions -> inside "VkPipelineVertexInputStateCreateInfo"
-//  This binding description corresponds to single VertexBuffer
-std::vector<VkVertexInputBindingDescription> Model::Vertex::getBindingDescriptions(){
-    std::vector<VkVertexInputBindingDescription> bindingDescription(1);
-    bindingDescription[0].binding = 0;  //  for binding index "0"
-    bindingDescription[0].stride = sizeof(Vertex);  //  read size of Vertex as 1 item => currently bind0 has pos&color data
-    bindingDescription[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-    return bindingDescription;
-//  you can also return 
-//  {{0,0,VK_FORMAT_R32G32_SFLOAT,offsetof(Vertex, position)},
-//  {1,0,VK_FORMAT_R32G32_SFLOAT,offsetof(Vertex, position)}}
-//  the order is ["location", "binding", "format", "offset"]
+//  Gribb/Hartmann plane extraction, depth is 0~1 so near plane is row 2 alone
+Model::cullView Model::cullView::fromMatrices(const glm::mat4& modelViewProjection, const glm::vec3& cameraPosition){
+    cullView view{};
+    const glm::mat4& m = modelViewProjection;
+    glm::vec4 rows[4];
+    for(int r = 0; r < 4; r++){
+        rows[r] = glm::vec4{m[0][r], m[1][r], m[2][r], m[3][r]};
+    }
+    view.planes[0] = rows[3] + rows[0];     //  left
+    view.planes[1] = rows[3] - rows[0];     //  right
+    view.planes[2] = rows[3] + rows[1];     //  top(y down)
+    view.planes[3] = rows[3] - rows[1];     //  bottom
+    view.planes[4] = rows[2];               //  near
+    view.planes[5] = rows[3] - rows[2];     //  far
+    for(auto& plane : view.planes){
+        float length = glm::length(glm::vec3{plane});
+        plane = length > 0.0f ? plane / length : plane;
+    }
+    view.cameraPosition = cameraPosition;
+    return view;
 }
-std::vector<VkVertexInputAttributeDescription> Model::Vertex::getAttributeDescriptions(){
-    std::vector<VkVertexInputAttributeDescription> attributeDescription{};
-    //  Order of param      =>      location, binding, format, offset
-    attributeDescription.push_back({0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, position)});
-    attributeDescription.push_back({1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, color)});
-    attributeDescription.push_back({2, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, normal)});
-    attributeDescription.push_back({3, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, uv)});
 
-    return attributeDescription;
+bool Model::cullView::isVisible(const meshlet& cluster) const{
+    for(const auto& plane : planes){
+        if(glm::dot(glm::vec3{plane}, cluster.center) + plane.w < -cluster.radius){
+            return false;
+        }
+    }
+    //  camera inside the back facing cone -> every triangle of the cluster faces away
+    glm::vec3 toApex = cluster.coneApex - cameraPosition;
+    float distance = glm::length(toApex);
+    return !(distance > 0.0f && glm::dot(toApex, cluster.coneAxis) >= cluster.coneCutoff * distance);
 }
 
+uint32_t Model::selectLod(float screenScale, float maxScreenError) const{
+    for(uint32_t lod = static_cast<uint32_t>(lodDraws.size()); lod > 1; lod--){
+        if(lodDraws[lod - 1].error * screenScale <= maxScreenError){
+            return lod - 1;
+        }
+    }
+    return 0;
+}
+
+VkDeviceSize Model::getGpuMemorySize() const{
+    return vertexBufferSize + indexBufferSize + (impostor ? impostor->getMemorySize() : 0);
+}
 
+void Model::bind(VkCommandBuffer commandBuffer, uint32_t bindingMask){
+    VkBuffer buffers[] = {vertexBuffer, vertexBuffer};
+    VkDeviceSize offsets[] = {0, attributeOffset};   //  starting offset to where binding starts
+    //  record to commandBuffer to bind 
+    //  [i]th value of "buffer"&"offset" to binding-index["first_binding" + i]
+    //  streams the pipeline does not read stay unbound -> a position only pass never touches the attribute stream
+    const uint32_t streamCount = vertexFormat == VertexFormat::SPLIT ? 2 : 1;
+    uint32_t first = 0;
+    while(first < streamCount){
+        if((bindingMask & (1u << first)) == 0){
+            first++;
+            continue;
+        }
+        uint32_t count = 1;
+        while(first + count < streamCount && (bindingMask & (1u << (first + count))) != 0){
+            count++;
+        }
+        vkCmdBindVertexBuffers(commandBuffer, first, count, buffers + first, offsets + first);
+        first += count;
+    }
+    if(hasIndexBuffer){
+        // VK_INDEX_TYPE should match indices vector type OR represents total vertices that can be represented (2^16-1 || 2^32-1)
+        vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, indexType); 
+    }
+}
 
 void Model::bufferData::loadModel(const std::string &filepath){
+    //  native loader works in place on the mapped file, it bails out on obj features it does not reproduce exactly
+    if(ObjLoader::load(filepath, *this)){
+        return;
+    }
+    loadModelTinyObj(filepath);
+}
+
+void Model::bufferData::loadModelTinyObj(const std::string &filepath){
     tinyobj::attrib_t attrib;   //  has all the obj data
     std::vector<tinyobj::shape_t> shapes;   //  contains index data for mesh(vertex,index,textureCoord)
-    std::vector<tinyobj::material_t> materials; // contains index data for texture(image, albedo,...)
+    std::vector<tinyobj::material_t> objMaterials; // contains index data for texture(image, albedo,...)
     std::string warn ,err;
     //  LoadObj need components as address to vector, not the fisrt starting address
     //  (which is just the address pointing towards 1 element and no connection with the rest of the container)
 
-    if(!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filepath.c_str())){
+    //  mtllib names are relative to the obj, not to the working directory
+    std::string materialDirectory = std::filesystem::path(filepath).parent_path().string();
+    if(!materialDirectory.empty()){
+        materialDirectory += "/";
+    }
+    if(!tinyobj::LoadObj(&attrib, &shapes, &objMaterials, &warn, &err, filepath.c_str(), materialDirectory.c_str())){
         throw std::runtime_error(warn + err);
     }
 
     vertices.clear();
     indices.clear();
+    materials.clear();
+    submeshes.clear();
+    bounds.assign(1, boundingVolume{});
 
-    std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+    size_t cornerCount = 0;
+    for(const auto &shape : shapes){
+        cornerCount += shape.mesh.indices.size();
+    }
+    indices.reserve(cornerCount);
+    //  chech for duplicate vertex data => if same dont save in vertex but save index id to indices
+    VertexDedupTable uniqueVertices{cornerCount};
 
+    //  box of every shape first -> its sphere radius is fitted while the corners below get expanded
     for(const auto &shape : shapes){
+        boundingVolume& shapeBounds = bounds.emplace_back();
         for(const auto &index : shape.mesh.indices){
+            if(index.vertex_index >= 0){
+                shapeBounds.expand(glm::vec3{attrib.vertices[3 * index.vertex_index + 0],
+                                             attrib.vertices[3 * index.vertex_index + 1],
+                                             attrib.vertices[3 * index.vertex_index + 2]});
+            }
+        }
+        bounds[0].expand(shapeBounds);
+    }
+    for(auto &volume : bounds){
+        volume.centerOnBox();
+    }
+
+    for(size_t s = 0; s < shapes.size(); s++){
+        boundingVolume& shapeBounds = bounds[s + 1];
+        for(const auto &index : shapes[s].mesh.indices){
             Vertex vertex{};
             if(index.vertex_index >= 0){
                 vertex.position = {
@@ -215,15 +814,33 @@ void Model::bufferData::loadModel(const std::string &filepath){
                     attrib.texcoords[2 * index.texcoord_index + 1]
                 };                
             }
+            shapeBounds.fitRadius(vertex.position);
+            bounds[0].fitRadius(vertex.position);
             //  insert added vertex
-            if(uniqueVertices.count(vertex) == 0){
-                uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-                vertices.push_back(vertex);
-            }
-            indices.push_back(uniqueVertices[vertex]);
+            indices.push_back(uniqueVertices.findOrInsert(vertex, vertices));
+        }
+    }
+
+    //  no library found -> no materials, same as a file without usemtl
+    if(objMaterials.empty()){
+        return;
+    }
+    std::vector<material> library(objMaterials.size());
+    for(size_t m = 0; m < objMaterials.size(); m++){
+        library[m].diffuse = {objMaterials[m].diffuse[0], objMaterials[m].diffuse[1], objMaterials[m].diffuse[2]};
+        library[m].setName(objMaterials[m].name);
+        library[m].setDiffuseTexture(objMaterials[m].diffuse_texname);
+    }
+    //  triangulated -> one material id per triangle, -1 for faces without a known material
+    std::vector<uint32_t> triangleMaterials{};
+    triangleMaterials.reserve(indices.size() / 3);
+    for(const auto &shape : shapes){
+        for(size_t f = 0; f < shape.mesh.indices.size() / 3; f++){
+            const int id = f < shape.mesh.material_ids.size() ? shape.mesh.material_ids[f] : -1;
+            triangleMaterials.push_back(id >= 0 ? static_cast<uint32_t>(id) : static_cast<uint32_t>(library.size()));
         }
     }
- 
+    assignMaterials(triangleMaterials, library);
 }
 
 
@@ -4,11 +4,50 @@
 #include "device.h"
 #include "../core/core.h" 
 
+#include <algorithm>
+#include <iosfwd>
+#include <limits>
 #include <vector>
 #include <memory>
 
 namespace VULKVULK{
 
+class UploadBatch;
+class Impostor;
+struct ImpostorAtlas;
+struct ObjStreamOptions;
+
+//  Optional processing applied to a mesh after it is loaded from source(result gets baked into the mesh cache)
+struct ModelLoadOptions{
+    //  merge near duplicate vertices(scan noise) before anything else, see VertexWelder, negative epsilon -> exact
+    bool weldVertices = false;
+    float weldPositionEpsilon = 1e-5f;          //  relative to mesh radius
+    float weldNormalEpsilon = 0.01f;            //  distance between unit normals, ~radians
+    float weldColorEpsilon = 1.0f / 255.0f;
+    float weldUvEpsilon = 1e-4f;
+
+    bool optimizeMesh = false;      //  vertex cache + vertex fetch reorder, see MeshOptimizer
+    bool compactVertices = false;   //  upload as Model::CompactVertex(quantized on upload, cache keeps full precision)
+    bool splitPositions = false;    //  upload as VertexFormat::SPLIT(position stream + attribute stream), not with compactVertices
+
+    bool generateLods = false;      //  simplified levels sharing the vertex buffer, see MeshSimplifier
+    std::vector<float> lodRatios{0.5f, 0.25f, 0.125f};  //  triangle count of each level relative to level 0
+    float lodMaxError = 0.02f;      //  relative to mesh radius, levels stop simplifying past this
+
+    bool buildMeshlets = false;     //  cluster triangles for per cluster frustum/backface culling, see MeshletBuilder
+
+    bool compressCache = false;     //  write the mesh cache GeometryCodec packed(same data -> not part of processKey)
+
+    //  octahedral impostor atlas for distant draws, see ImpostorBaker
+    //  baked from the loaded mesh on every load, not stored in the mesh cache -> not part of processKey
+    bool bakeImpostor = false;
+    uint32_t impostorFrames = 8;        //  per atlas side
+    uint32_t impostorFrameSize = 64;    //  pixels per frame side
+
+    //  identifies the processing baked into the cache -> cache baked with different options is rebuilt
+    uint32_t processKey() const;
+};
+
 //  Take vertex data from target -> allocate memory and copy given data to that memory
 class Model{
 public:
@@ -18,53 +57,317 @@ public:
         glm::vec3 normal{};
         glm::vec2 uv{};
 
-        //  Return function for pipeline
-        static std::vector<VkVertexInputBindingDescription> getBindingDescriptions();
-        static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
-
         bool operator==(const Vertex& other) const {
             return position == other.position && color == other.color && normal == other.normal && uv == other.uv;
         }
     };
+    //  Quantized layout, 20 bytes instead of 44 -> see VertexQuantizer for the encoding
+    //  Vulkan vertex input and packing of every layout come from its declaration in vertexLayout.h
+    struct CompactVertex{
+        int16_t position[4]{};      //  snorm16 relative to mesh bounds, w = 1
+        int16_t normal[2]{};        //  octahedral snorm16
+        uint8_t color[4]{};         //  unorm8, a = 1
+        uint16_t uv[2]{};           //  half float
+    };
+    //  Two streams instead of one interleaved Vertex : tightly packed positions(glm::vec3) at binding 0, these at binding 1
+    //  -> a pass that only needs positions(depth, shadows) binds binding 0 alone and fetches 12 bytes per vertex, not 44
+    struct SplitAttributes{
+        glm::vec3 color{};
+        glm::vec3 normal{};
+        glm::vec2 uv{};
+    };
+    enum class VertexFormat : uint32_t{
+        FULL,       //  Vertex, FullVertexInput
+        COMPACT,    //  CompactVertex, CompactVertexInput
+        SPLIT,      //  glm::vec3 + SplitAttributes, SplitVertexInput
+    };
+    //  bit per vertex binding a pipeline reads, see Pipeline::getVertexBindingMask
+    static constexpr uint32_t POSITION_BINDING_BIT = 1u << 0;
+    static constexpr uint32_t ATTRIBUTE_BINDING_BIT = 1u << 1;    //  SPLIT only, FULL/COMPACT keep everything in binding 0
+    static constexpr uint32_t ALL_BINDINGS = POSITION_BINDING_BIT | ATTRIBUTE_BINDING_BIT;
+
+    //  One vkCmdDrawIndexed -> meshes split for 16 bit indices draw several ranges out of the same buffers
+    struct drawRange{
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+        int32_t vertexOffset = 0;
+    };
+
+    //  Draw ranges of one level -> switching level is only a different slice of the model's draw ranges
+    struct lodDraw{
+        uint32_t firstRange = 0;
+        uint32_t rangeCount = 0;
+        float error = 0.0f;
+        uint32_t firstMeshlet = 0;
+        uint32_t meshletCount = 0;
+        uint32_t firstSubmesh = 0;  //  submeshes of this level, see Model::getSubmesh
+        uint32_t submeshCount = 0;
+    };
+    //  Surface description of a submesh, from the OBJ's MTL library(Kd, map_Kd)
+    //  plain fixed size data -> stored as is in the mesh cache
+    struct material{
+        glm::vec3 diffuse{1.0f};
+        char name[52]{};            //  "newmtl" name, truncated, empty for the default material
+        char diffuseTexture[192]{}; //  map_Kd relative to the OBJ, empty when there is none
+
+        //  equal key -> same look, models with identical materials share the key(name is not part of it)
+        uint64_t key() const;
+        void setName(const std::string& value);
+        void setDiffuseTexture(const std::string& value);
+    };
+    //  Index range of one level drawn with one material, triangles of a material are contiguous inside every level
+    struct submesh{
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+        uint32_t material = 0;      //  into the model's materials
+    };
+    //  Level of detail inside the index stream, level 0 is the full mesh
+    struct lodLevel{
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+        float error = 0.0f;         //  model space distance to level 0 surface
+        uint32_t firstMeshlet = 0;  //  meshlets covering this level, in index order
+        uint32_t meshletCount = 0;
+    };
+    //  Cluster of contiguous triangles in the index stream, bounds in model space
+    struct meshlet{
+        glm::vec3 center{};
+        float radius = 0.0f;
+        //  every triangle faces away from cameras with dot(normalize(coneApex - camera), coneAxis) >= coneCutoff
+        //  cutoff above 1 -> never back facing as a whole
+        glm::vec3 coneApex{};
+        float coneCutoff = 2.0f;
+        glm::vec3 coneAxis{};
+        uint32_t firstIndex = 0;
+        uint32_t triangleCount = 0;
+        uint32_t vertexCount = 0;
+    };
+    //  Axis aligned box + sphere around the box center, model space
+    //  filled in two steps : box from every point, then centerOnBox() and the radius from every point again
+    struct boundingVolume{
+        glm::vec3 min{std::numeric_limits<float>::max()};
+        glm::vec3 max{-std::numeric_limits<float>::max()};
+        glm::vec3 center{};
+        float radius = 0.0f;
+
+        bool isEmpty() const { return min.x > max.x; }
+        void expand(const glm::vec3& point){ min = glm::min(min, point); max = glm::max(max, point); }
+        void expand(const boundingVolume& other){ min = glm::min(min, other.min); max = glm::max(max, other.max); }
+        void centerOnBox(){ center = isEmpty() ? glm::vec3{0.0f} : (min + max) * 0.5f; radius = 0.0f; }
+        void fitRadius(const glm::vec3& point){
+            glm::vec3 offset = point - center;
+            float distanceSquared = glm::dot(offset, offset);
+            if(distanceSquared > radius * radius){
+                radius = glm::sqrt(distanceSquared);
+            }
+        }
+        static boundingVolume fromVertices(const Vertex* vertices, uint32_t count);
+    };
+    //  Culling state of one object for one frame, everything in model space
+    struct cullView{
+        glm::vec4 planes[6]{};      //  normalized, inside is dot(xyz, p) + w >= 0
+        glm::vec3 cameraPosition{};
+
+        //  "modelViewProjection" without position dequantization, "cameraPosition" already mapped by inverse(model matrix)
+        static cullView fromMatrices(const glm::mat4& modelViewProjection, const glm::vec3& cameraPosition);
+        bool isVisible(const meshlet& cluster) const;
+    };
+
+    //  Non-owning view of vertex/index arrays -> lets us upload straight from memory we do not own(ex. mapped cache file)
+    struct bufferView{
+        const Vertex* vertices = nullptr;
+        uint32_t vertexCount = 0;
+        const uint32_t* indices = nullptr;
+        uint32_t indexCount = 0;
+        const lodLevel* lods = nullptr;     //  none -> whole index stream is a single level
+        uint32_t lodCount = 0;
+        const meshlet* meshlets = nullptr;
+        uint32_t meshletCount = 0;
+        const boundingVolume* bounds = nullptr;     //  see bufferData::bounds, none -> computed by prepare
+        uint32_t boundsCount = 0;
+        const material* materials = nullptr;        //  none -> every level is one submesh with the default material
+        uint32_t materialCount = 0;
+        const submesh* submeshes = nullptr;
+        uint32_t submeshCount = 0;
+    };
     struct bufferData{
         std::vector<Vertex> vertices{};
         std::vector<uint32_t> indices{};
+        std::vector<lodLevel> lods{};
+        std::vector<meshlet> meshlets{};
+        //  [0] whole mesh, [1..] every OBJ shape(run of faces between o/g lines) in file order
+        //  computed while the loader builds the vertices, processing never moves a vertex so they stay valid
+        std::vector<boundingVolume> bounds{};
+        //  sorted by firstIndex, level 0 first then every LOD level's own, empty -> one implicit submesh per level
+        //  every pass that moves triangles keeps each material's triangles together inside a level
+        std::vector<material> materials{};
+        std::vector<submesh> submeshes{};
 
+        //  Stable sort of the triangles by "triangleMaterials"(index into "library" per triangle, anything past the
+        //  library -> default material) into level 0 submeshes, materials end up in order of first use
+        //  expects no LODs/meshlets yet
+        void assignMaterials(const std::vector<uint32_t>& triangleMaterials, const std::vector<material>& library);
         void loadModel(const std::string &filepath);
+        //  reference path through tinyobj -> loadModel falls back to this, benchmarks compare against it
+        void loadModelTinyObj(const std::string &filepath);
+        bufferView view() const;
+    };
+    //  Everything a model puts on the gpu, built on the CPU -> safe to build on worker threads(see AssetLoader)
+    struct preparedMesh{
+        VertexFormat format = VertexFormat::FULL;
+        std::vector<uint8_t> vertexData{};      //  streams of the format's VertexInput, packed by its layouts
+                                                //  SPLIT : positions, then the attributes from "attributeOffset" on
+        VkDeviceSize attributeOffset = 0;
+        uint32_t vertexCount = 0;
+        std::vector<uint16_t> indices{};
+        std::vector<drawRange> ranges{};
+        std::vector<lodDraw> lods{};
+        std::vector<meshlet> meshlets{};
+        glm::mat4 positionDequantization{1.0f};
+        float boundingRadius = 0.0f;            //  farthest vertex from the model origin
+        boundingVolume bounds{};
+        std::vector<boundingVolume> shapeBounds{};
+        std::vector<material> materials{};      //  at least one
+        std::vector<submesh> submeshes{};       //  per level, see lodDraw::firstSubmesh
+        uint64_t contentHash = 0;               //  over format, vertexData, indices and submeshes -> equal hash, same model
+                                                //  (+ impostor settings when there is one)
+        std::shared_ptr<const ImpostorAtlas> impostor{};    //  ModelLoadOptions::bakeImpostor
     };
 
-    Model(Device& _device, const Model::bufferData& bData);
+    Model(Device& _device, const Model::bufferData& bData, VertexFormat format = VertexFormat::FULL);
+    Model(Device& _device, const Model::bufferView& bView, VertexFormat format = VertexFormat::FULL);
+    //  buffers get created now but filled when "batch" is submitted -> "mesh" has to outlive the submit
+    //  model must not be drawn before the batch completes
+    Model(Device& _device, const preparedMesh& mesh, UploadBatch& batch);
     ~Model();
     
     Model(const Model&) = delete;
     Model& operator=(const Model&) = delete;
 
     //  Basically does what VAO does in opengl
-    void bind(VkCommandBuffer commandBuffer);
+    //  "bindingMask" -> only the vertex streams the bound pipeline reads(Pipeline::getVertexBindingMask)
+    void bind(VkCommandBuffer commandBuffer, uint32_t bindingMask = ALL_BINDINGS);
     //  same as Draw call in opengl
-    void draw(VkCommandBuffer commandBuffer);
+    //  with "cull", only meshlets passing it get drawn(neighbouring visible meshlets merge into one draw)
+    //  whole level regardless of materials, returns the number of draw calls recorded
+    uint32_t draw(VkCommandBuffer commandBuffer, uint32_t lod = 0, const cullView* cull = nullptr);
+    //  only the triangles of one submesh of the level -> renderer sorts these by material across models
+    uint32_t drawSubmesh(VkCommandBuffer commandBuffer, uint32_t lod, uint32_t submeshIndex, const cullView* cull = nullptr);
+    bool hasMeshlets() const { return !meshlets.empty(); }
+
+    uint32_t getSubmeshCount(uint32_t lod) const;
+    const submesh& getSubmesh(uint32_t lod, uint32_t submeshIndex) const;
+    const material& getMaterial(uint32_t materialIndex) const { return materials[materialIndex]; }
+    uint64_t getMaterialKey(uint32_t materialIndex) const { return materialKeys[materialIndex]; }
+    uint32_t getMaterialCount() const { return static_cast<uint32_t>(materials.size()); }
+
+    uint32_t getLodCount() const { return static_cast<uint32_t>(std::max<size_t>(lodDraws.size(), 1)); }
+    //  coarsest level whose error, scaled by "screenScale"(model units -> fraction of screen height), stays under "maxScreenError"
+    uint32_t selectLod(float screenScale, float maxScreenError) const;
+
+    VertexFormat getVertexFormat() const { return vertexFormat; }
+    //  maps stored positions back to model space(identity for FULL) -> multiply into the model matrix
+    const glm::mat4& getPositionDequantization() const { return positionDequantization; }
+    VkDeviceSize getVertexBufferSize() const { return vertexBufferSize; }
+    VkDeviceSize getIndexBufferSize() const { return indexBufferSize; }
+    //  everything the model holds on the GPU : vertex + index buffers and the impostor atlas
+    VkDeviceSize getGpuMemorySize() const;
+    size_t getDrawRangeCount() const { return drawRanges.size(); }
+    uint64_t getContentHash() const { return contentHash; }
+    //  never shared by two models of one run, not even after one was destroyed -> safe cache key unlike the address
+    uint64_t getUniqueId() const { return uniqueId; }
+    //  sphere around the model space origin containing every vertex
+    float getBoundingRadius() const { return boundingRadius; }
+    const boundingVolume& getBounds() const { return bounds; }
+    //  one per OBJ shape in file order, empty for procedural and streamed models
+    const std::vector<boundingVolume>& getShapeBounds() const { return shapeBounds; }
+    //  nullptr unless loaded with ModelLoadOptions::bakeImpostor
+    Impostor* getImpostor() const { return impostor.get(); }
 
     //  helper function
-    static std::unique_ptr<Model> createModelFromFile(Device& device, const std::string& filepath);
+    static std::unique_ptr<Model> createModelFromFile(Device& device, const std::string& filepath, const ModelLoadOptions& options = ModelLoadOptions{});
+    //  CPU half of createModelFromFile : mesh cache or source + processing from "options", no Vulkan calls
+    static preparedMesh prepareFromFile(const std::string& filepath, const ModelLoadOptions& options = ModelLoadOptions{});
+    //  source parse + processing from "options" into "bData", no cache involved(what gets baked into .vkmesh)
+    static void processFile(const std::string& filepath, const ModelLoadOptions& options, bufferData& bData, std::ostream& log);
+    //  index packing + vertex format conversion
+    static preparedMesh prepare(const bufferView& bView, VertexFormat format);
+    //  Bounded memory import for very large OBJ files(see ObjLoader::stream) -> batches go to the GPU as they are parsed
+    //  no cache/processing, 32 bit indices and FULL vertices, buffers are sized by the importer's exact counts
+    static std::unique_ptr<Model> createModelFromFileStreamed(Device& device, const std::string& filepath, const ObjStreamOptions& options);
+    //  Pieces of the streamed import, AssetLoader parses on a worker and records the uploads from the main thread
+    //  empty buffers for the whole mesh -> batches in file order at increasing offsets -> finishStreamed once all are in
+    //  the model must not be drawn before finishStreamed and the completion of every batch
+    static std::unique_ptr<Model> createStreamed(Device& device, size_t indexCount, size_t vertexCount);
+    //  data is read when "batch" gets submitted, throws when the batch does not fit the buffer
+    void uploadStreamedVertices(UploadBatch& batch, const Vertex* vertices, size_t count);
+    void uploadStreamedIndices(UploadBatch& batch, const uint32_t* indices, size_t count);
+    //  throws if fewer vertices/indices came in than createStreamed was sized for
+    void finishStreamed();
 
 private:
-    void createVertexBuffers(const std::vector<Vertex>& vertices);
-    void createIndexBuffer(const std::vector<uint32_t>& indices);
+    //  empty model, buffers are filled in by createStreamed and the streamed uploads
+    explicit Model(Device& _device);
+
+    void createBuffers(const preparedMesh& mesh, UploadBatch& batch);
+    void createVertexBuffer(const preparedMesh& mesh, UploadBatch& batch);
+    void createIndexBuffer(const preparedMesh& mesh, UploadBatch& batch);
+    void setMaterials(std::vector<material> modelMaterials);
+    //  [firstIndex, endIndex) of "level", draw ranges(and with "cull" the visible meshlets) clipped to it
+    uint32_t drawIndices(VkCommandBuffer commandBuffer, const lodDraw& level, uint32_t firstIndex, uint32_t endIndex,
+                         const cullView* cull);
+
+    static uint64_t nextUniqueId();
 
     Device& device;
-    VkBuffer vertexBuffer;
-    VkBuffer indexBuffer;
+    const uint64_t uniqueId = nextUniqueId();
+    VkBuffer vertexBuffer = VK_NULL_HANDLE;
+    VkBuffer indexBuffer = VK_NULL_HANDLE;
 
-    VkDeviceMemory vertexBufferMemory;  
-    VkDeviceMemory indexBufferMemory;
+    VkDeviceMemory vertexBufferMemory = VK_NULL_HANDLE;  
+    VkDeviceMemory indexBufferMemory = VK_NULL_HANDLE;
 
-    uint32_t vertexCount;
-    uint32_t indexCount;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
     bool hasIndexBuffer = false;
 
+    VertexFormat vertexFormat = VertexFormat::FULL;
+    VkDeviceSize attributeOffset = 0;
+    glm::mat4 positionDequantization{1.0f};
+    float boundingRadius = 0.0f;
+    boundingVolume bounds{};
+    std::vector<boundingVolume> shapeBounds{};
+    VkDeviceSize vertexBufferSize = 0;
+    VkDeviceSize indexBufferSize = 0;
+    uint64_t contentHash = 0;
+    VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+    std::vector<drawRange> drawRanges{};
+    std::vector<lodDraw> lodDraws{};
+    std::vector<meshlet> meshlets{};
+    std::vector<material> materials{};
+    std::vector<uint64_t> materialKeys{};
+    std::vector<submesh> submeshes{};
+    std::unique_ptr<Impostor> impostor{};
+
+};
+
+}   //  namespace VULKVULK
+
+//  to make a hashing function for our Vertex struct, we need to enable this -> to hash individual vec component
+//  though experimental, it is considered safe
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+#include "../Core/utils.h"
+
+template <>
+struct std::hash<VULKVULK::Model::Vertex> {
+  size_t operator()(VULKVULK::Model::Vertex const &vertex) const {
+    size_t seed = 0;
+    VULKVULK::hashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
+    return seed;
+  }
 };
 
-}
 //  NOTE: that bufferMemory is seperate object and is not part of the buffer object when it gets created
 //          -> This allows programmers control with memory allocation
 #endif
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "pipeline.h"
+#include "../IO/assetPack.h"
 
 #include <fstream>
 #include <stdexcept>
@@ -21,6 +22,10 @@ Pipeline::~Pipeline(){
 }
 
 std::vector<char> Pipeline::readFile(const std::string& filePath){
+    //  shaders ship inside the asset pack, loose files are the fallback(development)
+    if(const AssetPack::entryView entry = AssetPack::shared().find(filePath)){
+        return std::vector<char>(entry.data, entry.data + entry.size);
+    }
     std::ifstream file{filePath.c_str(), std::ios::ate | std::ios::binary};
 
     if(!file.is_open()){
@@ -72,14 +77,14 @@ void Pipeline::createGraphicsPipeline(
     shaderStages[1].pSpecializationInfo = nullptr;
     
     //  Specifying format of vertex Data -> sort of like VBO/VAO in opengl
-    auto bindingDescriptions = Model::Vertex::getBindingDescriptions();
-    auto attributeDescriptions = Model::Vertex::getAttributeDescriptions();
+    const VertexInputDescription& vertexInput = configInfo.vertexInput;
+    vertexBindingMask = vertexInput.bindingMask();
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-    vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size()); 
-    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-    vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
+    vertexInputInfo.vertexAttributeDescriptionCount = vertexInput.attributeCount;
+    vertexInputInfo.vertexBindingDescriptionCount = vertexInput.bindingCount; 
+    vertexInputInfo.pVertexAttributeDescriptions = vertexInput.attributes;
+    vertexInputInfo.pVertexBindingDescriptions = vertexInput.bindings;
 
     VkGraphicsPipelineCreateInfo pipelineInfo{};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
@@ -126,6 +131,8 @@ void Pipeline::bind(VkCommandBuffer commandBuffer){
 
 
 void Pipeline::defaultPipelineConfigInfo(PipelineConfigInfo& configInfo){
+    configInfo.vertexInput = FullVertexInput::description();
+
     //  drawing(or operation) setting for given vertex data -> like GL_TRIANGLE inside drawCall from openGL
     configInfo.inputAssemblyInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
     configInfo.inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;    //  everry 3point => triangle, if its 'strip', we get similar effect as using indicies
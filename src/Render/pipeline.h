@@ -6,7 +6,7 @@
 
 
 #include "device.h"
-#include "model.h"
+#include "vertexLayout.h"
 
 namespace VULKVULK{
 //  data used to configure pipeline => outside class for future use on application 
@@ -14,6 +14,8 @@ struct PipelineConfigInfo{
     PipelineConfigInfo() = default;
     PipelineConfigInfo(const PipelineConfigInfo&) = delete;
     PipelineConfigInfo& operator=(const PipelineConfigInfo&) = delete;
+    //  vertex layout the pipeline reads -> default is FullVertexInput(Model::Vertex)
+    VertexInputDescription vertexInput{};
     VkPipelineViewportStateCreateInfo viewportInfo;
     //VkViewport viewport;  => when using "Dynamic Viewport", we will fill them with commandBuffers so no need for them to be here
     //VkRect2D scissor;
@@ -43,6 +45,8 @@ class Pipeline{
 
 
         void bind(VkCommandBuffer commandBuffer);
+        //  bit per vertex binding of the config's vertex input -> Model::bind binds only these streams
+        uint32_t getVertexBindingMask() const { return vertexBindingMask; }
         //  used outside to give defualt ConfigInfo
         static void defaultPipelineConfigInfo(PipelineConfigInfo& configInfo);
 
@@ -62,6 +66,7 @@ class Pipeline{
         VkPipeline graphicPipeline;
         VkShaderModule vertShaderModule;
         VkShaderModule fragShaderModule;
+        uint32_t vertexBindingMask = 0;
 };
 
 }   //  namespace VULKVULK
@@ -1,5 +1,13 @@
 #include "simpleRenderSystem.h"
+#include "impostor.h"
+#include "impostorBaker.h"
+#include "swapChain.h"
+#include "uploadBatch.h"
+#include "../IO/textureStreamer.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <functional>
 #include <stdexcept>
 #include <array>
 
@@ -9,17 +17,33 @@ namespace VULKVULK{
 struct SimplePushConstantData{
     glm::mat4 transform{1.f};
     glm::mat4 modelMatrix{1.f}; //  even though we need mat3, we're passing mat4 bc of alignment rulse
+                                //  4th column is free -> carries the material's diffuse color(impostors : atlas frame)
+                                //  impostors also use the w of every column, see renderGameObjects
 
 }; 
 
+//  object part(transform + normal matrix columns) and material part(4th normal matrix column) get pushed separately
+constexpr uint32_t OBJECT_PUSH_SIZE = offsetof(SimplePushConstantData, modelMatrix) + 3 * sizeof(glm::vec4);
+constexpr uint32_t MATERIAL_PUSH_OFFSET = OBJECT_PUSH_SIZE;
+constexpr VkShaderStageFlags PUSH_STAGES = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+//  set 0 is the impostor atlas
+constexpr uint32_t TEXTURE_SET = 1;
+//  streamed images with a descriptor set at once, draws past that sample the white texture until sets are freed
+constexpr uint32_t MAX_TEXTURE_SETS = 1024;
+
 
 SimpleRenderSystem::SimpleRenderSystem(Device& device, VkRenderPass renderPass) : myDevice(device){
     createPipelineLayout();
     createPipeline(renderPass);   
+    createTextureSets();
 }
 
 SimpleRenderSystem::~SimpleRenderSystem(){
+    //  texture sets are freed with their pool
+    vkDestroyDescriptorPool(myDevice.device(), myTexturePool, nullptr);
     vkDestroyPipelineLayout(myDevice.device(), myPipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(myDevice.device(), myImpostorSetLayout, nullptr);
+    vkDestroyDescriptorSetLayout(myDevice.device(), myTextureSetLayout, nullptr);
     //  pipeline gets destoryed with its deconstructor->RAII
     //  Command buffer get destroyed with its CommandPool WHICH gets destoryed with Device
 }
@@ -27,14 +51,31 @@ SimpleRenderSystem::~SimpleRenderSystem(){
 
 void SimpleRenderSystem::createPipelineLayout(){
     VkPushConstantRange pushConstantRange{};
-    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    pushConstantRange.stageFlags = PUSH_STAGES;
     pushConstantRange.offset = 0;   //  for if your using pushConstant range seperatly for shaders
     pushConstantRange.size = sizeof(SimplePushConstantData);
+    //  only the impostor pipeline reads set 0, only the mesh pipelines read set 1
+    //  -> every pipeline shares the layout so pushed constants stay valid
+    myImpostorSetLayout = Impostor::createSetLayout(myDevice);
+
+    VkDescriptorSetLayoutBinding textureBinding{};
+    textureBinding.binding = 0;
+    textureBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    textureBinding.descriptorCount = 1;
+    textureBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    VkDescriptorSetLayoutCreateInfo textureLayoutInfo{};
+    textureLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    textureLayoutInfo.bindingCount = 1;
+    textureLayoutInfo.pBindings = &textureBinding;
+    if(vkCreateDescriptorSetLayout(myDevice.device(), &textureLayoutInfo, nullptr, &myTextureSetLayout) != VK_SUCCESS){
+        throw std::runtime_error("Failed to create texture descriptor set layout");
+    }
+    const std::array<VkDescriptorSetLayout, 2> setLayouts{myImpostorSetLayout, myTextureSetLayout};
  
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 0;
-    pipelineLayoutInfo.pSetLayouts = nullptr;   //  pass data other than vertex data to our shaders(ex. texture, uniform buffer)
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = setLayouts.data();   //  pass data other than vertex data to our shaders(ex. texture, uniform buffer)
     pipelineLayoutInfo.pushConstantRangeCount = 1;
     pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;   //  efficiently push small data to our shader
     if(vkCreatePipelineLayout(myDevice.device(), &pipelineLayoutInfo, nullptr, &myPipelineLayout) != VK_SUCCESS){
@@ -55,27 +96,341 @@ void SimpleRenderSystem::createPipeline(VkRenderPass renderPass){
         "./shaders/compiledShaders/vert.spv",
         "./shaders/compiledShaders/frag.spv",
         pipelineConfig);
+
+    //  same state, only vertex input and vertex shader differ
+    pipelineConfig.vertexInput = CompactVertexInput::description();
+    myCompactPipeline = std::make_unique<Pipeline>(
+        myDevice, 
+        "./shaders/compiledShaders/compact_vert.spv",
+        "./shaders/compiledShaders/frag.spv",
+        pipelineConfig);
+
+    //  Vertex locations spread over two bindings -> same shaders as the interleaved layout
+    //  LESS_OR_EQUAL : passes where the depth prepass already wrote the same(invariant) depth
+    pipelineConfig.vertexInput = SplitVertexInput::description();
+    pipelineConfig.depthStencilInfo.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+    mySplitPipeline = std::make_unique<Pipeline>(
+        myDevice, 
+        "./shaders/compiledShaders/vert.spv",
+        "./shaders/compiledShaders/frag.spv",
+        pipelineConfig);
+    pipelineConfig.depthStencilInfo.depthCompareOp = VK_COMPARE_OP_LESS;
+
+    //  Quad corners come from gl_VertexIndex -> nothing to read from vertex buffers
+    pipelineConfig.vertexInput = VertexInputDescription{};
+    myImpostorPipeline = std::make_unique<Pipeline>(
+        myDevice, 
+        "./shaders/compiledShaders/impostor_vert.spv",
+        "./shaders/compiledShaders/impostor_frag.spv",
+        pipelineConfig);
+
+    //  Depth only, binding 0 of SPLIT alone -> the attribute stream is never bound nor fetched
+    pipelineConfig.vertexInput = PositionVertexInput::description();
+    pipelineConfig.colorBlendAttachment.colorWriteMask = 0;
+    myDepthPrepassPipeline = std::make_unique<Pipeline>(
+        myDevice, 
+        "./shaders/compiledShaders/depth_prepass_vert.spv",
+        "./shaders/compiledShaders/depth_prepass_frag.spv",
+        pipelineConfig);
+}
+
+void SimpleRenderSystem::createTextureSets(){
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSize.descriptorCount = MAX_TEXTURE_SETS + 1;
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    poolInfo.maxSets = MAX_TEXTURE_SETS + 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    if(vkCreateDescriptorPool(myDevice.device(), &poolInfo, nullptr, &myTexturePool) != VK_SUCCESS){
+        throw std::runtime_error("Failed to create texture descriptor pool");
+    }
+
+    //  one white texel -> materials without map_Kd(or still streaming in) keep their diffuse color
+    Texture::preparedTexture white{};
+    white.format = VK_FORMAT_R8G8B8A8_UNORM;
+    white.width = 1;
+    white.height = 1;
+    white.levels = {{1, 1, 0, 4}};
+    white.pixels = {255, 255, 255, 255};
+    white.data = white.pixels.data();
+    white.dataSize = white.pixels.size();
+    UploadBatch batch{myDevice};
+    myDefaultTexture = std::make_unique<Texture>(myDevice, white, batch);
+    batch.submit();
+    batch.wait();
+    myDefaultTextureSet = allocateTextureSet(*myDefaultTexture);
+    if(myDefaultTextureSet == VK_NULL_HANDLE){
+        throw std::runtime_error("Failed to allocate default texture descriptor set");
+    }
+}
+
+VkDescriptorSet SimpleRenderSystem::allocateTextureSet(const Texture& texture){
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = myTexturePool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &myTextureSetLayout;
+    VkDescriptorSet set = VK_NULL_HANDLE;
+    if(vkAllocateDescriptorSets(myDevice.device(), &allocInfo, &set) != VK_SUCCESS){
+        return VK_NULL_HANDLE;
+    }
+    VkDescriptorImageInfo image{};
+    image.sampler = texture.getSampler();
+    image.imageView = texture.getImageView();
+    image.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = set;
+    write.dstBinding = 0;
+    write.dstArrayElement = 0;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.descriptorCount = 1;
+    write.pImageInfo = &image;
+    vkUpdateDescriptorSets(myDevice.device(), 1, &write, 0, nullptr);
+    return set;
+}
+
+VkDescriptorSet SimpleRenderSystem::textureSetFor(const GameObject& gameObject, uint32_t material){
+    if(material >= gameObject.textures.size() || !gameObject.textures[material]){
+        return myDefaultTextureSet;
+    }
+    //  nullptr until the base levels arrived, a new image whenever the streamer changed the resident levels
+    std::shared_ptr<Texture> texture = gameObject.textures[material]->get();
+    if(!texture){
+        return myDefaultTextureSet;
+    }
+    auto [found, inserted] = textureSets.try_emplace(texture.get());
+    if(inserted){
+        const VkDescriptorSet set = allocateTextureSet(*texture);
+        if(set == VK_NULL_HANDLE){
+            textureSets.erase(found);
+            return myDefaultTextureSet;
+        }
+        found->second = {std::move(texture), set, frame};
+    }
+    found->second.lastFrame = frame;
+    return found->second.set;
+}
+
+void SimpleRenderSystem::releaseTextureSets(){
+    //  the streamer dropped the image(replaced or released) -> only this cache holds it
+    for(auto it = textureSets.begin(); it != textureSets.end();){
+        if(it->second.texture.use_count() == 1 && frame - it->second.lastFrame > SwapChain::MAX_FRAMES_IN_FLIGHT){
+            vkFreeDescriptorSets(myDevice.device(), myTexturePool, 1, &it->second.set);
+            it = textureSets.erase(it);
+        }
+        else{
+            ++it;
+        }
+    }
+}
+
+Pipeline& SimpleRenderSystem::pipelineFor(Model::VertexFormat format){
+    switch(format){
+        case Model::VertexFormat::COMPACT: return *myCompactPipeline;
+        case Model::VertexFormat::SPLIT: return *mySplitPipeline;
+        default: return *myPipeline;
+    }
 }
 
 //  TODO:   Most camera calculations are done inside gpu, sending perspective & translation matrix to shader using uniform buffers
 void SimpleRenderSystem::renderGameObjects(VkCommandBuffer commandBuffer, std::vector<GameObject> &gameObjects, const Camera& camera){
     
-    myPipeline->bind(commandBuffer);
     //  VP transform
     auto projectionView = camera.GetProjection() * camera.GetView();
+    //  projection[1][1] = 1/tan(fov/2) -> size at depth 1 in NDC, NDC spans 2 units of screen height
+    const float projectionScale = camera.GetProjection()[1][1] * 0.5f;
+    //  camera position in world space, meshlet cones are tested against it
+    const glm::vec3 cameraPosition = glm::inverse(camera.GetView())[3];
 
-    //  loop through every gameObject
-    for(auto& gameObject : gameObjects){
-        SimplePushConstantData push{};
+    frame++;
+    releaseTextureSets();
+
+    //  1. per object state + one draw item per submesh of its level
+    objectStates.resize(gameObjects.size());
+    drawItems.clear();
+    for(size_t i = 0; i < gameObjects.size(); i++){
+        GameObject& gameObject = gameObjects[i];
+        //  model still loading
+        if(!gameObject.model){
+            continue;
+        }
+        Model& model = *gameObject.model;
+        objectState& state = objectStates[i];
         auto modelMatrix = gameObject.transform.mat4();
-        push.transform = projectionView * modelMatrix; //   MVP tranform
-        push.modelMatrix = gameObject.transform.normalMatrix(); //  glm automatically converts mat3 to mat4
-
-        vkCmdPushConstants(commandBuffer, myPipelineLayout,
-                        VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                        0, sizeof(SimplePushConstantData), &push);
-        gameObject.model->bind(commandBuffer);
-        gameObject.model->draw(commandBuffer);
+        state.normalMatrix = gameObject.transform.normalMatrix(); //  glm automatically converts mat3 to mat4
+        const glm::vec3& scale = gameObject.transform.scale;
+        const float maxScale = glm::max(glm::max(glm::abs(scale.x), glm::abs(scale.y)), glm::abs(scale.z));
+
+        //  far and small on screen -> frame of the atlas closest to the direction the camera sees the model from
+        if(Impostor* impostor = model.getImpostor()){
+            const glm::vec3 worldCenter = modelMatrix * glm::vec4(impostor->getCenter(), 1.0f);
+            const float depth = (camera.GetView() * glm::vec4(worldCenter, 1.0f)).z;
+            if(depth > impostorDistance && depth > 0.0f
+               && 2.0f * impostor->getRadius() * maxScale * projectionScale / depth < impostorScreenSize){
+                const glm::vec3 cameraModel = glm::inverse(modelMatrix) * glm::vec4(cameraPosition, 1.0f);
+                const uint32_t frames = impostor->getFrameCount();
+                const uint32_t frame = ImpostorBaker::frameFor(frames, cameraModel - impostor->getCenter());
+                const uint32_t frameX = frame % frames;
+                const uint32_t frameY = frame / frames;
+                const glm::vec3 toCamera = glm::normalize(cameraModel - impostor->getCenter());
+                const glm::vec3 forward = ImpostorBaker::frameDirection(frames, frameX, frameY);
+                glm::vec3 right{}, up{}, frameRight{}, frameUp{};
+                ImpostorBaker::frameBasis(toCamera, right, up);
+                ImpostorBaker::frameBasis(forward, frameRight, frameUp);
+                //  quad corner (x, y) in [-1, 1] -> model space point on the plane through the sphere center facing the camera
+                glm::mat4 quad{1.0f};
+                quad[0] = glm::vec4{right * impostor->getRadius(), 0.0f};
+                quad[1] = glm::vec4{up * impostor->getRadius(), 0.0f};
+                quad[3] = glm::vec4{impostor->getCenter(), 1.0f};
+                state.transform = projectionView * modelMatrix * quad;
+                state.impostorFrame = {float(frameX) / float(frames), float(frameY) / float(frames), 1.0f / float(frames), 0.0f};
+                //  frame baked along "forward", seen along "toCamera" -> slide quad points along the view direction onto
+                //  the frame plane, linear in the corner so the vertex shader remaps with a 2x2 matrix
+                const float facing = glm::max(glm::dot(toCamera, forward), 1e-3f);
+                auto onFrame = [&](const glm::vec3& axis){
+                    const glm::vec3 projected = axis - toCamera * (glm::dot(axis, forward) / facing);
+                    return glm::vec2{glm::dot(projected, frameRight), glm::dot(projected, frameUp)};
+                };
+                const glm::vec2 alongRight = onFrame(right);
+                const glm::vec2 alongUp = onFrame(up);
+                state.impostorRemap = {alongRight.x, alongUp.x, alongRight.y, alongUp.y};
+                drawItems.push_back({true, model.getVertexFormat(), 0, VK_NULL_HANDLE, &model, static_cast<uint32_t>(i), 0, 0});
+                continue;
+            }
+        }
+        //  compact positions are stored relative to mesh bounds -> dequantization rides along with MVP
+        state.transform = projectionView * modelMatrix * model.getPositionDequantization(); //   MVP tranform
+
+        //  LOD from projected error : model units -> fraction of screen height at the object's view depth
+        state.lod = 0;
+        if(model.getLodCount() > 1){
+            float depth = (camera.GetView() * glm::vec4(gameObject.transform.translation, 1.0f)).z;
+            if(depth > 0.0f){
+                state.lod = model.selectLod(maxScale * projectionScale / depth, lodScreenError);
+            }
+        }
+        //  meshlet bounds live in model space -> cull against model space frustum & camera
+        state.useCull = clusterCulling && model.hasMeshlets();
+        if(state.useCull){
+            glm::vec3 cameraModel = glm::inverse(modelMatrix) * glm::vec4(cameraPosition, 1.0f);
+            state.cull = Model::cullView::fromMatrices(projectionView * modelMatrix, cameraModel);
+        }
+        for(uint32_t s = 0; s < model.getSubmeshCount(state.lod); s++){
+            const uint32_t material = model.getSubmesh(state.lod, s).material;
+            drawItems.push_back({false, model.getVertexFormat(), model.getMaterialKey(material), textureSetFor(gameObject, material),
+                                 &model, static_cast<uint32_t>(i), s, material});
+        }
+    }
+
+    //  2. same material next to each other across every model, same model next to each other inside a material
+    //  impostors last, grouped by model -> one descriptor set bind per model
+    std::sort(drawItems.begin(), drawItems.end(), [](const drawItem& a, const drawItem& b){
+        if(a.impostor != b.impostor){
+            return b.impostor;
+        }
+        if(!a.impostor && a.format != b.format){
+            return a.format < b.format;
+        }
+        if(a.materialKey != b.materialKey){
+            return a.materialKey < b.materialKey;
+        }
+        //  same map_Kd name can still be different files(models in different folders)
+        if(a.textureSet != b.textureSet){
+            return std::less<VkDescriptorSet>{}(a.textureSet, b.textureSet);
+        }
+        if(a.model != b.model){
+            return std::less<Model*>{}(a.model, b.model);
+        }
+        return a.object != b.object ? a.object < b.object : a.submesh < b.submesh;
+    });
+
+    stats = frameStats{};
+    //  3. depth of every SPLIT mesh from positions alone -> the color pass shades only the closest surface
+    //  same items, LOD and meshlet culling as the color pass so both passes rasterize the same triangles
+    if(depthPrepass){
+        const drawItem* previous = nullptr;
+        for(const drawItem& item : drawItems){
+            if(item.impostor || item.format != Model::VertexFormat::SPLIT){
+                continue;
+            }
+            const objectState& state = objectStates[item.object];
+            if(previous == nullptr){
+                myDepthPrepassPipeline->bind(commandBuffer);
+                stats.pipelineBinds++;
+            }
+            if(previous == nullptr || item.model != previous->model){
+                item.model->bind(commandBuffer, myDepthPrepassPipeline->getVertexBindingMask());
+                stats.bufferBinds++;
+            }
+            if(previous == nullptr || item.object != previous->object){
+                vkCmdPushConstants(commandBuffer, myPipelineLayout, PUSH_STAGES, 0, sizeof(state.transform), &state.transform);
+                stats.objectPushes++;
+            }
+            stats.drawCalls += item.model->drawSubmesh(commandBuffer, state.lod, item.submesh, state.useCull ? &state.cull : nullptr);
+            previous = &item;
+        }
+    }
+
+    //  4. record, every kind of state only changes when the sorted items ask for it
+    const drawItem* previous = nullptr;
+    for(const drawItem& item : drawItems){
+        const objectState& state = objectStates[item.object];
+        if(item.impostor){
+            if(previous == nullptr || !previous->impostor){
+                myImpostorPipeline->bind(commandBuffer);
+                stats.pipelineBinds++;
+            }
+            if(previous == nullptr || !previous->impostor || item.model != previous->model){
+                item.model->getImpostor()->bind(commandBuffer, myPipelineLayout, 0);
+                stats.bufferBinds++;
+            }
+            //  frame differs per object -> the whole block, 4th column included
+            //  w of the columns is unused by the lighting(mat3) -> carries the corner to frame remap
+            SimplePushConstantData push{};
+            push.transform = state.transform;
+            push.modelMatrix = state.normalMatrix;
+            push.modelMatrix[3] = state.impostorFrame;
+            for(int column = 0; column < 4; column++){
+                push.modelMatrix[column].w = state.impostorRemap[column];
+            }
+            vkCmdPushConstants(commandBuffer, myPipelineLayout, PUSH_STAGES, 0, sizeof(push), &push);
+            stats.objectPushes++;
+            vkCmdDraw(commandBuffer, 6, 1, 0, 0);
+            stats.drawCalls++;
+            previous = &item;
+            continue;
+        }
+        if(previous == nullptr || previous->impostor || item.format != previous->format){
+            pipelineFor(item.format).bind(commandBuffer);
+            stats.pipelineBinds++;
+        }
+        //  both pipelines share the layout -> pushed constants survive the pipeline switch
+        if(previous == nullptr || previous->impostor || item.materialKey != previous->materialKey){
+            const glm::vec4 diffuse{item.model->getMaterial(item.material).diffuse, 1.0f};
+            vkCmdPushConstants(commandBuffer, myPipelineLayout, PUSH_STAGES, MATERIAL_PUSH_OFFSET, sizeof(diffuse), &diffuse);
+            stats.materialChanges++;
+        }
+        if(previous == nullptr || previous->impostor || item.textureSet != previous->textureSet){
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, myPipelineLayout, TEXTURE_SET, 1, &item.textureSet, 0, nullptr);
+            stats.textureBinds++;
+        }
+        if(previous == nullptr || previous->impostor || item.model != previous->model){
+            item.model->bind(commandBuffer, pipelineFor(item.format).getVertexBindingMask());
+            stats.bufferBinds++;
+        }
+        if(previous == nullptr || previous->impostor || item.object != previous->object){
+            SimplePushConstantData push{};
+            push.transform = state.transform;
+            push.modelMatrix = state.normalMatrix;
+            vkCmdPushConstants(commandBuffer, myPipelineLayout, PUSH_STAGES, 0, OBJECT_PUSH_SIZE, &push);
+            stats.objectPushes++;
+        }
+        stats.drawCalls += item.model->drawSubmesh(commandBuffer, state.lod, item.submesh, state.useCull ? &state.cull : nullptr);
+        previous = &item;
     }
  
 }
@@ -5,8 +5,10 @@
 #include "../Render/device.h" 
 #include "../GameAsset/gameObject.h"    //  -> contains model.h
 #include "../Render/camera.h"
+#include "../Render/texture.h"
 
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 namespace VULKVULK{
@@ -18,17 +20,111 @@ class SimpleRenderSystem{
         SimpleRenderSystem(const SimpleRenderSystem&) = delete;
         SimpleRenderSystem& operator=(const SimpleRenderSystem&) = delete;
         
+        //  State changes recorded by one renderGameObjects call
+        struct frameStats{
+            uint32_t pipelineBinds = 0;
+            uint32_t materialChanges = 0;   //  material constants pushed
+            uint32_t textureBinds = 0;      //  material texture descriptor sets
+            uint32_t bufferBinds = 0;       //  vertex + index buffer of a model(impostors : atlas descriptor set)
+            uint32_t objectPushes = 0;      //  transform constants pushed
+            uint32_t drawCalls = 0;
+
+            bool operator==(const frameStats& other) const {
+                return pipelineBinds == other.pipelineBinds && materialChanges == other.materialChanges
+                    && textureBinds == other.textureBinds && bufferBinds == other.bufferBinds
+                    && objectPushes == other.objectPushes && drawCalls == other.drawCalls;
+            }
+            bool operator!=(const frameStats& other) const { return !(*this == other); }
+        };
+
+        //  Every submesh of every object is drawn sorted by (vertex format, material, texture, model, object)
+        //  -> one pipeline bind per format, one material change per distinct material, buffers rebound only between models
+        //  Materials sample the resident image of GameObject::textures, a white texel while there is none
+        //  SPLIT meshes first write their depth from the position stream alone, see setDepthPrepass
+        //  Objects with an impostor(ModelLoadOptions::bakeImpostor) farther than the impostor distance and smaller on
+        //  screen than the impostor size are drawn as one camera facing quad instead, after every mesh
         void renderGameObjects(VkCommandBuffer commandBuffer, std::vector<GameObject> &gameObjects, const Camera& camera);    //  we will get gameObjects from app using "loadGameObjects()"
+        const frameStats& getFrameStats() const { return stats; }
+
+        //  largest LOD error allowed on screen, as fraction of screen height(default ~1 pixel at 1080p)
+        void setLodScreenError(float screenError) { lodScreenError = screenError; }
+        //  frustum & normal cone culling per meshlet before issuing draws
+        void setClusterCulling(bool enabled) { clusterCulling = enabled; }
+        //  depth only pass over SPLIT meshes before the color pass -> no overdraw shading, costs a second vertex pass
+        void setDepthPrepass(bool enabled) { depthPrepass = enabled; }
+        //  bounding sphere diameter as fraction of screen height below which impostors replace meshes
+        void setImpostorScreenSize(float screenSize) { impostorScreenSize = screenSize; }
+        //  view depth closer than this always draws the mesh
+        void setImpostorDistance(float distance) { impostorDistance = distance; }
 
     private: 
+        //  one submesh of one object this frame
+        struct drawItem{
+            bool impostor;              //  one quad of the model's Impostor, submesh/material unused
+            Model::VertexFormat format;
+            uint64_t materialKey;
+            VkDescriptorSet textureSet;     //  set 1 of the mesh pipelines
+            Model* model;
+            uint32_t object;            //  into gameObjects/objectStates
+            uint32_t submesh;
+            uint32_t material;
+        };
+        //  per object values every submesh of the object shares
+        struct objectState{
+            glm::mat4 transform{1.0f};
+            glm::mat4 normalMatrix{1.0f};
+            Model::cullView cull{};
+            bool useCull = false;
+            uint32_t lod = 0;
+            glm::vec4 impostorFrame{};  //  atlas u, v of the frame facing the camera + frame size in uv
+            glm::vec4 impostorRemap{};  //  quad corner -> frame plane, 2x2 row major(see renderGameObjects)
+        };
+        //  descriptor set of one streamed image, holds the image -> the key can not be reused while the entry exists
+        struct textureSet{
+            std::shared_ptr<Texture> texture;
+            VkDescriptorSet set;
+            uint64_t lastFrame;         //  last frame that drew with it
+        };
+
         void createPipelineLayout();
         void createPipeline(VkRenderPass renderPass);
+        //  descriptor pool + the white texture untextured materials sample
+        void createTextureSets();
+        //  VK_NULL_HANDLE once the pool is full
+        VkDescriptorSet allocateTextureSet(const Texture& texture);
+        //  set of the image currently resident for "material" of the object
+        VkDescriptorSet textureSetFor(const GameObject& gameObject, uint32_t material);
+        //  frees sets of images nobody but this cache holds and no frame in flight uses anymore
+        void releaseTextureSets();
+        Pipeline& pipelineFor(Model::VertexFormat format);
 
  
         Device &myDevice;  
 
         std::unique_ptr<Pipeline> myPipeline = nullptr;
+        std::unique_ptr<Pipeline> myCompactPipeline = nullptr;    //  for Model::VertexFormat::COMPACT
+        std::unique_ptr<Pipeline> mySplitPipeline = nullptr;      //  for Model::VertexFormat::SPLIT
+        std::unique_ptr<Pipeline> myImpostorPipeline = nullptr;   //  no vertex input, quad corners from the vertex index
+        std::unique_ptr<Pipeline> myDepthPrepassPipeline = nullptr;   //  PositionVertexInput, no color writes
+        VkDescriptorSetLayout myImpostorSetLayout = VK_NULL_HANDLE;   //  set 0, see Impostor
+        VkDescriptorSetLayout myTextureSetLayout = VK_NULL_HANDLE;    //  set 1 : binding 0 material diffuse texture
+        VkDescriptorPool myTexturePool = VK_NULL_HANDLE;
+        std::unique_ptr<Texture> myDefaultTexture = nullptr;
+        VkDescriptorSet myDefaultTextureSet = VK_NULL_HANDLE;
         VkPipelineLayout myPipelineLayout; 
+
+        float lodScreenError = 1.0f / 1080.0f;
+        bool clusterCulling = true;
+        bool depthPrepass = true;
+        float impostorScreenSize = 0.08f;
+        float impostorDistance = 10.0f;
+
+        //  kept between frames -> no allocation once the scene stopped growing
+        std::vector<objectState> objectStates{};
+        std::vector<drawItem> drawItems{};
+        std::unordered_map<const Texture*, textureSet> textureSets{};
+        uint64_t frame = 0;
+        frameStats stats{};
 };
 
 }   //  namespace VULKVULK
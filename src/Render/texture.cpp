@@ -0,0 +1,239 @@
+#include "texture.h"
+#include "uploadBatch.h"
+#include "../IO/textureCache.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace VULKVULK{
+
+uint32_t TextureLoadOptions::processKey() const{
+    //  FNV-1a over every option that changes the baked data
+    uint32_t key = 2166136261u;
+    auto mix = [&](const void* data, size_t size){
+        auto bytes = static_cast<const uint8_t*>(data);
+        for(size_t i = 0; i < size; i++){
+            key = (key ^ bytes[i]) * 16777619u;
+        }
+    };
+    mix(&srgb, sizeof(srgb));
+    mix(&mipFilter, sizeof(mipFilter));
+    mix(&compression, sizeof(compression));
+    return key;
+}
+
+Texture::textureView Texture::preparedTexture::view() const{
+    textureView result{};
+    result.format = format;
+    result.width = width;
+    result.height = height;
+    result.levels = levels.data();
+    result.levelCount = static_cast<uint32_t>(levels.size());
+    result.data = data;
+    result.dataSize = dataSize;
+    return result;
+}
+
+VkFormat Texture::formatFor(TextureCompression compression, bool srgb){
+    switch(compression){
+        case TextureCompression::BC1: return srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+        case TextureCompression::BC7: return srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+        default: return srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    }
+}
+
+TextureCompression Texture::supportedCompression(Device& device, TextureCompression compression, bool srgb){
+    if(compression == TextureCompression::NONE){
+        return compression;
+    }
+    //  BC formats are optional(textureCompressionBC) -> mobile GPUs usually can not sample them
+    bool supported = device.isFormatSupported(formatFor(compression, srgb), VK_IMAGE_TILING_OPTIMAL,
+                                              VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
+    return supported ? compression : TextureCompression::NONE;
+}
+
+Texture::preparedTexture Texture::prepareFromFile(const std::string& filepath, const TextureLoadOptions& options){
+    //  collected and printed at once -> lines of textures loading on different threads do not interleave
+    std::ostringstream log{};
+    preparedTexture texture{};
+
+    //  Fast path : cache from the mounted asset pack or next to the source -> levels are uploaded straight from the mapping
+    textureView cachedView{};
+    const bool packed = TextureCache::readFromPack(filepath, options.processKey(), cachedView);
+    if(packed || TextureCache::read(filepath, options.processKey(), texture.cacheFile, cachedView)){
+        texture.format = cachedView.format;
+        texture.width = cachedView.width;
+        texture.height = cachedView.height;
+        texture.levels.assign(cachedView.levels, cachedView.levels + cachedView.levelCount);
+        texture.data = cachedView.data;
+        texture.dataSize = cachedView.dataSize;
+        log << "Texture " << filepath << " : " << texture.width << "x" << texture.height << ", "
+            << texture.levels.size() << " mips, " << texture.dataSize / 1024 << (packed ? " KB (pack)\n" : " KB (cached)\n");
+        std::cout << log.str();
+        return texture;
+    }
+
+    texture = processFile(filepath, options, log);
+    if(!TextureCache::write(filepath, options.processKey(), texture.view())){
+        log << "Could not write texture cache for " << filepath << "\n";
+    }
+    std::cout << log.str();
+    return texture;
+}
+
+Texture::preparedTexture Texture::processFile(const std::string& filepath, const TextureLoadOptions& options, std::ostream& log){
+    preparedTexture texture{};
+    auto start = std::chrono::steady_clock::now();
+    int width = 0, height = 0, channels = 0;
+    //  always expanded to RGBA -> one code path for mips and encoders
+    stbi_uc* decoded = stbi_load(filepath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if(decoded == nullptr){
+        throw std::runtime_error("failed to load texture " + filepath + " : " + stbi_failure_reason());
+    }
+    auto decodedTime = std::chrono::steady_clock::now();
+    std::vector<MipGenerator::image> chain = MipGenerator::buildChain(
+        decoded, static_cast<uint32_t>(width), static_cast<uint32_t>(height), options.mipFilter, options.srgb);
+    stbi_image_free(decoded);
+    auto mipTime = std::chrono::steady_clock::now();
+
+    //  levels back to back, every level size is a multiple of the block size -> offsets stay valid copy offsets
+    for(const MipGenerator::image& level : chain){
+        std::vector<uint8_t> encoded = BlockCompressor::compress(level.pixels.data(), level.width, level.height, options.compression);
+        texture.levels.push_back({level.width, level.height, texture.pixels.size(), encoded.size()});
+        texture.pixels.insert(texture.pixels.end(), encoded.begin(), encoded.end());
+    }
+    auto encodeTime = std::chrono::steady_clock::now();
+    texture.format = formatFor(options.compression, options.srgb);
+    texture.width = static_cast<uint32_t>(width);
+    texture.height = static_cast<uint32_t>(height);
+    texture.data = texture.pixels.data();
+    texture.dataSize = texture.pixels.size();
+
+    auto ms = [](auto from, auto to){ return std::chrono::duration<double, std::milli>(to - from).count(); };
+    log << "Texture " << filepath << " : " << width << "x" << height << ", " << texture.levels.size() << " mips, "
+        << texture.dataSize / 1024 << " KB (decode " << ms(start, decodedTime) << " ms, mips " << ms(decodedTime, mipTime)
+        << " ms, encode " << ms(mipTime, encodeTime) << " ms)\n";
+    return texture;
+}
+
+Texture::Texture(Device& device, const preparedTexture& texture, UploadBatch& batch, uint32_t firstMip) : device(device){
+    if(firstMip >= texture.levels.size()){
+        throw std::runtime_error("texture has no mip level " + std::to_string(firstMip) + "!");
+    }
+    this->firstMip = firstMip;
+    createImage(texture);
+    createImageView();
+    createSampler();
+    //  recorded last -> a failed constructor never leaves a copy into a destroyed image in the batch
+    recordUpload(texture, batch);
+}
+
+Texture::~Texture(){
+    vkDestroySampler(device.device(), sampler, nullptr);
+    vkDestroyImageView(device.device(), imageView, nullptr);
+    vkDestroyImage(device.device(), image, nullptr);
+    vkFreeMemory(device.device(), imageMemory, nullptr);
+}
+
+std::unique_ptr<Texture> Texture::createTextureFromFile(Device& device, const std::string& filepath, const TextureLoadOptions& options){
+    TextureLoadOptions supportedOptions = options;
+    supportedOptions.compression = supportedCompression(device, options.compression, options.srgb);
+    const preparedTexture texture = prepareFromFile(filepath, supportedOptions);
+    UploadBatch batch{device};
+    auto result = std::make_unique<Texture>(device, texture, batch);
+    batch.submit();
+    batch.wait();
+    return result;
+}
+
+void Texture::createImage(const preparedTexture& texture){
+    format = texture.format;
+    width = texture.levels[firstMip].width;
+    height = texture.levels[firstMip].height;
+    mipCount = static_cast<uint32_t>(texture.levels.size()) - firstMip;
+
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = format;
+    imageInfo.extent.width = width;
+    imageInfo.extent.height = height;
+    imageInfo.extent.depth = 1;
+    imageInfo.mipLevels = mipCount;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    device.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, imageMemory);
+
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(device.device(), image, &memRequirements);
+    memorySize = memRequirements.size;
+}
+
+void Texture::recordUpload(const preparedTexture& texture, UploadBatch& batch){
+    //  one region per level, all levels in one copy command
+    //  levels are stored largest first -> the levels from firstMip on are one contiguous tail of the data
+    const uint64_t tailOffset = texture.levels[firstMip].offset;
+    std::vector<VkBufferImageCopy> regions(mipCount);
+    for(uint32_t i = 0; i < mipCount; i++){
+        const mipLevel& level = texture.levels[firstMip + i];
+        VkBufferImageCopy& region = regions[i];
+        region.bufferOffset = level.offset - tailOffset;
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = i;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = {0, 0, 0};
+        region.imageExtent = {level.width, level.height, 1};
+    }
+    batch.uploadImage(texture.data + tailOffset, texture.dataSize - tailOffset, image, regions, mipCount);
+}
+
+void Texture::createImageView(){
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = format;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = mipCount;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+    if(vkCreateImageView(device.device(), &viewInfo, nullptr, &imageView) != VK_SUCCESS){
+        throw std::runtime_error("failed to create texture image view!");
+    }
+}
+
+void Texture::createSampler(){
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    //  samplerAnisotropy is always enabled by Device
+    samplerInfo.anisotropyEnable = VK_TRUE;
+    samplerInfo.maxAnisotropy = device.properties.limits.maxSamplerAnisotropy;
+    samplerInfo.compareEnable = VK_FALSE;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = static_cast<float>(mipCount);
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    if(vkCreateSampler(device.device(), &samplerInfo, nullptr, &sampler) != VK_SUCCESS){
+        throw std::runtime_error("failed to create texture sampler!");
+    }
+}
+
+}   //  namespace VULKVULK
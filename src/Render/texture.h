@@ -0,0 +1,116 @@
+#ifndef TEXTURE_H
+#define TEXTURE_H
+
+#include "device.h"
+#include "blockCompressor.h"
+#include "mipGenerator.h"
+#include "../IO/mappedFile.h"
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace VULKVULK{
+
+class UploadBatch;
+
+struct TextureLoadOptions{
+    bool srgb = true;                                       //  color data, false for normal/roughness maps etc.
+    MipFilter mipFilter = MipFilter::KAISER;
+    TextureCompression compression = TextureCompression::BC7;  //  falls back to NONE if the device can not sample it
+
+    //  identifies the processing baked into the cache -> cache baked with different options is rebuilt
+    uint32_t processKey() const;
+};
+
+//  Sampled 2D image with a full mip chain
+//  Decoding(stb_image), mip generation and block compression run in prepareFromFile -> meant for worker threads,
+//  the result is written to "<source>.vktex" so later loads only map the cache and upload
+class Texture{
+public:
+    //  one mip level inside the prepared data
+    struct mipLevel{
+        uint32_t width;
+        uint32_t height;
+        uint64_t offset;
+        uint64_t size;
+    };
+    //  non owning view of a whole mip chain, what the cache reads and writes
+    struct textureView{
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        const mipLevel* levels = nullptr;
+        uint32_t levelCount = 0;
+        const uint8_t* data = nullptr;
+        uint64_t dataSize = 0;
+    };
+    //  CPU side result of loading a texture file, data either lives in "pixels", the mapped cache or the asset pack
+    //  -> moving it keeps "data" valid, so it can sit in an UploadBatch until the copies are done
+    struct preparedTexture{
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<mipLevel> levels{};
+        std::vector<uint8_t> pixels{};
+        MappedFile cacheFile{};
+        const uint8_t* data = nullptr;
+        uint64_t dataSize = 0;
+
+        textureView view() const;
+    };
+
+    //  worker thread safe, throws if the file can not be decoded
+    static preparedTexture prepareFromFile(const std::string& filepath, const TextureLoadOptions& options);
+    //  decode + mips + encode only, no cache involved(what gets baked into .vktex), throws like prepareFromFile
+    static preparedTexture processFile(const std::string& filepath, const TextureLoadOptions& options, std::ostream& log);
+    //  "compression" if the device can sample it, NONE otherwise
+    static TextureCompression supportedCompression(Device& device, TextureCompression compression, bool srgb);
+    static VkFormat formatFor(TextureCompression compression, bool srgb);
+
+    //  records the mip uploads into "batch" -> usable once the batch completed, "texture" must stay alive until then
+    //  "firstMip" > 0 leaves the largest levels out(texture streaming), level firstMip becomes the image's level 0
+    Texture(Device& device, const preparedTexture& texture, UploadBatch& batch, uint32_t firstMip = 0);
+    ~Texture();
+
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
+
+    //  blocking load, for startup and tools
+    static std::unique_ptr<Texture> createTextureFromFile(Device& device, const std::string& filepath,
+                                                          const TextureLoadOptions& options = TextureLoadOptions{});
+
+    VkImageView getImageView() const { return imageView; }
+    VkSampler getSampler() const { return sampler; }
+    VkFormat getFormat() const { return format; }
+    uint32_t getWidth() const { return width; }
+    uint32_t getHeight() const { return height; }
+    uint32_t getMipCount() const { return mipCount; }
+    //  level of the source chain that is this image's level 0
+    uint32_t getFirstMip() const { return firstMip; }
+    VkDeviceSize getMemorySize() const { return memorySize; }
+
+private:
+    void createImage(const preparedTexture& texture);
+    void createImageView();
+    void createSampler();
+    void recordUpload(const preparedTexture& texture, UploadBatch& batch);
+
+    Device& device;
+    VkImage image = VK_NULL_HANDLE;
+    VkDeviceMemory imageMemory = VK_NULL_HANDLE;
+    VkImageView imageView = VK_NULL_HANDLE;
+    VkSampler sampler = VK_NULL_HANDLE;
+
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t mipCount = 0;
+    uint32_t firstMip = 0;
+    VkDeviceSize memorySize = 0;
+};
+
+}   //  namespace VULKVULK
+
+#endif
@@ -0,0 +1,175 @@
+#include "uploadBatch.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace VULKVULK{
+
+namespace{
+//  keeps every copy source offset aligned for the copy engine
+constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+
+VkImageMemoryBarrier imageBarrier(VkImage image, uint32_t mipLevels, VkImageLayout oldLayout, VkImageLayout newLayout,
+                                  VkAccessFlags srcAccess, VkAccessFlags dstAccess){
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = mipLevels;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+    return barrier;
+}
+}   //  namespace
+
+UploadBatch::UploadBatch(Device& device) : device(device){}
+
+UploadBatch::~UploadBatch(){
+    if(submitted){
+        wait();
+        vkFreeCommandBuffers(device.device(), device.getCommandPool(), 1, &commandBuffer);
+        vkDestroyFence(device.device(), fence, nullptr);
+        vkDestroyBuffer(device.device(), stagingBuffer, nullptr);
+        vkFreeMemory(device.device(), stagingBufferMemory, nullptr);
+    }
+}
+
+void UploadBatch::uploadBuffer(const void* data, VkDeviceSize size, VkBuffer dstBuffer, VkDeviceSize dstOffset){
+    assert(!submitted && "UploadBatch already submitted!");
+    if(size == 0){
+        return;
+    }
+    stagingSize = (stagingSize + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+    copies.push_back({data, size, stagingSize, dstBuffer, dstOffset});
+    stagingSize += size;
+}
+
+void UploadBatch::uploadImage(const void* data, VkDeviceSize size, VkImage dstImage,
+                              const std::vector<VkBufferImageCopy>& regions, uint32_t mipLevels){
+    assert(!submitted && "UploadBatch already submitted!");
+    stagingSize = (stagingSize + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+    images.push_back({data, size, stagingSize, dstImage, regions, mipLevels});
+    for(VkBufferImageCopy& region : images.back().regions){
+        region.bufferOffset += stagingSize;
+    }
+    stagingSize += size;
+}
+
+void UploadBatch::submit(){
+    assert(!submitted && "UploadBatch already submitted!");
+    if(copies.empty() && images.empty()){
+        complete = true;
+        return;
+    }
+
+    //  single staging buffer for the whole batch
+    device.createBuffer(
+        stagingSize,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        stagingBuffer, stagingBufferMemory);
+    void* mapped;
+    vkMapMemory(device.device(), stagingBufferMemory, 0, stagingSize, 0, &mapped);
+    for(const auto& copy : copies){
+        memcpy(static_cast<uint8_t*>(mapped) + copy.stagingOffset, copy.data, static_cast<size_t>(copy.size));
+    }
+    for(const auto& upload : images){
+        memcpy(static_cast<uint8_t*>(mapped) + upload.stagingOffset, upload.data, static_cast<size_t>(upload.size));
+    }
+    vkUnmapMemory(device.device(), stagingBufferMemory);
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = device.getCommandPool();
+    allocInfo.commandBufferCount = 1;
+    vkAllocateCommandBuffers(device.device(), &allocInfo, &commandBuffer);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    for(const auto& copy : copies){
+        VkBufferCopy copyRegion{};
+        copyRegion.srcOffset = copy.stagingOffset;
+        copyRegion.dstOffset = copy.dstOffset;
+        copyRegion.size = copy.size;
+        vkCmdCopyBuffer(commandBuffer, stagingBuffer, copy.dstBuffer, 1, &copyRegion);
+    }
+    if(!images.empty()){
+        //  every level is overwritten -> old contents can be discarded
+        std::vector<VkImageMemoryBarrier> toTransfer(images.size());
+        for(size_t i = 0; i < images.size(); i++){
+            toTransfer[i] = imageBarrier(images[i].dstImage, images[i].mipLevels,
+                                         VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                         0, VK_ACCESS_TRANSFER_WRITE_BIT);
+        }
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                            0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(toTransfer.size()), toTransfer.data());
+        for(const auto& upload : images){
+            vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, upload.dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                   static_cast<uint32_t>(upload.regions.size()), upload.regions.data());
+        }
+    }
+    //  transfer writes -> visible to vertex input and fragment shaders of everything submitted after this batch
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+    std::vector<VkImageMemoryBarrier> toShader(images.size());
+    for(size_t i = 0; i < images.size(); i++){
+        toShader[i] = imageBarrier(images[i].dstImage, images[i].mipLevels,
+                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                   VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+    }
+    VkPipelineStageFlags dstStages = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+    if(!images.empty()){
+        dstStages |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    }
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStages,
+                        0, 1, &barrier, 0, nullptr, static_cast<uint32_t>(toShader.size()), toShader.data());
+    vkEndCommandBuffer(commandBuffer);
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    if(vkCreateFence(device.device(), &fenceInfo, nullptr, &fence) != VK_SUCCESS){
+        throw std::runtime_error("failed to create upload fence!");
+    }
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    if(vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, fence) != VK_SUCCESS){
+        throw std::runtime_error("failed to submit upload batch!");
+    }
+    submitted = true;
+    //  sources are not touched after this point
+    copies.clear();
+    images.clear();
+}
+
+bool UploadBatch::isComplete(){
+    if(!complete && submitted){
+        complete = vkGetFenceStatus(device.device(), fence) == VK_SUCCESS;
+    }
+    return complete;
+}
+
+void UploadBatch::wait(){
+    if(!complete && submitted){
+        vkWaitForFences(device.device(), 1, &fence, VK_TRUE, UINT64_MAX);
+        complete = true;
+    }
+}
+
+}   //  namespace VULKVULK
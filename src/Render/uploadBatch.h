@@ -0,0 +1,70 @@
+#ifndef UPLOAD_BATCH_H
+#define UPLOAD_BATCH_H
+
+#include "device.h"
+
+#include <vector>
+
+namespace VULKVULK{
+
+//  Collects buffer and image uploads and sends them in one go : one staging buffer, one command buffer, one submit
+//  Device::copyBuffer waits for the queue after every copy -> batching lets many models upload per wait(or none, see isComplete)
+class UploadBatch{
+public:
+    explicit UploadBatch(Device& device);
+    //  waits for a submitted batch before freeing the staging memory
+    ~UploadBatch();
+
+    UploadBatch(const UploadBatch&) = delete;
+    UploadBatch& operator=(const UploadBatch&) = delete;
+
+    //  "data" is only read at submit() -> it must stay alive until then
+    void uploadBuffer(const void* data, VkDeviceSize size, VkBuffer dstBuffer, VkDeviceSize dstOffset = 0);
+    //  "regions" bufferOffsets are relative to "data", every level in [0, mipLevels) is written
+    //  -> image goes UNDEFINED -> TRANSFER_DST -> SHADER_READ_ONLY inside the batch
+    void uploadImage(const void* data, VkDeviceSize size, VkImage dstImage,
+                     const std::vector<VkBufferImageCopy>& regions, uint32_t mipLevels);
+
+    //  Copies everything into staging memory and submits to the graphics queue with a fence
+    //  The batch ends with a barrier so vertex/index reads and fragment shader samples of later submissions see the data
+    void submit();
+    //  Non blocking fence check -> true once the GPU finished the copies(also true for an empty batch)
+    bool isComplete();
+    void wait();
+
+    bool empty() const { return stagingSize == 0; }
+    VkDeviceSize getStagingSize() const { return stagingSize; }
+
+private:
+    struct pendingCopy{
+        const void* data;
+        VkDeviceSize size;
+        VkDeviceSize stagingOffset;
+        VkBuffer dstBuffer;
+        VkDeviceSize dstOffset;
+    };
+    struct pendingImage{
+        const void* data;
+        VkDeviceSize size;
+        VkDeviceSize stagingOffset;
+        VkImage dstImage;
+        std::vector<VkBufferImageCopy> regions;
+        uint32_t mipLevels;
+    };
+
+    Device& device;
+    std::vector<pendingCopy> copies{};
+    std::vector<pendingImage> images{};
+    VkDeviceSize stagingSize = 0;
+
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    VkFence fence = VK_NULL_HANDLE;
+    bool submitted = false;
+    bool complete = false;
+};
+
+}   //  namespace VULKVULK
+
+#endif
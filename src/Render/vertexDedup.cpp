@@ -0,0 +1,46 @@
+#include "vertexDedup.h"
+
+#include <algorithm>
+
+namespace VULKVULK{
+
+namespace{
+constexpr size_t MIN_SLOT_COUNT = 64;
+
+size_t nextPowerOfTwo(size_t value){
+    size_t result = 1;
+    while(result < value){
+        result <<= 1;
+    }
+    return result;
+}
+}
+
+VertexDedupTable::VertexDedupTable(size_t indexCount){
+    //  smooth meshes share every vertex between ~6 triangles, hard edged ones(cube) far less
+    //  -> size for 1/3 of the corners being unique at 50% load, grow if the mesh turns out to be more split
+    size_t expectedUnique = indexCount / 3 + 1;
+    rehash(std::max(MIN_SLOT_COUNT, nextPowerOfTwo(expectedUnique * 2)), {});
+}
+
+void VertexDedupTable::rehash(size_t newSlotCount, const std::vector<Model::Vertex>& vertices){
+    std::vector<uint64_t> oldSlots = std::move(slots);
+    slots.assign(newSlotCount, 0);
+    slotMask = newSlotCount - 1;
+    growThreshold = newSlotCount / 4 * 3;   //  linear probing falls apart above ~75% load
+
+    for(uint64_t entry : oldSlots){
+        if(entry == 0){
+            continue;
+        }
+        //  tag only keeps the upper hash bits -> recompute for the slot position
+        uint32_t index = static_cast<uint32_t>(entry) - 1;
+        size_t slot = static_cast<size_t>(hash(vertices[index])) & slotMask;
+        while(slots[slot] != 0){
+            slot = (slot + 1) & slotMask;
+        }
+        slots[slot] = entry;
+    }
+}
+
+}   //  namespace VULKVULK
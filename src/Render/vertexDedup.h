@@ -0,0 +1,91 @@
+#ifndef VERTEX_DEDUP_H
+#define VERTEX_DEDUP_H
+
+#include "model.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace VULKVULK{
+
+//  Flat open addressing(linear probing) table used for vertex welding in the loaders
+//  -> one probe sequence per corner for find-or-insert, no node allocation, vertex itself stays in the output array
+//
+//  Every slot packs [32 bit hash tag | vertex index + 1] so most mismatches are rejected without touching the vertex array
+class VertexDedupTable{
+public:
+    //  Presized from the index count of the mesh, so the common case never rehashes
+    explicit VertexDedupTable(size_t indexCount);
+
+    //  Returns index of a vertex equal to "vertex" in "vertices", otherwise appends it and returns the new index
+    uint32_t findOrInsert(const Model::Vertex& vertex, std::vector<Model::Vertex>& vertices);
+
+    //  Hash over the raw 44 bytes, 32x32->64 multiplies over word pairs(same shape as xxh3's accumulate, vectorizes well)
+    static uint64_t hash(const Model::Vertex& vertex);
+
+private:
+    void rehash(size_t newSlotCount, const std::vector<Model::Vertex>& vertices);
+
+    std::vector<uint64_t> slots;
+    size_t slotMask = 0;
+    size_t usedSlots = 0;
+    size_t growThreshold = 0;
+};
+
+inline uint64_t VertexDedupTable::hash(const Model::Vertex& vertex){
+    static_assert(sizeof(Model::Vertex) == 11 * sizeof(uint32_t), "hash expects Vertex to be 11 tightly packed floats");
+    static constexpr uint32_t KEYS[12] = {
+        0xbe4ba423u, 0x396cfeb8u, 0x1cad21f7u, 0x2c81017cu, 0xdb979083u, 0x7c6dbe5eu,
+        0x9e3779b9u, 0x85ebca6bu, 0xc2b2ae35u, 0x27d4eb2fu, 0x165667b1u, 0xd3a2646cu,
+    };
+    uint32_t words[12];
+    std::memcpy(words, &vertex, sizeof(Model::Vertex));
+    words[11] = 0;
+
+    uint64_t accumulator = 0;
+    for(int i = 0; i < 12; i += 2){
+        //  -0.0f == 0.0f for operator== so they have to land in the same bucket
+        uint32_t low = (words[i] & 0x7fffffffu) != 0 ? words[i] : 0u;
+        uint32_t high = (words[i + 1] & 0x7fffffffu) != 0 ? words[i + 1] : 0u;
+        accumulator += uint64_t(low ^ KEYS[i]) * uint64_t(high ^ KEYS[i + 1]);
+    }
+    //  murmur3 finalizer -> low bits(used for slot) depend on every input bit
+    accumulator ^= accumulator >> 33;
+    accumulator *= 0xff51afd7ed558ccdull;
+    accumulator ^= accumulator >> 33;
+    accumulator *= 0xc4ceb9fe1a85ec53ull;
+    accumulator ^= accumulator >> 33;
+    return accumulator;
+}
+
+inline uint32_t VertexDedupTable::findOrInsert(const Model::Vertex& vertex, std::vector<Model::Vertex>& vertices){
+    const uint64_t h = hash(vertex);
+    const uint64_t tag = h & 0xffffffff00000000ull;
+    size_t slot = static_cast<size_t>(h) & slotMask;
+    while(true){
+        const uint64_t entry = slots[slot];
+        if(entry == 0){
+            break;
+        }
+        if((entry & 0xffffffff00000000ull) == tag){
+            uint32_t index = static_cast<uint32_t>(entry) - 1;
+            if(vertices[index] == vertex){
+                return index;
+            }
+        }
+        slot = (slot + 1) & slotMask;
+    }
+
+    uint32_t index = static_cast<uint32_t>(vertices.size());
+    vertices.push_back(vertex);
+    slots[slot] = tag | (uint64_t(index) + 1);
+    if(++usedSlots > growThreshold){
+        rehash(slots.size() * 2, vertices);
+    }
+    return index;
+}
+
+}   //  namespace VULKVULK
+
+#endif
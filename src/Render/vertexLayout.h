@@ -0,0 +1,307 @@
+#ifndef VERTEX_LAYOUT_H
+#define VERTEX_LAYOUT_H
+
+#include "vertexQuantizer.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace VULKVULK{
+
+//  Vertex formats declared once at compile time : a struct lists its attributes(location, meaning, encoding, offset)
+//  and gets from that list
+//      - the Vulkan binding/attribute descriptions as static constexpr arrays(no allocation, no hand kept offsets)
+//      - pack/unpack between Model::Vertex and the struct, unrolled for that struct -> no per vertex branching
+//
+//      using MyLayout = VertexLayout<MyVertex, 0,
+//          VertexAttribute<0, VertexSemantic::POSITION, vertexEncoding::BoundsSnorm16x4, offsetof(MyVertex, position)>,
+//          VertexAttribute<2, VertexSemantic::NORMAL, vertexEncoding::OctahedralSnorm16x2, offsetof(MyVertex, normal)>>;
+//
+//  Attributes a layout leaves out are dropped by pack and come back default(zero) from unpack
+//  Layouts of the formats Model uploads are at the bottom of this file
+
+//  Model::Vertex member an attribute carries
+enum class VertexSemantic : uint32_t{
+    POSITION,
+    COLOR,
+    NORMAL,
+    UV,
+};
+
+template <VertexSemantic Semantic> struct vertexSemanticMember;
+template <> struct vertexSemanticMember<VertexSemantic::POSITION>{
+    static glm::vec3& get(Model::Vertex& vertex){ return vertex.position; }
+    static const glm::vec3& get(const Model::Vertex& vertex){ return vertex.position; }
+};
+template <> struct vertexSemanticMember<VertexSemantic::COLOR>{
+    static glm::vec3& get(Model::Vertex& vertex){ return vertex.color; }
+    static const glm::vec3& get(const Model::Vertex& vertex){ return vertex.color; }
+};
+template <> struct vertexSemanticMember<VertexSemantic::NORMAL>{
+    static glm::vec3& get(Model::Vertex& vertex){ return vertex.normal; }
+    static const glm::vec3& get(const Model::Vertex& vertex){ return vertex.normal; }
+};
+template <> struct vertexSemanticMember<VertexSemantic::UV>{
+    static glm::vec2& get(Model::Vertex& vertex){ return vertex.uv; }
+    static const glm::vec2& get(const Model::Vertex& vertex){ return vertex.uv; }
+};
+
+//  Value <-> bytes read through FORMAT, unpack mirrors what the gpu does with them
+//  "bounds" only matters to positions stored relative to the mesh bounds, see VertexQuantizer::PositionBounds
+namespace vertexEncoding{
+
+struct Float3{
+    static constexpr VkFormat FORMAT = VK_FORMAT_R32G32B32_SFLOAT;
+    using storage = glm::vec3;
+
+    static void pack(const glm::vec3& value, storage& out, const VertexQuantizer::PositionBounds&){ out = value; }
+    static glm::vec3 unpack(const storage& in, const VertexQuantizer::PositionBounds&){ return in; }
+};
+
+struct Float2{
+    static constexpr VkFormat FORMAT = VK_FORMAT_R32G32_SFLOAT;
+    using storage = glm::vec2;
+
+    static void pack(const glm::vec2& value, storage& out, const VertexQuantizer::PositionBounds&){ out = value; }
+    static glm::vec2 unpack(const storage& in, const VertexQuantizer::PositionBounds&){ return in; }
+};
+
+//  snorm16 relative to the bounds, RGB16 snorm is optional for vertex input so it carries an unused w = 1
+struct BoundsSnorm16x4{
+    static constexpr VkFormat FORMAT = VK_FORMAT_R16G16B16A16_SNORM;
+    using storage = int16_t[4];
+
+    static void pack(const glm::vec3& value, storage& out, const VertexQuantizer::PositionBounds& bounds){
+        const glm::vec3 local = (value - bounds.center) / bounds.extent;
+        for(int i = 0; i < 3; i++){
+            out[i] = VertexQuantizer::encodeSnorm16(local[i]);
+        }
+        out[3] = VertexQuantizer::encodeSnorm16(1.0f);
+    }
+    static glm::vec3 unpack(const storage& in, const VertexQuantizer::PositionBounds& bounds){
+        const glm::vec3 local{VertexQuantizer::decodeSnorm16(in[0]), VertexQuantizer::decodeSnorm16(in[1]),
+                              VertexQuantizer::decodeSnorm16(in[2])};
+        return bounds.center + bounds.extent * local;
+    }
+};
+
+//  unit vector folded onto the octahedron, decoded by simple_compact.vert
+struct OctahedralSnorm16x2{
+    static constexpr VkFormat FORMAT = VK_FORMAT_R16G16_SNORM;
+    using storage = int16_t[2];
+
+    static void pack(const glm::vec3& value, storage& out, const VertexQuantizer::PositionBounds&){
+        const glm::vec2 octahedral = VertexQuantizer::encodeOctahedral(value);
+        out[0] = VertexQuantizer::encodeSnorm16(octahedral.x);
+        out[1] = VertexQuantizer::encodeSnorm16(octahedral.y);
+    }
+    static glm::vec3 unpack(const storage& in, const VertexQuantizer::PositionBounds&){
+        return VertexQuantizer::decodeOctahedral({VertexQuantizer::decodeSnorm16(in[0]), VertexQuantizer::decodeSnorm16(in[1])});
+    }
+};
+
+//  a = 1
+struct Unorm8x4{
+    static constexpr VkFormat FORMAT = VK_FORMAT_R8G8B8A8_UNORM;
+    using storage = uint8_t[4];
+
+    static void pack(const glm::vec3& value, storage& out, const VertexQuantizer::PositionBounds&){
+        for(int i = 0; i < 3; i++){
+            out[i] = VertexQuantizer::encodeUnorm8(value[i]);
+        }
+        out[3] = 255;
+    }
+    static glm::vec3 unpack(const storage& in, const VertexQuantizer::PositionBounds&){
+        return glm::vec3{float(in[0]), float(in[1]), float(in[2])} / 255.0f;
+    }
+};
+
+struct Half2{
+    static constexpr VkFormat FORMAT = VK_FORMAT_R16G16_SFLOAT;
+    using storage = uint16_t[2];
+
+    static void pack(const glm::vec2& value, storage& out, const VertexQuantizer::PositionBounds&){
+        out[0] = VertexQuantizer::encodeHalf(value.x);
+        out[1] = VertexQuantizer::encodeHalf(value.y);
+    }
+    static glm::vec2 unpack(const storage& in, const VertexQuantizer::PositionBounds&){
+        return {VertexQuantizer::decodeHalf(in[0]), VertexQuantizer::decodeHalf(in[1])};
+    }
+};
+
+}   //  namespace vertexEncoding
+
+//  One attribute of a layout, "Offset" is offsetof the member holding Encoding::storage
+template <uint32_t Location, VertexSemantic Semantic, typename Encoding, size_t Offset>
+struct VertexAttribute{
+    static constexpr uint32_t LOCATION = Location;
+    static constexpr VertexSemantic SEMANTIC = Semantic;
+    static constexpr uint32_t OFFSET = static_cast<uint32_t>(Offset);
+    using encoding = Encoding;
+
+    template <typename VertexT>
+    static void pack(const Model::Vertex& vertex, VertexT& out, const VertexQuantizer::PositionBounds& bounds){
+        Encoding::pack(vertexSemanticMember<Semantic>::get(vertex), member(out), bounds);
+    }
+    template <typename VertexT>
+    static void unpack(const VertexT& in, Model::Vertex& out, const VertexQuantizer::PositionBounds& bounds){
+        vertexSemanticMember<Semantic>::get(out) = Encoding::unpack(member(in), bounds);
+    }
+
+private:
+    template <typename VertexT>
+    static typename Encoding::storage& member(VertexT& vertex){
+        static_assert(Offset + sizeof(typename Encoding::storage) <= sizeof(VertexT), "attribute outside of its vertex");
+        return *reinterpret_cast<typename Encoding::storage*>(reinterpret_cast<unsigned char*>(&vertex) + Offset);
+    }
+    template <typename VertexT>
+    static const typename Encoding::storage& member(const VertexT& vertex){
+        static_assert(Offset + sizeof(typename Encoding::storage) <= sizeof(VertexT), "attribute outside of its vertex");
+        return *reinterpret_cast<const typename Encoding::storage*>(reinterpret_cast<const unsigned char*>(&vertex) + Offset);
+    }
+};
+
+//  Attributes of one vertex buffer binding, one VertexT per vertex
+template <typename VertexT, uint32_t Binding, typename... Attributes>
+struct VertexLayout{
+    using vertex = VertexT;
+    static constexpr uint32_t BINDING = Binding;
+
+    static constexpr VkVertexInputBindingDescription bindingDescription{Binding, sizeof(VertexT), VK_VERTEX_INPUT_RATE_VERTEX};
+    //  Order of param      =>      location, binding, format, offset
+    static constexpr std::array<VkVertexInputAttributeDescription, sizeof...(Attributes)> attributeDescriptions{{
+        {Attributes::LOCATION, Binding, Attributes::encoding::FORMAT, Attributes::OFFSET}...
+    }};
+
+    static void pack(const Model::Vertex& vertex, VertexT& out, const VertexQuantizer::PositionBounds& bounds){
+        (Attributes::pack(vertex, out, bounds), ...);
+    }
+    //  only the members this layout carries, on top of whatever "out" holds
+    static void unpack(const VertexT& in, Model::Vertex& out, const VertexQuantizer::PositionBounds& bounds){
+        (Attributes::unpack(in, out, bounds), ...);
+    }
+};
+
+//  What PipelineConfigInfo keeps of a VertexInput -> points at its static arrays, nothing to copy or free
+struct VertexInputDescription{
+    const VkVertexInputBindingDescription* bindings = nullptr;
+    uint32_t bindingCount = 0;
+    const VkVertexInputAttributeDescription* attributes = nullptr;
+    uint32_t attributeCount = 0;
+
+    //  bit per binding, see Pipeline::getVertexBindingMask
+    constexpr uint32_t bindingMask() const{
+        uint32_t mask = 0;
+        for(uint32_t i = 0; i < bindingCount; i++){
+            mask |= 1u << bindings[i].binding;
+        }
+        return mask;
+    }
+};
+
+//  Attribute arrays of several bindings as one array
+template <size_t... Counts>
+constexpr std::array<VkVertexInputAttributeDescription, (Counts + ...)> joinVertexAttributes(
+    const std::array<VkVertexInputAttributeDescription, Counts>&... parts){
+    std::array<VkVertexInputAttributeDescription, (Counts + ...)> joined{};
+    size_t next = 0;
+    auto append = [&](const auto& part){
+        for(const auto& attribute : part){
+            joined[next++] = attribute;
+        }
+    };
+    (append(parts), ...);
+    return joined;
+}
+
+//  Everything a pipeline reads : one layout per binding, streams lie back to back in one buffer
+template <typename... Layouts>
+struct VertexInput{
+    static constexpr size_t STREAM_COUNT = sizeof...(Layouts);
+    //  start of every stream is aligned to this -> offsets stay valid bind offsets and element aligned
+    static constexpr size_t STREAM_ALIGNMENT = 16;
+
+    static constexpr std::array<VkVertexInputBindingDescription, STREAM_COUNT> bindingDescriptions{{Layouts::bindingDescription...}};
+    static constexpr auto attributeDescriptions = joinVertexAttributes(Layouts::attributeDescriptions...);
+
+    static constexpr VertexInputDescription description(){
+        return {bindingDescriptions.data(), static_cast<uint32_t>(bindingDescriptions.size()),
+                attributeDescriptions.data(), static_cast<uint32_t>(attributeDescriptions.size())};
+    }
+
+    //  Byte offset of every stream for "count" vertices, returns the size of the whole buffer
+    static size_t streamOffsets(uint32_t count, std::array<size_t, STREAM_COUNT>& offsets){
+        const size_t strides[] = {sizeof(typename Layouts::vertex)...};
+        size_t size = 0;
+        for(size_t i = 0; i < STREAM_COUNT; i++){
+            offsets[i] = (size + STREAM_ALIGNMENT - 1) & ~(STREAM_ALIGNMENT - 1);
+            size = offsets[i] + strides[i] * count;
+        }
+        return size;
+    }
+    //  "data" holds streamOffsets(count) bytes
+    static void pack(const Model::Vertex* vertices, uint32_t count, uint8_t* data, const VertexQuantizer::PositionBounds& bounds){
+        std::array<size_t, STREAM_COUNT> offsets{};
+        streamOffsets(count, offsets);
+        packStreams(vertices, count, data, offsets, bounds, std::index_sequence_for<Layouts...>{});
+    }
+    static Model::Vertex unpack(const uint8_t* data, uint32_t count, uint32_t index, const VertexQuantizer::PositionBounds& bounds){
+        std::array<size_t, STREAM_COUNT> offsets{};
+        streamOffsets(count, offsets);
+        Model::Vertex vertex{};
+        unpackStreams(data, offsets, index, vertex, bounds, std::index_sequence_for<Layouts...>{});
+        return vertex;
+    }
+
+private:
+    template <size_t... Stream>
+    static void packStreams(const Model::Vertex* vertices, uint32_t count, uint8_t* data, const std::array<size_t, STREAM_COUNT>& offsets,
+                            const VertexQuantizer::PositionBounds& bounds, std::index_sequence<Stream...>){
+        (packStream<Layouts>(vertices, count, data + offsets[Stream], bounds), ...);
+    }
+    template <typename Layout>
+    static void packStream(const Model::Vertex* vertices, uint32_t count, uint8_t* data, const VertexQuantizer::PositionBounds& bounds){
+        auto out = reinterpret_cast<typename Layout::vertex*>(data);
+        for(uint32_t i = 0; i < count; i++){
+            Layout::pack(vertices[i], out[i], bounds);
+        }
+    }
+    template <size_t... Stream>
+    static void unpackStreams(const uint8_t* data, const std::array<size_t, STREAM_COUNT>& offsets, uint32_t index, Model::Vertex& vertex,
+                              const VertexQuantizer::PositionBounds& bounds, std::index_sequence<Stream...>){
+        (Layouts::unpack(reinterpret_cast<const typename Layouts::vertex*>(data + offsets[Stream])[index], vertex, bounds), ...);
+    }
+};
+
+//  Layouts of Model::VertexFormat, all of them use the locations of Model::Vertex -> one fragment shader for every format
+using FullVertexLayout = VertexLayout<Model::Vertex, 0,
+    VertexAttribute<0, VertexSemantic::POSITION, vertexEncoding::Float3, offsetof(Model::Vertex, position)>,
+    VertexAttribute<1, VertexSemantic::COLOR, vertexEncoding::Float3, offsetof(Model::Vertex, color)>,
+    VertexAttribute<2, VertexSemantic::NORMAL, vertexEncoding::Float3, offsetof(Model::Vertex, normal)>,
+    VertexAttribute<3, VertexSemantic::UV, vertexEncoding::Float2, offsetof(Model::Vertex, uv)>>;
+
+//  every format here is mandatory for vertex buffers
+using CompactVertexLayout = VertexLayout<Model::CompactVertex, 0,
+    VertexAttribute<0, VertexSemantic::POSITION, vertexEncoding::BoundsSnorm16x4, offsetof(Model::CompactVertex, position)>,
+    VertexAttribute<1, VertexSemantic::COLOR, vertexEncoding::Unorm8x4, offsetof(Model::CompactVertex, color)>,
+    VertexAttribute<2, VertexSemantic::NORMAL, vertexEncoding::OctahedralSnorm16x2, offsetof(Model::CompactVertex, normal)>,
+    VertexAttribute<3, VertexSemantic::UV, vertexEncoding::Half2, offsetof(Model::CompactVertex, uv)>>;
+
+using PositionStreamLayout = VertexLayout<glm::vec3, 0,
+    VertexAttribute<0, VertexSemantic::POSITION, vertexEncoding::Float3, 0>>;
+using AttributeStreamLayout = VertexLayout<Model::SplitAttributes, 1,
+    VertexAttribute<1, VertexSemantic::COLOR, vertexEncoding::Float3, offsetof(Model::SplitAttributes, color)>,
+    VertexAttribute<2, VertexSemantic::NORMAL, vertexEncoding::Float3, offsetof(Model::SplitAttributes, normal)>,
+    VertexAttribute<3, VertexSemantic::UV, vertexEncoding::Float2, offsetof(Model::SplitAttributes, uv)>>;
+
+using FullVertexInput = VertexInput<FullVertexLayout>;
+using CompactVertexInput = VertexInput<CompactVertexLayout>;
+using SplitVertexInput = VertexInput<PositionStreamLayout, AttributeStreamLayout>;
+//  binding 0 of SPLIT alone -> depth prepass(SimpleRenderSystem), reads nothing but location 0
+using PositionVertexInput = VertexInput<PositionStreamLayout>;
+
+}   //  namespace VULKVULK
+
+#endif
@@ -0,0 +1,134 @@
+#include "vertexQuantizer.h"
+#include "vertexLayout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace VULKVULK{
+
+static_assert(sizeof(Model::CompactVertex) == 20, "CompactVertex should stay tightly packed");
+
+glm::mat4 VertexQuantizer::PositionBounds::dequantizeMatrix() const{
+    return glm::scale(glm::translate(glm::mat4{1.0f}, center), extent);
+}
+
+VertexQuantizer::PositionBounds VertexQuantizer::computeBounds(const Model::Vertex* vertices, uint32_t count){
+    PositionBounds bounds{};
+    if(count == 0){
+        return bounds;
+    }
+    glm::vec3 minPos = vertices[0].position;
+    glm::vec3 maxPos = vertices[0].position;
+    for(uint32_t i = 1; i < count; i++){
+        minPos = glm::min(minPos, vertices[i].position);
+        maxPos = glm::max(maxPos, vertices[i].position);
+    }
+    bounds.center = (minPos + maxPos) * 0.5f;
+    bounds.extent = (maxPos - minPos) * 0.5f;
+    for(int axis = 0; axis < 3; axis++){
+        if(!(bounds.extent[axis] > 0.0f)){
+            bounds.extent[axis] = 1.0f;
+        }
+    }
+    return bounds;
+}
+
+Model::CompactVertex VertexQuantizer::encode(const Model::Vertex& vertex, const PositionBounds& bounds){
+    Model::CompactVertex compact{};
+    CompactVertexLayout::pack(vertex, compact, bounds);
+    return compact;
+}
+
+Model::Vertex VertexQuantizer::decode(const Model::CompactVertex& vertex, const PositionBounds& bounds){
+    Model::Vertex full{};
+    CompactVertexLayout::unpack(vertex, full, bounds);
+    return full;
+}
+
+void VertexQuantizer::quantize(const Model::bufferView& bView, std::vector<Model::CompactVertex>& out, PositionBounds& bounds){
+    bounds = computeBounds(bView.vertices, bView.vertexCount);
+    out.resize(bView.vertexCount);
+    CompactVertexInput::pack(bView.vertices, bView.vertexCount, reinterpret_cast<uint8_t*>(out.data()), bounds);
+}
+
+int16_t VertexQuantizer::encodeSnorm16(float value){
+    return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+//  VK_FORMAT_*_SNORM : -32768 and -32767 both map to -1
+float VertexQuantizer::decodeSnorm16(int16_t value){
+    return std::max(float(value) / 32767.0f, -1.0f);
+}
+
+uint8_t VertexQuantizer::encodeUnorm8(float value){
+    return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+uint16_t VertexQuantizer::encodeHalf(float value){
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    const uint32_t absBits = bits & 0x7FFFFFFF;
+    if(absBits >= 0x7F800000){          //  inf, nan(keep it quiet)
+        return sign | 0x7C00 | (absBits > 0x7F800000 ? 0x0200 : 0);
+    }
+    if(absBits >= 0x477FF000){          //  >= 65520 rounds past the largest half
+        return sign | 0x7C00;
+    }
+    if(absBits < 0x38800000){           //  below 2^-14 -> half subnormal, scaled value is exact in float
+        float absValue;
+        std::memcpy(&absValue, &absBits, sizeof(absValue));
+        return sign | static_cast<uint16_t>(std::nearbyint(absValue * 16777216.0f));
+    }
+    //  rebias exponent(127 -> 15) and round to nearest even on the 13 dropped mantissa bits
+    uint32_t rounded = absBits - 0x38000000 + 0x0FFF + ((absBits >> 13) & 1);
+    return sign | static_cast<uint16_t>(rounded >> 13);
+}
+
+float VertexQuantizer::decodeHalf(uint16_t value){
+    const uint32_t sign = uint32_t(value & 0x8000) << 16;
+    const uint32_t exponent = (value >> 10) & 0x1F;
+    const uint32_t mantissa = value & 0x03FF;
+    uint32_t bits;
+    if(exponent == 0){
+        float magnitude = std::ldexp(float(mantissa), -24);
+        std::memcpy(&bits, &magnitude, sizeof(bits));
+        bits |= sign;
+    }
+    else if(exponent == 31){
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    }
+    else{
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+glm::vec2 VertexQuantizer::encodeOctahedral(const glm::vec3& normal){
+    float l1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if(!(l1 > 0.0f)){
+        return glm::vec2{0.0f};
+    }
+    glm::vec2 p = glm::vec2{normal.x, normal.y} / l1;
+    if(normal.z < 0.0f){
+        //  fold lower hemisphere over the diagonals
+        glm::vec2 folded{1.0f - std::abs(p.y), 1.0f - std::abs(p.x)};
+        p.x = p.x >= 0.0f ? folded.x : -folded.x;
+        p.y = p.y >= 0.0f ? folded.y : -folded.y;
+    }
+    return p;
+}
+
+//  Same math as simple_compact.vert
+glm::vec3 VertexQuantizer::decodeOctahedral(const glm::vec2& encoded){
+    glm::vec3 n{encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y)};
+    float t = std::max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return glm::normalize(n);
+}
+
+}   //  namespace VULKVULK
@@ -0,0 +1,42 @@
+#ifndef VERTEX_QUANTIZER_H
+#define VERTEX_QUANTIZER_H
+
+#include "model.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace VULKVULK{
+
+//  Encoders for Model::CompactVertex(the encodings of vertexLayout.h build on the scalar ones here), decoders mirror
+//  what the gpu does with the matching VkFormat(used to measure error)
+class VertexQuantizer{
+public:
+    //  Position is stored relative to the mesh bounds -> decoded = center + extent * snorm
+    struct PositionBounds{
+        glm::vec3 center{0.0f};
+        glm::vec3 extent{1.0f};     //  half size, never 0 so flat meshes still decode
+
+        //  folded into the model matrix so the shader never sees these values
+        glm::mat4 dequantizeMatrix() const;
+    };
+    static PositionBounds computeBounds(const Model::Vertex* vertices, uint32_t count);
+
+    static Model::CompactVertex encode(const Model::Vertex& vertex, const PositionBounds& bounds);
+    static Model::Vertex decode(const Model::CompactVertex& vertex, const PositionBounds& bounds);
+    static void quantize(const Model::bufferView& bView, std::vector<Model::CompactVertex>& out, PositionBounds& bounds);
+
+    static int16_t encodeSnorm16(float value);
+    static float decodeSnorm16(int16_t value);
+    static uint8_t encodeUnorm8(float value);
+    //  IEEE half, round to nearest even
+    static uint16_t encodeHalf(float value);
+    static float decodeHalf(uint16_t value);
+    //  Unit vector -> point on octahedron unfolded to [-1,1]^2, zero vector encodes to (0,0)
+    static glm::vec2 encodeOctahedral(const glm::vec3& normal);
+    static glm::vec3 decodeOctahedral(const glm::vec2& encoded);
+};
+
+}   //  namespace VULKVULK
+
+#endif
@@ -0,0 +1,193 @@
+#include "vertexWelder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace VULKVULK{
+
+namespace{
+
+constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+//  cell coordinates are packed 21 bits per axis, counted from the mesh minimum -> cellSize >= extent * 1e-6 keeps them in
+//  range wherever the mesh sits, only degenerate extents clamp onto the border cells(slower, still correct)
+constexpr int64_t CELL_LIMIT = (int64_t(1) << 20) - 1;
+
+//  Open addressing(linear probing) map from packed cell coordinates to the representatives inside the cell,
+//  kept as a linked list in creation order -> the first match of a walk is the lowest index in that cell
+class cellGrid{
+public:
+    explicit cellGrid(size_t vertexCount){
+        size_t slotCount = 64;
+        while(slotCount < vertexCount * 2){
+            slotCount <<= 1;
+        }
+        keys.assign(slotCount, 0);
+        heads.assign(slotCount, NONE);
+        tails.assign(slotCount, NONE);
+        mask = slotCount - 1;
+    }
+
+    static uint64_t key(int64_t x, int64_t y, int64_t z){
+        auto axis = [](int64_t value){ return uint64_t(std::clamp(value, -CELL_LIMIT, CELL_LIMIT) + CELL_LIMIT + 1); };
+        return (axis(x) << 42) | (axis(y) << 21) | axis(z);     //  never 0 -> 0 marks an empty slot
+    }
+
+    //  first representative of the cell, NONE if the cell is empty
+    uint32_t head(uint64_t cell) const{
+        for(size_t slot = hash(cell) & mask; keys[slot] != 0; slot = (slot + 1) & mask){
+            if(keys[slot] == cell){
+                return heads[slot];
+            }
+        }
+        return NONE;
+    }
+
+    //  at most one slot per representative and the table is 2x the vertex count -> never full
+    void append(uint64_t cell, uint32_t representative, std::vector<uint32_t>& next){
+        size_t slot = hash(cell) & mask;
+        while(keys[slot] != 0 && keys[slot] != cell){
+            slot = (slot + 1) & mask;
+        }
+        if(keys[slot] == 0){
+            keys[slot] = cell;
+            heads[slot] = representative;
+        }
+        else{
+            next[tails[slot]] = representative;
+        }
+        tails[slot] = representative;
+    }
+
+private:
+    static size_t hash(uint64_t cell){
+        cell ^= cell >> 33;
+        cell *= 0xff51afd7ed558ccdull;
+        cell ^= cell >> 33;
+        return static_cast<size_t>(cell);
+    }
+
+    std::vector<uint64_t> keys;
+    std::vector<uint32_t> heads;
+    std::vector<uint32_t> tails;
+    size_t mask = 0;
+};
+
+template <typename V>
+bool within(const V& a, const V& b, float limit){
+    if(limit < 0.0f){
+        return a == b;
+    }
+    const V d = a - b;
+    return glm::dot(d, d) <= limit * limit;
+}
+
+bool similar(const Model::Vertex& a, const Model::Vertex& b, const VertexWelder::tolerance& limits){
+    return within(a.position, b.position, limits.position)
+        && within(a.normal, b.normal, limits.normal)
+        && within(a.color, b.color, limits.color)
+        && within(a.uv, b.uv, limits.uv);
+}
+
+}   //  namespace
+
+VertexWelder::Stats VertexWelder::weld(Model::bufferData& bData, const tolerance& limits){
+    Stats stats{};
+    stats.vertexCount = static_cast<uint32_t>(bData.vertices.size());
+    if(bData.vertices.empty()){
+        return stats;
+    }
+
+    //  cell = position tolerance, exact positions still get a grid fine enough to keep cells small
+    glm::vec3 minimum{std::numeric_limits<float>::max()};
+    glm::vec3 maximum{-std::numeric_limits<float>::max()};
+    for(const auto& vertex : bData.vertices){
+        minimum = glm::min(minimum, vertex.position);
+        maximum = glm::max(maximum, vertex.position);
+    }
+    const glm::vec3 extent = maximum - minimum;
+    const float cellSize = std::max({limits.position, std::max({extent.x, extent.y, extent.z}) * 1e-6f,
+                                     std::numeric_limits<float>::min()});
+    const float inverseCell = 1.0f / cellSize;
+    //  relative to the minimum -> meshes far from the origin(georeferenced scans) get the same cells as at the origin
+    auto cellOf = [&](const glm::vec3& position, int axis){
+        return static_cast<int64_t>(std::floor((static_cast<double>(position[axis]) - minimum[axis]) * inverseCell));
+    };
+
+    //  representatives in first use order -> the welded array comes out in vertex fetch friendly order as well
+    std::vector<uint32_t> remap(bData.vertices.size(), NONE);
+    std::vector<Model::Vertex> welded{};
+    std::vector<uint32_t> next{};
+    welded.reserve(bData.vertices.size());
+    next.reserve(bData.vertices.size());
+    cellGrid grid{bData.vertices.size()};
+    for(uint32_t index : bData.indices){
+        if(remap[index] != NONE){
+            continue;
+        }
+        const Model::Vertex& vertex = bData.vertices[index];
+        const int64_t x = cellOf(vertex.position, 0);
+        const int64_t y = cellOf(vertex.position, 1);
+        const int64_t z = cellOf(vertex.position, 2);
+        uint32_t match = NONE;
+        for(int64_t dz = -1; dz <= 1; dz++){
+            for(int64_t dy = -1; dy <= 1; dy++){
+                for(int64_t dx = -1; dx <= 1; dx++){
+                    for(uint32_t r = grid.head(cellGrid::key(x + dx, y + dy, z + dz)); r != NONE && r < match; r = next[r]){
+                        if(similar(welded[r], vertex, limits)){
+                            match = r;
+                        }
+                    }
+                }
+            }
+        }
+        if(match == NONE){
+            match = static_cast<uint32_t>(welded.size());
+            welded.push_back(vertex);
+            next.push_back(NONE);
+            grid.append(cellGrid::key(x, y, z), match, next);
+        }
+        else{
+            stats.mergedVertices++;
+        }
+        remap[index] = match;
+    }
+
+    //  triangles that lost an edge cover no area anymore, submeshes shrink by what they lost
+    const std::vector<Model::submesh> parts = bData.submeshes;
+    size_t part = 0;
+    size_t write = 0;
+    for(size_t i = 0; i + 2 < bData.indices.size(); i += 3){
+        const uint32_t a = remap[bData.indices[i]];
+        const uint32_t b = remap[bData.indices[i + 1]];
+        const uint32_t c = remap[bData.indices[i + 2]];
+        if(a == b || b == c || a == c){
+            while(part < parts.size() && parts[part].firstIndex + parts[part].indexCount <= i){
+                part++;
+            }
+            if(part < parts.size()){
+                bData.submeshes[part].indexCount -= 3;
+            }
+            stats.removedTriangles++;
+            continue;
+        }
+        bData.indices[write++] = a;
+        bData.indices[write++] = b;
+        bData.indices[write++] = c;
+    }
+    bData.indices.resize(write);
+    uint32_t firstIndex = 0;
+    for(auto& submesh : bData.submeshes){
+        submesh.firstIndex = firstIndex;
+        firstIndex += submesh.indexCount;
+    }
+    bData.submeshes.erase(std::remove_if(bData.submeshes.begin(), bData.submeshes.end(),
+                                         [](const Model::submesh& submesh){ return submesh.indexCount == 0; }),
+                          bData.submeshes.end());
+    bData.vertices = std::move(welded);
+    stats.weldedCount = static_cast<uint32_t>(bData.vertices.size());
+    return stats;
+}
+
+}   //  namespace VULKVULK
@@ -0,0 +1,42 @@
+#ifndef VERTEX_WELDER_H
+#define VERTEX_WELDER_H
+
+#include "model.h"
+
+#include <cstdint>
+
+namespace VULKVULK{
+
+//  Merges vertices that only differ by float noise(photogrammetry/scan exports) -> the exact dedup of the loaders
+//  keeps them apart since they are not bit identical
+//
+//  Candidates come from a spatial hash grid on positions(cell = position tolerance -> the 27 cells around a vertex
+//  hold everything within reach). Vertices are visited in index buffer order and each one maps to the lowest index
+//  representative within every tolerance, otherwise it becomes a representative itself.
+//  Representatives keep their attributes as they are(no averaging) -> same result for the same input, every time,
+//  on any thread count, and every position used afterwards is one the mesh already had(bounds stay valid)
+class VertexWelder{
+public:
+    //  Euclidean distances between the attributes of two vertices, negative -> attribute has to match exactly
+    struct tolerance{
+        float position = 0.0f;      //  model space
+        float normal = 0.0f;        //  between normals, ~angle in radians for unit normals
+        float color = 0.0f;
+        float uv = 0.0f;
+    };
+    struct Stats{
+        uint32_t vertexCount = 0;       //  before
+        uint32_t weldedCount = 0;       //  after
+        uint32_t mergedVertices = 0;    //  mapped onto another vertex
+        uint32_t removedTriangles = 0;  //  collapsed to a line or a point by the merge
+    };
+
+    //  Welds bData.vertices, remaps bData.indices and drops triangles that lost an edge(submesh ranges follow)
+    //  Runs right after loading -> expects no LODs/meshlets yet, bounds stay valid
+    //  vertices only used by dropped triangles stay in the array(MeshOptimizer::optimizeVertexFetch drops them)
+    static Stats weld(Model::bufferData& bData, const tolerance& limits);
+};
+
+}   //  namespace VULKVULK
+
+#endif